@@ -0,0 +1,8 @@
+#! /usr/bin/env python
+
+# Programs that are runnable.
+ns3_runnable_programs = ['build/src/bridge/examples/ns3-dev-csma-bridge-debug', 'build/src/bridge/examples/ns3-dev-csma-bridge-one-hop-debug', 'build/src/config-store/examples/ns3-dev-config-store-save-debug', 'build/src/core/examples/ns3-dev-main-callback-debug', 'build/src/core/examples/ns3-dev-sample-simulator-debug', 'build/src/core/examples/ns3-dev-main-ptr-debug', 'build/src/core/examples/ns3-dev-main-random-variable-debug', 'build/src/core/examples/ns3-dev-main-random-variable-stream-debug', 'build/src/core/examples/ns3-dev-sample-random-variable-debug', 'build/src/core/examples/ns3-dev-sample-random-variable-stream-debug', 'build/src/core/examples/ns3-dev-command-line-example-debug', 'build/src/core/examples/ns3-dev-hash-example-debug', 'build/src/core/examples/ns3-dev-sample-log-time-format-debug', 'build/src/core/examples/ns3-dev-test-string-value-formatting-debug', 'build/src/core/examples/ns3-dev-main-test-sync-debug', 'build/src/csma/examples/ns3-dev-csma-one-subnet-debug', 'build/src/csma/examples/ns3-dev-csma-broadcast-debug', 'build/src/csma/examples/ns3-dev-csma-packet-socket-debug', 'build/src/csma/examples/ns3-dev-csma-multicast-debug', 'build/src/csma/examples/ns3-dev-csma-raw-ip-socket-debug', 'build/src/csma/examples/ns3-dev-csma-ping-debug', 'build/src/internet/examples/ns3-dev-main-simple-debug', 'build/src/mobility/examples/ns3-dev-main-grid-topology-debug', 'build/src/mobility/examples/ns3-dev-main-random-topology-debug', 'build/src/mobility/examples/ns3-dev-main-random-walk-debug', 'build/src/mobility/examples/ns3-dev-mobility-trace-example-debug', 'build/src/mobility/examples/ns3-dev-ns2-mobility-trace-debug', 'build/src/mobility/examples/ns3-dev-bonnmotion-ns2-example-debug', 'build/src/network/examples/ns3-dev-main-packet-header-debug', 'build/src/network/examples/ns3-dev-main-packet-tag-debug', 'build/src/network/examples/ns3-dev-packet-socket-apps-debug', 'build/src/point-to-point/examples/ns3-dev-main-attribute-value-debug', 'build/src/stats/examples/ns3-dev-gnuplot-example-debug', 'build/src/stats/examples/ns3-dev-double-probe-example-debug', 'build/src/stats/examples/ns3-dev-time-probe-example-debug', 'build/src/stats/examples/ns3-dev-gnuplot-aggregator-example-debug', 'build/src/stats/examples/ns3-dev-gnuplot-helper-example-debug', 'build/src/stats/examples/ns3-dev-file-aggregator-example-debug', 'build/src/stats/examples/ns3-dev-file-helper-example-debug', 'build/src/traffic-control/examples/ns3-dev-red-tests-debug', 'build/src/traffic-control/examples/ns3-dev-red-vs-ared-debug', 'build/src/traffic-control/examples/ns3-dev-adaptive-red-tests-debug', 'build/src/traffic-control/examples/ns3-dev-pfifo-vs-red-debug', 'build/src/traffic-control/examples/ns3-dev-codel-vs-pfifo-basic-test-debug', 'build/src/traffic-control/examples/ns3-dev-codel-vs-pfifo-asymmetric-debug', 'build/src/traffic-control/examples/ns3-dev-pie-example-debug', 'build/src/traffic-control/examples/ns3-dev-pi-square-example-debug', 'build/src/traffic-control/examples/ns3-dev-dual-q-coupled-pi-square-example-debug', 'build/examples/tcp/ns3-dev-tcp-large-transfer-debug', 'build/examples/tcp/ns3-dev-tcp-nsc-lfn-debug', 'build/examples/tcp/ns3-dev-tcp-nsc-zoo-debug', 'build/examples/tcp/ns3-dev-tcp-star-server-debug', 'build/examples/tcp/ns3-dev-tcp-bulk-send-debug', 'build/examples/tcp/ns3-dev-tcp-pcap-nanosec-example-debug', 'build/examples/tcp/ns3-dev-tcp-nsc-comparison-debug', 'build/examples/tcp/ns3-dev-tcp-variants-comparison-debug', 'build/examples/tcp/ns3-dev-dctcp-example-debug', 'build/examples/tcp/ns3-dev-tcp-prague-example-debug', 'build/examples/tcp/ns3-dev-tcp-fluid-dualq-example-debug', 'build/examples/routing/ns3-dev-dynamic-global-routing-debug', 'build/examples/routing/ns3-dev-static-routing-slash32-debug', 'build/examples/routing/ns3-dev-global-routing-slash32-debug', 'build/examples/routing/ns3-dev-global-injection-slash32-debug', 'build/examples/routing/ns3-dev-simple-global-routing-debug', 'build/examples/routing/ns3-dev-simple-alternate-routing-debug', 'build/examples/routing/ns3-dev-mixed-global-routing-debug', 'build/examples/routing/ns3-dev-simple-routing-ping6-debug', 'build/examples/routing/ns3-dev-ripng-simple-network-debug', 'build/examples/routing/ns3-dev-rip-simple-network-debug', 'build/examples/routing/ns3-dev-global-routing-multi-switch-plus-router-debug', 'build/examples/udp-client-server/ns3-dev-udp-client-server-debug', 'build/examples/udp-client-server/ns3-dev-udp-trace-client-server-debug', 'build/examples/error-model/ns3-dev-simple-error-model-debug', 'build/examples/tutorial/ns3-dev-hello-simulator-debug', 'build/examples/tutorial/ns3-dev-first-debug', 'build/examples/tutorial/ns3-dev-second-debug', 'build/examples/tutorial/ns3-dev-fourth-debug', 'build/examples/tutorial/ns3-dev-fifth-debug', 'build/examples/tutorial/ns3-dev-sixth-debug', 'build/examples/tutorial/ns3-dev-seventh-debug', 'build/examples/udp/ns3-dev-udp-echo-debug', 'build/examples/socket/ns3-dev-socket-bound-static-routing-debug', 'build/examples/socket/ns3-dev-socket-bound-tcp-static-routing-debug', 'build/examples/socket/ns3-dev-socket-options-ipv4-debug', 'build/examples/socket/ns3-dev-socket-options-ipv6-debug', 'build/examples/realtime/ns3-dev-realtime-udp-echo-debug', 'build/examples/naming/ns3-dev-object-names-debug', 'build/examples/ipv6/ns3-dev-icmpv6-redirect-debug', 'build/examples/ipv6/ns3-dev-ping6-debug', 'build/examples/ipv6/ns3-dev-radvd-debug', 'build/examples/ipv6/ns3-dev-radvd-two-prefix-debug', 'build/examples/ipv6/ns3-dev-test-ipv6-debug', 'build/examples/ipv6/ns3-dev-fragmentation-ipv6-debug', 'build/examples/ipv6/ns3-dev-fragmentation-ipv6-two-MTU-debug', 'build/examples/ipv6/ns3-dev-loose-routing-ipv6-debug', 'build/examples/traffic-control/ns3-dev-traffic-control-debug', 'build/examples/traffic-control/ns3-dev-queue-discs-benchmark-debug', 'build/examples/traffic-control/ns3-dev-red-vs-fengadaptive-debug', 'build/examples/traffic-control/ns3-dev-red-vs-nlred-debug', 'build/scratch/subdir/ns3-dev-subdir-debug', 'build/scratch/ns3-dev-scratch-simulator-debug']
+
+# Scripts that are runnable.
+ns3_runnable_scripts = ['csma-bridge.py', 'sample-simulator.py', 'simple-routing-ping6.py', 'first.py', 'second.py', 'realtime-udp-echo.py']
+
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2007 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DROPTAIL_H
+#define DROPTAIL_H
+
+#include "ns3/queue.h"
+#include "ns3/ring-buffer.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A FIFO packet queue that drops tail-end packets on overflow
+ *
+ * Items are stored in a RingBuffer rather than in the list provided by the
+ * Queue base class, so that enqueue and dequeue operations do not allocate
+ * memory once the queue has reached its steady state occupancy.
+ */
+template <typename Item>
+class DropTailQueue : public Queue<Item>
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief DropTailQueue Constructor
+   *
+   * Creates a droptail queue with a maximum size of 100 packets by default
+   */
+  DropTailQueue ();
+
+  virtual ~DropTailQueue ();
+
+  virtual bool Enqueue (Ptr<Item> item);
+  virtual Ptr<Item> Dequeue (void);
+  virtual Ptr<Item> Remove (void);
+  virtual Ptr<const Item> Peek (void) const;
+
+private:
+  using Queue<Item>::WouldOverflow;
+  using Queue<Item>::NotifyEnqueue;
+  using Queue<Item>::NotifyDequeue;
+  using Queue<Item>::NotifyRemove;
+  using Queue<Item>::DropBeforeEnqueue;
+
+  RingBuffer<Ptr<Item> > m_items; //!< the items in the queue
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename Item>
+TypeId
+DropTailQueue<Item>::GetTypeId (void)
+{
+  static TypeId tid = TypeId (("ns3::DropTailQueue<" + GetTypeParamName<DropTailQueue<Item> > () + ">").c_str ())
+    .SetParent<Queue<Item> > ()
+    .SetGroupName ("Network")
+    .template AddConstructor<DropTailQueue<Item> > ()
+  ;
+  return tid;
+}
+
+template <typename Item>
+DropTailQueue<Item>::DropTailQueue () :
+  Queue<Item> ()
+{
+  QUEUE_LOG (LOG_LOGIC, "DropTailQueue(" << this << ")");
+}
+
+template <typename Item>
+DropTailQueue<Item>::~DropTailQueue ()
+{
+  QUEUE_LOG (LOG_LOGIC, "~DropTailQueue(" << this << ")");
+}
+
+template <typename Item>
+bool
+DropTailQueue<Item>::Enqueue (Ptr<Item> item)
+{
+  QUEUE_LOG (LOG_LOGIC, "DropTailQueue:Enqueue(" << this << ", " << item << ")");
+
+  if (WouldOverflow (item))
+    {
+      DropBeforeEnqueue (item);
+      return false;
+    }
+
+  m_items.PushBack (item);
+  NotifyEnqueue (item);
+
+  return true;
+}
+
+template <typename Item>
+Ptr<Item>
+DropTailQueue<Item>::Dequeue (void)
+{
+  QUEUE_LOG (LOG_LOGIC, "DropTailQueue:Dequeue(" << this << ")");
+
+  if (m_items.IsEmpty ())
+    {
+      QUEUE_LOG (LOG_LOGIC, "Queue empty");
+      return 0;
+    }
+
+  Ptr<Item> item = m_items.PopFront ();
+  NotifyDequeue (item);
+
+  QUEUE_LOG (LOG_LOGIC, "Popped " << item);
+
+  return item;
+}
+
+template <typename Item>
+Ptr<Item>
+DropTailQueue<Item>::Remove (void)
+{
+  QUEUE_LOG (LOG_LOGIC, "DropTailQueue:Remove(" << this << ")");
+
+  if (m_items.IsEmpty ())
+    {
+      QUEUE_LOG (LOG_LOGIC, "Queue empty");
+      return 0;
+    }
+
+  Ptr<Item> item = m_items.PopFront ();
+  NotifyRemove (item);
+
+  QUEUE_LOG (LOG_LOGIC, "Removed " << item);
+
+  return item;
+}
+
+template <typename Item>
+Ptr<const Item>
+DropTailQueue<Item>::Peek (void) const
+{
+  QUEUE_LOG (LOG_LOGIC, "DropTailQueue:Peek(" << this << ")");
+
+  if (m_items.IsEmpty ())
+    {
+      QUEUE_LOG (LOG_LOGIC, "Queue empty");
+      return 0;
+    }
+
+  return m_items.Front ();
+}
+
+} // namespace ns3
+
+#endif /* DROPTAIL_H */
@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef IP_CHECKSUM_H
+#define IP_CHECKSUM_H
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Compute the 16-bit one's complement sum of a contiguous span
+ * of bytes (RFC 1071).
+ *
+ * The span is summed a vector at a time when the compiler targets
+ * AVX2 or SSE2, and a 32-bit word at a time otherwise.  The result is
+ * folded to 16 bits but not complemented, and uses the same byte order
+ * as Buffer::Iterator::ReadU16, so that the partial sums of several
+ * spans can be added together and passed to
+ * Buffer::Iterator::CalculateIpChecksum as an initial checksum.
+ *
+ * \param data the first byte of the span
+ * \param size the number of bytes in the span
+ * \returns the folded one's complement sum of the span.
+ */
+uint16_t IpChecksumAccumulate (const uint8_t *data, uint32_t size);
+
+/**
+ * \ingroup packet
+ *
+ * \brief Incrementally update an Internet checksum (RFC 1624, eqn. 3)
+ * after a 16-bit word of the checksummed data has changed.
+ *
+ * The checksum and both words must use the same byte order.
+ *
+ * \param checksum the checksum covering the old word
+ * \param oldWord the old value of the word
+ * \param newWord the new value of the word
+ * \returns the checksum covering the new word.
+ */
+uint16_t IpChecksumUpdate (uint16_t checksum, uint16_t oldWord, uint16_t newWord);
+
+} // namespace ns3
+
+#endif /* IP_CHECKSUM_H */
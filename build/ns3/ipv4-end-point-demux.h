@@ -0,0 +1,299 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2005 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+
+#ifndef IPV4_END_POINT_DEMUX_H
+#define IPV4_END_POINT_DEMUX_H
+
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include "ns3/ipv4-address.h"
+#include "ipv4-interface.h"
+
+namespace ns3 {
+
+class Ipv4EndPoint;
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief Demultiplexes packets to various transport layer endpoints
+ *
+ * This class serves as a lookup table to match partial or full information
+ * about a four-tuple to an ns3::Ipv4EndPoint.  It internally contains a list
+ * of endpoints, and has APIs to add and find endpoints in this demux.  This
+ * code is shared in common to TCP and UDP protocols in ns3.  This demux
+ * sits between ns3's layer four and the socket layer
+ *
+ * To keep the cost of a lookup independent of the number of connections,
+ * the endpoints are also indexed in a hash table keyed by their four-tuple,
+ * which gives the exact matches, and the endpoints having a wildcard local
+ * address or a wildcard peer (e.g., the listening sockets) are indexed by
+ * local port. The endpoints notify the demux when their addresses change,
+ * so that the tables are kept up to date.
+ */
+
+class Ipv4EndPointDemux {
+public:
+  /**
+   * \brief Container of the IPv4 endpoints.
+   */
+  typedef std::list<Ipv4EndPoint *> EndPoints;
+
+  /**
+   * \brief Iterator to the container of the IPv4 endpoints.
+   */
+  typedef std::list<Ipv4EndPoint *>::iterator EndPointsI;
+
+  Ipv4EndPointDemux ();
+  ~Ipv4EndPointDemux ();
+
+  /**
+   * \brief Get the entire list of end points registered.
+   * \return list of Ipv4EndPoint
+   */
+  EndPoints GetAllEndPoints (void);
+
+  /**
+   * \brief Lookup for port local.
+   * \param port port to test
+   * \return true if a port local is in EndPoints, false otherwise
+   */
+  bool LookupPortLocal (uint16_t port);
+
+  /**
+   * \brief Lookup for address and port.
+   * \param addr address to test
+   * \param port port to test
+   * \return true if there is a match in EndPoints, false otherwise
+   */
+  bool LookupLocal (Ipv4Address addr, uint16_t port);
+
+  /**
+   * \brief lookup for a match with all the parameters.
+   *
+   * The function will return a list of most-matching EndPoints, in this order:
+   *   -# Full match
+   *   -# All but local address
+   *   -# Only local port and local address match
+   *   -# Only local port match
+   *
+   * EndPoint with disabled Rx are skipped.
+   *
+   * \param daddr destination address to test
+   * \param dport destination port to test
+   * \param saddr source address to test
+   * \param sport source port to test
+   * \param incomingInterface the incoming interface
+   * \return list of IPv4EndPoints (could be 0 element)
+   */
+  EndPoints Lookup (Ipv4Address daddr, 
+                    uint16_t dport, 
+                    Ipv4Address saddr, 
+                    uint16_t sport,
+                    Ptr<Ipv4Interface> incomingInterface);
+
+  /**
+   * \brief simple lookup for a match with all the parameters.
+   * \param daddr destination address to test
+   * \param dport destination port to test
+   * \param saddr source address to test
+   * \param sport source port to test
+   * \return IPv4EndPoint (0 if not found)
+   */
+  Ipv4EndPoint *SimpleLookup (Ipv4Address daddr, 
+                              uint16_t dport, 
+                              Ipv4Address saddr, 
+                              uint16_t sport);
+
+  /**
+   * \brief Allocate a Ipv4EndPoint.
+   * \return an empty Ipv4EndPoint instance
+   */
+  Ipv4EndPoint *Allocate (void);
+
+  /**
+   * \brief Allocate a Ipv4EndPoint.
+   * \param address IPv4 address
+   * \return an Ipv4EndPoint instance
+   */
+  Ipv4EndPoint *Allocate (Ipv4Address address);
+
+  /**
+   * \brief Allocate a Ipv4EndPoint.
+   * \param port local port
+   * \return an Ipv4EndPoint instance
+   */
+  Ipv4EndPoint *Allocate (uint16_t port);
+
+  /**
+   * \brief Allocate a Ipv4EndPoint.
+   * \param address local address
+   * \param port local port
+   * \return an Ipv4EndPoint instance
+   */
+  Ipv4EndPoint *Allocate (Ipv4Address address, uint16_t port);
+
+  /**
+   * \brief Allocate a Ipv4EndPoint.
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return an Ipv4EndPoint instance
+   */
+  Ipv4EndPoint *Allocate (Ipv4Address localAddress, 
+                          uint16_t localPort,
+                          Ipv4Address peerAddress, 
+                          uint16_t peerPort);
+
+  /**
+   * \brief Remove a end point.
+   * \param endPoint the end point to remove
+   */
+  void DeAllocate (Ipv4EndPoint *endPoint);
+
+private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Four-tuple of an end point, key of the connection table.
+   */
+  struct FourTuple
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    FourTuple (Ipv4Address localAddress, uint16_t localPort,
+               Ipv4Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Equality operator.
+     * \param other the four-tuple to compare with
+     * \return true if the four-tuples are equal
+     */
+    bool operator== (const FourTuple &other) const;
+
+    Ipv4Address m_localAddress;  //!< Local address
+    uint16_t m_localPort;        //!< Local port
+    Ipv4Address m_peerAddress;   //!< Peer address
+    uint16_t m_peerPort;         //!< Peer port
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param tuple the four-tuple
+     * \return the hash of the four-tuple
+     */
+    size_t operator() (const FourTuple &tuple) const;
+  };
+
+  /**
+   * \brief Container of the end points indexed by four-tuple.
+   */
+  typedef std::unordered_multimap<FourTuple, Ipv4EndPoint *, FourTupleHash> Connections;
+
+  /**
+   * \brief Add a newly allocated end point to the demux.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Update the tables after the addresses of an end point changed.
+   * \param endPoint the end point
+   * \param localAddress the previous local address
+   * \param peerAddress the previous peer address
+   * \param peerPort the previous peer port
+   */
+  void Rehash (Ipv4EndPoint *endPoint, Ipv4Address localAddress,
+               Ipv4Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Remove an end point from the connection table.
+   * \param endPoint the end point
+   * \param tuple the four-tuple the end point is stored with
+   */
+  void RemoveConnection (Ipv4EndPoint *endPoint, const FourTuple &tuple);
+
+  /**
+   * \brief Check if an end point may match packets of more than one peer.
+   * \param localAddress local address of the end point
+   * \param peerAddress peer address of the end point
+   * \param peerPort peer port of the end point
+   * \return true if the end point belongs to the listening table
+   */
+  static bool IsListening (Ipv4Address localAddress, Ipv4Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Allocate an ephemeral port.
+   * \returns the ephemeral port
+   */
+  uint16_t AllocateEphemeralPort (void);
+
+  /**
+   * \brief The ephemeral port.
+   */
+  uint16_t m_ephemeral;
+
+  /**
+   * \brief The last ephemeral port.
+   */
+  uint16_t m_portLast;
+
+  /**
+   * \brief The first ephemeral port.
+   */
+  uint16_t m_portFirst;
+
+  /**
+   * \brief A list of IPv4 end points.
+   */
+  EndPoints m_endPoints;
+
+  /**
+   * \brief The IPv4 end points indexed by four-tuple.
+   */
+  Connections m_connections;
+
+  /**
+   * \brief The IPv4 end points with a wildcard address or peer, by local port.
+   */
+  std::map<uint16_t, EndPoints> m_listening;
+
+  /**
+   * \brief The number of IPv4 end points using each local port.
+   */
+  std::map<uint16_t, uint32_t> m_ports;
+};
+
+} // namespace ns3
+
+#endif /* IPV4_END_POINTS_H */
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IPV4_PREFIX_TRIE_H
+#define IPV4_PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Path-compressed binary trie of IPv4 prefixes
+ *
+ * Index of the routes of Ipv4GlobalRouting and Ipv4StaticRouting. Every
+ * prefix (network and mask) is stored with a value, usually the position
+ * of the route in the routing table, and Lookup returns the values of all
+ * the prefixes matching an address in O(32) steps, whatever the number of
+ * routes. The routing protocols then apply their own selection rules
+ * (longest prefix, metric, ECMP...) to the few matching routes.
+ *
+ * Internal nodes are only created where two prefixes diverge, so the trie
+ * has less than two nodes per prefix. Prefixes with a non-contiguous mask
+ * (which Ipv4Mask allows) can not be stored in a trie: they are kept
+ * aside and checked one by one.
+ */
+class Ipv4PrefixTrie
+{
+public:
+  Ipv4PrefixTrie ();
+
+  /**
+   * \brief Remove all the prefixes
+   */
+  void Clear (void);
+
+  /**
+   * \brief Add a prefix
+   * \param network the network address
+   * \param mask the network mask
+   * \param value the value associated with the prefix
+   */
+  void Insert (Ipv4Address network, Ipv4Mask mask, uint32_t value);
+
+  /**
+   * \brief Find the prefixes matching an address
+   * \param dest the address
+   * \param values cleared, then filled with the values of the matching
+   *        prefixes, in increasing order
+   */
+  void Lookup (Ipv4Address dest, std::vector<uint32_t> &values) const;
+
+private:
+  /// Node of the trie, covering the addresses of a prefix
+  struct Node
+  {
+    uint32_t m_prefix;              //!< prefix, masked
+    uint8_t m_length;               //!< prefix length
+    int32_t m_child[2];             //!< index of the children (next bit 0 or 1), -1 if none
+    std::vector<uint32_t> m_values; //!< values of the prefix, empty for internal nodes
+  };
+
+  /// Prefix with a non-contiguous mask
+  struct Sparse
+  {
+    Ipv4Address m_network;          //!< network address
+    Ipv4Mask m_mask;                //!< network mask
+    uint32_t m_value;               //!< associated value
+  };
+
+  /**
+   * \brief Add a node
+   * \param prefix the prefix
+   * \param length the prefix length
+   * \return the index of the node
+   */
+  int32_t NewNode (uint32_t prefix, uint8_t length);
+
+  std::vector<Node> m_nodes;       //!< nodes, the root (0.0.0.0/0) first
+  std::vector<Sparse> m_sparse;    //!< prefixes with a non-contiguous mask
+};
+
+} // namespace ns3
+
+#endif /* IPV4_PREFIX_TRIE_H */
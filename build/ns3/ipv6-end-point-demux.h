@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2007-2009 Strasbourg University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sebastien Vincent <vincent@clarinet.u-strasbg.fr>
+ */
+
+#ifndef IPV6_END_POINT_DEMUX_H
+#define IPV6_END_POINT_DEMUX_H
+
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include "ns3/ipv6-address.h"
+#include "ipv6-interface.h"
+
+namespace ns3 {
+
+class Ipv6EndPoint;
+
+/**
+ * \ingroup ipv6
+ *
+ * \brief Demultiplexer for end points.
+ *
+ * As in ns3::Ipv4EndPointDemux, the end points are indexed by four-tuple
+ * for the exact matches, and by local port when their local address or
+ * their peer is a wildcard.
+ */
+class Ipv6EndPointDemux
+{
+public:
+  /**
+   * \brief Container of the IPv6 endpoints.
+   */
+  typedef std::list<Ipv6EndPoint *>EndPoints;
+
+  /**
+   * \brief Iterator to the container of the IPv6 endpoints.
+   */
+  typedef std::list<Ipv6EndPoint *>::iterator EndPointsI;
+
+  Ipv6EndPointDemux ();
+  ~Ipv6EndPointDemux ();
+
+  /**
+   * \brief Lookup for port local.
+   * \param port port to test
+   * \return true if a port local is in EndPoints, false otherwise
+   */
+  bool LookupPortLocal (uint16_t port);
+
+  /**
+   * \brief Lookup for address and port.
+   * \param addr address to test
+   * \param port port to test
+   * \return true if there is a match in EndPoints, false otherwise
+   */
+  bool LookupLocal (Ipv6Address addr, uint16_t port);
+
+  /**
+   * \brief lookup for a match with all the parameters.
+   *
+   * The function will return a list of most-matching EndPoints, in this order:
+   *   -# Full match
+   *   -# All but local address
+   *   -# Only local port and local address match
+   *   -# Only local port match
+   *
+   * EndPoint with disabled Rx are skipped.
+   *
+   * \param dst destination address to test
+   * \param dport destination port to test
+   * \param src source address to test
+   * \param sport source port to test
+   * \param incomingInterface the incoming interface
+   * \return list of IPv6EndPoints (could be 0 element)
+   */
+  EndPoints Lookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport, Ptr<Ipv6Interface> incomingInterface);
+
+  /**
+   * \brief Simple lookup for a four-tuple match.
+   * \param dst destination address to test
+   * \param dport destination port to test
+   * \param src source address to test
+   * \param sport source port to test
+   * \return match or 0 if not found
+   */
+  Ipv6EndPoint* SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport);
+
+  /**
+   * \brief Allocate a Ipv6EndPoint.
+   * \return an empty Ipv6EndPoint instance
+   */
+  Ipv6EndPoint * Allocate (void);
+
+  /**
+   * \brief Allocate a Ipv6EndPoint.
+   * \param address IPv6 address
+   * \return an Ipv6EndPoint instance
+   */
+  Ipv6EndPoint * Allocate (Ipv6Address address);
+
+  /**
+   * \brief Allocate a Ipv6EndPoint.
+   * \param port local port
+   * \return an Ipv6EndPoint instance
+   */
+  Ipv6EndPoint * Allocate (uint16_t port);
+
+  /**
+   * \brief Allocate a Ipv6EndPoint.
+   * \param address local address
+   * \param port local port
+   * \return an Ipv6EndPoint instance
+   */
+  Ipv6EndPoint * Allocate (Ipv6Address address, uint16_t port);
+
+  /**
+   * \brief Allocate a Ipv6EndPoint.
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return an Ipv6EndPoint instance
+   */
+  Ipv6EndPoint * Allocate (Ipv6Address localAddress, uint16_t localPort, Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Remove a end point.
+   * \param endPoint the end point to remove
+   */
+  void DeAllocate (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Get the entire list of end points registered.
+   * \return list of Ipv6EndPoint
+   */
+  EndPoints GetEndPoints () const;
+
+private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Four-tuple of an end point, key of the connection table.
+   */
+  struct FourTuple
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    FourTuple (Ipv6Address localAddress, uint16_t localPort,
+               Ipv6Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Equality operator.
+     * \param other the four-tuple to compare with
+     * \return true if the four-tuples are equal
+     */
+    bool operator== (const FourTuple &other) const;
+
+    Ipv6Address m_localAddress;  //!< Local address
+    uint16_t m_localPort;        //!< Local port
+    Ipv6Address m_peerAddress;   //!< Peer address
+    uint16_t m_peerPort;         //!< Peer port
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param tuple the four-tuple
+     * \return the hash of the four-tuple
+     */
+    size_t operator() (const FourTuple &tuple) const;
+  };
+
+  /**
+   * \brief Container of the end points indexed by four-tuple.
+   */
+  typedef std::unordered_multimap<FourTuple, Ipv6EndPoint *, FourTupleHash> Connections;
+
+  /**
+   * \brief Add a newly allocated end point to the demux.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Update the tables after the addresses of an end point changed.
+   * \param endPoint the end point
+   * \param localAddress the previous local address
+   * \param peerAddress the previous peer address
+   * \param peerPort the previous peer port
+   */
+  void Rehash (Ipv6EndPoint *endPoint, Ipv6Address localAddress,
+               Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Remove an end point from the connection table.
+   * \param endPoint the end point
+   * \param tuple the four-tuple the end point is stored with
+   */
+  void RemoveConnection (Ipv6EndPoint *endPoint, const FourTuple &tuple);
+
+  /**
+   * \brief Check if an end point may match packets of more than one peer.
+   * \param localAddress local address of the end point
+   * \param peerAddress peer address of the end point
+   * \param peerPort peer port of the end point
+   * \return true if the end point belongs to the listening table
+   */
+  static bool IsListening (Ipv6Address localAddress, Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Allocate a ephemeral port.
+   * \return a port
+   */
+  uint16_t AllocateEphemeralPort ();
+
+  /**
+   * \brief The ephemeral port.
+   */
+  uint16_t m_ephemeral;
+
+  /**
+   * \brief The first ephemeral port.
+   */
+  uint16_t m_portFirst;
+
+  /**
+   * \brief The last ephemeral port.
+   */
+  uint16_t m_portLast;
+
+  /**
+   * \brief A list of IPv6 end points.
+   */
+  EndPoints m_endPoints;
+
+  /**
+   * \brief The IPv6 end points indexed by four-tuple.
+   */
+  Connections m_connections;
+
+  /**
+   * \brief The IPv6 end points with a wildcard address or peer, by local port.
+   */
+  std::map<uint16_t, EndPoints> m_listening;
+
+  /**
+   * \brief The number of IPv6 end points using each local port.
+   */
+  std::map<uint16_t, uint32_t> m_ports;
+};
+
+} /* namespace ns3 */
+
+#endif /* IPV6_END_POINT_DEMUX_H */
+
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MAPPED_PCAP_FILE_H
+#define MAPPED_PCAP_FILE_H
+
+#include <string>
+#include <stdint.h>
+#include <cstddef>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \brief A read-only pcap file, mapped in memory
+ *
+ * Unlike PcapFile, which reads each record through an iostream, the whole
+ * file is mapped in the address space of the process and the records are
+ * browsed in place with an Iterator, without any copy nor system call per
+ * record:
+ *
+ * \code
+ *   MappedPcapFile file;
+ *   if (file.Open ("trace.pcap"))
+ *     {
+ *       for (MappedPcapFile::Iterator i = file.Begin (); i != file.End (); ++i)
+ *         {
+ *           Consume (i->timestamp, i->data, i->inclLen);
+ *         }
+ *     }
+ * \endcode
+ *
+ * The kernel is told that the file is read sequentially, and the iterator
+ * asks for the pages ahead of the current record to be read in advance, so
+ * that very large traces can be replayed at memory speed.
+ *
+ * Files in both byte orders, with microsecond or nanosecond timestamps,
+ * are supported. A truncated last record ends the iteration.
+ */
+class MappedPcapFile
+{
+public:
+  /**
+   * \brief A record of the file
+   */
+  struct Record
+  {
+    Time timestamp;      //!< Timestamp of the packet
+    uint32_t inclLen;    //!< Number of bytes of packet data in the file
+    uint32_t origLen;    //!< Original length of the packet
+    const uint8_t *data; //!< Packet data, valid while the file is open
+  };
+
+  /**
+   * \brief Iterator over the records of a MappedPcapFile
+   */
+  class Iterator
+  {
+public:
+    Iterator ();
+    /**
+     * \return a reference to the current record
+     */
+    const Record & operator * (void) const;
+    /**
+     * \return a pointer to the current record
+     */
+    const Record * operator -> (void) const;
+    /**
+     * Move to the next record
+     * \return a reference to this iterator
+     */
+    Iterator & operator ++ (void);
+    /**
+     * \param o the other iterator
+     * \return true if both iterators refer to the same record
+     */
+    bool operator == (const Iterator &o) const;
+    /**
+     * \param o the other iterator
+     * \return true if the iterators refer to different records
+     */
+    bool operator != (const Iterator &o) const;
+private:
+    /// Friend class
+    friend class MappedPcapFile;
+    /**
+     * \param file the file to iterate over
+     * \param offset the offset of the record header
+     */
+    Iterator (const MappedPcapFile *file, std::size_t offset);
+    /**
+     * Decode the record at m_offset, or move to the end of the file if
+     * there is no complete record there
+     */
+    void Load (void);
+
+    const MappedPcapFile *m_file; //!< the file
+    std::size_t m_offset;         //!< offset of the current record header
+    std::size_t m_prefetched;     //!< end of the data already asked for in advance
+    Record m_record;              //!< the current record
+  };
+
+  MappedPcapFile ();
+  ~MappedPcapFile ();
+
+  /**
+   * \brief Map a pcap file in memory and check its header
+   *
+   * \param filename the name of the file
+   * \return true on success, false if the file cannot be mapped or is not
+   * a valid pcap file
+   */
+  bool Open (std::string const &filename);
+
+  /**
+   * \brief Unmap the file. The data of the records are no longer valid.
+   */
+  void Close (void);
+
+  /**
+   * \return true if a file is mapped
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * \return the data link type of the file
+   */
+  uint32_t GetDataLinkType (void) const;
+
+  /**
+   * \return the maximum length of saved packets
+   */
+  uint32_t GetSnapLen (void) const;
+
+  /**
+   * \return true if the timestamps are in nanoseconds
+   */
+  bool IsNanoSecMode (void) const;
+
+  /**
+   * \return true if the file is in the opposite byte order
+   */
+  bool GetSwapMode (void) const;
+
+  /**
+   * \return an iterator which refers to the first record
+   */
+  Iterator Begin (void) const;
+
+  /**
+   * \return an iterator which indicates past-the-last record
+   */
+  Iterator End (void) const;
+
+private:
+  /**
+   * \brief Copy constructor, not implemented: a mapping has a single owner
+   * \param o the other file
+   */
+  MappedPcapFile (const MappedPcapFile &o);
+  /**
+   * \brief Assignment operator, not implemented: a mapping has a single owner
+   * \param o the other file
+   * \return this file
+   */
+  MappedPcapFile & operator = (const MappedPcapFile &o);
+
+  /**
+   * \param offset offset of a 32 bit value in the file
+   * \return the value, in host byte order
+   */
+  uint32_t Read32 (std::size_t offset) const;
+
+  /**
+   * \brief Ask the kernel to read in advance the pages following an offset
+   * \param offset the offset
+   * \return the end of the range asked for
+   */
+  std::size_t Prefetch (std::size_t offset) const;
+
+  /// Size of the range read in advance, in bytes
+  static const std::size_t PREFETCH_WINDOW = 4 * 1024 * 1024;
+
+  const uint8_t *m_base;   //!< start of the mapping
+  std::size_t m_size;      //!< size of the file
+  bool m_swapMode;         //!< whether the file is in the opposite byte order
+  bool m_nanosecMode;      //!< whether the timestamps are in nanoseconds
+  uint32_t m_snapLen;      //!< maximum length of saved packets
+  uint32_t m_dataLinkType; //!< data link type
+};
+
+} // namespace ns3
+
+#endif /* MAPPED_PCAP_FILE_H */
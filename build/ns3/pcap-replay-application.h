@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_REPLAY_APPLICATION_H
+#define PCAP_REPLAY_APPLICATION_H
+
+#include <string>
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "ns3/mapped-pcap-file.h"
+
+namespace ns3 {
+
+class NetDevice;
+class Packet;
+
+/**
+ * \ingroup applications
+ * \defgroup pcapreplay PcapReplayApplication
+ *
+ * This traffic generator replays the IPv4 and IPv6 packets of a pcap trace.
+ */
+
+/**
+ * \ingroup pcapreplay
+ *
+ * \brief Replay the packets of a pcap trace on a device of the node.
+ *
+ * The network layer packets found in the trace are sent, as they were
+ * captured, on the device selected by the DeviceIndex attribute: addresses,
+ * ports, ECN bits and every other field are preserved. The inter-arrival
+ * times of the trace are preserved too, the first packet being sent when
+ * the application starts. Packets which were truncated at capture time are
+ * padded with zeros to their original length.
+ *
+ * The trace is mapped in memory (see MappedPcapFile) and read while it is
+ * replayed, so that traces of millions of packets can be replayed without
+ * being loaded beforehand nor read record per record from the file system.
+ *
+ * The following data link types are supported: Ethernet, PPP, raw IP,
+ * Linux cooked capture and BSD loopback. Frames which do not carry IPv4
+ * nor IPv6 packets are skipped.
+ */
+class PcapReplayApplication : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapReplayApplication ();
+
+  virtual ~PcapReplayApplication ();
+
+  /**
+   * \return the number of packets sent so far
+   */
+  uint64_t GetSent (void) const;
+
+  /**
+   * \return the number of frames of the trace skipped so far
+   */
+  uint64_t GetSkipped (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  // inherited from Application base class.
+  virtual void StartApplication (void);    // Called at time specified by Start
+  virtual void StopApplication (void);     // Called at time specified by Stop
+
+  /**
+   * \brief Send the current record and schedule the next one
+   */
+  void SendRecord (void);
+
+  /**
+   * \brief Schedule the transmission of the current record, if any
+   */
+  void ScheduleNext (void);
+
+  /**
+   * \brief Find the network layer packet carried by a frame of the trace
+   * \param record the record of the frame
+   * \param offset Returns the offset of the network layer packet
+   * \param protocol Returns the EtherType of the network layer packet
+   * \return false if the frame does not carry an IPv4 or IPv6 packet
+   */
+  bool Decapsulate (const MappedPcapFile::Record &record, uint32_t &offset, uint16_t &protocol) const;
+
+  std::string m_filename;            //!< Name of the pcap file
+  uint32_t m_deviceIndex;            //!< Index of the device the packets are sent on
+  Address m_destination;             //!< Link layer destination of the packets
+  MappedPcapFile m_file;             //!< The trace
+  MappedPcapFile::Iterator m_current; //!< The next record to replay
+  Ptr<NetDevice> m_device;           //!< The device the packets are sent on
+  Time m_origin;                     //!< Timestamp of the first record of the trace
+  Time m_start;                      //!< Time the application started
+  uint64_t m_sent;                   //!< Number of packets sent
+  uint64_t m_skipped;                //!< Number of frames skipped
+  EventId m_sendEvent;               //!< Event to send the next packet
+
+  /// Traced Callback: sent packets
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* PCAP_REPLAY_APPLICATION_H */
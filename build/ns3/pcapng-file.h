@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+
+/**
+ * \brief A class writing a pcapng file
+ *
+ * Unlike a pcap file, a pcapng file can hold the packets captured on
+ * several interfaces, each with its own data link type, snap length, name
+ * and description, so that all the devices of a node (or of a whole
+ * simulation) can be traced into a single file. The file is made of a
+ * Section Header Block, followed by an Interface Description Block for
+ * each interface and an Enhanced Packet Block for each packet. Timestamps
+ * are stored with a nanosecond resolution.
+ *
+ * The file can optionally be compressed on the fly with gzip, if the build
+ * found zlib. Tools such as wireshark read such files directly.
+ *
+ * See https://github.com/pcapng/pcapng for the file format.
+ */
+class PcapNgFile
+{
+public:
+  /// Compression of the file
+  enum Compression
+  {
+    NONE = 0, //!< Uncompressed file
+    GZIP      //!< gzip (zlib) stream
+  };
+
+  static const uint32_t SNAPLEN_DEFAULT = 65535; /**< Default value for maximum octets to save per packet */
+
+  PcapNgFile ();
+  ~PcapNgFile ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying stream, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * \param compression a compression type
+   * \return true if files can be written with this compression in this build
+   */
+  static bool IsCompressionSupported (Compression compression);
+
+  /**
+   * \brief Create a new pcapng file and write its Section Header Block
+   *
+   * \param filename String containing the name of the file.
+   * \param compression The compression of the file.
+   */
+  void Open (std::string const &filename, Compression compression = NONE);
+
+  /**
+   * \brief Close the underlying file.
+   */
+  void Close (void);
+
+  /**
+   * \brief Write the Interface Description Block of a new interface
+   *
+   * \param dataLinkType A data link type as defined in the pcap library.
+   * \param snapLen Maximum size of the packet data saved for this interface.
+   * \param name The name of the interface (if_name option), if not empty.
+   * \param description The description of the interface (if_description
+   * option), if not empty.
+   * \return the index of the interface, to be passed to Write
+   */
+  uint32_t AddInterface (uint32_t dataLinkType,
+                         uint32_t snapLen = SNAPLEN_DEFAULT,
+                         std::string const &name = "",
+                         std::string const &description = "");
+
+  /**
+   * \return the number of interfaces added to the file
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \brief Write next packet to file
+   *
+   * \param interface Index of the interface the packet was captured on
+   * \param tsNs      Packet timestamp, nanoseconds
+   * \param data      Data buffer
+   * \param totalLen  Total packet length
+   */
+  void Write (uint32_t interface, uint64_t tsNs, uint8_t const * const data, uint32_t totalLen);
+
+  /**
+   * \brief Write next packet to file
+   *
+   * \param interface Index of the interface the packet was captured on
+   * \param tsNs      Packet timestamp, nanoseconds
+   * \param p         Packet to write
+   */
+  void Write (uint32_t interface, uint64_t tsNs, Ptr<const Packet> p);
+
+  /**
+   * \brief Write next packet to file
+   *
+   * \param interface Index of the interface the packet was captured on
+   * \param tsNs      Packet timestamp, nanoseconds
+   * \param header    Header to write, in front of the packet
+   * \param p         Packet to write
+   */
+  void Write (uint32_t interface, uint64_t tsNs, const Header &header, Ptr<const Packet> p);
+
+private:
+  /**
+   * \brief Start a new block in m_block
+   * \param type the block type
+   */
+  void BeginBlock (uint32_t type);
+
+  /**
+   * \brief Append a 16 bit value to the current block
+   * \param value the value
+   */
+  void Append16 (uint16_t value);
+
+  /**
+   * \brief Append a 32 bit value to the current block
+   * \param value the value
+   */
+  void Append32 (uint32_t value);
+
+  /**
+   * \brief Reserve room for some data in the current block, padded to 32 bits
+   * \param length the length of the data
+   * \return a pointer to the room reserved
+   */
+  uint8_t *AppendData (uint32_t length);
+
+  /**
+   * \brief Append an option to the current block
+   * \param code the option code
+   * \param value the option value
+   * \param length the length of the option value
+   */
+  void AppendOption (uint16_t code, const void *value, uint16_t length);
+
+  /**
+   * \brief Write the Enhanced Packet Block header and reserve room for the
+   *        packet data
+   * \param interface Index of the interface the packet was captured on
+   * \param tsNs Packet timestamp, nanoseconds
+   * \param totalLen Total packet length
+   * \param inclLen Returns the number of bytes of packet data to save
+   * \return a pointer to the room reserved for the packet data
+   */
+  uint8_t *BeginPacketBlock (uint32_t interface, uint64_t tsNs, uint32_t totalLen, uint32_t &inclLen);
+
+  /**
+   * \brief Complete the current block and write it to the file
+   */
+  void EndBlock (void);
+
+  std::string m_filename;          //!< file name
+  std::ofstream m_file;            //!< file stream, if uncompressed
+  void *m_gzFile;                  //!< zlib stream, if compressed
+  bool m_fail;                     //!< whether writing the file failed
+  std::vector<uint32_t> m_snapLen; //!< snap length of each interface
+  std::vector<uint8_t> m_block;    //!< block being built
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
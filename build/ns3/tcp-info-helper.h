@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCP_INFO_HELPER_H
+#define TCP_INFO_HELPER_H
+
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/node-container.h"
+
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+struct TcpInfoRow;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Sample the state of the TCP connections of a set of nodes
+ *
+ * Instead of connecting to the traced values of every socket, which fire
+ * at every change, the helper polls the TcpSocketBase::GetTcpInfo snapshot
+ * of every connection at a regular interval, and writes one line per
+ * connection and sample to a stream. The columns, described by a header
+ * line starting with '#', are separated by tabs:
+ *
+ * - time (s), node id, local address and port, peer address and port
+ * - TCP state, congestion state, ECN state (numeric values of the enums)
+ * - cWnd, ssThresh, bytes in flight, SACKed and lost bytes, receiver window
+ * - SRTT, RTT variation, last RTT sample and RTO, in microseconds
+ * - pacing rate and delivery rate, in bit/s
+ * - bytes delivered, segments retransmitted, CE-marked segments received
+ *   and CE marks echoed by the peer
+ *
+ * Listening and closed sockets are skipped.
+ *
+ * The BINARY format holds the same values, packed in columns. The stream,
+ * opened with std::ios::binary, starts with a header: the magic number
+ * 0x49504354 ("TCPI") on 32 bits, the version (1) and the number of columns
+ * on 16 bits, and for each column the size of its values and the length of
+ * its name on 8 bits, followed by the name. Each sample of a node with at
+ * least one connection is then a block: the time in nanoseconds on 64 bits,
+ * the node id and the number of rows N on 32 bits, then each column as an
+ * array of N values. Addresses take 16 bytes, IPv4 addresses being mapped to
+ * IPv6 (::ffff:a.b.c.d), and the other values are unsigned integers of the
+ * size of their column. All the integers are little endian.
+ */
+class TcpInfoHelper
+{
+public:
+  /// Format of the samples
+  enum Format
+  {
+    TEXT,   //!< One line of tab-separated columns per connection and sample
+    BINARY  //!< One block of packed columns per node and sample
+  };
+
+  /**
+   * \brief Sample the connections of all the nodes at regular intervals
+   * \param interval the time between two samples
+   * \param stream the output stream object to use
+   * \param stop the time of the last sample
+   * \param format the format of the samples
+   */
+  static void SampleAllEvery (Time interval, Ptr<OutputStreamWrapper> stream,
+                              Time stop = Time::Max (), Format format = TEXT);
+
+  /**
+   * \brief Sample the connections of some nodes at regular intervals
+   * \param interval the time between two samples
+   * \param nodes the nodes to sample
+   * \param stream the output stream object to use
+   * \param stop the time of the last sample
+   * \param format the format of the samples
+   */
+  static void SampleEvery (Time interval, NodeContainer nodes,
+                           Ptr<OutputStreamWrapper> stream, Time stop = Time::Max (),
+                           Format format = TEXT);
+
+  /**
+   * \brief Write the header which names the columns
+   * \param stream the output stream object to use
+   * \param format the format of the samples
+   */
+  static void WriteHeader (Ptr<OutputStreamWrapper> stream, Format format = TEXT);
+
+  /**
+   * \brief Write every connection of a node, now
+   * \param node the node to sample
+   * \param stream the output stream object to use
+   * \param format the format of the samples
+   */
+  static void Sample (Ptr<Node> node, Ptr<OutputStreamWrapper> stream, Format format = TEXT);
+
+private:
+  /**
+   * \brief Write the connections of a node as lines of text
+   * \param node the sampled node
+   * \param rows the connections of the node
+   * \param stream the output stream object to use
+   */
+  static void WriteText (Ptr<Node> node, const std::vector<TcpInfoRow> &rows,
+                         Ptr<OutputStreamWrapper> stream);
+
+  /**
+   * \brief Write the connections of a node as a block of packed columns
+   * \param node the sampled node
+   * \param rows the connections of the node
+   * \param stream the output stream object to use
+   */
+  static void WriteBinary (Ptr<Node> node, const std::vector<TcpInfoRow> &rows,
+                           Ptr<OutputStreamWrapper> stream);
+
+  /**
+   * \brief Sample a node, and schedule the next sample
+   * \param interval the time between two samples
+   * \param node the node to sample
+   * \param stream the output stream object to use
+   * \param stop the time of the last sample
+   * \param format the format of the samples
+   */
+  static void SampleNodeEvery (Time interval, Ptr<Node> node,
+                               Ptr<OutputStreamWrapper> stream, Time stop, Format format);
+};
+
+} // namespace ns3
+
+#endif /* TCP_INFO_HELPER_H */
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCP_OPTION_ACCECN_H
+#define TCP_OPTION_ACCECN_H
+
+#include "ns3/tcp-option.h"
+
+namespace ns3 {
+
+/**
+ * \brief Defines the Accurate ECN TCP option (kinds 172 and 174), as in
+ * draft-ietf-tcpm-accurate-ecn
+ *
+ * The option carries up to three 24-bit counters of the payload bytes
+ * received with the ECT(0), CE and ECT(1) codepoints (EE0B, ECEB and EE1B).
+ * With kind ACCECN0 the fields are in the order EE0B, ECEB, EE1B; with kind
+ * ACCECN1 in the order EE1B, ECEB, EE0B. Trailing fields can be omitted,
+ * so that the option is 2, 5, 8 or 11 bytes long.
+ *
+ * Counters are kept modulo 2^24 on the wire; receivers compute the
+ * increase from the last value seen modulo 2^24.
+ */
+class TcpOptionAccEcn : public TcpOption
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  TcpOptionAccEcn ();
+  virtual ~TcpOptionAccEcn ();
+
+  virtual void Print (std::ostream &os) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  virtual uint8_t GetKind (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+
+  /**
+   * \brief Set the order of the fields
+   *
+   * \param kind TcpOption::ACCECN0 or TcpOption::ACCECN1
+   */
+  void SetOrder (uint8_t kind);
+
+  /**
+   * \brief Set the number of counters carried by the option
+   *
+   * \param n number of fields, between 0 and 3
+   */
+  void SetFieldCount (uint8_t n);
+
+  /**
+   * \return the number of counters carried by the option
+   */
+  uint8_t GetFieldCount (void) const;
+
+  /**
+   * \brief Set the counter of bytes received with ECT(0)
+   * \param bytes the counter value (modulo 2^24)
+   */
+  void SetE0b (uint32_t bytes);
+
+  /**
+   * \brief Set the counter of bytes received with CE
+   * \param bytes the counter value (modulo 2^24)
+   */
+  void SetCeb (uint32_t bytes);
+
+  /**
+   * \brief Set the counter of bytes received with ECT(1)
+   * \param bytes the counter value (modulo 2^24)
+   */
+  void SetE1b (uint32_t bytes);
+
+  /**
+   * \return the counter of bytes received with ECT(0)
+   */
+  uint32_t GetE0b (void) const;
+
+  /**
+   * \return the counter of bytes received with CE
+   */
+  uint32_t GetCeb (void) const;
+
+  /**
+   * \return the counter of bytes received with ECT(1)
+   */
+  uint32_t GetE1b (void) const;
+
+  /**
+   * \brief Check if the option carries a given counter
+   *
+   * \param field 0 for EE0B, 1 for ECEB, 2 for EE1B
+   * \return true if the counter is present
+   */
+  bool HasField (uint8_t field) const;
+
+  /**
+   * \brief Mask to keep the 24 bits of a counter
+   */
+  static const uint32_t COUNTER_MASK = 0xFFFFFF;
+
+private:
+  /**
+   * \brief Get the counter stored at a position in the option
+   * \param pos position of the field in the option
+   * \return a reference to the counter
+   */
+  uint32_t & FieldAt (uint8_t pos);
+
+  /**
+   * \brief Get the counter stored at a position in the option
+   * \param pos position of the field in the option
+   * \return the counter
+   */
+  uint32_t FieldAt (uint8_t pos) const;
+
+  uint8_t m_kind;        //!< ACCECN0 or ACCECN1, i.e. the field order
+  uint8_t m_fields;      //!< Number of counters carried
+  uint32_t m_e0b;        //!< ECT(0) payload bytes
+  uint32_t m_ceb;        //!< CE payload bytes
+  uint32_t m_e1b;        //!< ECT(1) payload bytes
+};
+
+} // namespace ns3
+
+#endif /* TCP_OPTION_ACCECN_H */
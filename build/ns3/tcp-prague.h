@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCP_PRAGUE_H
+#define TCP_PRAGUE_H
+
+#include "ns3/tcp-dctcp.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief An implementation of TCP Prague, the scalable congestion control
+ * of the L4S architecture
+ *
+ * Prague extends DCTCP with the requirements a sender has to meet to use
+ * the L4S queue of a DualQ AQM:
+ *
+ * - its packets carry the ECT(1) codepoint, on data and pure ACKs alike;
+ * - the window is reduced in proportion to the DCTCP alpha (the fraction
+ *   of marked bytes) once per round trip, but the reduction is spread over
+ *   the ACKs of the following round instead of being applied at once, so
+ *   that the sending rate does not collapse and then burst;
+ * - flows with a RTT shorter than the RttTarget attribute grow as if their
+ *   RTT was RttTarget: the additive increase per ACK is scaled by
+ *   (srtt / RttTarget)^2, which gives flows of different RTTs the same rate
+ *   increase per unit of time;
+ * - a bottleneck with a classic ECN AQM (RFC 3168) is detected from a
+ *   persistent queuing delay (smoothed RTT minus minimum RTT) larger than
+ *   ClassicEcnQueueDelay, in which case Prague falls back to a Reno-friendly
+ *   response: the window is halved on congestion and grows by one segment
+ *   per RTT.
+ *
+ * Paced sending is left to the socket (see the EnablePacing attribute of
+ * TcpSocketState), which the L4S requirements recommend for Prague.
+ */
+class TcpPrague : public TcpDctcp
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpPrague ();
+
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpPrague (const TcpPrague& sock);
+
+  virtual ~TcpPrague (void);
+
+  virtual std::string GetName () const;
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+  virtual void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+
+  /**
+   * \brief Start a window reduction in response to an ECN Echo
+   *
+   * \param tcb internal congestion state
+   */
+  virtual void ReduceCwnd (Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Update the RTT estimations, the classic ECN detection and the
+   * pending window reduction
+   *
+   * \param tcb internal congestion state
+   * \param segmentsAcked count of segments ACKed
+   * \param rtt The estimated rtt
+   */
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time &rtt);
+
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                   const TcpSocketState::TcpCongState_t newState);
+
+  /**
+   * \return true if a classic ECN AQM has been detected at the bottleneck
+   */
+  bool IsClassicEcn (void) const;
+
+protected:
+  virtual void CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+
+private:
+  /**
+   * \brief Update the classic ECN detection at the end of a round trip
+   */
+  void UpdateClassicEcn (void);
+
+  Time m_rttTarget;                     //!< RTT below which the window growth is scaled
+  Time m_classicThreshold;              //!< Queuing delay revealing a classic ECN AQM
+  bool m_classicDetection;              //!< Whether to detect classic ECN AQMs
+  Time m_minRtt;                        //!< Minimum RTT
+  Time m_srtt;                          //!< Smoothed RTT
+  double m_classicScore;                //!< EWMA of the rounds with a large queuing delay
+  bool m_classicEcn;                    //!< Whether the bottleneck runs a classic ECN AQM
+  SequenceNumber32 m_roundEnd;          //!< Sequence number ending the current round
+  bool m_roundStarted;                  //!< Whether m_roundEnd is valid
+  double m_cWndCnt;                     //!< Fractional bytes of additive increase
+  bool m_cwrPending;                    //!< Whether a window reduction is in progress
+  uint32_t m_cwrPriorCwnd;              //!< Window before the reduction
+  uint32_t m_cwrTarget;                 //!< Window after the reduction
+  uint32_t m_cwrAcked;                  //!< Bytes acked since the reduction started
+};
+
+} // namespace ns3
+
+#endif /* TCP_PRAGUE_H */
@@ -0,0 +1,733 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010-2015 Adrian Sai-wah Tam
+ * Copyright (c) 2016 Natale Patriciello <natale.patriciello@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Original author: Adrian Sai-wah Tam <adrian.sw.tam@gmail.com>
+ */
+
+#ifndef TCP_TX_BUFFER_H
+#define TCP_TX_BUFFER_H
+
+#include <map>
+
+#include "ns3/object.h"
+#include "ns3/traced-value.h"
+#include "ns3/sequence-number.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/tcp-option-sack.h"
+
+namespace ns3 {
+class Packet;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Item that encloses the application packet and some flags for it
+ */
+class TcpTxItem
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  TcpTxItem ();
+
+  /**
+   * \brief Copy-constructor
+   * \param other TcpTxTag to copy values from
+   */
+  TcpTxItem (const TcpTxItem &other);
+
+  /**
+   * \brief Print the time
+   * \param os ostream
+   */
+  void Print (std::ostream &os) const;
+
+  Ptr<Packet> m_packet; //!< Application packet
+  bool m_lost;          //!< Indicates if the segment has been lost (RTO)
+  bool m_retrans;       //!< Indicates if the segment is retransmitted
+  Time m_lastSent;      //!< Timestamp of the time at which the segment has
+                        //   been sent last time
+  bool m_sacked;        //!< Indicates if the segment has been SACKed
+
+  // Delivery rate state of the connection when the segment was sent
+  uint64_t m_delivered;   //!< Bytes delivered by the connection
+  Time m_deliveredTime;   //!< Time of the last delivery of the connection
+  Time m_firstSentTime;   //!< Send time of the first segment of the sampling interval
+  bool m_isAppLimited;    //!< Connection application-limited
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Delivery rate sample, generated for every ACK
+ *
+ * The sample measures the bytes delivered between the transmission of the
+ * most recently sent segment acknowledged by the ACK, and its delivery. The
+ * interval is the longest between the "send phase" and the "ACK phase" of
+ * that flight of data, as in draft-cheng-iccrg-delivery-rate-estimation.
+ * When no segment has been delivered, or the interval is shorter than the
+ * minimum RTT, the sample is not valid: its interval and rate are zero.
+ */
+struct TcpRateSample
+{
+  TcpRateSample ();
+
+  DataRate m_deliveryRate;    //!< Delivery rate, zero if the sample is not valid
+  bool m_isAppLimited;        //!< The sample was taken while application-limited
+  Time m_interval;            //!< Length of the sampling interval, zero if not valid
+  Time m_sendElapsed;         //!< Send phase of the interval
+  Time m_ackElapsed;          //!< ACK phase of the interval
+  uint64_t m_delivered;       //!< Bytes delivered over the interval
+  uint64_t m_priorDelivered;  //!< Bytes delivered by the connection when the segment was sent
+  Time m_priorTime;           //!< Delivery time of the connection when the segment was sent
+  Time m_rtt;                 //!< RTT of the segment, zero if retransmitted or not valid
+  uint64_t m_totalDelivered;  //!< Bytes delivered by the connection so far
+  uint32_t m_ackedSacked;     //!< Bytes newly acknowledged or SACKed by the ACK
+  uint32_t m_priorInFlight;   //!< Bytes in flight before the ACK (set by the socket)
+  uint32_t m_bytesInFlight;   //!< Bytes in flight after the ACK (set by the socket)
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Tcp sender buffer
+ *
+ * The class keeps track of all data that the application wishes to transmit to
+ * the other end. When the data is acknowledged, it is removed from the buffer.
+ * The buffer has a maximum size, and data is not saved if the amount exceeds
+ * the limit. Packets can be added to the class through the method Add(). An
+ * important thing to remember is that all the data managed is strictly
+ * sequential. It can be divided into blocks, but all the data follow a strict
+ * ordering. That order is managed through SequenceNumber.
+ *
+ * In other words, this buffer contains numbered bytes (e.g., 1,2,3), and the
+ * class is allowed to return only ordered (using "<" as operator) subsets
+ * (e.g. 1,2 or 2,3 or 1,2,3).
+ *
+ * The data structure underlying this is composed by two distinct packet
+ * containers. The first (SentList) is initially empty, and it maps the first
+ * sequence number of the packets returned by the method CopyFromSequence to
+ * the packets themselves. The second (AppList) is initially
+ * empty, and it contains the packets coming from the applications, but that
+ * are not transmitted yet as segments. To discover how the chunks are managed
+ * and retrieved from these lists, check CopyFromSequence documentation.
+ *
+ * The head of the data is represented by m_firstByteSeq, and it is returned by
+ * HeadSequence(). The last byte is returned by TailSequence(). In this class,
+ * we also store the size (in bytes) of the packets inside the SentList in the
+ * variable m_sentSize.
+ *
+ * SACK management
+ * ---------------
+ *
+ * The SACK information is usually saved in a data structure referred as
+ * scoreboard. In this implementation, the scoreboard is developed on top of
+ * the existing classes. In particular, instead of keeping raw pointers to
+ * packets in TcpTxBuffer we added the capability to store some flags
+ * associated with every segment sent. This is done through the use of the
+ * class TcpTxItem: instead of storing a list of packets, we store the sent
+ * TcpTxItem in a map, keyed by the sequence number of their first byte. Each
+ * item has different flags (check the corresponding documentation) and
+ * maintaining the scoreboard is a matter of looking up the items covered by
+ * a SACK block and set the SACK flag on them.
+ *
+ * Scoreboard indexes
+ * ------------------
+ *
+ * The algorithms outlined in RFC 6675 are written as walks over the whole
+ * sequence space, which makes every ACK cost O(window) with large windows.
+ * Besides the sent map, the buffer keeps four indexes of the sent items,
+ * again keyed by sequence number:
+ *
+ * - the SACKed items;
+ * - the items not SACKed and retransmitted;
+ * - the items not SACKed, not retransmitted and marked lost (after an RTO);
+ * - the items not SACKed, not retransmitted and not marked lost.
+ *
+ * together with the number of SACKed bytes, and of the bytes marked lost
+ * and not SACKed. The RFC 6675 IsLost () test is monotone: if a segment is
+ * lost because of the SACKed segments above it, so are all the segments
+ * before it. Walking the SACKed index down from the highest SACKed item
+ * for at most dupThresh items gives the boundary under which the segments
+ * are lost, and therefore:
+ *
+ * - Update () costs O(log n) per SACK block and per newly SACKed item, as
+ *   the items already SACKed are skipped;
+ * - IsLost () and NextSeg () cost O(log n + dupThresh);
+ * - BytesInFlight () costs O(dupThresh) plus the segments deemed lost and not
+ *   retransmitted yet (the ones NextSeg () is about to return);
+ * - the retrieval of a segment to retransmit costs O(log n).
+ *
+ * Every change to the flags, the size or the sequence number of a sent item
+ * must be surrounded by RemoveFromScoreboard () and AddToScoreboard (), so
+ * that the indexes and the counters stay consistent.
+ *
+ * RACK
+ * ----
+ *
+ * Besides the RFC 6675 rules, the buffer can mark segments lost by time, as
+ * RACK (RFC 8985) does. Every time a segment is SACKed or cumulatively
+ * acknowledged, the buffer remembers the transmission time of the most
+ * recently sent segment delivered (RACK.xmit_ts) and its RTT. A segment sent
+ * before it, and not delivered yet, is lost if RACK.rtt plus a reordering
+ * window has elapsed since it was sent. The detection is run by the socket
+ * through RackDetectLoss (); the lost segments are marked with the lost flag,
+ * so that NextSeg () returns them for retransmission and BytesInFlight ()
+ * does not count them. The first transmissions are sent in sequence order,
+ * hence the walk over the items not retransmitted stops at the first one
+ * which is not lost yet.
+ *
+ * Delivery rate
+ * -------------
+ *
+ * Every sent item is stamped with the count of bytes delivered by the
+ * connection, and the time of the last delivery. When the item is SACKed or
+ * cumulatively acknowledged, the stamps of the most recently sent item
+ * delivered by the ACK are kept; GenerateRateSample (), called by the socket
+ * once the ACK has been processed, turns them into a TcpRateSample. The
+ * application-limited periods, marked by the socket through
+ * MarkAppLimited (), taint the samples taken until the data sent in them
+ * has been delivered.
+ *
+ * \see Size
+ * \see SizeFromSequence
+ * \see CopyFromSequence
+ */
+class TcpTxBuffer : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief Constructor
+   * \param n initial Sequence number to be transmitted
+   */
+  TcpTxBuffer (uint32_t n = 0);
+  virtual ~TcpTxBuffer (void);
+
+  // Accessors
+
+  /**
+   * \brief Get the sequence number of the buffer head
+   * \returns the first byte's sequence number
+   */
+  SequenceNumber32 HeadSequence (void) const;
+
+  /**
+   * \brief Get the sequence number of the buffer tail (plus one)
+   * \returns the last byte's sequence number + 1
+   */
+  SequenceNumber32 TailSequence (void) const;
+
+  /**
+   * \brief Get the sequence number of the last segment sent
+   *
+   * This is the first byte of the highest segment in the sent list, i.e.,
+   * the segment that a Tail Loss Probe retransmits.
+   *
+   * \returns the first byte's sequence number of the last segment sent, or
+   * the head sequence if nothing has been sent
+   */
+  SequenceNumber32 LastSentSequence (void) const;
+
+  /**
+   * \brief Returns total number of bytes in this buffer
+   * \returns total number of bytes in this Tx buffer
+   */
+  uint32_t Size (void) const;
+
+  /**
+   * \brief Get the maximum buffer size
+   * \returns the Tx window size (in bytes)
+   */
+  uint32_t MaxBufferSize (void) const;
+
+  /**
+   * \brief Set the maximum buffer size
+   * \param n Tx window size (in bytes)
+   */
+  void SetMaxBufferSize (uint32_t n);
+
+  /**
+   * \brief Returns the available capacity of this buffer
+   * \returns available capacity in this Tx window
+   */
+  uint32_t Available (void) const;
+
+  /**
+   * \brief Append a data packet to the end of the buffer
+   *
+   * \param p The packet to be appended to the Tx buffer
+   * \return Boolean to indicate success
+   */
+  bool Add (Ptr<Packet> p);
+
+  /**
+   * \brief Returns the number of bytes from the buffer in the range [seq, tailSequence)
+   *
+   * \param seq initial sequence number
+   * \returns the number of bytes from the buffer in the range
+   */
+  uint32_t SizeFromSequence (const SequenceNumber32& seq) const;
+
+  /**
+   * \brief Copy data from the range [seq, seq+numBytes) into a packet
+   *
+   * In the following, we refer to the block [seq, seq+numBytes) simply as "block".
+   * We check the boundary of the block, and divide the possibilities in three
+   * cases:
+   *
+   * - the block have already been transmitted (managed in GetTransmittedSegment)
+   * - the block have not been transmitted yet (managed in GetNewSegment)
+   *
+   * The last case is when the block is partially transmitted and partially
+   * not transmitted. We trick this case by requesting the portion not transmitted
+   * from GetNewSegment, and then calling GetTransmittedSegment with the full
+   * block range.
+   *
+   * \param numBytes number of bytes to copy
+   * \param seq start sequence number to extract
+   * \returns a packet
+   */
+  Ptr<Packet> CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq);
+
+  /**
+   * \brief Set the head sequence of the buffer
+   *
+   * Set the head (m_firstByteSeq) to seq. Supposed to be called only when the
+   * connection is just set up and we did not send any data out yet.
+   * \param seq The sequence number of the head byte
+   */
+  void SetHeadSequence (const SequenceNumber32& seq);
+
+  /**
+   * \brief Discard data up to but not including this sequence number.
+   *
+   * \param seq The first sequence number to maintain after discarding all the
+   * previous sequences.
+   */
+  void DiscardUpTo (const SequenceNumber32& seq);
+
+  /**
+   * \brief Update the scoreboard
+   * \param list list of SACKed blocks
+   * \returns true in case of an update
+   */
+  bool Update (const TcpOptionSack::SackList &list);
+
+  /**
+   * \brief Check if a segment is lost per RFC 6675
+   * \param seq sequence to check
+   * \param dupThresh dupAck threshold
+   * \param segmentSize segment size
+   * \return true if the sequence is supposed to be lost, false otherwise
+   */
+  bool IsLost (const SequenceNumber32 &seq, uint32_t dupThresh, uint32_t segmentSize) const;
+
+  /**
+   * \brief Get the next sequence number to transmit, according to RFC 6675
+   *
+   * \param seq Next sequence number to transmit, based on the scoreboard information
+   * \param dupThresh dupAck threshold
+   * \param segmentSize segment size
+   * \param isRecovery true if the socket congestion state is in recovery mode
+   * \return true is seq is updated, false otherwise
+   */
+  bool NextSeg (SequenceNumber32 *seq, uint32_t dupThresh, uint32_t segmentSize,
+                bool isRecovery) const;
+
+  /**
+   * \brief Return total bytes in flight
+   *
+   * The routine follows the "SetPipe" function in RFC 6675
+   *
+   * \param dupThresh duplicate ACK threshold
+   * \param segmentSize segment size
+   * \returns total bytes in flight
+   */
+  uint32_t BytesInFlight (uint32_t dupThresh, uint32_t segmentSize) const;
+
+  /**
+   * \brief Mark the segments lost by time, as RACK does (RFC 8985)
+   *
+   * A segment not delivered yet is lost if it was sent before the most
+   * recently sent segment which was delivered, and more than the RTT of the
+   * latter plus the reordering window has elapsed since its transmission.
+   * The reordering window is a quarter of the minimum RTT, capped at srtt;
+   * it is zero when no reordering has been seen, and either the socket is
+   * in recovery or dupThresh segments have been SACKed.
+   *
+   * \param srtt smoothed RTT of the connection
+   * \param isRecovery true if the socket congestion state is in recovery mode
+   * \param dupThresh dupAck threshold
+   * \param timeout output parameter, set to the time after which a segment
+   * not lost yet should be considered again, or zero
+   * \return true if some segment has been marked lost
+   */
+  bool RackDetectLoss (const Time &srtt, bool isRecovery, uint32_t dupThresh,
+                       Time *timeout);
+
+  /**
+   * \brief Generate the delivery rate sample of the last ACK
+   *
+   * The segments delivered since the previous call are accounted; the
+   * state of the sample is reset for the next ACK.
+   *
+   * \return the rate sample
+   */
+  TcpRateSample GenerateRateSample (void);
+
+  /**
+   * \brief Mark the connection application-limited
+   *
+   * The samples are application-limited until the bytes currently in
+   * flight have been delivered.
+   *
+   * \param bytesInFlight bytes in flight
+   */
+  void MarkAppLimited (uint32_t bytesInFlight);
+
+  /**
+   * \brief Get the bytes delivered (acknowledged or SACKed) so far
+   * \return the bytes delivered by the connection
+   */
+  uint64_t GetDelivered (void) const;
+
+  /**
+   * \brief Get the delivery rate of the connection
+   *
+   * It is the rate of the last sample which was not application-limited,
+   * or of an application-limited one with a higher rate.
+   *
+   * \return the delivery rate, zero if no valid sample has been taken yet
+   */
+  DataRate GetDeliveryRate (void) const;
+
+  /**
+   * \brief Get the bytes SACKed by the receiver and not yet acknowledged
+   * \return the size of the SACKed segments
+   */
+  uint32_t GetSackedBytes (void) const;
+
+  /**
+   * \brief Get the bytes marked lost and not SACKed
+   * \return the size of the lost segments
+   */
+  uint32_t GetLostBytes (void) const;
+
+  /**
+   * \brief Set the entire sent list as lost (typically after an RTO)
+   *
+   * Used to set all the sent list as lost, so the bytes in flight is not counting
+   * them as in flight, but we will continue to use SACK informations for
+   * recovering the timeout.
+   */
+  void SetSentListLost ();
+
+  /**
+   * \brief Reset the Scoreboard from all SACK informations
+   */
+  void ResetScoreboard ();
+
+  /**
+   * \brief Check if the head is retransmitted
+   *
+   * \return true if the head is retransmitted, false in all other cases
+   * (including no segment sent)
+   */
+  bool IsHeadRetransmitted () const;
+
+  /**
+   * \brief Reset the sent list
+   *
+   * Move all the packets (except the HEAD) from the sent list to the appList.
+   * The head is then marked as un-sacked, un-retransmitted, and lost.
+   */
+  void ResetSentList ();
+
+  /**
+   * \brief Take the last segment sent and put it back into the un-sent list
+   * (at the beginning)
+   */
+  void ResetLastSegmentSent ();
+
+  /**
+   * \brief Craft a SACK block. Used in case the other end does not support
+   * SACK
+   *
+   * \param seq Look to usable block starting from this sequence number (seq will
+   * not be included in the block)
+   * \param available Space left in the header for that SACK option
+   * \return a SACK option that SACK the first un-SACKed segment in our sentList.
+   */
+  Ptr<const TcpOptionSack> CraftSackOption (const SequenceNumber32 &seq, uint8_t available) const;
+
+private:
+  friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
+
+  typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::map<SequenceNumber32, TcpTxItem*> SentList; //!< container for sent items, keyed by their first sequence number
+
+  /**
+   * \brief Find the boundary of the segments lost per RFC 6675
+   *
+   * A segment which is not SACKed is lost when dupThresh SACKed segments, or
+   * more than (dupThresh - 1) * segmentSize SACKed bytes, are above it. The
+   * function walks the SACKed items down from the highest one, until the
+   * condition is met.
+   *
+   * \param dupThresh dupAck threshold
+   * \param segmentSize segment size
+   * \param bound output parameter, set to the sequence under which the
+   * segments not SACKed are lost
+   * \return true if bound has been set, false if no segment is lost by SACK
+   */
+  bool GetLossBound (uint32_t dupThresh, uint32_t segmentSize, SequenceNumber32 *bound) const;
+
+  /**
+   * \brief Check if a segment is lost per RFC 6675
+   * \param segment the sent item to check, with its sequence number
+   * \param hasBound the return value of GetLossBound
+   * \param bound the boundary set by GetLossBound
+   * \return true if the sequence is supposed to be lost, false otherwise
+   */
+  bool IsLost (const SentList::value_type &segment, bool hasBound,
+               const SequenceNumber32 &bound) const;
+
+  /**
+   * \brief Add a sent item to the scoreboard indexes and counters
+   * \param segment the sent item, with its sequence number
+   */
+  void AddToScoreboard (const SentList::value_type &segment);
+
+  /**
+   * \brief Remove a sent item from the scoreboard indexes and counters
+   *
+   * It must be called with the flags and the size that were used to add it.
+   *
+   * \param segment the sent item, with its sequence number
+   */
+  void RemoveFromScoreboard (const SentList::value_type &segment);
+
+  /**
+   * \brief Clear the scoreboard indexes and counters
+   */
+  void ClearScoreboard (void);
+
+  /**
+   * \brief Update the RACK state with a segment just delivered
+   * \param segment the sent item, with its sequence number
+   */
+  void RackUpdate (const SentList::value_type &segment);
+
+  /**
+   * \brief Update the delivery rate state with a segment just delivered
+   * \param item the sent item
+   * \param bytes bytes of the item delivered (less than its size if
+   * partially acknowledged)
+   */
+  void RateDelivered (const TcpTxItem *item, uint32_t bytes);
+
+  /**
+   * \brief Find the first sent item not SACKed, starting at or after seq
+   * \param seq sequence from which to search
+   * \param start output parameter, set to the first sequence of the item
+   * \return the item, or 0 if all the items after seq are SACKed
+   */
+  TcpTxItem* GetFirstUnsacked (const SequenceNumber32 &seq, SequenceNumber32 *start) const;
+
+  /**
+   * \brief Get a block of data not transmitted yet and move it into SentList
+   *
+   * If the block is not yet transmitted, hopefully, seq is exactly the sequence
+   * number of the first byte of the first packet inside AppList. We extract
+   * the block from AppList and move it into the SentList, before returning the
+   * block itself. We manage possible fragmentation (or merges) inside AppList
+   * through GetPacketFromList.
+   *
+   * \see GetPacketFromList
+   * \param numBytes number of bytes to copy
+   *
+   * \return the position of the item that contains the right packet
+   */
+  SentList::iterator GetNewSegment (uint32_t numBytes);
+
+  /**
+   * \brief Get a block of data previously transmitted
+   *
+   * This is clearly a retransmission, and if everything is going well,
+   * the block requested is matching perfectly with another one requested
+   * in the past. If not, the items at the boundaries of the block are split,
+   * and the items inside the block are merged, as in GetPacketFromList.
+   *
+   * \param numBytes number of bytes to copy
+   * \param seq sequence requested
+   * \returns the position of the item that contains the right packet
+   */
+  SentList::iterator GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &seq);
+
+  /**
+   * \brief Get a block (which is returned as Packet) from a list
+   *
+   * This function extract a block [requestedSeq,numBytes) from the list, which
+   * starts at startingSeq.
+   *
+   * The cases we need to manage are two, and they are depicted in the following
+   * image:
+   *
+   *\verbatim
+                       |------|     |----|     |----|
+                list = |      | --> |    | --> |    |
+                       |------|     |----|     |----|
+
+                       ^      ^
+                       | ^ ^  |         (1)
+                     seq | |  seq + numBytes
+                         | |
+                         | |
+                      seq   seq + numBytes     (2)
+   \endverbatim
+   *
+   * The case 1 is easy to manage: the requested block is exactly a packet
+   * already stored. If one value (seq or seq + numBytes) does not align
+   * to a packet boundary, or when both values does not align (case 2), it is
+   * a bit more complex.
+   *
+   * Basically, we have two possible operations:
+   *
+   *  - fragment : split an existing packet in two
+   *  - merge    : merge two existing packets in one
+   *
+   * and we reduce case (2) to case (1) through sequentially applying fragment
+   * or merge. For instance:
+   *
+   *\verbatim
+      |------|
+      |      |
+      |------|
+
+      ^ ^  ^ ^
+      | |  | |
+  start |  | |
+        |  | end
+       seq |
+           seq + numBytes
+   \endverbatim
+   *
+   * To reduce to case (1), we need to perform two fragment operations:
+   *
+   * - fragment (start, seq)
+   * - fragment (seq + numBytes, end)
+   *
+   * After these operations, the requested block is exactly the resulting packet.
+   * Merge operation is required when the requested block span over two (or more)
+   * existing packets.
+   *
+   * While this could be extremely slow in the worst possible scenario (one big
+   * packet which is split in small packets for transmission, and merged for
+   * re-transmission) that scenario is unlikely during a TCP transmission (since
+   * MSS can change, but it is stable, and retransmissions do not happen for
+   * each segment).
+   *
+   * \param list List to extract block from
+   * \param startingSeq Starting sequence of the list
+   * \param numBytes Bytes to extract, starting from requestedSeq
+   * \param requestedSeq Requested sequence
+   * \param listEdited output parameter which indicates if the list has been edited
+   * \return the item that contains the right packet
+   */
+  TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
+                                uint32_t numBytes, const SequenceNumber32 &requestedSeq,
+                                bool *listEdited) const;
+
+  /**
+   * \brief Merge two TcpTxItem
+   *
+   * Merge t2 in t1. It consists in copying the lastSent field if t2 is more
+   * recent than t1. Retransmitted field is copied only if it set in t2 but not
+   * in t1. Sacked is copied only if it is true in both items.
+   *
+   * \param t1 first item
+   * \param t2 second item
+   */
+  void MergeItems (TcpTxItem &t1, TcpTxItem &t2) const;
+
+  /**
+   * \brief Split one TcpTxItem
+   *
+   * Move "size" bytes from t2 into t1, copying all the fields.
+   *
+   * \param t1 first item
+   * \param t2 second item
+   * \param size Size to split
+   */
+  void SplitItems (TcpTxItem &t1, TcpTxItem &t2, uint32_t size) const;
+
+  /**
+   * \brief Get the highest SACKed byte
+   * \return the sequence after the highest SACKed byte, or the head sequence
+   * if nothing is SACKed
+   */
+  SequenceNumber32 GetHighestSacked (void) const;
+
+  PacketList m_appList;  //!< Buffer for application data
+  SentList m_sentList;   //!< Buffer for sent (but not acked) data
+  uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
+  uint32_t m_size;       //!< Size of all data in this buffer
+  uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
+
+  TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
+
+  SentList m_sackedItems;   //!< Sent items SACKed
+  SentList m_retxItems;     //!< Sent items not SACKed, retransmitted
+  SentList m_lostItems;     //!< Sent items not SACKed nor retransmitted, marked lost
+  SentList m_unretxItems;   //!< Sent items not SACKed nor retransmitted, not marked lost
+  uint32_t m_sackedBytes;   //!< Size of the SACKed items
+  uint32_t m_lostBytes;     //!< Size of the items marked lost and not SACKed
+
+  Time m_rackXmitTs;              //!< Transmission time of the most recently sent segment delivered
+  SequenceNumber32 m_rackEndSeq;  //!< End sequence of that segment
+  Time m_rackRtt;                 //!< RTT measured on that segment
+  Time m_rackMinRtt;              //!< Minimum RTT measured on the delivered segments
+  SequenceNumber32 m_rackFack;    //!< Highest end sequence delivered
+  bool m_rackReorderingSeen;      //!< A segment has been delivered below m_rackFack
+
+  uint64_t m_rateDelivered;       //!< Bytes delivered by the connection
+  Time m_rateDeliveredTime;       //!< Time of the last delivery
+  Time m_rateFirstSentTime;       //!< Send time of the most recently sent segment delivered
+  uint64_t m_rateAppLimited;      //!< End of the application-limited period (in delivered bytes), or 0
+  TcpRateSample m_rateSample;     //!< Sample being built for the current ACK
+  DataRate m_rateLastRate;        //!< Rate of the connection, see GetDeliveryRate ()
+};
+
+/**
+ * \brief Output operator.
+ * \param os The output stream.
+ * \param tcpTxBuf the TcpTxBuffer to print.
+ * \returns The output stream.
+ */
+std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
+
+} // namepsace ns3
+
+#endif /* TCP_TX_BUFFER_H */
@@ -0,0 +1,242 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/** Network topology
+ *
+ *     1Gb/s, 1ms                            1Gb/s, 1ms
+ * n0--------------|                    |---------------n4
+ *                 |    10Mbps, 5ms     |
+ *                 n2------------------n3
+ *      1Gb/s, 1ms |  DualQCoupledPi2   |     1Gb/s, 1ms
+ * n1--------------|                    |---------------n5
+ *
+ * Same dumbbell as tcp-prague-example: a TcpPrague flow from n1 to n5 and
+ * a TcpNewReno flow from n0 to n4 are measured, while the bottleneck is
+ * also loaded by --backgroundClassic NewReno flows and --backgroundL4S
+ * Prague flows.
+ *
+ * With --fluid=0, the background flows are simulated packet per packet, as
+ * BulkSend applications on n0 and n1. With --fluid=1, each group is a
+ * FluidTcpSource on n2, which injects their aggregate rate into the DualQ
+ * queue disc. Comparing the goodput of the measured flows and the delays of
+ * both queues between the two modes validates the fluid model, and the run
+ * time shows the gain.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpFluidDualQExample");
+
+Time sojournSum[2];
+uint32_t sojournSamples = 0;
+
+void
+SampleSojourn (Ptr<DualQCoupledPiSquareQueueDisc> queueDisc, Time interval)
+{
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      sojournSum[i] += queueDisc->GetSojournTime (i);
+    }
+  sojournSamples++;
+  Simulator::Schedule (interval, &SampleSojourn, queueDisc, interval);
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string bottleneckRate = "10Mbps";
+  std::string bottleneckDelay = "5ms";
+  uint32_t background[2] = { 10, 0 };
+  bool fluid = true;
+  double stopTime = 20.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("bottleneckRate", "Rate of the bottleneck link", bottleneckRate);
+  cmd.AddValue ("bottleneckDelay", "Delay of the bottleneck link", bottleneckDelay);
+  cmd.AddValue ("backgroundClassic", "Number of background NewReno flows", background[0]);
+  cmd.AddValue ("backgroundL4S", "Number of background Prague flows", background[1]);
+  cmd.AddValue ("fluid", "<0/1> to model the background flows as a fluid", fluid);
+  cmd.AddValue ("stopTime", "Duration of the simulation, in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
+  Config::SetDefault ("ns3::TcpSocketBase::UseEcn", BooleanValue (true));
+  Config::SetDefault ("ns3::TcpDctcp::DctcpAlphaOnInit", DoubleValue (1.0));
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (false));
+
+  Config::SetDefault ("ns3::DualQCoupledPiSquareQueueDisc::Mode", StringValue ("QUEUE_DISC_MODE_PACKETS"));
+  Config::SetDefault ("ns3::DualQCoupledPiSquareQueueDisc::MeanPktSize", UintegerValue (1500));
+  Config::SetDefault ("ns3::DualQCoupledPiSquareQueueDisc::QueueLimit", UintegerValue (200));
+
+  NodeContainer c;
+  c.Create (6);
+  NodeContainer n0n2 = NodeContainer (c.Get (0), c.Get (2));
+  NodeContainer n1n2 = NodeContainer (c.Get (1), c.Get (2));
+  NodeContainer n2n3 = NodeContainer (c.Get (2), c.Get (3));
+  NodeContainer n3n4 = NodeContainer (c.Get (3), c.Get (4));
+  NodeContainer n3n5 = NodeContainer (c.Get (3), c.Get (5));
+
+  InternetStackHelper internet;
+  internet.Install (c);
+
+  // Classic flows from n0 to n4, L4S flows from n1 to n5
+  Config::Set ("/NodeList/0/$ns3::TcpL4Protocol/SocketType", TypeIdValue (TcpNewReno::GetTypeId ()));
+  Config::Set ("/NodeList/4/$ns3::TcpL4Protocol/SocketType", TypeIdValue (TcpNewReno::GetTypeId ()));
+  Config::Set ("/NodeList/1/$ns3::TcpL4Protocol/SocketType", TypeIdValue (TcpPrague::GetTypeId ()));
+  Config::Set ("/NodeList/5/$ns3::TcpL4Protocol/SocketType", TypeIdValue (TcpPrague::GetTypeId ()));
+
+  TrafficControlHelper tchPfifo;
+  uint16_t handle = tchPfifo.SetRootQueueDisc ("ns3::PfifoFastQueueDisc");
+  tchPfifo.AddInternalQueues (handle, 3, "ns3::DropTailQueue", "MaxPackets", UintegerValue (1000));
+
+  TrafficControlHelper tchDualQ;
+  handle = tchDualQ.SetRootQueueDisc ("ns3::DualQCoupledPiSquareQueueDisc");
+  tchDualQ.AddInternalQueues (handle, 2, "ns3::DropTailQueue", "MaxPackets", UintegerValue (1000));
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue (bottleneckRate));
+  bottleneck.SetChannelAttribute ("Delay", StringValue (bottleneckDelay));
+
+  NetDeviceContainer devn0n2 = access.Install (n0n2);
+  NetDeviceContainer devn1n2 = access.Install (n1n2);
+  NetDeviceContainer devn2n3 = bottleneck.Install (n2n3);
+  NetDeviceContainer devn3n4 = access.Install (n3n4);
+  NetDeviceContainer devn3n5 = access.Install (n3n5);
+  tchPfifo.Install (devn0n2);
+  tchPfifo.Install (devn1n2);
+  QueueDiscContainer queueDiscs = tchDualQ.Install (devn2n3);
+  tchPfifo.Install (devn3n4);
+  tchPfifo.Install (devn3n5);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (devn0n2);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  ipv4.Assign (devn1n2);
+  ipv4.SetBase ("10.1.3.0", "255.255.255.0");
+  Ipv4InterfaceContainer i2i3 = ipv4.Assign (devn2n3);
+  ipv4.SetBase ("10.1.4.0", "255.255.255.0");
+  Ipv4InterfaceContainer i3i4 = ipv4.Assign (devn3n4);
+  ipv4.SetBase ("10.1.5.0", "255.255.255.0");
+  Ipv4InterfaceContainer i3i5 = ipv4.Assign (devn3n5);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // The measured flows use the first port, the background flows the next ones
+  uint16_t port = 50000;
+  Ipv4Address sinkAddress[2] = { i3i4.GetAddress (1), i3i5.GetAddress (1) };
+  ApplicationContainer sinks[2];
+  ApplicationContainer sources;
+  for (uint32_t kind = 0; kind < 2; kind++)
+    {
+      uint32_t nFlows = fluid ? 1 : background[kind] + 1;
+      for (uint32_t i = 0; i < nFlows; i++)
+        {
+          PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port + i));
+          sinks[kind].Add (sinkHelper.Install (c.Get (4 + kind)));
+          BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (sinkAddress[kind], port + i));
+          sources.Add (source.Install (c.Get (kind)));
+        }
+      sinks[kind].Start (Seconds (0.0));
+      sinks[kind].Stop (Seconds (stopTime));
+    }
+  sources.Start (Seconds (0.1));
+  sources.Stop (Seconds (stopTime));
+
+  ApplicationContainer fluidSources[2];
+  if (fluid)
+    {
+      // Path RTT of the dumbbell, without the queue of the bottleneck
+      Time baseRtt = 2 * (MilliSeconds (2) + Time (bottleneckDelay));
+      ObjectFactory factory;
+      factory.SetTypeId ("ns3::FluidTcpSource");
+      factory.Set ("BaseRtt", TimeValue (baseRtt));
+      factory.Set ("DeviceIndex", UintegerValue (devn2n3.Get (0)->GetIfIndex ()));
+      factory.Set ("Local", Ipv4AddressValue (i2i3.GetAddress (0)));
+      factory.Set ("Remote", Ipv4AddressValue (i2i3.GetAddress (1)));
+      for (uint32_t kind = 0; kind < 2; kind++)
+        {
+          if (background[kind] == 0)
+            {
+              continue;
+            }
+          factory.Set ("NFlows", UintegerValue (background[kind]));
+          factory.Set ("CongestionControl", EnumValue (kind == 0 ? FluidTcpSource::RENO : FluidTcpSource::PRAGUE));
+          Ptr<Application> app = factory.Create<Application> ();
+          c.Get (2)->AddApplication (app);
+          fluidSources[kind].Add (app);
+          fluidSources[kind].Start (Seconds (0.1));
+          fluidSources[kind].Stop (Seconds (stopTime));
+        }
+    }
+
+  Ptr<DualQCoupledPiSquareQueueDisc> dualQ = StaticCast<DualQCoupledPiSquareQueueDisc> (queueDiscs.Get (0));
+  Simulator::Schedule (Seconds (1), &SampleSojourn, dualQ, MilliSeconds (10));
+
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+
+  double duration = stopTime - 0.1;
+  std::string name[2] = { "Classic (NewReno)", "L4S (Prague)" };
+  for (uint32_t kind = 0; kind < 2; kind++)
+    {
+      std::cout << name[kind] << " goodput: "
+                << DynamicCast<PacketSink> (sinks[kind].Get (0))->GetTotalRx () * 8 / duration / 1e6 << " Mbps";
+      // The first sink is the one of the measured flow
+      uint64_t rx = 0;
+      for (uint32_t i = 1; i < sinks[kind].GetN (); i++)
+        {
+          rx += DynamicCast<PacketSink> (sinks[kind].Get (i))->GetTotalRx ();
+        }
+      if (fluidSources[kind].GetN () > 0)
+        {
+          Ptr<FluidTcpSource> source = DynamicCast<FluidTcpSource> (fluidSources[kind].Get (0));
+          rx = source->GetSent () * 1500;
+        }
+      std::cout << ", " << background[kind] << " background flows: "
+                << rx * 8 / duration / 1e6 << " Mbps" << std::endl;
+    }
+
+  DualQCoupledPiSquareQueueDisc::Stats st = dualQ->GetStats ();
+  std::cout << "*** DualQCoupledPiSquare stats from Node 2 queue ***" << std::endl;
+  std::cout << "\t " << st.unforcedClassicDrop << " Unforced drops (Classic traffic)" << std::endl;
+  std::cout << "\t " << st.unforcedClassicMark << " Unforced marks (Classic traffic)" << std::endl;
+  std::cout << "\t " << st.unforcedL4SMark << " Unforced marks (L4S traffic)" << std::endl;
+  std::cout << "\t " << st.forcedDrop << " Forced drops" << std::endl;
+  if (sojournSamples > 0)
+    {
+      std::cout << "\t " << (sojournSum[0] / sojournSamples).GetSeconds () * 1000
+                << " Mean Classic queue delay (ms)" << std::endl;
+      std::cout << "\t " << (sojournSum[1] / sojournSamples).GetSeconds () * 1000
+                << " Mean L4S queue delay (ms)" << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
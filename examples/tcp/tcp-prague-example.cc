@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/** Network topology
+ *
+ *    100Mb/s, 1ms                          100Mb/s, 1ms
+ * n0--------------|                    |---------------n4
+ *                 |    10Mbps, 5ms     |
+ *                 n2------------------n3
+ *    100Mb/s, 1ms |  DualQCoupledPi2   |    100Mb/s, 1ms
+ * n1--------------|                    |---------------n5
+ *
+ * A TcpPrague flow (L4S) from n1 to n5 shares the bottleneck with a classic
+ * ECN-capable TcpNewReno flow from n0 to n4. The DualQ AQM classifies the
+ * ECT(1) packets of Prague into its L4S queue. The goodput of both flows,
+ * the congestion window of the Prague flow and the queue statistics are
+ * reported, including the peak length of both queues, which pacing
+ * (--enablePacing) reduces.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpPragueExample");
+
+std::stringstream filePlotCwnd;
+
+void
+CwndTracer (uint32_t oldval, uint32_t newval)
+{
+  std::ofstream fPlotCwnd (filePlotCwnd.str ().c_str (), std::ios::out | std::ios::app);
+  fPlotCwnd << Simulator::Now ().GetSeconds () << " " << newval << std::endl;
+  fPlotCwnd.close ();
+}
+
+uint32_t peakQueue[2] = { 0, 0 };
+
+void
+QueueLengthTracer (uint32_t queue, uint32_t oldval, uint32_t newval)
+{
+  peakQueue[queue] = std::max (peakQueue[queue], newval);
+}
+
+void
+TraceCwnd (uint32_t nodeId)
+{
+  std::ostringstream path;
+  path << "/NodeList/" << nodeId << "/$ns3::TcpL4Protocol/SocketList/0/CongestionWindow";
+  Config::ConnectWithoutContext (path.str (), MakeCallback (&CwndTracer));
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string bottleneckRate = "10Mbps";
+  std::string bottleneckDelay = "5ms";
+  std::string pathOut = ".";
+  bool writeForPlot = false;
+  bool writePcap = false;
+  bool useAccEcn = false;
+  bool enablePacing = false;
+  double stopTime = 20.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("bottleneckRate", "Rate of the bottleneck link", bottleneckRate);
+  cmd.AddValue ("bottleneckDelay", "Delay of the bottleneck link", bottleneckDelay);
+  cmd.AddValue ("stopTime", "Duration of the simulation, in seconds", stopTime);
+  cmd.AddValue ("pathOut", "Path to save results from --writeForPlot/--writePcap", pathOut);
+  cmd.AddValue ("writeForPlot", "<0/1> to write the cwnd of the Prague flow (gnuplot)", writeForPlot);
+  cmd.AddValue ("writePcap", "<0/1> to write results in pcapfile", writePcap);
+  cmd.AddValue ("useAccEcn", "<0/1> to negotiate Accurate ECN feedback", useAccEcn);
+  cmd.AddValue ("enablePacing", "<0/1> to pace the segments of both flows", enablePacing);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
+  Config::SetDefault ("ns3::TcpSocketBase::UseEcn", BooleanValue (true));
+  Config::SetDefault ("ns3::TcpSocketBase::UseAccEcn", BooleanValue (useAccEcn));
+  Config::SetDefault ("ns3::TcpSocketState::EnablePacing", BooleanValue (enablePacing));
+  // Like Linux, start with the most conservative response to the first mark
+  Config::SetDefault ("ns3::TcpDctcp::DctcpAlphaOnInit", DoubleValue (1.0));
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (false));
+
+  Config::SetDefault ("ns3::DualQCoupledPiSquareQueueDisc::Mode", StringValue ("QUEUE_DISC_MODE_PACKETS"));
+  Config::SetDefault ("ns3::DualQCoupledPiSquareQueueDisc::MeanPktSize", UintegerValue (1500));
+  Config::SetDefault ("ns3::DualQCoupledPiSquareQueueDisc::QueueLimit", UintegerValue (200));
+
+  NodeContainer c;
+  c.Create (6);
+  NodeContainer n0n2 = NodeContainer (c.Get (0), c.Get (2));
+  NodeContainer n1n2 = NodeContainer (c.Get (1), c.Get (2));
+  NodeContainer n2n3 = NodeContainer (c.Get (2), c.Get (3));
+  NodeContainer n3n4 = NodeContainer (c.Get (3), c.Get (4));
+  NodeContainer n3n5 = NodeContainer (c.Get (3), c.Get (5));
+
+  InternetStackHelper internet;
+  internet.Install (c);
+
+  // Classic flow from n0 to n4, L4S flow from n1 to n5
+  Config::Set ("/NodeList/0/$ns3::TcpL4Protocol/SocketType", TypeIdValue (TcpNewReno::GetTypeId ()));
+  Config::Set ("/NodeList/4/$ns3::TcpL4Protocol/SocketType", TypeIdValue (TcpNewReno::GetTypeId ()));
+  Config::Set ("/NodeList/1/$ns3::TcpL4Protocol/SocketType", TypeIdValue (TcpPrague::GetTypeId ()));
+  Config::Set ("/NodeList/5/$ns3::TcpL4Protocol/SocketType", TypeIdValue (TcpPrague::GetTypeId ()));
+
+  TrafficControlHelper tchPfifo;
+  uint16_t handle = tchPfifo.SetRootQueueDisc ("ns3::PfifoFastQueueDisc");
+  tchPfifo.AddInternalQueues (handle, 3, "ns3::DropTailQueue", "MaxPackets", UintegerValue (1000));
+
+  TrafficControlHelper tchDualQ;
+  handle = tchDualQ.SetRootQueueDisc ("ns3::DualQCoupledPiSquareQueueDisc");
+  tchDualQ.AddInternalQueues (handle, 2, "ns3::DropTailQueue", "MaxPackets", UintegerValue (1000));
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue (bottleneckRate));
+  bottleneck.SetChannelAttribute ("Delay", StringValue (bottleneckDelay));
+
+  NetDeviceContainer devn0n2 = access.Install (n0n2);
+  NetDeviceContainer devn1n2 = access.Install (n1n2);
+  NetDeviceContainer devn2n3 = bottleneck.Install (n2n3);
+  NetDeviceContainer devn3n4 = access.Install (n3n4);
+  NetDeviceContainer devn3n5 = access.Install (n3n5);
+  tchPfifo.Install (devn0n2);
+  tchPfifo.Install (devn1n2);
+  QueueDiscContainer queueDiscs = tchDualQ.Install (devn2n3);
+  tchPfifo.Install (devn3n4);
+  tchPfifo.Install (devn3n5);
+
+  // Internal queue 0 holds the Classic packets, queue 1 the L4S ones
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      queueDiscs.Get (0)->GetInternalQueue (i)->TraceConnectWithoutContext ("PacketsInQueue",
+                                                                            MakeBoundCallback (&QueueLengthTracer, i));
+    }
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (devn0n2);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  ipv4.Assign (devn1n2);
+  ipv4.SetBase ("10.1.3.0", "255.255.255.0");
+  ipv4.Assign (devn2n3);
+  ipv4.SetBase ("10.1.4.0", "255.255.255.0");
+  Ipv4InterfaceContainer i3i4 = ipv4.Assign (devn3n4);
+  ipv4.SetBase ("10.1.5.0", "255.255.255.0");
+  Ipv4InterfaceContainer i3i5 = ipv4.Assign (devn3n5);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint16_t port = 50000;
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinks;
+  sinks.Add (sinkHelper.Install (c.Get (4)));
+  sinks.Add (sinkHelper.Install (c.Get (5)));
+  sinks.Start (Seconds (0.0));
+  sinks.Stop (Seconds (stopTime));
+
+  BulkSendHelper classic ("ns3::TcpSocketFactory", InetSocketAddress (i3i4.GetAddress (1), port));
+  ApplicationContainer sources = classic.Install (c.Get (0));
+  BulkSendHelper l4s ("ns3::TcpSocketFactory", InetSocketAddress (i3i5.GetAddress (1), port));
+  sources.Add (l4s.Install (c.Get (1)));
+  sources.Start (Seconds (0.1));
+  sources.Stop (Seconds (stopTime));
+
+  if (writeForPlot)
+    {
+      filePlotCwnd << pathOut << "/" << "tcp-prague-cwnd.plotme";
+      remove (filePlotCwnd.str ().c_str ());
+      Simulator::Schedule (Seconds (0.2), &TraceCwnd, 1);
+    }
+
+  if (writePcap)
+    {
+      std::stringstream stmp;
+      stmp << pathOut << "/tcp-prague";
+      bottleneck.EnablePcap (stmp.str (), devn2n3.Get (0));
+    }
+
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+
+  double duration = stopTime - 0.1;
+  std::cout << "Classic (NewReno) goodput: "
+            << DynamicCast<PacketSink> (sinks.Get (0))->GetTotalRx () * 8 / duration / 1e6 << " Mbps" << std::endl;
+  std::cout << "L4S (Prague) goodput:      "
+            << DynamicCast<PacketSink> (sinks.Get (1))->GetTotalRx () * 8 / duration / 1e6 << " Mbps" << std::endl;
+
+  DualQCoupledPiSquareQueueDisc::Stats st = StaticCast<DualQCoupledPiSquareQueueDisc> (queueDiscs.Get (0))->GetStats ();
+  std::cout << "*** DualQCoupledPiSquare stats from Node 2 queue ***" << std::endl;
+  std::cout << "\t " << st.unforcedClassicDrop << " Unforced drops (Classic traffic)" << std::endl;
+  std::cout << "\t " << st.unforcedClassicMark << " Unforced marks (Classic traffic)" << std::endl;
+  std::cout << "\t " << st.unforcedL4SMark << " Unforced marks (L4S traffic)" << std::endl;
+  std::cout << "\t " << st.forcedDrop << " Forced drops" << std::endl;
+  std::cout << "\t " << peakQueue[0] << " Peak Classic queue length (packets)" << std::endl;
+  std::cout << "\t " << peakQueue[1] << " Peak L4S queue length (packets)" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,287 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/dual-q-coupled-pi-square-queue-disc.h"
+#include "fluid-tcp-source.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FluidTcpSource");
+
+NS_OBJECT_ENSURE_REGISTERED (FluidTcpSource);
+
+static const uint16_t IPV4_PROTOCOL = 0x0800; //!< EtherType of IPv4
+static const uint8_t FLUID_PROTOCOL = 253;    //!< IP protocol of the packets (RFC 3692 experimentation)
+
+TypeId
+FluidTcpSource::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FluidTcpSource")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<FluidTcpSource> ()
+    .AddAttribute ("NFlows",
+                   "The number of flows represented by the model.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&FluidTcpSource::m_nFlows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("CongestionControl",
+                   "The congestion control of the flows.",
+                   EnumValue (RENO),
+                   MakeEnumAccessor (&FluidTcpSource::m_cc),
+                   MakeEnumChecker (RENO, "Reno",
+                                    DCTCP, "Dctcp",
+                                    PRAGUE, "Prague"))
+    .AddAttribute ("Gain",
+                   "The gain of the moving average of the fraction of marked packets (DCTCP and Prague).",
+                   DoubleValue (1.0 / 16),
+                   MakeDoubleAccessor (&FluidTcpSource::m_g),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("Ecn",
+                   "Whether the Reno flows are ECN-capable (DCTCP and Prague always are).",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&FluidTcpSource::m_ecn),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BaseRtt",
+                   "The RTT of the flows, without the queue of the bottleneck.",
+                   TimeValue (MilliSeconds (20)),
+                   MakeTimeAccessor (&FluidTcpSource::m_baseRtt),
+                   MakeTimeChecker ())
+    .AddAttribute ("PacketSize",
+                   "The size of the injected IPv4 packets, header included.",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&FluidTcpSource::m_packetSize),
+                   MakeUintegerChecker<uint32_t> (20))
+    .AddAttribute ("TimeStep",
+                   "The integration step of the model.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&FluidTcpSource::m_timeStep),
+                   MakeTimeChecker ())
+    .AddAttribute ("InitialWindow",
+                   "The window of the flows when the application starts, in packets.",
+                   DoubleValue (10),
+                   MakeDoubleAccessor (&FluidTcpSource::m_initialWindow),
+                   MakeDoubleChecker<double> (1))
+    .AddAttribute ("MaxWindow",
+                   "The maximum window of the flows, in packets.",
+                   DoubleValue (10000),
+                   MakeDoubleAccessor (&FluidTcpSource::m_maxWindow),
+                   MakeDoubleChecker<double> (1))
+    .AddAttribute ("DeviceIndex",
+                   "The index of the bottleneck device of the node.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FluidTcpSource::m_deviceIndex),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Local",
+                   "The source address of the injected packets.",
+                   Ipv4AddressValue (),
+                   MakeIpv4AddressAccessor (&FluidTcpSource::m_local),
+                   MakeIpv4AddressChecker ())
+    .AddAttribute ("Remote",
+                   "The destination address of the injected packets.",
+                   Ipv4AddressValue (),
+                   MakeIpv4AddressAccessor (&FluidTcpSource::m_remote),
+                   MakeIpv4AddressChecker ())
+    .AddTraceSource ("Window", "The window of a flow, in packets",
+                     MakeTraceSourceAccessor (&FluidTcpSource::m_window),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("Tx", "A packet is injected",
+                     MakeTraceSourceAccessor (&FluidTcpSource::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+FluidTcpSource::FluidTcpSource ()
+  : m_nFlows (10),
+    m_g (1.0 / 16),
+    m_cc (RENO),
+    m_ecn (true),
+    m_packetSize (1500),
+    m_initialWindow (10),
+    m_maxWindow (10000),
+    m_deviceIndex (0),
+    m_window (0),
+    m_alpha (1),
+    m_rate (0),
+    m_sent (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FluidTcpSource::~FluidTcpSource ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+double
+FluidTcpSource::GetWindow (void) const
+{
+  return m_window;
+}
+
+DataRate
+FluidTcpSource::GetRate (void) const
+{
+  return DataRate (static_cast<uint64_t> (m_rate * m_packetSize * 8));
+}
+
+uint64_t
+FluidTcpSource::GetSent (void) const
+{
+  return m_sent;
+}
+
+void
+FluidTcpSource::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_device = 0;
+  m_tc = 0;
+  m_queueDisc = 0;
+  m_history.clear ();
+  // chain up
+  Application::DoDispose ();
+}
+
+bool
+FluidTcpSource::IsL4S (void) const
+{
+  return m_cc != RENO;
+}
+
+void
+FluidTcpSource::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_UNLESS (m_deviceIndex < GetNode ()->GetNDevices (),
+                       "Node " << GetNode ()->GetId () << " has no device " << m_deviceIndex);
+  m_device = GetNode ()->GetDevice (m_deviceIndex);
+  m_tc = GetNode ()->GetObject<TrafficControlLayer> ();
+  NS_ABORT_MSG_UNLESS (m_tc != 0, "Node " << GetNode ()->GetId () << " has no traffic control layer");
+  m_queueDisc = DynamicCast<DualQCoupledPiSquareQueueDisc> (m_tc->GetRootQueueDiscOnDevice (m_device));
+  NS_ABORT_MSG_UNLESS (m_queueDisc != 0, "Device " << m_deviceIndex << " of node " <<
+                       GetNode ()->GetId () << " has no DualQCoupledPiSquareQueueDisc");
+
+  m_window = m_initialWindow;
+  m_alpha = 1;
+  m_rate = m_nFlows * m_window / m_baseRtt.GetSeconds ();
+  m_history.clear ();
+  Step ();
+  Inject ();
+}
+
+void
+FluidTcpSource::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_stepEvent);
+  Simulator::Cancel (m_sendEvent);
+}
+
+void
+FluidTcpSource::Step (void)
+{
+  NS_LOG_FUNCTION (this);
+  double rtt;
+  double prob;
+  if (IsL4S ())
+    {
+      rtt = (m_baseRtt + m_queueDisc->GetSojournTime (1)).GetSeconds ();
+      prob = m_queueDisc->GetL4SProb ();
+    }
+  else
+    {
+      rtt = (m_baseRtt + m_queueDisc->GetSojournTime (0)).GetSeconds ();
+      prob = m_queueDisc->GetClassicProb ();
+    }
+  FluidSample sample = { m_window, rtt, prob };
+  m_history.push_back (sample);
+
+  // The congestion signals felt now were applied one RTT ago; older states
+  // are not needed anymore
+  double dt = m_timeStep.GetSeconds ();
+  uint32_t lag = static_cast<uint32_t> (rtt / dt + 0.5);
+  while (m_history.size () > lag + 1)
+    {
+      m_history.pop_front ();
+    }
+  const FluidSample &past = m_history.front ();
+
+  double decrease;
+  if (m_cc == RENO)
+    {
+      decrease = m_window * past.m_window * past.m_prob / (2 * past.m_rtt);
+    }
+  else
+    {
+      double marked = 1 - std::pow (1 - past.m_prob, past.m_window);
+      decrease = m_window * m_alpha * marked / (2 * rtt);
+      m_alpha += m_g * (past.m_prob - m_alpha) * dt / rtt;
+    }
+  double window = m_window + (1 / rtt - decrease) * dt;
+  window = std::max (1.0, std::min (window, m_maxWindow));
+  m_window = window;
+  m_rate = m_nFlows * window / rtt;
+  NS_LOG_LOGIC ("Window " << window << " RTT " << rtt << " probability " << prob);
+
+  m_stepEvent = Simulator::Schedule (m_timeStep, &FluidTcpSource::Step, this);
+}
+
+void
+FluidTcpSource::Inject (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ipv4Header header;
+  header.SetSource (m_local);
+  header.SetDestination (m_remote);
+  header.SetProtocol (FLUID_PROTOCOL);
+  header.SetTtl (64);
+  header.SetPayloadSize (m_packetSize - header.GetSerializedSize ());
+  if (IsL4S ())
+    {
+      header.SetEcn (Ipv4Header::ECN_ECT1);
+    }
+  else if (m_ecn)
+    {
+      header.SetEcn (Ipv4Header::ECN_ECT0);
+    }
+
+  Ptr<Packet> p = Create<Packet> (m_packetSize - header.GetSerializedSize ());
+  m_txTrace (p);
+  m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (p, m_device->GetBroadcast (), IPV4_PROTOCOL, header));
+  m_sent++;
+
+  m_sendEvent = Simulator::Schedule (Seconds (1 / m_rate), &FluidTcpSource::Inject, this);
+}
+
+} // namespace ns3
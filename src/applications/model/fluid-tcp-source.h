@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef FLUID_TCP_SOURCE_H
+#define FLUID_TCP_SOURCE_H
+
+#include <deque>
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/traced-value.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+class NetDevice;
+class Packet;
+class TrafficControlLayer;
+class DualQCoupledPiSquareQueueDisc;
+
+/**
+ * \ingroup applications
+ * \defgroup fluidtcp FluidTcpSource
+ *
+ * This traffic generator loads a DualQ bottleneck with the aggregate of
+ * many long-lived TCP flows, modeled as a fluid.
+ */
+
+/**
+ * \ingroup fluidtcp
+ *
+ * \brief Fluid model of NFlows long-lived TCP flows through a DualQ bottleneck
+ *
+ * The application is installed on the node of the bottleneck, and injects
+ * packets directly into the DualQCoupledPiSquareQueueDisc of the device
+ * selected by DeviceIndex. The flows are not simulated packet per packet:
+ * their common window W (in packets) follows the fluid model of Misra,
+ * Gong and Towsley, integrated every TimeStep, and the aggregate rate
+ * NFlows * W / R is injected as a stream of evenly spaced packets. R is
+ * BaseRtt plus the sojourn time of the queue of the flows, and the
+ * congestion signal p is the probability applied by the queue disc to
+ * their packets (see DualQCoupledPiSquareQueueDisc::GetClassicProb and
+ * GetL4SProb), taken one RTT earlier:
+ *
+ * - Reno (Classic queue): dW/dt = 1/R - W(t) W(t-R) p(t-R) / (2 R(t-R))
+ * - DCTCP and Prague (L4S queue), after Alizadeh et al. (SIGMETRICS 2011):
+ *   dW/dt = 1/R - W(t) a(t) q(t-R) / (2 R) and da/dt = g (p(t-R) - a(t)) / R,
+ *   where a is the moving average of the fraction of marked packets, of
+ *   gain g, and q = 1 - (1 - p)^W the probability that a window is marked
+ *
+ * The packets are marked ECT(1) for DCTCP and Prague, ECT(0) for Reno if
+ * Ecn is set. Their destination address should be the peer of the device,
+ * which discards them: they only load the queue and the link. The queue
+ * disc marks and drops them like any other packet, but only the
+ * probabilities act on the model; the drops due to the queue limit, slow
+ * start and timeouts are not modeled.
+ */
+class FluidTcpSource : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief The congestion controls of the flows
+   */
+  typedef enum
+  {
+    RENO,    //!< Classic AIMD, halving the window per congestion signal
+    DCTCP,   //!< Scalable, half a packet per mark
+    PRAGUE   //!< Same response as DCTCP
+  } FluidCongestionControl_t;
+
+  FluidTcpSource ();
+
+  virtual ~FluidTcpSource ();
+
+  /**
+   * \return the window of a flow, in packets
+   */
+  double GetWindow (void) const;
+
+  /**
+   * \return the aggregate sending rate of the flows
+   */
+  DataRate GetRate (void) const;
+
+  /**
+   * \return the number of packets injected so far
+   */
+  uint64_t GetSent (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  // inherited from Application base class.
+  virtual void StartApplication (void);    // Called at time specified by Start
+  virtual void StopApplication (void);     // Called at time specified by Stop
+
+  /**
+   * \brief Integrate the model over a TimeStep, and schedule the next step
+   */
+  void Step (void);
+
+  /**
+   * \brief Inject a packet, and schedule the next one at the current rate
+   */
+  void Inject (void);
+
+  /**
+   * \return true if the flows use the L4S queue
+   */
+  bool IsL4S (void) const;
+
+  /**
+   * \brief State of the model at a step, kept for the delayed terms
+   */
+  struct FluidSample
+  {
+    double m_window;  //!< Window of a flow, in packets
+    double m_rtt;     //!< RTT, in seconds
+    double m_prob;    //!< Congestion signal probability
+  };
+
+  uint32_t m_nFlows;                  //!< Number of flows
+  double m_g;                         //!< Gain of the marking average
+  FluidCongestionControl_t m_cc;      //!< Congestion control of the flows
+  bool m_ecn;                         //!< Reno flows are ECN-capable
+  Time m_baseRtt;                     //!< RTT without the bottleneck queue
+  uint32_t m_packetSize;              //!< Size of the IPv4 packets
+  Time m_timeStep;                    //!< Integration step
+  double m_initialWindow;             //!< Initial window, in packets
+  double m_maxWindow;                 //!< Maximum window, in packets
+  uint32_t m_deviceIndex;             //!< Index of the bottleneck device
+  Ipv4Address m_local;                //!< Source address of the packets
+  Ipv4Address m_remote;               //!< Destination address of the packets
+
+  Ptr<NetDevice> m_device;                          //!< Bottleneck device
+  Ptr<TrafficControlLayer> m_tc;                    //!< Traffic control layer of the node
+  Ptr<DualQCoupledPiSquareQueueDisc> m_queueDisc;   //!< Queue disc of the device
+  TracedValue<double> m_window;       //!< Window of a flow, in packets
+  double m_alpha;                     //!< Average fraction of marked packets
+  double m_rate;                      //!< Aggregate rate, in packets per second
+  std::deque<FluidSample> m_history;  //!< Past states, the newest at the back
+  uint64_t m_sent;                    //!< Number of packets injected
+  EventId m_stepEvent;                //!< Next integration step
+  EventId m_sendEvent;                //!< Next packet
+
+  /// Traced Callback: injected packets
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* FLUID_TCP_SOURCE_H */
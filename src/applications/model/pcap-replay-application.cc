@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-helper.h"
+#include "pcap-replay-application.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapReplayApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapReplayApplication);
+
+static const uint16_t IPV4_PROTOCOL = 0x0800; //!< EtherType of IPv4
+static const uint16_t IPV6_PROTOCOL = 0x86dd; //!< EtherType of IPv6
+
+TypeId
+PcapReplayApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapReplayApplication")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<PcapReplayApplication> ()
+    .AddAttribute ("Filename",
+                   "The name of the pcap file to replay.",
+                   StringValue (""),
+                   MakeStringAccessor (&PcapReplayApplication::m_filename),
+                   MakeStringChecker ())
+    .AddAttribute ("DeviceIndex",
+                   "The index of the device of the node the packets are sent on.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapReplayApplication::m_deviceIndex),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Destination",
+                   "The link layer destination of the packets. "
+                   "By default, the broadcast address of the device.",
+                   AddressValue (),
+                   MakeAddressAccessor (&PcapReplayApplication::m_destination),
+                   MakeAddressChecker ())
+    .AddTraceSource ("Tx", "A packet of the trace is sent",
+                     MakeTraceSourceAccessor (&PcapReplayApplication::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+PcapReplayApplication::PcapReplayApplication ()
+  : m_deviceIndex (0),
+    m_sent (0),
+    m_skipped (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapReplayApplication::~PcapReplayApplication ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+PcapReplayApplication::GetSent (void) const
+{
+  return m_sent;
+}
+
+uint64_t
+PcapReplayApplication::GetSkipped (void) const
+{
+  return m_skipped;
+}
+
+void
+PcapReplayApplication::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_device = 0;
+  m_file.Close ();
+  // chain up
+  Application::DoDispose ();
+}
+
+void
+PcapReplayApplication::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_UNLESS (m_file.Open (m_filename), "Unable to open the pcap file " << m_filename);
+  NS_ABORT_MSG_UNLESS (m_deviceIndex < GetNode ()->GetNDevices (),
+                       "Node " << GetNode ()->GetId () << " has no device " << m_deviceIndex);
+  m_device = GetNode ()->GetDevice (m_deviceIndex);
+  if (m_destination.IsInvalid ())
+    {
+      m_destination = m_device->GetBroadcast ();
+    }
+
+  m_current = m_file.Begin ();
+  if (m_current != m_file.End ())
+    {
+      m_origin = m_current->timestamp;
+    }
+  m_start = Simulator::Now ();
+  ScheduleNext ();
+}
+
+void
+PcapReplayApplication::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sendEvent);
+}
+
+void
+PcapReplayApplication::ScheduleNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_current == m_file.End ())
+    {
+      NS_LOG_LOGIC ("End of " << m_filename << ": " << m_sent << " packets sent");
+      return;
+    }
+  Time at = m_start + m_current->timestamp - m_origin;
+  // timestamps are not always monotonic in captured traces
+  Time delay = at > Simulator::Now () ? at - Simulator::Now () : Time (0);
+  m_sendEvent = Simulator::Schedule (delay, &PcapReplayApplication::SendRecord, this);
+}
+
+void
+PcapReplayApplication::SendRecord (void)
+{
+  NS_LOG_FUNCTION (this);
+  const MappedPcapFile::Record &record = *m_current;
+  uint32_t offset;
+  uint16_t protocol;
+  if (Decapsulate (record, offset, protocol))
+    {
+      Ptr<Packet> p = Create<Packet> (record.data + offset, record.inclLen - offset);
+      if (record.origLen > record.inclLen)
+        {
+          p->AddPaddingAtEnd (record.origLen - record.inclLen);
+        }
+      m_txTrace (p);
+      m_device->Send (p, m_destination, protocol);
+      m_sent++;
+    }
+  else
+    {
+      m_skipped++;
+    }
+  ++m_current;
+  ScheduleNext ();
+}
+
+bool
+PcapReplayApplication::Decapsulate (const MappedPcapFile::Record &record, uint32_t &offset, uint16_t &protocol) const
+{
+  const uint8_t *data = record.data;
+  uint32_t length = record.inclLen;
+  switch (m_file.GetDataLinkType ())
+    {
+    case PcapHelper::DLT_EN10MB:
+      offset = 14;
+      if (length < offset)
+        {
+          return false;
+        }
+      protocol = (data[12] << 8) | data[13];
+      // skip a 802.1Q tag
+      if (protocol == 0x8100 && length >= offset + 4)
+        {
+          protocol = (data[16] << 8) | data[17];
+          offset += 4;
+        }
+      break;
+    case PcapHelper::DLT_PPP:
+      offset = 2;
+      if (length < offset)
+        {
+          return false;
+        }
+      protocol = (data[0] << 8) | data[1];
+      protocol = protocol == 0x0021 ? IPV4_PROTOCOL : protocol == 0x0057 ? IPV6_PROTOCOL : 0;
+      break;
+    case PcapHelper::DLT_LINUX_SLL:
+      offset = 16;
+      if (length < offset)
+        {
+          return false;
+        }
+      protocol = (data[14] << 8) | data[15];
+      break;
+    case PcapHelper::DLT_NULL:
+      offset = 4;
+      if (length <= offset)
+        {
+          return false;
+        }
+      // the address family is in the byte order of the capturing host:
+      // look at the IP version instead
+      protocol = (data[offset] >> 4) == 4 ? IPV4_PROTOCOL : (data[offset] >> 4) == 6 ? IPV6_PROTOCOL : 0;
+      break;
+    case PcapHelper::DLT_RAW:
+    case 228: // LINKTYPE_IPV4
+    case 229: // LINKTYPE_IPV6
+      offset = 0;
+      if (length == 0)
+        {
+          return false;
+        }
+      protocol = (data[0] >> 4) == 4 ? IPV4_PROTOCOL : (data[0] >> 4) == 6 ? IPV6_PROTOCOL : 0;
+      break;
+    default:
+      NS_ABORT_MSG ("Unsupported data link type " << m_file.GetDataLinkType () << " in " << m_filename);
+      return false;
+    }
+  return protocol == IPV4_PROTOCOL || protocol == IPV6_PROTOCOL;
+}
+
+} // namespace ns3
@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/dual-q-coupled-pi-square-queue-disc.h"
+#include "ns3/fluid-tcp-source.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/data-rate.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Check that the aggregate of a FluidTcpSource settles where the fluid
+ * model and the AQM put it: the bottleneck is fully used, the queue of the
+ * flows stays around its target (the reference delay of the Classic queue,
+ * below the marking threshold for the L4S one), and the window meets the
+ * steady state of the model: W^2 p / 2 = 1 for Reno, and p = sqrt (2 / W)
+ * for the scalable flows, whose window saws around the step threshold of
+ * the L4S queue (Alizadeh et al., SIGMETRICS 2011).
+ */
+class FluidTcpSourceTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param cc the congestion control of the flows
+   * \param desc the description of the test
+   */
+  FluidTcpSourceTestCase (FluidTcpSource::FluidCongestionControl_t cc, std::string desc);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Sample the state of the model and of the queue disc every 10 ms
+   * \param source the fluid source
+   * \param queueDisc the bottleneck queue disc
+   */
+  void Sample (Ptr<FluidTcpSource> source, Ptr<DualQCoupledPiSquareQueueDisc> queueDisc);
+
+  /**
+   * Count the packets delivered through the bottleneck
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the EtherType
+   * \param from the sender address
+   * \param to the destination address
+   * \param packetType the type of packet
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+  FluidTcpSource::FluidCongestionControl_t m_cc; //!< congestion control of the flows
+  uint32_t m_samples;    //!< number of samples
+  double m_sojourn;      //!< sum of the sampled sojourn times, in seconds
+  double m_window;       //!< sum of the sampled windows
+  double m_prob;         //!< sum of the sampled probabilities
+  uint64_t m_rxBytes;    //!< bytes delivered since the first sample
+};
+
+FluidTcpSourceTestCase::FluidTcpSourceTestCase (FluidTcpSource::FluidCongestionControl_t cc, std::string desc)
+  : TestCase (desc),
+    m_cc (cc),
+    m_samples (0),
+    m_sojourn (0),
+    m_window (0),
+    m_prob (0),
+    m_rxBytes (0)
+{
+}
+
+void
+FluidTcpSourceTestCase::Sample (Ptr<FluidTcpSource> source, Ptr<DualQCoupledPiSquareQueueDisc> queueDisc)
+{
+  m_window += source->GetWindow ();
+  if (m_cc == FluidTcpSource::RENO)
+    {
+      m_sojourn += queueDisc->GetSojournTime (0).GetSeconds ();
+      m_prob += queueDisc->GetClassicProb ();
+    }
+  else
+    {
+      m_sojourn += queueDisc->GetSojournTime (1).GetSeconds ();
+      m_prob += queueDisc->GetL4SProb ();
+    }
+  m_samples++;
+  Simulator::Schedule (MilliSeconds (10), &FluidTcpSourceTestCase::Sample, this, source, queueDisc);
+}
+
+void
+FluidTcpSourceTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                                 const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  if (m_samples > 0)
+    {
+      m_rxBytes += p->GetSize ();
+    }
+}
+
+void
+FluidTcpSourceTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+  InternetStackHelper internet;
+  internet.Install (n);
+
+  Ptr<SimpleNetDevice> txDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  txDev->SetAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
+  n.Get (0)->AddDevice (txDev);
+  n.Get (1)->AddDevice (rxDev);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  rxDev->SetChannel (channel);
+  txDev->SetChannel (channel);
+  NetDeviceContainer d;
+  d.Add (txDev);
+  d.Add (rxDev);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::DualQCoupledPiSquareQueueDisc",
+                        "Mode", StringValue ("QUEUE_DISC_MODE_PACKETS"),
+                        "MeanPktSize", UintegerValue (1500),
+                        "QueueLimit", UintegerValue (1000));
+  QueueDiscContainer qdiscs = tch.Install (txDev);
+  Ptr<DualQCoupledPiSquareQueueDisc> queueDisc = DynamicCast<DualQCoupledPiSquareQueueDisc> (qdiscs.Get (0));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (d);
+
+  n.Get (1)->RegisterProtocolHandler (MakeCallback (&FluidTcpSourceTestCase::Receive, this),
+                                      0x0800, rxDev);
+
+  Ptr<FluidTcpSource> source = CreateObject<FluidTcpSource> ();
+  source->SetAttribute ("NFlows", UintegerValue (10));
+  source->SetAttribute ("CongestionControl", EnumValue (m_cc));
+  source->SetAttribute ("BaseRtt", TimeValue (MilliSeconds (50)));
+  source->SetAttribute ("DeviceIndex", UintegerValue (txDev->GetIfIndex ()));
+  source->SetAttribute ("Local", Ipv4AddressValue (i.GetAddress (0)));
+  source->SetAttribute ("Remote", Ipv4AddressValue (i.GetAddress (1)));
+  n.Get (0)->AddApplication (source);
+  source->SetStartTime (Seconds (1));
+  source->SetStopTime (Seconds (20));
+
+  // Leave the model 9 s to converge
+  Simulator::Schedule (Seconds (10), &FluidTcpSourceTestCase::Sample, this, source, queueDisc);
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+
+  double sojourn = m_sojourn / m_samples;
+  double window = m_window / m_samples;
+  double prob = m_prob / m_samples;
+  double rate = m_rxBytes * 8 / 10.0;
+  double steadyState;
+  NS_TEST_EXPECT_MSG_GT (source->GetSent (), 0u, "No packet injected");
+  NS_TEST_EXPECT_MSG_GT (rate, 90e6, "Bottleneck not used");
+  if (m_cc == FluidTcpSource::RENO)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (sojourn, 0.015, 0.005, "Classic queue away from its reference delay");
+      steadyState = window * window * prob / 2;
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_LT (sojourn, 0.002, "L4S queue above the marking threshold");
+      steadyState = prob / std::sqrt (2 / window);
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (steadyState, 1, 0.5, "Window away from the steady state of the model");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief FluidTcpSource TestSuite
+ */
+class FluidTcpSourceTestSuite : public TestSuite
+{
+public:
+  FluidTcpSourceTestSuite () : TestSuite ("fluid-tcp-source", UNIT)
+  {
+    AddTestCase (new FluidTcpSourceTestCase (FluidTcpSource::RENO, "Fluid Reno flows in the Classic queue"),
+                 TestCase::QUICK);
+    AddTestCase (new FluidTcpSourceTestCase (FluidTcpSource::PRAGUE, "Fluid Prague flows in the L4S queue"),
+                 TestCase::QUICK);
+  }
+};
+
+static FluidTcpSourceTestSuite g_fluidTcpSourceTestSuite; //!< Static variable for test initialization
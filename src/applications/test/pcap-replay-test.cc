@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <vector>
+#include "ns3/log.h"
+#include "ns3/pcap-file.h"
+#include "ns3/mapped-pcap-file.h"
+#include "ns3/trace-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/pcap-replay-helper.h"
+#include "ns3/pcap-replay-application.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that the packets of a pcap trace are replayed by a
+ * PcapReplayApplication with their original timing, addresses, ports and
+ * ECN bits.
+ */
+class PcapReplayTestCase : public TestCase
+{
+public:
+  PcapReplayTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Write a record carrying an IPv4/UDP packet to the trace
+   * \param file the trace
+   * \param ts the timestamp of the record, in microseconds
+   * \param size the size of the UDP payload
+   * \param ecn the ECN codepoint of the packet
+   */
+  void WriteRecord (PcapFile &file, uint64_t ts, uint32_t size, Ipv4Header::EcnType ecn);
+
+  /**
+   * Receive the replayed packets
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  std::vector<Time> m_times;    //!< reception times
+  std::vector<uint8_t> m_tos;   //!< received TOS bytes
+  std::vector<uint32_t> m_sizes; //!< received payload sizes
+  std::vector<Address> m_from;  //!< senders of the packets
+};
+
+PcapReplayTestCase::PcapReplayTestCase ()
+  : TestCase ("Test that a PcapReplayApplication replays the packets of a trace")
+{
+}
+
+void
+PcapReplayTestCase::WriteRecord (PcapFile &file, uint64_t ts, uint32_t size, Ipv4Header::EcnType ecn)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  UdpHeader udp;
+  udp.SetSourcePort (5000);
+  udp.SetDestinationPort (9);
+  p->AddHeader (udp);
+  Ipv4Header ip;
+  ip.SetSource (Ipv4Address ("10.1.1.1"));
+  ip.SetDestination (Ipv4Address ("10.1.1.2"));
+  ip.SetProtocol (17);
+  ip.SetPayloadSize (p->GetSize ());
+  ip.SetTtl (64);
+  ip.SetEcn (ecn);
+  p->AddHeader (ip);
+  file.Write (ts / 1000000, ts % 1000000, p);
+}
+
+void
+PcapReplayTestCase::Receive (Ptr<Socket> socket)
+{
+  Address from;
+  Ptr<Packet> p;
+  while ((p = socket->RecvFrom (from)))
+    {
+      SocketIpTosTag tos;
+      NS_TEST_EXPECT_MSG_EQ (p->RemovePacketTag (tos), true, "TOS not received");
+      m_times.push_back (Simulator::Now ());
+      m_tos.push_back (tos.GetTos ());
+      m_sizes.push_back (p->GetSize ());
+      m_from.push_back (from);
+    }
+}
+
+void
+PcapReplayTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("replay.pcap");
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  f.Init (PcapHelper::DLT_RAW, 100);
+  WriteRecord (f, 100000000, 20, Ipv4Header::ECN_ECT1);
+  WriteRecord (f, 100001500, 30, Ipv4Header::ECN_CE);
+  // not an IP packet: skipped
+  uint8_t garbage[20] = { 0 };
+  f.Write (100, 5000, garbage, sizeof (garbage));
+  // truncated to the snap length, and padded back when replayed
+  WriteRecord (f, 100010000, 200, Ipv4Header::ECN_NotECT);
+  f.Close ();
+
+  MappedPcapFile mapped;
+  NS_TEST_ASSERT_MSG_EQ (mapped.Open (filename), true, "Unable to map the trace");
+  NS_TEST_EXPECT_MSG_EQ (mapped.GetDataLinkType (), PcapHelper::DLT_RAW, "Wrong data link type");
+  uint32_t records = 0;
+  for (MappedPcapFile::Iterator i = mapped.Begin (); i != mapped.End (); ++i)
+    {
+      records++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (records, 4, "Wrong number of records");
+  MappedPcapFile::Iterator last = mapped.Begin ();
+  ++last;
+  ++last;
+  ++last;
+  NS_TEST_EXPECT_MSG_EQ (last->timestamp, MicroSeconds (100010000), "Wrong timestamp");
+  NS_TEST_EXPECT_MSG_EQ (last->inclLen, 100, "Wrong captured length");
+  NS_TEST_EXPECT_MSG_EQ (last->origLen, 20 + 8 + 200, "Wrong original length");
+  mapped.Close ();
+
+  NodeContainer n;
+  n.Create (2);
+  InternetStackHelper internet;
+  internet.Install (n);
+
+  Ptr<SimpleNetDevice> txDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  n.Get (0)->AddDevice (txDev);
+  n.Get (1)->AddDevice (rxDev);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  rxDev->SetChannel (channel);
+  txDev->SetChannel (channel);
+  NetDeviceContainer d;
+  d.Add (txDev);
+  d.Add (rxDev);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (d);
+
+  Ptr<Socket> socket = Socket::CreateSocket (n.Get (1), UdpSocketFactory::GetTypeId ());
+  socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  socket->SetIpRecvTos (true);
+  socket->SetRecvCallback (MakeCallback (&PcapReplayTestCase::Receive, this));
+
+  PcapReplayHelper replay (filename);
+  replay.SetAttribute ("DeviceIndex", UintegerValue (txDev->GetIfIndex ()));
+  ApplicationContainer apps = replay.Install (n.Get (0));
+  apps.Start (Seconds (1.0));
+  apps.Stop (Seconds (10.0));
+
+  Simulator::Run ();
+
+  Ptr<PcapReplayApplication> app = DynamicCast<PcapReplayApplication> (apps.Get (0));
+  NS_TEST_EXPECT_MSG_EQ (app->GetSent (), 3, "Wrong number of packets sent");
+  NS_TEST_EXPECT_MSG_EQ (app->GetSkipped (), 1, "Wrong number of frames skipped");
+  Simulator::Destroy ();
+  remove (filename.c_str ());
+
+  NS_TEST_ASSERT_MSG_EQ (m_times.size (), 3, "Wrong number of packets received");
+  NS_TEST_EXPECT_MSG_EQ (m_times[0], Seconds (1), "Wrong time of the first packet");
+  NS_TEST_EXPECT_MSG_EQ (m_times[1], Seconds (1) + MicroSeconds (1500), "Wrong inter-arrival time");
+  NS_TEST_EXPECT_MSG_EQ (m_times[2], Seconds (1) + MicroSeconds (10000), "Wrong inter-arrival time");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (m_tos[0] & 0x3), Ipv4Header::ECN_ECT1, "Wrong ECN bits");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (m_tos[1] & 0x3), Ipv4Header::ECN_CE, "Wrong ECN bits");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (m_tos[2] & 0x3), Ipv4Header::ECN_NotECT, "Wrong ECN bits");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[1], 30, "Wrong payload size");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[2], 200, "Truncated packet not padded");
+  InetSocketAddress from = InetSocketAddress::ConvertFrom (m_from[0]);
+  NS_TEST_EXPECT_MSG_EQ (from.GetIpv4 (), Ipv4Address ("10.1.1.1"), "Wrong source address");
+  NS_TEST_EXPECT_MSG_EQ (from.GetPort (), 5000, "Wrong source port");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief Pcap replay TestSuite
+ */
+class PcapReplayTestSuite : public TestSuite
+{
+public:
+  PcapReplayTestSuite ();
+};
+
+PcapReplayTestSuite::PcapReplayTestSuite ()
+  : TestSuite ("pcap-replay", UNIT)
+{
+  AddTestCase (new PcapReplayTestCase, TestCase::QUICK);
+}
+
+static PcapReplayTestSuite pcapReplayTestSuite; //!< Static variable for test initialization
@@ -70,6 +70,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentUid = 0;
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
+  m_eventCount = 0;
   m_unscheduledEvents = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
@@ -146,6 +147,7 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
+  m_eventCount++;
   next.impl->Invoke ();
   next.impl->Unref ();
 
@@ -414,4 +416,10 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
 } // namespace ns3
@@ -184,6 +184,15 @@ public:
    */
   static uint32_t GetContext (void);
 
+  /**
+   * Get the number of events processed since the simulator was created
+   * (or since the last Destroy), Destroy events excepted. Canceled events
+   * are counted: they stay in the event list until their expiration.
+   *
+   * @return The number of executed events
+   */
+  static uint64_t GetEventCount (void);
+
   /** Context enum values. */
   enum {
     /**
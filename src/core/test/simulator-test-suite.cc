@@ -131,11 +131,14 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (!a.IsExpired (), true, "");
   Simulator::Cancel (a);
   NS_TEST_EXPECT_MSG_EQ (a.IsExpired (), true, "");
+  uint64_t events = Simulator::GetEventCount ();
   Simulator::Run ();
   NS_TEST_EXPECT_MSG_EQ (m_a, true, "Event A did not run ?");
   NS_TEST_EXPECT_MSG_EQ (m_b, true, "Event B did not run ?");
   NS_TEST_EXPECT_MSG_EQ (m_c, true, "Event C did not run ?");
   NS_TEST_EXPECT_MSG_EQ (m_d, true, "Event D did not run ?");
+  events = Simulator::GetEventCount () - events;
+  NS_TEST_EXPECT_MSG_EQ (events, 3, "Events A (canceled), B and D should have been counted");
 
   EventId anId = Simulator::ScheduleNow (&SimulatorEventsTestCase::Eventfoo0, this);
   EventId anotherId = anId;
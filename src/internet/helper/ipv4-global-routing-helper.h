@@ -82,6 +82,8 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * Only the routers which can reach a link state advertisement that
+   * changed since the previous computation have their routes replaced.
    */
   static void RecomputeRoutingTables (void);
 private:
@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <vector>
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/net-device.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ndisc-cache.h"
+#include "neighbor-cache-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NeighborCacheHelper");
+
+void
+NeighborCacheHelper::PopulateNeighborCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  for (uint32_t i = 0; i < ChannelList::GetNChannels (); i++)
+    {
+      PopulateNeighborCache (ChannelList::GetChannel (i));
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (Ptr<Channel> channel)
+{
+  NS_LOG_FUNCTION (channel);
+  // The IPv4 and IPv6 interfaces of the devices attached to the channel
+  std::vector<Ptr<NetDevice> > devices;
+  std::vector<Ptr<Ipv4Interface> > ipv4Interfaces;
+  std::vector<Ptr<Ipv6Interface> > ipv6Interfaces;
+  for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = channel->GetDevice (i);
+      Ptr<Ipv4Interface> ipv4Interface;
+      Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+      if (ipv4 != 0 && ipv4->GetInterfaceForDevice (device) >= 0)
+        {
+          ipv4Interface = ipv4->GetInterface (ipv4->GetInterfaceForDevice (device));
+        }
+      Ptr<Ipv6Interface> ipv6Interface;
+      Ptr<Ipv6L3Protocol> ipv6 = device->GetNode ()->GetObject<Ipv6L3Protocol> ();
+      if (ipv6 != 0 && ipv6->GetInterfaceForDevice (device) >= 0)
+        {
+          ipv6Interface = ipv6->GetInterface (ipv6->GetInterfaceForDevice (device));
+        }
+      devices.push_back (device);
+      ipv4Interfaces.push_back (ipv4Interface);
+      ipv6Interfaces.push_back (ipv6Interface);
+    }
+
+  for (uint32_t i = 0; i < devices.size (); i++)
+    {
+      Ptr<ArpCache> arpCache = ipv4Interfaces[i] ? ipv4Interfaces[i]->GetArpCache () : 0;
+      Ptr<NdiscCache> ndiscCache = ipv6Interfaces[i] ? ipv6Interfaces[i]->GetNdiscCache () : 0;
+      for (uint32_t j = 0; j < devices.size (); j++)
+        {
+          if (i == j)
+            {
+              continue;
+            }
+          Address mac = devices[j]->GetAddress ();
+          if (arpCache && ipv4Interfaces[j])
+            {
+              for (uint32_t k = 0; k < ipv4Interfaces[j]->GetNAddresses (); k++)
+                {
+                  Ipv4Address address = ipv4Interfaces[j]->GetAddress (k).GetLocal ();
+                  ArpCache::Entry *entry = arpCache->Lookup (address);
+                  if (entry == 0)
+                    {
+                      entry = arpCache->Add (address);
+                    }
+                  NS_LOG_LOGIC ("Permanent ARP entry " << address << " " << mac);
+                  entry->SetMacAddress (mac);
+                  entry->MarkPermanent ();
+                }
+            }
+          if (ndiscCache && ipv6Interfaces[j])
+            {
+              for (uint32_t k = 0; k < ipv6Interfaces[j]->GetNAddresses (); k++)
+                {
+                  Ipv6Address address = ipv6Interfaces[j]->GetAddress (k).GetAddress ();
+                  NdiscCache::Entry *entry = ndiscCache->Lookup (address);
+                  if (entry == 0)
+                    {
+                      entry = ndiscCache->Add (address);
+                    }
+                  NS_LOG_LOGIC ("Permanent NDISC entry " << address << " " << mac);
+                  entry->SetMacAddress (mac);
+                  entry->MarkPermanent ();
+                }
+            }
+        }
+    }
+}
+
+} // namespace ns3
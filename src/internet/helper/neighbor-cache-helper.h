@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NEIGHBOR_CACHE_HELPER_H
+#define NEIGHBOR_CACHE_HELPER_H
+
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Channel;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Fill the ARP and Neighbor Discovery caches from the topology
+ *
+ * In large simulations, address resolution adds a round trip and a burst
+ * of broadcasts at the start of every conversation, and its timers keep
+ * running all along. Once the addresses are assigned, the helper adds a
+ * PERMANENT entry to the cache of every IPv4 and IPv6 interface for every
+ * address of the other interfaces attached to the same channel, so that no
+ * ARP request nor Neighbor Solicitation is ever needed.
+ *
+ * Only the devices attached to the same channel are neighbors: hosts on
+ * both sides of a bridge still resolve each other's addresses. Addresses
+ * assigned after the call are not known either.
+ */
+class NeighborCacheHelper
+{
+public:
+  /**
+   * \brief Fill the caches of the interfaces attached to every channel
+   */
+  static void PopulateNeighborCache (void);
+
+  /**
+   * \brief Fill the caches of the interfaces attached to a channel
+   * \param channel the channel
+   */
+  static void PopulateNeighborCache (Ptr<Channel> channel);
+};
+
+} // namespace ns3
+
+#endif /* NEIGHBOR_CACHE_HELPER_H */
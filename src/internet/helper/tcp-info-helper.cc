@@ -0,0 +1,322 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <cstring>
+
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/buffer.h"
+#include "tcp-info-helper.h"
+
+namespace ns3 {
+
+/// Magic number opening the binary files ("TCPI")
+static const uint32_t TCP_INFO_MAGIC = 0x49504354;
+/// Version of the binary format
+static const uint16_t TCP_INFO_VERSION = 1;
+
+/// Columns of the binary format
+enum TcpInfoColumn
+{
+  LOCAL, LPORT, PEER, PPORT, STATE, CA, ECN,
+  CWND, SSTHRESH, INFLIGHT, SACKED, LOST, RWND,
+  SRTT, RTTVAR, RTT, RTO, PACING, DELIVERY,
+  DELIVERED, RETRANS, CE_RCVD, CE_ECHOED,
+  N_COLUMNS
+};
+
+/// Name and size in bytes of the binary columns, in TcpInfoColumn order
+static const struct
+{
+  const char *name; //!< Column name
+  uint8_t size;     //!< Size of a value
+} g_tcpInfoColumns[N_COLUMNS] = {
+  { "local", 16 }, { "lport", 2 }, { "peer", 16 }, { "pport", 2 },
+  { "state", 1 }, { "ca", 1 }, { "ecn", 1 },
+  { "cwnd", 4 }, { "ssthresh", 4 }, { "inflight", 4 }, { "sacked", 4 }, { "lost", 4 }, { "rwnd", 4 },
+  { "srtt_us", 8 }, { "rttvar_us", 8 }, { "rtt_us", 8 }, { "rto_us", 8 },
+  { "pacing_bps", 8 }, { "delivery_bps", 8 },
+  { "delivered", 8 }, { "retrans", 4 }, { "ce_rcvd", 4 }, { "ce_echoed", 4 }
+};
+
+/// A connection sampled by TcpInfoHelper::Sample
+struct TcpInfoRow
+{
+  Address local; //!< Local socket address
+  Address peer;  //!< Peer socket address
+  TcpInfo info;  //!< Snapshot of the connection
+};
+
+/**
+ * \brief Write the address and port of a socket address
+ * \param os the output stream
+ * \param address an InetSocketAddress or an Inet6SocketAddress
+ */
+static void
+WriteSocketAddress (std::ostream *os, const Address &address)
+{
+  if (InetSocketAddress::IsMatchingType (address))
+    {
+      InetSocketAddress inet = InetSocketAddress::ConvertFrom (address);
+      *os << inet.GetIpv4 () << "\t" << inet.GetPort ();
+    }
+  else
+    {
+      Inet6SocketAddress inet6 = Inet6SocketAddress::ConvertFrom (address);
+      *os << inet6.GetIpv6 () << "\t" << inet6.GetPort ();
+    }
+}
+
+/**
+ * \brief Write the address of a socket address as 16 bytes, IPv4 addresses
+ * being mapped to IPv6 (::ffff:a.b.c.d)
+ * \param it the buffer iterator
+ * \param address an InetSocketAddress or an Inet6SocketAddress
+ */
+static void
+WriteSocketAddress (Buffer::Iterator &it, const Address &address)
+{
+  uint8_t buf[16];
+  if (InetSocketAddress::IsMatchingType (address))
+    {
+      Ipv4Address ipv4 = InetSocketAddress::ConvertFrom (address).GetIpv4 ();
+      Ipv6Address::MakeIpv4MappedAddress (ipv4).Serialize (buf);
+    }
+  else
+    {
+      Inet6SocketAddress::ConvertFrom (address).GetIpv6 ().Serialize (buf);
+    }
+  it.Write (buf, 16);
+}
+
+/**
+ * \param address an InetSocketAddress or an Inet6SocketAddress
+ * \returns the port of the socket address
+ */
+static uint16_t
+GetSocketPort (const Address &address)
+{
+  if (InetSocketAddress::IsMatchingType (address))
+    {
+      return InetSocketAddress::ConvertFrom (address).GetPort ();
+    }
+  return Inet6SocketAddress::ConvertFrom (address).GetPort ();
+}
+
+/**
+ * \param row a sampled connection
+ * \param column a column of the binary format, other than an address
+ * \returns the value of the column for the connection
+ */
+static uint64_t
+GetColumnValue (const TcpInfoRow &row, uint32_t column)
+{
+  const TcpInfo &info = row.info;
+  switch (column)
+    {
+    case LPORT: return GetSocketPort (row.local);
+    case PPORT: return GetSocketPort (row.peer);
+    case STATE: return info.m_state;
+    case CA: return info.m_congState;
+    case ECN: return info.m_ecnState;
+    case CWND: return info.m_cWnd;
+    case SSTHRESH: return info.m_ssThresh;
+    case INFLIGHT: return info.m_bytesInFlight;
+    case SACKED: return info.m_sackedBytes;
+    case LOST: return info.m_lostBytes;
+    case RWND: return info.m_rWnd;
+    case SRTT: return info.m_srtt.GetMicroSeconds ();
+    case RTTVAR: return info.m_rttVar.GetMicroSeconds ();
+    case RTT: return info.m_lastRtt.GetMicroSeconds ();
+    case RTO: return info.m_rto.GetMicroSeconds ();
+    case PACING: return info.m_pacingRate.GetBitRate ();
+    case DELIVERY: return info.m_deliveryRate.GetBitRate ();
+    case DELIVERED: return info.m_bytesDelivered;
+    case RETRANS: return info.m_retransSegments;
+    case CE_RCVD: return info.m_ecnCeRcvd;
+    case CE_ECHOED: return info.m_ecnCeEchoed;
+    default: NS_FATAL_ERROR ("Not a numeric column: " << column);
+    }
+  return 0;
+}
+
+void
+TcpInfoHelper::SampleAllEvery (Time interval, Ptr<OutputStreamWrapper> stream, Time stop,
+                               Format format)
+{
+  SampleEvery (interval, NodeContainer::GetGlobal (), stream, stop, format);
+}
+
+void
+TcpInfoHelper::SampleEvery (Time interval, NodeContainer nodes,
+                            Ptr<OutputStreamWrapper> stream, Time stop, Format format)
+{
+  WriteHeader (stream, format);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Simulator::Schedule (interval, &TcpInfoHelper::SampleNodeEvery, interval, *i, stream,
+                           stop, format);
+    }
+}
+
+void
+TcpInfoHelper::WriteHeader (Ptr<OutputStreamWrapper> stream, Format format)
+{
+  if (format == TEXT)
+    {
+      *stream->GetStream () << "#time\tnode\tlocal\tlport\tpeer\tpport\tstate\tca\tecn"
+                            << "\tcwnd\tssthresh\tinflight\tsacked\tlost\trwnd"
+                            << "\tsrtt_us\trttvar_us\trtt_us\trto_us\tpacing_bps\tdelivery_bps"
+                            << "\tdelivered\tretrans\tce_rcvd\tce_echoed" << std::endl;
+      return;
+    }
+
+  uint32_t size = 4 + 2 + 2;
+  for (uint32_t c = 0; c < N_COLUMNS; ++c)
+    {
+      size += 2 + std::strlen (g_tcpInfoColumns[c].name);
+    }
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  Buffer::Iterator it = buffer.Begin ();
+  it.WriteHtolsbU32 (TCP_INFO_MAGIC);
+  it.WriteHtolsbU16 (TCP_INFO_VERSION);
+  it.WriteHtolsbU16 (N_COLUMNS);
+  for (uint32_t c = 0; c < N_COLUMNS; ++c)
+    {
+      uint8_t length = std::strlen (g_tcpInfoColumns[c].name);
+      it.WriteU8 (g_tcpInfoColumns[c].size);
+      it.WriteU8 (length);
+      it.Write (reinterpret_cast<const uint8_t *> (g_tcpInfoColumns[c].name), length);
+    }
+  buffer.CopyData (stream->GetStream (), size);
+}
+
+void
+TcpInfoHelper::Sample (Ptr<Node> node, Ptr<OutputStreamWrapper> stream, Format format)
+{
+  Ptr<TcpL4Protocol> tcp = node->GetObject<TcpL4Protocol> ();
+  if (tcp == 0)
+    {
+      return;
+    }
+
+  std::vector<TcpInfoRow> rows;
+  TcpInfoRow row;
+  for (uint32_t i = 0; i < tcp->GetNSockets (); ++i)
+    {
+      Ptr<TcpSocketBase> socket = tcp->GetSocket (i);
+      row.info = socket->GetTcpInfo ();
+      if (row.info.m_state == TcpSocket::LISTEN || row.info.m_state == TcpSocket::CLOSED
+          || socket->GetPeerName (row.peer) != 0)
+        {
+          continue;
+        }
+      socket->GetSockName (row.local);
+      rows.push_back (row);
+    }
+
+  if (format == TEXT)
+    {
+      WriteText (node, rows, stream);
+    }
+  else if (rows.size () > 0)
+    {
+      WriteBinary (node, rows, stream);
+    }
+}
+
+void
+TcpInfoHelper::WriteText (Ptr<Node> node, const std::vector<TcpInfoRow> &rows,
+                          Ptr<OutputStreamWrapper> stream)
+{
+  std::ostream *os = stream->GetStream ();
+  double now = Simulator::Now ().GetSeconds ();
+  for (std::vector<TcpInfoRow>::const_iterator r = rows.begin (); r != rows.end (); ++r)
+    {
+      const TcpInfo &info = r->info;
+      *os << now << "\t" << node->GetId () << "\t";
+      WriteSocketAddress (os, r->local);
+      *os << "\t";
+      WriteSocketAddress (os, r->peer);
+      *os << "\t" << info.m_state << "\t" << info.m_congState << "\t" << info.m_ecnState
+          << "\t" << info.m_cWnd << "\t" << info.m_ssThresh << "\t" << info.m_bytesInFlight
+          << "\t" << info.m_sackedBytes << "\t" << info.m_lostBytes << "\t" << info.m_rWnd
+          << "\t" << info.m_srtt.GetMicroSeconds () << "\t" << info.m_rttVar.GetMicroSeconds ()
+          << "\t" << info.m_lastRtt.GetMicroSeconds () << "\t" << info.m_rto.GetMicroSeconds ()
+          << "\t" << info.m_pacingRate.GetBitRate () << "\t" << info.m_deliveryRate.GetBitRate ()
+          << "\t" << info.m_bytesDelivered << "\t" << info.m_retransSegments
+          << "\t" << info.m_ecnCeRcvd << "\t" << info.m_ecnCeEchoed << "\n";
+    }
+}
+
+void
+TcpInfoHelper::WriteBinary (Ptr<Node> node, const std::vector<TcpInfoRow> &rows,
+                            Ptr<OutputStreamWrapper> stream)
+{
+  uint32_t rowSize = 0;
+  for (uint32_t c = 0; c < N_COLUMNS; ++c)
+    {
+      rowSize += g_tcpInfoColumns[c].size;
+    }
+  uint32_t size = 8 + 4 + 4 + rows.size () * rowSize;
+
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  Buffer::Iterator it = buffer.Begin ();
+  it.WriteHtolsbU64 (Simulator::Now ().GetNanoSeconds ());
+  it.WriteHtolsbU32 (node->GetId ());
+  it.WriteHtolsbU32 (rows.size ());
+  for (uint32_t c = 0; c < N_COLUMNS; ++c)
+    {
+      for (std::vector<TcpInfoRow>::const_iterator r = rows.begin (); r != rows.end (); ++r)
+        {
+          if (c == LOCAL || c == PEER)
+            {
+              WriteSocketAddress (it, c == LOCAL ? r->local : r->peer);
+              continue;
+            }
+          uint64_t value = GetColumnValue (*r, c);
+          switch (g_tcpInfoColumns[c].size)
+            {
+            case 1: it.WriteU8 (value); break;
+            case 2: it.WriteHtolsbU16 (value); break;
+            case 4: it.WriteHtolsbU32 (value); break;
+            default: it.WriteHtolsbU64 (value); break;
+            }
+        }
+    }
+  buffer.CopyData (stream->GetStream (), size);
+}
+
+void
+TcpInfoHelper::SampleNodeEvery (Time interval, Ptr<Node> node,
+                                Ptr<OutputStreamWrapper> stream, Time stop, Format format)
+{
+  Sample (node, stream, format);
+  if (Simulator::Now () + interval <= stop)
+    {
+      Simulator::Schedule (interval, &TcpInfoHelper::SampleNodeEvery, interval, node, stream,
+                           stop, format);
+    }
+}
+
+} // namespace ns3
@@ -86,7 +86,8 @@ ArpCache::GetTypeId (void)
 
 ArpCache::ArpCache ()
   : m_device (0), 
-    m_interface (0)
+    m_interface (0),
+    m_inverseCacheValid (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -195,12 +196,13 @@ void
 ArpCache::HandleWaitReplyTimeout (void)
 {
   NS_LOG_FUNCTION (this);
-  ArpCache::Entry* entry;
   bool restartWaitReplyTimer = false;
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++) 
+  // Entries leave the list when marked dead: walk a copy
+  std::list<ArpCache::Entry *> waitReplyEntries = m_waitReplyEntries;
+  for (std::list<ArpCache::Entry *>::iterator i = waitReplyEntries.begin (); i != waitReplyEntries.end (); i++)
     {
-      entry = (*i).second;
-      if (entry != 0 && entry->IsWaitReply ())
+      ArpCache::Entry* entry = *i;
+      if (entry->IsWaitReply ())
         {
           if (entry->GetRetries () < m_maxRetries)
             {
@@ -249,6 +251,9 @@ ArpCache::Flush (void)
       delete (*i).second;
     }
   m_arpCache.erase (m_arpCache.begin (), m_arpCache.end ());
+  m_inverseCache.clear ();
+  m_inverseCacheValid = false;
+  m_waitReplyEntries.clear ();
   if (m_waitReplyTimer.IsRunning ())
     {
       NS_LOG_LOGIC ("Stopping WaitReplyTimer at " << Simulator::Now ().GetSeconds () << " due to ArpCache flush");
@@ -296,21 +301,43 @@ ArpCache::PrintArpCache (Ptr<OutputStreamWrapper> stream)
     }
 }
 
+void
+ArpCache::IndexInverse (void)
+{
+  if (m_inverseCacheValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_inverseCache.clear ();
+  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++)
+    {
+      m_inverseCache[i->second->GetMacAddress ()].push_back (i->second);
+    }
+  m_inverseCacheValid = true;
+}
+
 std::list<ArpCache::Entry *>
 ArpCache::LookupInverse (Address to)
 {
   NS_LOG_FUNCTION (this << to);
 
-  std::list<ArpCache::Entry *> entryList;
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++)
+  // Called for every packet received from a router: look up an index
+  // rather than scan the entries
+  IndexInverse ();
+  InverseCache::const_iterator it = m_inverseCache.find (to);
+  if (it != m_inverseCache.end ())
     {
-      ArpCache::Entry *entry = (*i).second;
-      if (entry->GetMacAddress () == to)
-        {
-          entryList.push_back (entry);
-        }
+      return it->second;
     }
-  return entryList;
+  return std::list<ArpCache::Entry *> ();
+}
+
+void
+ArpCache::RemoveWaitReply (ArpCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  m_waitReplyEntries.remove (entry);
 }
 
 
@@ -334,6 +361,7 @@ ArpCache::Add (Ipv4Address to)
 
   ArpCache::Entry *entry = new ArpCache::Entry (this);
   m_arpCache[to] = entry;
+  m_inverseCacheValid = false;
   entry->SetIpv4Address (to);
   return entry;
 }
@@ -343,15 +371,18 @@ ArpCache::Remove (ArpCache::Entry *entry)
 {
   NS_LOG_FUNCTION (this << entry);
   
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++)
+  CacheI i = m_arpCache.find (entry->GetIpv4Address ());
+  if (i != m_arpCache.end () && (*i).second == entry)
     {
-      if ((*i).second == entry)
+      m_arpCache.erase (i);
+      m_inverseCacheValid = false;
+      if (entry->IsWaitReply ())
         {
-          m_arpCache.erase (i);
-          entry->ClearPendingPacket (); //clear the pending packets for entry's ipaddress
-          delete entry;
-          return;
+          RemoveWaitReply (entry);
         }
+      entry->ClearPendingPacket (); //clear the pending packets for entry's ipaddress
+      delete entry;
+      return;
     }
   NS_LOG_WARN ("Entry not found in this ARP Cache");
 }
@@ -396,6 +427,10 @@ ArpCache::Entry::MarkDead (void)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (m_state == ALIVE || m_state == WAIT_REPLY || m_state == DEAD);
+  if (m_state == WAIT_REPLY)
+    {
+      m_arp->RemoveWaitReply (this);
+    }
   m_state = DEAD;
   ClearRetries ();
   UpdateSeen ();
@@ -405,7 +440,8 @@ ArpCache::Entry::MarkAlive (Address macAddress)
 {
   NS_LOG_FUNCTION (this << macAddress);
   NS_ASSERT (m_state == WAIT_REPLY);
-  m_macAddress = macAddress;
+  m_arp->RemoveWaitReply (this);
+  SetMacAddress (macAddress);
   m_state = ALIVE;
   ClearRetries ();
   UpdateSeen ();
@@ -416,6 +452,10 @@ ArpCache::Entry::MarkPermanent (void)
   NS_LOG_FUNCTION (this << m_macAddress);
   NS_ASSERT (!m_macAddress.IsInvalid ());
 
+  if (m_state == WAIT_REPLY)
+    {
+      m_arp->RemoveWaitReply (this);
+    }
   m_state = PERMANENT;
   ClearRetries ();
   UpdateSeen ();
@@ -445,6 +485,7 @@ ArpCache::Entry::MarkWaitReply (Ipv4PayloadHeaderPair waiting)
   NS_ASSERT_MSG (waiting.first, "Can not add a null packet to the ARP queue");
 
   m_state = WAIT_REPLY;
+  m_arp->m_waitReplyEntries.push_back (this);
   m_pending.push_back (waiting);
   UpdateSeen ();
   m_arp->StartWaitReplyTimer ();
@@ -460,13 +501,17 @@ void
 ArpCache::Entry::SetMacAddresss (Address macAddress)
 {
   NS_LOG_FUNCTION (this);
-  m_macAddress = macAddress;
+  SetMacAddress (macAddress);
 }
 void 
 ArpCache::Entry::SetMacAddress (Address macAddress)
 {
   NS_LOG_FUNCTION (this);
-  m_macAddress = macAddress;
+  if (macAddress != m_macAddress)
+    {
+      m_macAddress = macAddress;
+      m_arp->m_inverseCacheValid = false;
+    }
 }
 Ipv4Address 
 ArpCache::Entry::GetIpv4Address (void) const
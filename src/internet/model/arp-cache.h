@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include "ns3/simulator.h"
 #include "ns3/callback.h"
 #include "ns3/packet.h"
@@ -324,6 +325,10 @@ private:
    * \brief ARP Cache container iterator
    */
   typedef sgi::hash_map<Ipv4Address, ArpCache::Entry *, Ipv4AddressHash>::iterator CacheI;
+  /**
+   * \brief Entries of the ARP Cache, by MAC address
+   */
+  typedef std::map<Address, std::list<ArpCache::Entry *> > InverseCache;
 
   virtual void DoDispose (void);
 
@@ -342,8 +347,22 @@ private:
    * If there are no Arp requests pending, this event is not scheduled.
    */
   void HandleWaitReplyTimeout (void);
+  /**
+   * \brief Index the entries by MAC address, unless they did not change
+   * since the last call
+   */
+  void IndexInverse (void);
+  /**
+   * \brief Forget an entry waiting for a reply
+   * \param entry the entry
+   */
+  void RemoveWaitReply (ArpCache::Entry *entry);
+
   uint32_t m_pendingQueueSize; //!< number of packets waiting for a resolution
   Cache m_arpCache; //!< the ARP cache
+  InverseCache m_inverseCache; //!< the entries, by MAC address
+  bool m_inverseCacheValid; //!< whether m_inverseCache indexes the current entries
+  std::list<ArpCache::Entry *> m_waitReplyEntries; //!< the entries waiting for a reply, oldest first
   TracedCallback<Ptr<const Packet> > m_dropTrace; //!< trace for packets dropped by the ARP cache queue
 };
 
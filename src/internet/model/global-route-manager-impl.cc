@@ -30,6 +30,10 @@
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/core-config.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/system-wall-clock-ms.h"
 #include "ns3/node-list.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -39,11 +43,24 @@
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
 #include "ipv4-global-routing.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \ingroup globalrouting
+ * \brief Number of threads computing the routes of the routers.
+ */
+static GlobalValue g_globalRoutingThreads ("GlobalRoutingThreads",
+                                           "The number of threads running the SPF calculations of "
+                                           "the global routing (only one without threading support)",
+                                           UintegerValue (1),
+                                           MakeUintegerChecker<uint32_t> (1));
+
 /**
  * \brief Stream insertion operator.
  *
@@ -531,6 +548,184 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
   return 0;
 }
 
+GlobalRouteManagerLSDB*
+GlobalRouteManagerLSDB::Copy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  GlobalRouteManagerLSDB* lsdb = new GlobalRouteManagerLSDB ();
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsdb->m_database.insert (LSDBPair_t (i->first, new GlobalRoutingLSA (*i->second)));
+    }
+  for (uint32_t j = 0; j < m_extdatabase.size (); j++)
+    {
+      lsdb->m_extdatabase.push_back (new GlobalRoutingLSA (*m_extdatabase[j]));
+    }
+  return lsdb;
+}
+
+/**
+ * \brief Compare the contents of two LSAs, whatever their SPF status
+ * \param a an LSA
+ * \param b another LSA
+ * \returns true if the LSAs advertise the same links
+ */
+static bool
+SameLSA (const GlobalRoutingLSA* a, const GlobalRoutingLSA* b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+GlobalRouteManagerLSDB::FindChangedLSAs (const GlobalRouteManagerLSDB* lsdb,
+                                         std::set<Ipv4Address>& changed) const
+{
+  NS_LOG_FUNCTION (this << lsdb);
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      GlobalRoutingLSA* other = lsdb->GetLSA (i->first);
+      if (!other || !SameLSA (i->second, other))
+        {
+          changed.insert (i->first);
+        }
+    }
+  for (LSDBMap_t::const_iterator i = lsdb->m_database.begin (); i != lsdb->m_database.end (); i++)
+    {
+      if (!GetLSA (i->first))
+        {
+          changed.insert (i->first);
+        }
+    }
+  uint32_t nExt = std::max (m_extdatabase.size (), lsdb->m_extdatabase.size ());
+  for (uint32_t j = 0; j < nExt; j++)
+    {
+      GlobalRoutingLSA* mine = j < m_extdatabase.size () ? m_extdatabase[j] : 0;
+      GlobalRoutingLSA* other = j < lsdb->m_extdatabase.size () ? lsdb->m_extdatabase[j] : 0;
+      if (mine && other && SameLSA (mine, other))
+        {
+          continue;
+        }
+      if (mine)
+        {
+          changed.insert (mine->GetAdvertisingRouter ());
+        }
+      if (other)
+        {
+          changed.insert (other->GetAdvertisingRouter ());
+        }
+    }
+}
+
+void
+GlobalRouteManagerLSDB::FindReachingLSAs (const std::set<Ipv4Address>& ids,
+                                          std::set<Ipv4Address>& reaching) const
+{
+  NS_LOG_FUNCTION (this);
+//
+// The SPF calculation finds the routers attached to a network by the link
+// data of their transit link records, like GetLSAByLinkData ().
+//
+  std::map<Ipv4Address, Ipv4Address> transitRouters;
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      GlobalRoutingLSA* lsa = i->second;
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              transitRouters.insert (std::make_pair (lr->GetLinkData (), i->first));
+            }
+        }
+    }
+//
+// Reverse the links followed by SPFNext ()
+//
+  std::map<Ipv4Address, std::vector<Ipv4Address> > predecessors;
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      GlobalRoutingLSA* lsa = i->second;
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+              if (lr->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+                  || lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  predecessors[lr->GetLinkId ()].push_back (i->first);
+                }
+            }
+        }
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              std::map<Ipv4Address, Ipv4Address>::const_iterator r =
+                transitRouters.find (lsa->GetAttachedRouter (j));
+              if (r != transitRouters.end ())
+                {
+                  predecessors[r->second].push_back (i->first);
+                }
+            }
+        }
+    }
+
+  std::vector<Ipv4Address> pending;
+  for (std::set<Ipv4Address>::const_iterator i = ids.begin (); i != ids.end (); i++)
+    {
+      if (reaching.insert (*i).second)
+        {
+          pending.push_back (*i);
+        }
+    }
+  while (!pending.empty ())
+    {
+      Ipv4Address id = pending.back ();
+      pending.pop_back ();
+      std::map<Ipv4Address, std::vector<Ipv4Address> >::const_iterator p = predecessors.find (id);
+      if (p == predecessors.end ())
+        {
+          continue;
+        }
+      for (std::vector<Ipv4Address>::const_iterator i = p->second.begin (); i != p->second.end (); i++)
+        {
+          if (reaching.insert (*i).second)
+            {
+              pending.push_back (*i);
+            }
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -565,6 +760,25 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
   m_lsdb = lsdb;
 }
 
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<GlobalRouter> router)
+{
+  NS_LOG_FUNCTION (this << router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from router " << router->GetRouterId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from router " << router->GetRouterId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from router "<< router->GetRouterId ());
+}
+
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
 {
@@ -578,19 +792,7 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
         {
           continue;
         }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteRoutes (router);
     }
   if (m_lsdb)
     {
@@ -613,6 +815,8 @@ void
 GlobalRouteManagerImpl::BuildGlobalRoutingDatabase () 
 {
   NS_LOG_FUNCTION (this);
+  SystemWallClockMs clock;
+  clock.Start ();
 //
 // Walk the list of nodes looking for the GlobalRouter Interface.  Nodes with
 // global router interfaces are, not too surprisingly, our routers.
@@ -657,6 +861,7 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
           m_lsdb->Insert (lsa->GetLinkStateId (), lsa); 
         }
     }
+  NS_LOG_INFO ("Built the link state database in " << clock.End () << " ms");
 }
 
 //
@@ -699,7 +904,7 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
 // Walk the list of nodes in the system.
 //
-  NS_LOG_INFO ("About to start SPF calculation");
+  SPFRoots_t roots;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -724,10 +929,127 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          roots.push_back (std::make_pair (rtr->GetRouterId (), node));
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+  SPFCalculateRoots (roots);
+}
+
+void
+GlobalRouteManagerImpl::RecomputeRoutingTables ()
+{
+  NS_LOG_FUNCTION (this);
+  SystemWallClockMs clock;
+  clock.Start ();
+  GlobalRouteManagerLSDB* previous = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+//
+// The routes of a router only depend on the LSAs it reaches, so the routers
+// reaching none of the LSAs which changed keep their routes.
+//
+  std::set<Ipv4Address> changed;
+  m_lsdb->FindChangedLSAs (previous, changed);
+  std::set<Ipv4Address> affected;
+  previous->FindReachingLSAs (changed, affected);
+  m_lsdb->FindReachingLSAs (changed, affected);
+  delete previous;
+  NS_LOG_INFO (changed.size () << " LSAs changed, affecting " << affected.size () << " vertices");
+
+  SPFRoots_t roots;
+  uint32_t nRouters = 0;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (!rtr)
+        {
+          continue;
+        }
+      nRouters++;
+      if (affected.find (rtr->GetRouterId ()) == affected.end ())
+        {
+          continue;
+        }
+      DeleteRoutes (rtr);
+      // Ignore nodes that are not assigned to our systemId (distributed sim)
+      if (node->GetSystemId () == MpiInterface::GetSystemId () && rtr->GetNumLSAs ())
+        {
+          roots.push_back (std::make_pair (rtr->GetRouterId (), node));
+        }
+    }
+  NS_LOG_INFO ("Recomputing the routes of " << roots.size () << " of " << nRouters << " routers");
+  SPFCalculateRoots (roots);
+  NS_LOG_INFO ("Recomputed the routing tables in " << clock.End () << " ms");
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateRoots (const SPFRoots_t& roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  UintegerValue threadsValue;
+  g_globalRoutingThreads.GetValue (threadsValue);
+  uint32_t nThreads = std::max<uint32_t> (std::min<uint32_t> (threadsValue.Get (), roots.size ()), 1);
+#ifndef HAVE_PTHREAD_H
+  nThreads = 1;
+#endif /* HAVE_PTHREAD_H */
+  SystemWallClockMs clock;
+  clock.Start ();
+  NS_LOG_INFO ("About to start SPF calculation");
+  if (nThreads <= 1)
+    {
+      for (SPFRoots_t::const_iterator i = roots.begin (); i != roots.end (); i++)
+        {
+          SPFCalculate (i->first, i->second);
+        }
+    }
+#ifdef HAVE_PTHREAD_H
+  else
+    {
+//
+// The workers are set up, and torn down, by this thread: copying the LSDB and
+// the roots changes reference counts shared by all of them.  A worker only
+// touches the objects of the nodes of its roots.
+//
+      std::vector<GlobalRouteManagerImpl*> workers;
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          GlobalRouteManagerImpl* worker = new GlobalRouteManagerImpl ();
+          delete worker->m_lsdb;
+          worker->m_lsdb = m_lsdb->Copy ();
+          for (uint32_t r = t; r < roots.size (); r += nThreads)
+            {
+              worker->m_roots.push_back (roots[r]);
+            }
+          workers.push_back (worker);
+        }
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          threads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFCalculateWorker,
+                                                                 workers[t])));
+          threads[t]->Start ();
+        }
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          threads[t]->Join ();
+          delete workers[t];
+        }
+    }
+#endif /* HAVE_PTHREAD_H */
+  NS_LOG_INFO ("Finished SPF calculation of " << roots.size () << " routers with " <<
+               nThreads << " threads in " << clock.End () << " ms");
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateWorker (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (SPFRoots_t::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
+    {
+      SPFCalculate (i->first, i->second);
+    }
 }
 
 //
@@ -1247,7 +1569,7 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
-  SPFCalculate (root);
+  SPFCalculate (root, 0);
 }
 
 //
@@ -1320,7 +1642,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
+                  Ptr<GlobalRouter> router = m_spfrootNode->GetObject<GlobalRouter> ();
                   NS_ASSERT (router);
                   Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
                   NS_ASSERT (gr);
@@ -1339,9 +1661,9 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
 
 // quagga ospf_spf_calculate
 void
-GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
+GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root, Ptr<Node> node)
 {
-  NS_LOG_FUNCTION (this << root);
+  NS_LOG_FUNCTION (this << root << node);
 
   SPFVertex *v;
 //
@@ -1366,6 +1688,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
+  m_spfrootNode = node;
   v->SetDistanceFromRoot (0);
   v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
@@ -1377,10 +1700,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_spfrootNode && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfrootNode = 0;
       return;
     }
 
@@ -1502,6 +1827,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfrootNode = 0;
 }
 
 void
@@ -1560,58 +1886,37 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node of the root vertex is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1626,39 +1931,36 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1729,60 +2031,37 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node of the root vertex is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1797,39 +2076,36 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // which the packets should be send for forwarding.
 //
 
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1846,68 +2122,42 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 //
 // We have an IP address <a> and a vertex ID of the root of the SPF tree.
 // The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
+// The answer is a little complicated since we have to find the Ipv4
+// interface of the node corresponding to the vertex ID in order to iterate
+// the interfaces and find the one corresponding to the address in question.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
+      return -1;
+    }
 //
 // This is the node we're building the routing table for.  We're going to need
 // the Ipv4 interface to look for the ipv4 interface index.  Since this node
 // is participating in routing IP version 4 packets, it certainly must have 
 // an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1944,60 +2194,37 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node of the root vertex is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2233,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Node " << node->GetId () <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,45 +2258,43 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          continue;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                  outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
+    }
 //
 // Done adding the routes for the selected node.
 //
-          return;
-        }
-    }
+  return;
 }
 void
 GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
@@ -2089,95 +2314,70 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node of the root vertex is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
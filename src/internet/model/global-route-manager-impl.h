@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -674,6 +675,44 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+/**
+ * @brief Make a deep copy of the database.
+ *
+ * The SPF computation changes the status of the LSAs, so every thread
+ * computing routes works on its own copy of the database.
+ *
+ * @returns A new database, holding copies of all the LSAs.
+ */
+  GlobalRouteManagerLSDB* Copy (void) const;
+
+/**
+ * @brief Find the LSAs which differ between two databases.
+ *
+ * The Link State IDs of the LSAs present in only one of the databases, or
+ * with different contents, are added to the set.  For the AS external LSAs,
+ * which are processed in order, the advertising routers of the LSAs which
+ * differ at the same position are added.
+ *
+ * @param lsdb the database to compare with
+ * @param changed the set of Link State IDs to fill
+ */
+  void FindChangedLSAs (const GlobalRouteManagerLSDB* lsdb,
+                        std::set<Ipv4Address>& changed) const;
+
+/**
+ * @brief Find the vertices which can reach a set of vertices.
+ *
+ * Walks the point-to-point and transit links of the database backwards, the
+ * way the SPF calculation walks them forward, from the given vertices.  The
+ * routes computed for a router only depend on the LSAs it can reach.
+ *
+ * @param ids the Link State IDs of the vertices to reach
+ * @param reaching the set to which the Link State IDs of the vertices
+ * reaching them, and of the vertices themselves, are added
+ */
+  void FindReachingLSAs (const std::set<Ipv4Address>& ids,
+                         std::set<Ipv4Address>& reaching) const;
+
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -735,6 +774,16 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after a change of the topology
+ *
+ * Builds a new routing database and compares it with the previous one.
+ * Only the routers which can reach an LSA that changed, in the previous or
+ * in the new topology, have their routes deleted and computed again; the
+ * routes of the others would not change.
+ */
+  virtual void RecomputeRoutingTables ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +815,37 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /// container of router IDs and nodes of the roots of SPF calculations
+  typedef std::vector<std::pair<Ipv4Address, Ptr<Node> > > SPFRoots_t;
+
   SPFVertex* m_spfroot; //!< the root node
+  Ptr<Node> m_spfrootNode; //!< the node of the root, whose routing tables are written
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  SPFRoots_t m_roots; //!< the roots of the SPF calculations of a worker thread
+
+  /**
+   * \brief Run the SPF calculation of a set of roots
+   *
+   * The calculations are split among the number of threads set by the
+   * "GlobalRoutingThreads" global value.  Every thread has its own copy of
+   * the LSDB and only writes the routing tables of its roots.
+   *
+   * \param roots the roots of the calculations
+   */
+  void SPFCalculateRoots (const SPFRoots_t& roots);
+
+  /**
+   * \brief Run the SPF calculation of all the roots in m_roots
+   *
+   * Entry point of the worker threads.
+   */
+  void SPFCalculateWorker (void);
+
+  /**
+   * \brief Delete all the routes of a router
+   * \param router the router
+   */
+  void DeleteRoutes (Ptr<GlobalRouter> router);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -786,8 +864,10 @@ private:
    *
    * Equivalent to quagga ospf_spf_calculate
    * \param root the root node
+   * \param node the node of the root, whose routing tables are written (no
+   * routes are added if 0)
    */
-  void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (Ipv4Address root, Ptr<Node> node);
 
   /**
    * \brief Process Stub nodes
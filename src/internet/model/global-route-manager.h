@@ -65,6 +65,12 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables of the routers affected by the changes of the topology
+ */
+  static void RecomputeRoutingTables ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -22,7 +22,7 @@
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
 #include "ns3/log.h"
-
+#include "ns3/hash.h"
 
 namespace ns3 {
 
@@ -45,24 +45,124 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   m_endPoints.clear ();
 }
 
+Ipv4EndPointDemux::FourTuple::FourTuple (Ipv4Address localAddress, uint16_t localPort,
+                                         Ipv4Address peerAddress, uint16_t peerPort)
+  : m_localAddress (localAddress),
+    m_localPort (localPort),
+    m_peerAddress (peerAddress),
+    m_peerPort (peerPort)
+{
+}
+
 bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv4EndPointDemux::FourTuple::operator== (const FourTuple &other) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return m_localAddress == other.m_localAddress && m_localPort == other.m_localPort
+         && m_peerAddress == other.m_peerAddress && m_peerPort == other.m_peerPort;
+}
+
+size_t
+Ipv4EndPointDemux::FourTupleHash::operator() (const FourTuple &tuple) const
+{
+  uint8_t buf[12];
+  tuple.m_localAddress.Serialize (buf);
+  tuple.m_peerAddress.Serialize (buf + 4);
+  buf[8] = tuple.m_localPort >> 8;
+  buf[9] = tuple.m_localPort & 0xff;
+  buf[10] = tuple.m_peerPort >> 8;
+  buf[11] = tuple.m_peerPort & 0xff;
+  return Hash32 (reinterpret_cast<char *> (buf), sizeof (buf));
+}
+
+bool
+Ipv4EndPointDemux::IsListening (Ipv4Address localAddress, Ipv4Address peerAddress, uint16_t peerPort)
+{
+  return localAddress == Ipv4Address::GetAny ()
+         || (peerAddress == Ipv4Address::GetAny () && peerPort == 0);
+}
+
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  uint16_t port = endPoint->GetLocalPort ();
+  m_endPoints.push_back (endPoint);
+  m_connections.insert (std::make_pair (FourTuple (endPoint->GetLocalAddress (), port,
+                                                   endPoint->GetPeerAddress (),
+                                                   endPoint->GetPeerPort ()),
+                                        endPoint));
+  if (IsListening (endPoint->GetLocalAddress (), endPoint->GetPeerAddress (),
+                   endPoint->GetPeerPort ()))
+    {
+      m_listening[port].push_back (endPoint);
+    }
+  m_ports[port]++;
+  endPoint->m_demux = this;
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+}
+
+void
+Ipv4EndPointDemux::RemoveConnection (Ipv4EndPoint *endPoint, const FourTuple &tuple)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  std::pair<Connections::iterator, Connections::iterator> range = m_connections.equal_range (tuple);
+  for (Connections::iterator it = range.first; it != range.second; ++it)
     {
-      if ((*i)->GetLocalPort  () == port) 
+      if (it->second == endPoint)
         {
-          return true;
+          m_connections.erase (it);
+          return;
         }
     }
-  return false;
+  NS_ASSERT_MSG (false, "End point not found in the connection table");
+}
+
+void
+Ipv4EndPointDemux::Rehash (Ipv4EndPoint *endPoint, Ipv4Address localAddress,
+                           Ipv4Address peerAddress, uint16_t peerPort)
+{
+  NS_LOG_FUNCTION (this << endPoint << localAddress << peerAddress << peerPort);
+  uint16_t port = endPoint->GetLocalPort ();
+  RemoveConnection (endPoint, FourTuple (localAddress, port, peerAddress, peerPort));
+  m_connections.insert (std::make_pair (FourTuple (endPoint->GetLocalAddress (), port,
+                                                   endPoint->GetPeerAddress (),
+                                                   endPoint->GetPeerPort ()),
+                                        endPoint));
+
+  // An end point that stays in the listening table keeps its position,
+  // so that the order of the lookup results does not change
+  bool wasListening = IsListening (localAddress, peerAddress, peerPort);
+  bool isListening = IsListening (endPoint->GetLocalAddress (), endPoint->GetPeerAddress (),
+                                  endPoint->GetPeerPort ());
+  if (wasListening && !isListening)
+    {
+      m_listening[port].remove (endPoint);
+      if (m_listening[port].empty ())
+        {
+          m_listening.erase (port);
+        }
+    }
+  else if (!wasListening && isListening)
+    {
+      m_listening[port].push_back (endPoint);
+    }
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       if ((*i)->GetLocalPort () == port &&
@@ -85,8 +185,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -101,8 +200,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -124,8 +222,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -134,24 +231,15 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (m_connections.count (FourTuple (localAddress, localPort, peerAddress, peerPort)) > 0)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -163,6 +251,24 @@ Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
     {
       if (*i == endPoint)
         {
+          uint16_t port = endPoint->GetLocalPort ();
+          RemoveConnection (endPoint, FourTuple (endPoint->GetLocalAddress (), port,
+                                                 endPoint->GetPeerAddress (),
+                                                 endPoint->GetPeerPort ()));
+          std::map<uint16_t, EndPoints>::iterator listening = m_listening.find (port);
+          if (listening != m_listening.end ())
+            {
+              listening->second.remove (endPoint);
+              if (listening->second.empty ())
+                {
+                  m_listening.erase (listening);
+                }
+            }
+          if (--m_ports[port] == 0)
+            {
+              m_ports.erase (port);
+            }
+          endPoint->m_demux = 0;
           delete endPoint;
           m_endPoints.erase (i);
           break;
@@ -192,6 +298,11 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
  * If we have an exact match, we return it.
  * Otherwise, if we find a generic match, we return it.
  * Otherwise, we return 0.
+ *
+ * Unless the packet is a broadcast, the exact matches are found in the
+ * connection table and the generic matches among the end points of the
+ * listening table with the packet local port, which are the only ones
+ * that may match with a wildcard.
  */
 Ipv4EndPointDemux::EndPoints
 Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
@@ -206,7 +317,54 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+    {
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+          daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+        {
+          subnetDirected = true;
+          incomingInterfaceAddr = addr.GetLocal ();
+        }
+    }
+  bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+  NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
+
+  EndPoints *candidates = &m_endPoints;
+  if (!isBroadcast)
+    {
+      std::pair<Connections::iterator, Connections::iterator> range =
+        m_connections.equal_range (FourTuple (daddr, dport, saddr, sport));
+      for (Connections::iterator it = range.first; it != range.second; ++it)
+        {
+          Ipv4EndPoint* endP = it->second;
+          if (!endP->IsRxEnabled ())
+            {
+              continue;
+            }
+          if (endP->GetBoundNetDevice ()
+              && endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+            {
+              continue;
+            }
+          retval4.push_back (endP);
+        }
+      if (!retval4.empty ())
+        {
+          return retval4;
+        }
+
+      std::map<uint16_t, EndPoints>::iterator listening = m_listening.find (dport);
+      if (listening == m_listening.end ())
+        {
+          return retval1;
+        }
+      candidates = &listening->second;
+    }
+
+  for (EndPointsI i = candidates->begin (); i != candidates->end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
 
@@ -241,20 +399,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
               continue;
             }
         }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-        {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
-            {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
-            }
-        }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
-      NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
       bool localAddressMatchesWildCard = 
         endP->GetLocalAddress () == Ipv4Address::GetAny ();
       bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
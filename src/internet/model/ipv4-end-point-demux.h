@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +42,13 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * To keep the cost of a lookup independent of the number of connections,
+ * the endpoints are also indexed in a hash table keyed by their four-tuple,
+ * which gives the exact matches, and the endpoints having a wildcard local
+ * address or a wildcard peer (e.g., the listening sockets) are indexed by
+ * local port. The endpoints notify the demux when their addresses change,
+ * so that the tables are kept up to date.
  */
 
 class Ipv4EndPointDemux {
@@ -163,6 +172,85 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Four-tuple of an end point, key of the connection table.
+   */
+  struct FourTuple
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    FourTuple (Ipv4Address localAddress, uint16_t localPort,
+               Ipv4Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Equality operator.
+     * \param other the four-tuple to compare with
+     * \return true if the four-tuples are equal
+     */
+    bool operator== (const FourTuple &other) const;
+
+    Ipv4Address m_localAddress;  //!< Local address
+    uint16_t m_localPort;        //!< Local port
+    Ipv4Address m_peerAddress;   //!< Peer address
+    uint16_t m_peerPort;         //!< Peer port
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param tuple the four-tuple
+     * \return the hash of the four-tuple
+     */
+    size_t operator() (const FourTuple &tuple) const;
+  };
+
+  /**
+   * \brief Container of the end points indexed by four-tuple.
+   */
+  typedef std::unordered_multimap<FourTuple, Ipv4EndPoint *, FourTupleHash> Connections;
+
+  /**
+   * \brief Add a newly allocated end point to the demux.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Update the tables after the addresses of an end point changed.
+   * \param endPoint the end point
+   * \param localAddress the previous local address
+   * \param peerAddress the previous peer address
+   * \param peerPort the previous peer port
+   */
+  void Rehash (Ipv4EndPoint *endPoint, Ipv4Address localAddress,
+               Ipv4Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Remove an end point from the connection table.
+   * \param endPoint the end point
+   * \param tuple the four-tuple the end point is stored with
+   */
+  void RemoveConnection (Ipv4EndPoint *endPoint, const FourTuple &tuple);
+
+  /**
+   * \brief Check if an end point may match packets of more than one peer.
+   * \param localAddress local address of the end point
+   * \param peerAddress peer address of the end point
+   * \param peerPort peer port of the end point
+   * \return true if the end point belongs to the listening table
+   */
+  static bool IsListening (Ipv4Address localAddress, Ipv4Address peerAddress, uint16_t peerPort);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -189,6 +277,21 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The IPv4 end points indexed by four-tuple.
+   */
+  Connections m_connections;
+
+  /**
+   * \brief The IPv4 end points with a wildcard address or peer, by local port.
+   */
+  std::map<uint16_t, EndPoints> m_listening;
+
+  /**
+   * \brief The number of IPv4 end points using each local port.
+   */
+  std::map<uint16_t, uint32_t> m_ports;
 };
 
 } // namespace ns3
@@ -18,6 +18,8 @@
 
 #include <vector>
 #include <iomanip>
+#include <algorithm>
+#include <cstring>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -27,6 +29,7 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
@@ -37,6 +40,10 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4GlobalRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4GlobalRouting);
 
+static const uint8_t TCP_PROT_NUMBER = 6;  //!< TCP Protocol number
+static const uint8_t UDP_PROT_NUMBER = 17; //!< UDP Protocol number
+static const uint32_t FLOWLET_PURGE_SIZE = 1024; //!< Minimum number of flowlets before removing the idle ones
+
 TypeId 
 Ipv4GlobalRouting::GetTypeId (void)
 { 
@@ -53,13 +60,33 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("FlowEcmpRouting",
+                   "Set to true if packets are routed among ECMP according to a hash of their addresses, protocol and ports, so that the packets of a flow follow the same route; takes precedence over RandomEcmpRouting",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_flowEcmpRouting),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EcmpHashSeed",
+                   "Seed of the flow hash used by FlowEcmpRouting. It is mixed with the node id, so that successive routers split the flows differently",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4GlobalRouting::m_ecmpHashSeed),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("FlowletTimeout",
+                   "With FlowEcmpRouting, idle time after which the next packets of a flow are routed as a new flowlet, on a route picked at random; zero disables flowlets",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&Ipv4GlobalRouting::m_flowletTimeout),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_flowEcmpRouting (false),
+    m_ecmpHashSeed (0),
+    m_nodeId (0),
+    m_flowletPurgeSize (FLOWLET_PURGE_SIZE),
+    m_routesIndexed (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +107,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_routesIndexed = false;
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -90,6 +119,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_routesIndexed = false;
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -105,6 +136,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_routesIndexed = false;
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -118,6 +151,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_routesIndexed = false;
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -133,94 +168,191 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_routesIndexed = false;
+  NotifyRoutesChanged ();
+}
+
+
+void
+Ipv4GlobalRouting::IndexRoutes (void)
+{
+  if (m_routesIndexed)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_hostTrie.Clear ();
+  m_hostIndex.assign (m_hostRoutes.begin (), m_hostRoutes.end ());
+  for (uint32_t i = 0; i < m_hostIndex.size (); i++)
+    {
+      m_hostTrie.Insert (m_hostIndex[i]->GetDest (), Ipv4Mask::GetOnes (), i);
+    }
+  m_networkTrie.Clear ();
+  m_networkIndex.assign (m_networkRoutes.begin (), m_networkRoutes.end ());
+  for (uint32_t i = 0; i < m_networkIndex.size (); i++)
+    {
+      m_networkTrie.Insert (m_networkIndex[i]->GetDestNetwork (), m_networkIndex[i]->GetDestNetworkMask (), i);
+    }
+  m_ASexternalTrie.Clear ();
+  m_ASexternalIndex.assign (m_ASexternalRoutes.begin (), m_ASexternalRoutes.end ());
+  for (uint32_t i = 0; i < m_ASexternalIndex.size (); i++)
+    {
+      m_ASexternalTrie.Insert (m_ASexternalIndex[i]->GetDestNetwork (), m_ASexternalIndex[i]->GetDestNetworkMask (), i);
+    }
+  m_routesIndexed = true;
 }
 
+uint32_t
+Ipv4GlobalRouting::GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p, bool hasTransportHeader)
+{
+  NS_LOG_FUNCTION (this << header << p << hasTransportHeader);
+  uint8_t key[21];
+  header.GetSource ().Serialize (key);
+  header.GetDestination ().Serialize (key + 4);
+  key[8] = header.GetProtocol ();
+  // The ports, if any, are the first 4 bytes of the transport header. All
+  // the fragments of a datagram are hashed without them, to keep them on
+  // the same route.
+  uint32_t size = 9;
+  if (hasTransportHeader && p != 0 && p->GetSize () >= 4
+      && (key[8] == TCP_PROT_NUMBER || key[8] == UDP_PROT_NUMBER)
+      && header.GetFragmentOffset () == 0 && header.IsLastFragment ())
+    {
+      p->CopyData (key + 9, 4);
+      size += 4;
+    }
+  uint32_t seeds[2] = { m_ecmpHashSeed, m_nodeId };
+  memcpy (key + size, seeds, sizeof (seeds));
+  size += sizeof (seeds);
+  m_hasher.clear ();
+  return m_hasher.GetHash32 ((const char *) key, size);
+}
+
+uint32_t
+Ipv4GlobalRouting::GetFlowletPath (uint32_t flowHash)
+{
+  NS_LOG_FUNCTION (this << flowHash);
+  if (m_flowletTimeout.IsZero ())
+    {
+      return flowHash;
+    }
+  Time now = Simulator::Now ();
+  std::map<uint32_t, Flowlet>::iterator it = m_flowlets.find (flowHash);
+  if (it == m_flowlets.end ())
+    {
+      if (m_flowlets.size () >= m_flowletPurgeSize)
+        {
+          // A flow idle for longer than the timeout starts a new flowlet
+          // anyway, its entry can go
+          for (std::map<uint32_t, Flowlet>::iterator i = m_flowlets.begin (); i != m_flowlets.end (); )
+            {
+              if (now - i->second.m_lastSeen > m_flowletTimeout)
+                {
+                  m_flowlets.erase (i++);
+                }
+              else
+                {
+                  ++i;
+                }
+            }
+          m_flowletPurgeSize = std::max (FLOWLET_PURGE_SIZE, (uint32_t) m_flowlets.size () * 2);
+        }
+      Flowlet flowlet = { now, flowHash };
+      it = m_flowlets.insert (std::make_pair (flowHash, flowlet)).first;
+    }
+  else if (now - it->second.m_lastSeen > m_flowletTimeout)
+    {
+      it->second.m_path = m_rand->GetInteger (0, 0xffffffff);
+      NS_LOG_LOGIC ("New flowlet of flow " << flowHash << " on path " << it->second.m_path);
+    }
+  it->second.m_lastSeen = now;
+  return it->second.m_path;
+}
 
 Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif, uint32_t flowHash)
 {
-  NS_LOG_FUNCTION (this << dest << oif);
+  NS_LOG_FUNCTION (this << dest << oif << flowHash);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
   // store all available routes that bring packets to their destination
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
+  IndexRoutes ();
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  m_hostTrie.Lookup (dest, m_matches);
+  for (std::vector<uint32_t>::const_iterator i = m_matches.begin ();
+       i != m_matches.end ();
+       i++)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      Ipv4RoutingTableEntry *route = m_hostIndex[*i];
+      NS_ASSERT (route->IsHost ());
+      if (oif != 0)
         {
-          if (oif != 0)
+          if (oif != m_ipv4->GetNetDevice (route->GetInterface ()))
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
         }
+      allRoutes.push_back (route);
+      NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << route);
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      m_networkTrie.Lookup (dest, m_matches);
+      for (std::vector<uint32_t>::const_iterator j = m_matches.begin ();
+           j != m_matches.end ();
+           j++)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          Ipv4RoutingTableEntry *route = m_networkIndex[*j];
+          if (oif != 0)
             {
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice (route->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
+          allRoutes.push_back (route);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << route);
         }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
+      m_ASexternalTrie.Lookup (dest, m_matches);
+      for (std::vector<uint32_t>::const_iterator k = m_matches.begin ();
+           k != m_matches.end ();
            k++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          Ipv4RoutingTableEntry *route = m_ASexternalIndex[*k];
+          NS_LOG_LOGIC ("Found external route" << route);
+          if (oif != 0)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice (route->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*k);
-              break;
             }
+          allRoutes.push_back (route);
+          break;
         }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
     {
-      // pick up one of the routes uniformly at random if random
+      // pick up one of the routes according to the flow of the packet
+      // if flow ECMP routing is enabled, uniformly at random if random
       // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
+      // consistently if both are disabled
       uint32_t selectIndex;
-      if (m_randomEcmpRouting)
+      if (m_flowEcmpRouting)
+        {
+          selectIndex = allRoutes.size () > 1 ? GetFlowletPath (flowHash) % allRoutes.size () : 0;
+        }
+      else if (m_randomEcmpRouting)
         {
           selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
         }
@@ -321,6 +453,8 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
               delete *i;
               m_hostRoutes.erase (i);
+              m_routesIndexed = false;
+              NotifyRoutesChanged ();
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
               return;
             }
@@ -338,6 +472,8 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
           delete *j;
           m_networkRoutes.erase (j);
+          m_routesIndexed = false;
+          NotifyRoutesChanged ();
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -354,6 +490,8 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
           delete *k;
           m_ASexternalRoutes.erase (k);
+          m_routesIndexed = false;
+          NotifyRoutesChanged ();
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -392,6 +530,12 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_routesIndexed = false;
+  NotifyRoutesChanged ();
+  m_hostIndex.clear ();
+  m_flowlets.clear ();
+  m_networkIndex.clear ();
+  m_ASexternalIndex.clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -468,7 +612,14 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 // See if this is a unicast packet we have a route for.
 //
   NS_LOG_LOGIC ("Unicast destination- looking up");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif);
+  // TCP adds its header before looking up the route, while UDP adds it
+  // after: the ports of UDP datagrams sent by this node are not hashed
+  uint32_t flowHash = 0;
+  if (m_flowEcmpRouting)
+    {
+      flowHash = GetFlowHash (header, p, header.GetProtocol () == TCP_PROT_NUMBER);
+    }
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif, flowHash);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -517,7 +668,12 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, P
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  uint32_t flowHash = 0;
+  if (m_flowEcmpRouting)
+    {
+      flowHash = GetFlowHash (header, p, true);
+    }
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), 0, flowHash);
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
@@ -537,9 +693,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -549,9 +703,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -561,9 +713,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -573,9 +723,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -585,6 +733,11 @@ Ipv4GlobalRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_FUNCTION (this << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  Ptr<Node> node = m_ipv4->GetObject<Node> ();
+  if (node != 0)
+    {
+      m_nodeId = node->GetId ();
+    }
 }
 
 
@@ -21,6 +21,8 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <map>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +30,9 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/nstime.h"
+#include "ns3/hash.h"
+#include "ns3/ipv4-prefix-trie.h"
 
 namespace ns3 {
 
@@ -238,6 +243,27 @@ private:
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
+  /// Set to true if packets are routed among ECMP according to a hash of their flow
+  bool m_flowEcmpRouting;
+  /// Seed of the flow hash, mixed with the node id
+  uint32_t m_ecmpHashSeed;
+  /// Idle time after which the next packet of a flow may take another route, zero to disable flowlets
+  Time m_flowletTimeout;
+  /// Id of the node, mixed in the flow hash
+  uint32_t m_nodeId;
+  /// Hash function of the flows
+  Hasher m_hasher;
+
+  /// Route of a flowlet
+  struct Flowlet
+  {
+    Time m_lastSeen;    //!< Time of the last packet of the flow
+    uint32_t m_path;    //!< Value selecting the route among ECMP
+  };
+  /// Flowlets, by flow hash
+  std::map<uint32_t, Flowlet> m_flowlets;
+  /// Number of flowlets above which the idle ones are removed
+  uint32_t m_flowletPurgeSize;
 
   /// container of Ipv4RoutingTableEntry (routes to hosts)
   typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
@@ -264,14 +290,63 @@ private:
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
    * \param oif output interface if any (put 0 otherwise)
+   * \param flowHash hash of the flow of the packet, used to select a route
+   *        among ECMP if FlowEcmpRouting is enabled
    * \return Ipv4Route to route the packet to reach dest address
    */
-  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0, uint32_t flowHash = 0);
+
+  /**
+   * \brief Hash the flow of a packet
+   *
+   * The hash covers the addresses, the protocol and, for TCP and UDP
+   * packets which are not fragments, the ports, along with the seed of the
+   * hash and the id of the node.
+   *
+   * \param header the IPv4 header of the packet
+   * \param p the payload of the packet, starting with its transport header
+   *        if hasTransportHeader is true (may be 0)
+   * \param hasTransportHeader whether the transport header was already
+   *        added to the payload
+   * \return the hash of the flow
+   */
+  uint32_t GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p, bool hasTransportHeader);
+
+  /**
+   * \brief Select the route of the current flowlet of a flow
+   *
+   * A flow keeps its route as long as its packets are separated by less
+   * than FlowletTimeout; after a longer gap, the next flowlet is sent on a
+   * route picked at random.
+   *
+   * \param flowHash the hash of the flow
+   * \return the value selecting the route among ECMP
+   */
+  uint32_t GetFlowletPath (uint32_t flowHash);
+
+  /**
+   * \brief Index the routes in prefix tries, unless they did not change
+   * since the last call
+   *
+   * The tries map the prefixes to the position of the routes in their list,
+   * so that LookupGlobal keeps the order of the lists (ECMP choice, first
+   * external route).
+   */
+  void IndexRoutes (void);
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  bool m_routesIndexed;                //!< Whether the tries index the current routes
+  Ipv4PrefixTrie m_hostTrie;           //!< Index of the routes to hosts
+  Ipv4PrefixTrie m_networkTrie;        //!< Index of the routes to networks
+  Ipv4PrefixTrie m_ASexternalTrie;     //!< Index of the external routes
+  std::vector<Ipv4RoutingTableEntry *> m_hostIndex;       //!< Routes to hosts, by position
+  std::vector<Ipv4RoutingTableEntry *> m_networkIndex;    //!< Routes to networks, by position
+  std::vector<Ipv4RoutingTableEntry *> m_ASexternalIndex; //!< External routes, by position
+  std::vector<uint32_t> m_matches;     //!< Positions of the routes matched by a lookup
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
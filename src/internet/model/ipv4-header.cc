@@ -22,6 +22,7 @@
 #include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/header.h"
+#include "ns3/ip-checksum.h"
 #include "ipv4-header.h"
 
 namespace ns3 {
@@ -41,6 +42,7 @@ Ipv4Header::Ipv4Header ()
     m_fragmentOffset (0),
     m_checksum (0),
     m_goodChecksum (true),
+    m_checksumValid (false),
     m_headerSize(5*4)
 {
 }
@@ -57,6 +59,7 @@ Ipv4Header::SetPayloadSize (uint16_t size)
 {
   NS_LOG_FUNCTION (this << size);
   m_payloadSize = size;
+  m_checksumValid = false;
 }
 uint16_t
 Ipv4Header::GetPayloadSize (void) const
@@ -76,12 +79,14 @@ Ipv4Header::SetIdentification (uint16_t identification)
 {
   NS_LOG_FUNCTION (this << identification);
   m_identification = identification;
+  m_checksumValid = false;
 }
 
 void 
 Ipv4Header::SetTos (uint8_t tos)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (tos));
+  UpdateChecksum (m_tos << 8, tos << 8);
   m_tos = tos;
 }
 
@@ -89,16 +94,22 @@ void
 Ipv4Header::SetDscp (DscpType dscp)
 {
   NS_LOG_FUNCTION (this << dscp);
-  m_tos &= 0x3; // Clear out the DSCP part, retain 2 bits of ECN
-  m_tos |= (dscp << 2);
+  uint8_t tos = m_tos;
+  tos &= 0x3; // Clear out the DSCP part, retain 2 bits of ECN
+  tos |= (dscp << 2);
+  UpdateChecksum (m_tos << 8, tos << 8);
+  m_tos = tos;
 }
 
 void
 Ipv4Header::SetEcn (EcnType ecn)
 {
   NS_LOG_FUNCTION (this << ecn);
-  m_tos &= 0xFC; // Clear out the ECN part, retain 6 bits of DSCP
-  m_tos |= ecn;
+  uint8_t tos = m_tos;
+  tos &= 0xFC; // Clear out the ECN part, retain 6 bits of DSCP
+  tos |= ecn;
+  UpdateChecksum (m_tos << 8, tos << 8);
+  m_tos = tos;
 }
 
 Ipv4Header::DscpType 
@@ -201,12 +212,14 @@ Ipv4Header::SetMoreFragments (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags |= MORE_FRAGMENTS;
+  m_checksumValid = false;
 }
 void
 Ipv4Header::SetLastFragment (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags &= ~MORE_FRAGMENTS;
+  m_checksumValid = false;
 }
 bool 
 Ipv4Header::IsLastFragment (void) const
@@ -220,12 +233,14 @@ Ipv4Header::SetDontFragment (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags |= DONT_FRAGMENT;
+  m_checksumValid = false;
 }
 void 
 Ipv4Header::SetMayFragment (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags &= ~DONT_FRAGMENT;
+  m_checksumValid = false;
 }
 bool 
 Ipv4Header::IsDontFragment (void) const
@@ -241,6 +256,7 @@ Ipv4Header::SetFragmentOffset (uint16_t offsetBytes)
   // check if the user is trying to set an invalid offset
   NS_ABORT_MSG_IF ((offsetBytes & 0x7), "offsetBytes must be multiple of 8 bytes");
   m_fragmentOffset = offsetBytes;
+  m_checksumValid = false;
 }
 uint16_t 
 Ipv4Header::GetFragmentOffset (void) const
@@ -259,6 +275,7 @@ void
 Ipv4Header::SetTtl (uint8_t ttl)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (ttl));
+  UpdateChecksum (m_ttl, ttl);
   m_ttl = ttl;
 }
 uint8_t 
@@ -279,6 +296,7 @@ Ipv4Header::SetProtocol (uint8_t protocol)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (protocol));
   m_protocol = protocol;
+  m_checksumValid = false;
 }
 
 void 
@@ -286,6 +304,7 @@ Ipv4Header::SetSource (Ipv4Address source)
 {
   NS_LOG_FUNCTION (this << source);
   m_source = source;
+  m_checksumValid = false;
 }
 Ipv4Address
 Ipv4Header::GetSource (void) const
@@ -299,6 +318,7 @@ Ipv4Header::SetDestination (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
   m_destination = dst;
+  m_checksumValid = false;
 }
 Ipv4Address
 Ipv4Header::GetDestination (void) const
@@ -315,6 +335,21 @@ Ipv4Header::IsChecksumOk (void) const
   return m_goodChecksum;
 }
 
+void
+Ipv4Header::UpdateChecksum (uint16_t oldWord, uint16_t newWord)
+{
+  NS_LOG_FUNCTION (this << oldWord << newWord);
+  /* The TOS byte is the high byte of the first 16-bit word of the
+   * header and the TTL byte is the low byte of the fifth one, in the
+   * byte order of Buffer::Iterator::ReadU16.  Only the bits which
+   * change matter, so the other byte of the word is left out.
+   */
+  if (m_checksumValid)
+    {
+      m_checksum = IpChecksumUpdate (m_checksum, oldWord, newWord);
+    }
+}
+
 TypeId 
 Ipv4Header::GetTypeId (void)
 {
@@ -411,8 +446,12 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
 
   if (m_calcChecksum) 
     {
-      i = start;
-      uint16_t checksum = i.CalculateIpChecksum (20);
+      uint16_t checksum = m_checksum;
+      if (!m_checksumValid)
+        {
+          i = start;
+          checksum = i.CalculateIpChecksum (20);
+        }
       NS_LOG_LOGIC ("checksum=" <<checksum);
       i = start;
       i.Next (10);
@@ -469,6 +508,13 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
       NS_LOG_LOGIC ("checksum=" <<checksum);
 
       m_goodChecksum = (checksum == 0);
+      // a router which only rewrites the TOS and TTL bytes can then
+      // update the checksum instead of computing it again (RFC 1624)
+      m_checksumValid = m_goodChecksum && headerSize == 20 && !(flags & (1<<7));
+    }
+  else
+    {
+      m_checksumValid = false;
     }
   return GetSerializedSize ();
 }
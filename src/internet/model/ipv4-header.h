@@ -236,6 +236,13 @@ public:
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
 private:
+  /**
+   * \brief Update the cached checksum, if any, after a 16-bit word of
+   * the header has changed (RFC 1624).
+   * \param oldWord the old value of the word
+   * \param newWord the new value of the word
+   */
+  void UpdateChecksum (uint16_t oldWord, uint16_t newWord);
 
   /// flags related to IP fragmentation
   enum FlagsE {
@@ -256,6 +263,7 @@ private:
   Ipv4Address m_destination; //!< destination address
   uint16_t m_checksum; //!< checksum
   bool m_goodChecksum; //!< true if checksum is correct
+  bool m_checksumValid; //!< true if m_checksum matches the header fields
   uint16_t m_headerSize; //!< IP header size
 };
 
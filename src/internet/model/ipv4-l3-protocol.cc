@@ -41,6 +41,9 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "tcp-l4-protocol.h"
+#include "tcp-header.h"
+#include "tcp-segmentation-offload-tag.h"
 
 namespace ns3 {
 
@@ -81,6 +84,16 @@ Ipv4L3Protocol::GetTypeId (void)
                      "Drop ipv4 packet",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_dropTrace),
                      "ns3::Ipv4L3Protocol::DropTracedCallback")
+    .AddAttribute ("RouteCacheSize",
+                   "The maximum number of flows whose forwarding route is "
+                   "cached, 0 to disable the cache. Only for routing "
+                   "protocols which select the same route for all the "
+                   "packets of a flow and notify the changes of their "
+                   "routes, such as static and global routing without "
+                   "random ECMP or flowlets.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_routeCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("InterfaceList",
                    "The set of Ipv4 interfaces associated to this Ipv4 stack.",
                    ObjectVectorValue (),
@@ -108,8 +121,17 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_routeCacheSize (0),
+    m_routeCacheGeneration (0),
+    m_routeCachePending (false)
 {
   NS_LOG_FUNCTION (this);
+  // Built once rather than for every received packet
+  m_ucb = MakeCallback (&Ipv4L3Protocol::IpForward, this);
+  m_cacheUcb = MakeCallback (&Ipv4L3Protocol::IpForwardAndCache, this);
+  m_mcb = MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this);
+  m_lcb = MakeCallback (&Ipv4L3Protocol::LocalDeliver, this);
+  m_ecb = MakeCallback (&Ipv4L3Protocol::RouteInputError, this);
 }
 
 Ipv4L3Protocol::~Ipv4L3Protocol ()
@@ -271,6 +293,7 @@ Ipv4L3Protocol::SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol)
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv4 (this);
+  FlushRouteCache ();
 }
 
 
@@ -301,6 +324,7 @@ Ipv4L3Protocol::DoDispose (void)
   m_sockets.clear ();
   m_node = 0;
   m_routingProtocol = 0;
+  FlushRouteCache ();
 
   for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
@@ -399,6 +423,7 @@ Ipv4L3Protocol::AddIpv4Interface (Ptr<Ipv4Interface>interface)
   uint32_t index = m_interfaces.size ();
   m_interfaces.push_back (interface);
   m_reverseInterfacesContainer[interface->GetDevice ()] = index;
+  FlushRouteCache ();
   return index;
 }
 
@@ -631,16 +656,98 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
     }
 
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
+  Ipv4Address destination = ipHeader.GetDestination ();
+  m_routeCachePending = m_routeCacheSize > 0 && !destination.IsMulticast () && !destination.IsBroadcast ();
+  if (m_routeCachePending)
+    {
+      if (m_routeCacheGeneration != Ipv4RoutingProtocol::GetRoutesGeneration ())
+        {
+          FlushRouteCache ();
+          m_routeCacheGeneration = Ipv4RoutingProtocol::GetRoutesGeneration ();
+        }
+      m_routeCacheKey.m_interface = interface;
+      m_routeCacheKey.m_source = ipHeader.GetSource ().Get ();
+      m_routeCacheKey.m_destination = destination.Get ();
+      m_routeCacheKey.m_protocol = ipHeader.GetProtocol ();
+      m_routeCacheKey.m_sourcePort = 0;
+      m_routeCacheKey.m_destinationPort = 0;
+      // The ports are the first 4 bytes of TCP and UDP headers, found in
+      // the first fragment only: all the fragments are keyed without them
+      if ((m_routeCacheKey.m_protocol == 6 || m_routeCacheKey.m_protocol == 17)
+          && ipHeader.IsLastFragment () && ipHeader.GetFragmentOffset () == 0
+          && packet->GetSize () >= 4)
+        {
+          uint8_t ports[4];
+          packet->CopyData (ports, 4);
+          m_routeCacheKey.m_sourcePort = (ports[0] << 8) | ports[1];
+          m_routeCacheKey.m_destinationPort = (ports[2] << 8) | ports[3];
+        }
+      RouteCache_t::const_iterator it = m_routeCache.find (m_routeCacheKey);
+      if (it != m_routeCache.end ())
+        {
+          NS_LOG_LOGIC ("Cached route to " << destination);
+          m_routeCachePending = false;
+          IpForward (it->second, packet, ipHeader);
+          return;
+        }
+    }
   if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
-                                      MakeCallback (&Ipv4L3Protocol::IpForward, this),
-                                      MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
-                                      MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
-                                      MakeCallback (&Ipv4L3Protocol::RouteInputError, this)
-                                      ))
+                                      m_routeCachePending ? m_cacheUcb : m_ucb,
+                                      m_mcb, m_lcb, m_ecb))
     {
       NS_LOG_WARN ("No route found for forwarding packet.  Drop.");
       m_dropTrace (ipHeader, packet, DROP_NO_ROUTE, m_node->GetObject<Ipv4> (), interface);
     }
+  m_routeCachePending = false;
+}
+
+bool
+Ipv4L3Protocol::RouteCacheKey::operator == (const RouteCacheKey &other) const
+{
+  return m_interface == other.m_interface
+         && m_source == other.m_source
+         && m_destination == other.m_destination
+         && m_protocol == other.m_protocol
+         && m_sourcePort == other.m_sourcePort
+         && m_destinationPort == other.m_destinationPort;
+}
+
+size_t
+Ipv4L3Protocol::RouteCacheKeyHash::operator () (const RouteCacheKey &key) const
+{
+  size_t hash = key.m_destination;
+  hash = hash * 31 + key.m_source;
+  hash = hash * 31 + ((key.m_sourcePort << 16) | key.m_destinationPort);
+  hash = hash * 31 + ((key.m_interface << 8) | key.m_protocol);
+  return hash;
+}
+
+void
+Ipv4L3Protocol::IpForwardAndCache (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << rtentry << p << header);
+  // Only cache the route of the packet being received, not of a packet
+  // queued by the routing protocol and forwarded later
+  if (m_routeCachePending
+      && header.GetSource ().Get () == m_routeCacheKey.m_source
+      && header.GetDestination ().Get () == m_routeCacheKey.m_destination)
+    {
+      if (m_routeCache.size () >= m_routeCacheSize)
+        {
+          NS_LOG_LOGIC ("Route cache full");
+          m_routeCache.clear ();
+        }
+      m_routeCache[m_routeCacheKey] = rtentry;
+      m_routeCachePending = false;
+    }
+  IpForward (rtentry, p, header);
+}
+
+void
+Ipv4L3Protocol::FlushRouteCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routeCache.clear ();
 }
 
 Ptr<Icmpv4L4Protocol> 
@@ -933,7 +1040,10 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
           if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
-              DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
+              if (!DoSegmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments))
+                {
+                  DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
+                }
               for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
                 {
                   CallTxTrace (it->second, it->first, m_node->GetObject<Ipv4> (), interface);
@@ -960,7 +1070,10 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
           if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
-              DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
+              if (!DoSegmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments))
+                {
+                  DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
+                }
               for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
                 {
                   NS_LOG_LOGIC ("Sending fragment " << *(it->first) );
@@ -1126,6 +1239,7 @@ Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   bool retVal = interface->AddAddress (address);
+  FlushRouteCache ();
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
@@ -1157,6 +1271,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
   Ipv4InterfaceAddress address = interface->RemoveAddress (addressIndex);
   if (address != Ipv4InterfaceAddress ())
     {
+      FlushRouteCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -1180,6 +1295,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, Ipv4Address address)
   Ipv4InterfaceAddress ifAddr = interface->RemoveAddress (address);
   if (ifAddr != Ipv4InterfaceAddress ())
     {
+      FlushRouteCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
@@ -1314,6 +1430,7 @@ Ipv4L3Protocol::SetUp (uint32_t i)
   if (interface->GetDevice ()->GetMtu () >= 68)
     {
       interface->SetUp ();
+      FlushRouteCache ();
 
       if (m_routingProtocol != 0)
         {
@@ -1332,6 +1449,7 @@ Ipv4L3Protocol::SetDown (uint32_t ifaceIndex)
   NS_LOG_FUNCTION (this << ifaceIndex);
   Ptr<Ipv4Interface> interface = GetInterface (ifaceIndex);
   interface->SetDown ();
+  FlushRouteCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -1354,6 +1472,7 @@ Ipv4L3Protocol::SetForwarding (uint32_t i, bool val)
   NS_LOG_FUNCTION (this << i);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   interface->SetForwarding (val);
+  FlushRouteCache ();
 }
 
 Ptr<NetDevice>
@@ -1372,6 +1491,7 @@ Ipv4L3Protocol::SetIpForward (bool forward)
     {
       (*i)->SetForwarding (forward);
     }
+  FlushRouteCache ();
 }
 
 bool 
@@ -1386,6 +1506,7 @@ Ipv4L3Protocol::SetWeakEsModel (bool model)
 {
   NS_LOG_FUNCTION (this << model);
   m_weakEsModel = model;
+  FlushRouteCache ();
 }
 
 bool 
@@ -1405,6 +1526,66 @@ Ipv4L3Protocol::RouteInputError (Ptr<const Packet> p, const Ipv4Header & ipHeade
   // \todo Send an ICMP no route.
 }
 
+bool
+Ipv4L3Protocol::DoSegmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listSegments)
+{
+  NS_LOG_FUNCTION (this << *packet << outIfaceMtu << &listSegments);
+
+  TcpSegmentationOffloadTag tsoTag;
+  if (ipv4Header.GetProtocol () != TcpL4Protocol::PROT_NUMBER
+      || !packet->PeekPacketTag (tsoTag))
+    {
+      return false;
+    }
+
+  Ptr<Packet> p = packet->Copy ();
+  p->RemovePacketTag (tsoTag);
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+
+  uint32_t segmentSize = tsoTag.GetSegmentSize ();
+  if (segmentSize == 0
+      || ipv4Header.GetSerializedSize () + tcpHeader.GetSerializedSize () + segmentSize > outIfaceMtu)
+    {
+      NS_LOG_LOGIC ("Segments do not fit in the MTU, fragmenting instead");
+      return false;
+    }
+
+  // Like Linux GSO, FIN and PSH are only kept on the last segment, and each
+  // segment gets its own IP identification
+  uint16_t identification = ipv4Header.GetIdentification ();
+  uint32_t offset = 0;
+  while (offset < p->GetSize ())
+    {
+      uint32_t size = std::min (segmentSize, p->GetSize () - offset);
+      Ptr<Packet> segment = p->CreateFragment (offset, size);
+
+      TcpHeader segmentTcpHeader = tcpHeader;
+      segmentTcpHeader.SetSequenceNumber (tcpHeader.GetSequenceNumber () + SequenceNumber32 (offset));
+      if (offset + size < p->GetSize ())
+        {
+          segmentTcpHeader.SetFlags (tcpHeader.GetFlags () & ~(TcpHeader::FIN | TcpHeader::PSH));
+        }
+      if (Node::ChecksumEnabled ())
+        {
+          segmentTcpHeader.EnableChecksums ();
+          segmentTcpHeader.InitializeChecksum (ipv4Header.GetSource (), ipv4Header.GetDestination (),
+                                               TcpL4Protocol::PROT_NUMBER);
+        }
+      segment->AddHeader (segmentTcpHeader);
+
+      Ipv4Header segmentIpHeader = ipv4Header;
+      segmentIpHeader.SetIdentification (identification++);
+      segmentIpHeader.SetPayloadSize (segment->GetSize ());
+
+      NS_LOG_LOGIC ("Segment " << segmentTcpHeader.GetSequenceNumber () << " of " << size << " bytes");
+      listSegments.push_back (Ipv4PayloadHeaderPair (segment, segmentIpHeader));
+      offset += size;
+    }
+
+  return true;
+}
+
 void
 Ipv4L3Protocol::DoFragmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments)
 {
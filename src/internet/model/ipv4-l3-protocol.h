@@ -34,6 +34,7 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
+#include "ns3/sgi-hashmap.h"
 
 class Ipv4L3ProtocolTestCase;
 
@@ -349,6 +350,26 @@ private:
                       Ptr<const Packet> p, 
                       const Ipv4Header &header);
 
+  /**
+   * \brief Cache the route of a packet, then forward it.
+   *
+   * Unicast forward callback given to the routing protocol when the route
+   * of the packet may be cached.
+   *
+   * \param rtentry route
+   * \param p packet to forward
+   * \param header IPv4 header to add to the packet
+   */
+  void
+  IpForwardAndCache (Ptr<Ipv4Route> rtentry,
+                     Ptr<const Packet> p,
+                     const Ipv4Header &header);
+
+  /**
+   * \brief Remove all the cached routes.
+   */
+  void FlushRouteCache (void);
+
   /**
    * \brief Deliver a packet.
    * \param p packet delivered
@@ -405,6 +426,23 @@ private:
    */
   void DoFragmentation (Ptr<Packet> packet, const Ipv4Header& ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments);
 
+  /**
+   * \brief Split a TCP super-segment into regular TCP segments
+   *
+   * A packet tagged with TcpSegmentationOffloadTag carries several TCP
+   * segments behind a single TCP header. It is split into segments of the
+   * size held by the tag, each with its own TCP and IPv4 headers, provided
+   * that they fit in the MTU.
+   *
+   * \param packet the packet
+   * \param ipv4Header the IPv4 header
+   * \param outIfaceMtu the MTU of the interface
+   * \param listSegments the list of segments
+   * \returns true if the packet has been segmented, false if it must be
+   * fragmented instead
+   */
+  bool DoSegmentation (Ptr<Packet> packet, const Ipv4Header& ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listSegments);
+
   /**
    * \brief Process a packet fragment
    * \param packet the packet
@@ -490,6 +528,53 @@ private:
 
   Ptr<Ipv4RoutingProtocol> m_routingProtocol; //!< Routing protocol associated with the stack
 
+  /**
+   * \brief Flow of a forwarded packet, key of the route cache
+   */
+  struct RouteCacheKey
+  {
+    uint32_t m_interface;   //!< input interface
+    uint32_t m_source;      //!< source address
+    uint32_t m_destination; //!< destination address
+    uint8_t m_protocol;     //!< transport protocol
+    uint16_t m_sourcePort;  //!< source port (TCP and UDP, 0 otherwise)
+    uint16_t m_destinationPort; //!< destination port (TCP and UDP, 0 otherwise)
+
+    /**
+     * \param other another key
+     * \returns true if the keys are equal
+     */
+    bool operator == (const RouteCacheKey &other) const;
+  };
+
+  /**
+   * \brief Hash of a RouteCacheKey
+   */
+  struct RouteCacheKeyHash
+  {
+    /**
+     * \param key the key
+     * \returns the hash of the key
+     */
+    size_t operator () (const RouteCacheKey &key) const;
+  };
+
+  /**
+   * \brief Container of the cached routes
+   */
+  typedef sgi::hash_map<RouteCacheKey, Ptr<Ipv4Route>, RouteCacheKeyHash> RouteCache_t;
+
+  uint32_t m_routeCacheSize;      //!< Maximum number of cached routes, 0 to disable the cache
+  RouteCache_t m_routeCache;      //!< Routes of the forwarded flows
+  uint64_t m_routeCacheGeneration; //!< Generation of the routes when the cache was filled
+  RouteCacheKey m_routeCacheKey;  //!< Key of the packet being routed
+  bool m_routeCachePending;       //!< Whether the route of the packet being routed may be cached
+  Ipv4RoutingProtocol::UnicastForwardCallback m_ucb;      //!< Forward callback given to the routing protocol
+  Ipv4RoutingProtocol::UnicastForwardCallback m_cacheUcb; //!< Forward callback filling the route cache
+  Ipv4RoutingProtocol::MulticastForwardCallback m_mcb;    //!< Multicast forward callback given to the routing protocol
+  Ipv4RoutingProtocol::LocalDeliverCallback m_lcb;        //!< Local delivery callback given to the routing protocol
+  Ipv4RoutingProtocol::ErrorCallback m_ecb;               //!< Error callback given to the routing protocol
+
   SocketList m_sockets; //!< List of IPv4 raw sockets.
 
   /**
@@ -259,6 +259,7 @@ Ipv4ListRouting::AddRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol, i
     {
       routingProtocol->SetIpv4 (m_ipv4);
     }
+  NotifyRoutesChanged ();
 }
 
 uint32_t 
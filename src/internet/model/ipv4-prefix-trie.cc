@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ipv4-prefix-trie.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4PrefixTrie");
+
+/**
+ * \param length a prefix length
+ * \return the mask of the prefix length
+ */
+static uint32_t
+MaskOf (uint8_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+/**
+ * \param address an address
+ * \param position the position of the bit, 0 being the most significant
+ * \return the bit of the address
+ */
+static uint32_t
+BitAt (uint32_t address, uint8_t position)
+{
+  return (address >> (31 - position)) & 1;
+}
+
+/**
+ * \param a an address
+ * \param b another address
+ * \param max the maximum length
+ * \return the length of the prefix common to both addresses, at most max
+ */
+static uint8_t
+CommonLength (uint32_t a, uint32_t b, uint8_t max)
+{
+  uint32_t diff = a ^ b;
+  uint8_t length = 0;
+  while (length < max && (diff & 0x80000000) == 0)
+    {
+      diff <<= 1;
+      length++;
+    }
+  return length;
+}
+
+Ipv4PrefixTrie::Ipv4PrefixTrie ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4PrefixTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes.clear ();
+  m_sparse.clear ();
+}
+
+int32_t
+Ipv4PrefixTrie::NewNode (uint32_t prefix, uint8_t length)
+{
+  Node node;
+  node.m_prefix = prefix;
+  node.m_length = length;
+  node.m_child[0] = -1;
+  node.m_child[1] = -1;
+  m_nodes.push_back (node);
+  return m_nodes.size () - 1;
+}
+
+void
+Ipv4PrefixTrie::Insert (Ipv4Address network, Ipv4Mask mask, uint32_t value)
+{
+  NS_LOG_FUNCTION (this << network << mask << value);
+  uint32_t hostBits = ~mask.Get ();
+  if ((hostBits & (hostBits + 1)) != 0)
+    {
+      NS_LOG_LOGIC ("Non-contiguous mask " << mask);
+      Sparse sparse = { network, mask, value };
+      m_sparse.push_back (sparse);
+      return;
+    }
+  uint8_t length = mask.GetPrefixLength ();
+  uint32_t prefix = network.Get () & mask.Get ();
+
+  if (m_nodes.empty ())
+    {
+      NewNode (0, 0);
+    }
+  // Nodes are referred to by index: NewNode may move them
+  int32_t n = 0;
+  while (m_nodes[n].m_length != length)
+    {
+      uint32_t bit = BitAt (prefix, m_nodes[n].m_length);
+      int32_t child = m_nodes[n].m_child[bit];
+      if (child < 0)
+        {
+          int32_t leaf = NewNode (prefix, length);
+          m_nodes[n].m_child[bit] = leaf;
+          n = leaf;
+          break;
+        }
+      uint8_t childLength = m_nodes[child].m_length;
+      uint8_t common = CommonLength (m_nodes[child].m_prefix, prefix, std::min (childLength, length));
+      if (common == childLength)
+        {
+          n = child;
+          continue;
+        }
+      // The prefix diverges from the child, or is shorter: insert a node
+      // where they part
+      int32_t split = NewNode (prefix & MaskOf (common), common);
+      m_nodes[split].m_child[BitAt (m_nodes[child].m_prefix, common)] = child;
+      m_nodes[n].m_child[bit] = split;
+      n = split;
+      if (common != length)
+        {
+          int32_t leaf = NewNode (prefix, length);
+          m_nodes[split].m_child[BitAt (prefix, common)] = leaf;
+          n = leaf;
+        }
+      break;
+    }
+  m_nodes[n].m_values.push_back (value);
+}
+
+void
+Ipv4PrefixTrie::Lookup (Ipv4Address dest, std::vector<uint32_t> &values) const
+{
+  NS_LOG_FUNCTION (this << dest);
+  values.clear ();
+  uint32_t address = dest.Get ();
+  int32_t n = m_nodes.empty () ? -1 : 0;
+  while (n >= 0)
+    {
+      const Node &node = m_nodes[n];
+      if ((address & MaskOf (node.m_length)) != node.m_prefix)
+        {
+          break;
+        }
+      values.insert (values.end (), node.m_values.begin (), node.m_values.end ());
+      if (node.m_length == 32)
+        {
+          break;
+        }
+      n = node.m_child[BitAt (address, node.m_length)];
+    }
+  for (std::vector<Sparse>::const_iterator it = m_sparse.begin (); it != m_sparse.end (); ++it)
+    {
+      if (it->m_mask.IsMatch (dest, it->m_network))
+        {
+          values.push_back (it->m_value);
+        }
+    }
+  std::sort (values.begin (), values.end ());
+}
+
+} // namespace ns3
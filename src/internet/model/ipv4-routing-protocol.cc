@@ -21,6 +21,8 @@
 #include "ipv4-routing-protocol.h"
 #include "ns3/log.h"
 
+#include <atomic>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4RoutingProtocol");
@@ -36,4 +38,20 @@ TypeId Ipv4RoutingProtocol::GetTypeId (void)
   return tid;
 }
 
+/// Generation of the routes of all the nodes. The global routing workers
+/// (GlobalRoutingThreads) add routes, and notify, concurrently.
+static std::atomic<uint64_t> g_routesGeneration (0);
+
+void
+Ipv4RoutingProtocol::NotifyRoutesChanged (void)
+{
+  g_routesGeneration++;
+}
+
+uint64_t
+Ipv4RoutingProtocol::GetRoutesGeneration (void)
+{
+  return g_routesGeneration;
+}
+
 } // namespace ns3
@@ -171,6 +171,22 @@ public:
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const = 0;
 
+  /**
+   * \brief Notify that the routes of a routing protocol changed
+   *
+   * Increments the generation of the routes, which invalidates the routes
+   * cached by Ipv4L3Protocol. Routing protocols which keep their routes in
+   * tables call it whenever the tables change. It is thread safe, as the
+   * global routing workers call it concurrently.
+   */
+  static void NotifyRoutesChanged (void);
+
+  /**
+   * \returns the generation of the routes, incremented by every call to
+   * NotifyRoutesChanged on any node
+   */
+  static uint64_t GetRoutesGeneration (void);
+
 };
 
 } // namespace ns3
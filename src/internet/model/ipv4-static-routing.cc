@@ -54,7 +54,8 @@ Ipv4StaticRouting::GetTypeId (void)
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_ipv4 (0),
+    m_routesIndexed (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -73,6 +74,8 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_routesIndexed = false;
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -87,6 +90,8 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_routesIndexed = false;
+  NotifyRoutesChanged ();
 }
 
 void 
@@ -144,6 +149,8 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_routesIndexed = false;
+  NotifyRoutesChanged ();
 }
 
 uint32_t 
@@ -219,6 +226,24 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
+void
+Ipv4StaticRouting::IndexRoutes (void)
+{
+  if (m_routesIndexed)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_networkTrie.Clear ();
+  m_networkIndex.assign (m_networkRoutes.begin (), m_networkRoutes.end ());
+  for (uint32_t i = 0; i < m_networkIndex.size (); i++)
+    {
+      Ipv4RoutingTableEntry *route = m_networkIndex[i].first;
+      m_networkTrie.Insert (route->GetDestNetwork (), route->GetDestNetworkMask (), i);
+    }
+  m_routesIndexed = true;
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
@@ -238,56 +263,55 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
       rtentry->SetSource (m_ipv4->GetAddress (m_ipv4->GetInterfaceForDevice (oif), 0).GetLocal ());
       return rtentry;
     }
-
-
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
+  // Only the matching routes are considered, in the order of the table
+  IndexRoutes ();
+  m_networkTrie.Lookup (dest, m_matches);
+  for (std::vector<uint32_t>::const_iterator i = m_matches.begin (); 
+       i != m_matches.end (); 
        i++) 
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
+      Ipv4RoutingTableEntry *j = m_networkIndex[*i].first;
+      uint32_t metric = m_networkIndex[*i].second;
       Ipv4Mask mask = (j)->GetDestNetworkMask ();
       uint16_t masklen = mask.GetPrefixLength ();
       Ipv4Address entry = (j)->GetDestNetwork ();
       NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      NS_ASSERT (mask.IsMatch (dest, entry));
+      NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
+      if (oif != 0)
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
+          if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
             {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
-          if (metric > shortest_metric)
-            {
-              NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
               continue;
             }
-          shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
-            {
-              break;
-            }
+        }
+      if (masklen < longest_mask) // Not interested if got shorter mask
+        {
+          NS_LOG_LOGIC ("Previous match longer, skipping");
+          continue;
+        }
+      if (masklen > longest_mask) // Reset metric if longer masklen
+        {
+          shortest_metric = 0xffffffff;
+        }
+      longest_mask = masklen;
+      if (metric > shortest_metric)
+        {
+          NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+          continue;
+        }
+      shortest_metric = metric;
+      Ipv4RoutingTableEntry* route = (j);
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+      if (masklen == 32)
+        {
+          break;
         }
     }
   if (rtentry != 0)
@@ -449,6 +473,8 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
         {
           delete j->first;
           m_networkRoutes.erase (j);
+          m_routesIndexed = false;
+          NotifyRoutesChanged ();
           return;
         }
       tmp++;
@@ -581,6 +607,9 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (*i);
     }
+  m_routesIndexed = false;
+  NotifyRoutesChanged ();
+  m_networkIndex.clear ();
   m_ipv4 = 0;
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -615,6 +644,8 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_routesIndexed = false;
+          NotifyRoutesChanged ();
         }
       else
         {
@@ -662,6 +693,8 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_routesIndexed = false;
+          NotifyRoutesChanged ();
         }
       else
         {
@@ -24,6 +24,7 @@
 
 #include <list>
 #include <utility>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -31,6 +32,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-prefix-trie.h"
 
 namespace ns3 {
 
@@ -403,6 +405,16 @@ private:
    */
   Ptr<Ipv4Route> LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Index the network routes in a prefix trie, unless they did not
+   * change since the last call
+   *
+   * The trie maps the prefixes to the position of the routes in
+   * m_networkRoutes, so that LookupStatic breaks the ties as the order of
+   * the list does.
+   */
+  void IndexRoutes (void);
+
   /**
    * \brief Lookup in the multicast forwarding table for destination.
    * \param origin source address
@@ -427,6 +439,11 @@ private:
    * \brief Ipv4 reference.
    */
   Ptr<Ipv4> m_ipv4;
+
+  bool m_routesIndexed;       //!< whether m_networkTrie indexes the current routes
+  Ipv4PrefixTrie m_networkTrie; //!< index of the network routes
+  std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> > m_networkIndex; //!< network routes, by position
+  std::vector<uint32_t> m_matches; //!< positions of the routes matched by a lookup
 };
 
 } // Namespace ns3
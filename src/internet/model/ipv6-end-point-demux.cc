@@ -21,6 +21,7 @@
 #include "ipv6-end-point-demux.h"
 #include "ipv6-end-point.h"
 #include "ns3/log.h"
+#include "ns3/hash.h"
 
 namespace ns3 {
 
@@ -45,22 +46,116 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
   m_endPoints.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv6EndPointDemux::FourTuple::FourTuple (Ipv6Address localAddress, uint16_t localPort,
+                                         Ipv6Address peerAddress, uint16_t peerPort)
+  : m_localAddress (localAddress),
+    m_localPort (localPort),
+    m_peerAddress (peerAddress),
+    m_peerPort (peerPort)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+}
+
+bool Ipv6EndPointDemux::FourTuple::operator== (const FourTuple &other) const
+{
+  return m_localAddress == other.m_localAddress && m_localPort == other.m_localPort
+         && m_peerAddress == other.m_peerAddress && m_peerPort == other.m_peerPort;
+}
+
+size_t Ipv6EndPointDemux::FourTupleHash::operator() (const FourTuple &tuple) const
+{
+  uint8_t buf[36];
+  tuple.m_localAddress.Serialize (buf);
+  tuple.m_peerAddress.Serialize (buf + 16);
+  buf[32] = tuple.m_localPort >> 8;
+  buf[33] = tuple.m_localPort & 0xff;
+  buf[34] = tuple.m_peerPort >> 8;
+  buf[35] = tuple.m_peerPort & 0xff;
+  return Hash32 (reinterpret_cast<char *> (buf), sizeof (buf));
+}
+
+bool Ipv6EndPointDemux::IsListening (Ipv6Address localAddress, Ipv6Address peerAddress, uint16_t peerPort)
+{
+  return localAddress == Ipv6Address::GetAny ()
+         || (peerAddress == Ipv6Address::GetAny () && peerPort == 0);
+}
+
+void Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  uint16_t port = endPoint->GetLocalPort ();
+  m_endPoints.push_back (endPoint);
+  m_connections.insert (std::make_pair (FourTuple (endPoint->GetLocalAddress (), port,
+                                                   endPoint->GetPeerAddress (),
+                                                   endPoint->GetPeerPort ()),
+                                        endPoint));
+  if (IsListening (endPoint->GetLocalAddress (), endPoint->GetPeerAddress (),
+                   endPoint->GetPeerPort ()))
     {
-      if ((*i)->GetLocalPort  () == port)
+      m_listening[port].push_back (endPoint);
+    }
+  m_ports[port]++;
+  endPoint->m_demux = this;
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+}
+
+void Ipv6EndPointDemux::RemoveConnection (Ipv6EndPoint *endPoint, const FourTuple &tuple)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  std::pair<Connections::iterator, Connections::iterator> range = m_connections.equal_range (tuple);
+  for (Connections::iterator it = range.first; it != range.second; ++it)
+    {
+      if (it->second == endPoint)
         {
-          return true;
+          m_connections.erase (it);
+          return;
         }
     }
-  return false;
+  NS_ASSERT_MSG (false, "End point not found in the connection table");
+}
+
+void Ipv6EndPointDemux::Rehash (Ipv6EndPoint *endPoint, Ipv6Address localAddress,
+                                Ipv6Address peerAddress, uint16_t peerPort)
+{
+  NS_LOG_FUNCTION (this << endPoint << localAddress << peerAddress << peerPort);
+  uint16_t port = endPoint->GetLocalPort ();
+  RemoveConnection (endPoint, FourTuple (localAddress, port, peerAddress, peerPort));
+  m_connections.insert (std::make_pair (FourTuple (endPoint->GetLocalAddress (), port,
+                                                   endPoint->GetPeerAddress (),
+                                                   endPoint->GetPeerPort ()),
+                                        endPoint));
+
+  /* An end point that stays in the listening table keeps its position,
+     so that the order of the lookup results does not change */
+  bool wasListening = IsListening (localAddress, peerAddress, peerPort);
+  bool isListening = IsListening (endPoint->GetLocalAddress (), endPoint->GetPeerAddress (),
+                                  endPoint->GetPeerPort ());
+  if (wasListening && !isListening)
+    {
+      m_listening[port].remove (endPoint);
+      if (m_listening[port].empty ())
+        {
+          m_listening.erase (port);
+        }
+    }
+  else if (!wasListening && isListening)
+    {
+      m_listening[port].push_back (endPoint);
+    }
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       if ((*i)->GetLocalPort () == port
@@ -82,8 +177,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -97,8 +191,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -118,8 +211,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -127,24 +219,15 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (m_connections.count (FourTuple (localAddress, localPort, peerAddress, peerPort)) > 0)
     {
-      if ((*i)->GetLocalPort () == localPort
-          && (*i)->GetLocalAddress () == localAddress
-          && (*i)->GetPeerPort () == peerPort
-          && (*i)->GetPeerAddress () == peerAddress)
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -155,6 +238,24 @@ void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
     {
       if (*i == endPoint)
         {
+          uint16_t port = endPoint->GetLocalPort ();
+          RemoveConnection (endPoint, FourTuple (endPoint->GetLocalAddress (), port,
+                                                 endPoint->GetPeerAddress (),
+                                                 endPoint->GetPeerPort ()));
+          std::map<uint16_t, EndPoints>::iterator listening = m_listening.find (port);
+          if (listening != m_listening.end ())
+            {
+              listening->second.remove (endPoint);
+              if (listening->second.empty ())
+                {
+                  m_listening.erase (listening);
+                }
+            }
+          if (--m_ports[port] == 0)
+            {
+              m_ports.erase (port);
+            }
+          endPoint->m_demux = 0;
           delete endPoint;
           m_endPoints.erase (i);
           break;
@@ -166,6 +267,10 @@ void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
  * If we have an exact match, we return it.
  * Otherwise, if we find a generic match, we return it.
  * Otherwise, we return 0.
+ *
+ * The exact matches are found in the connection table, and the generic
+ * matches among the end points of the listening table with the packet
+ * local port, which are the only ones that may match with a wildcard.
  */
 Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint16_t dport,
                                                         Ipv6Address saddr, uint16_t sport,
@@ -179,7 +284,34 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::pair<Connections::iterator, Connections::iterator> range =
+    m_connections.equal_range (FourTuple (daddr, dport, saddr, sport));
+  for (Connections::iterator it = range.first; it != range.second; ++it)
+    {
+      Ipv6EndPoint* endP = it->second;
+      if (!endP->IsRxEnabled ())
+        {
+          continue;
+        }
+      if (endP->GetBoundNetDevice ()
+          && (!incomingInterface || endP->GetBoundNetDevice () != incomingInterface->GetDevice ()))
+        {
+          continue;
+        }
+      retval4.push_back (endP);
+    }
+  if (!retval4.empty ())
+    {
+      return retval4;
+    }
+
+  std::map<uint16_t, EndPoints>::iterator listening = m_listening.find (dport);
+  if (listening == m_listening.end ())
+    {
+      return retval1;
+    }
+
+  for (EndPointsI i = listening->second.begin (); i != listening->second.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
 
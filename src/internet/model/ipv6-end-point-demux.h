@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +36,10 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * As in ns3::Ipv4EndPointDemux, the end points are indexed by four-tuple
+ * for the exact matches, and by local port when their local address or
+ * their peer is a wildcard.
  */
 class Ipv6EndPointDemux
 {
@@ -147,6 +153,86 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Four-tuple of an end point, key of the connection table.
+   */
+  struct FourTuple
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    FourTuple (Ipv6Address localAddress, uint16_t localPort,
+               Ipv6Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Equality operator.
+     * \param other the four-tuple to compare with
+     * \return true if the four-tuples are equal
+     */
+    bool operator== (const FourTuple &other) const;
+
+    Ipv6Address m_localAddress;  //!< Local address
+    uint16_t m_localPort;        //!< Local port
+    Ipv6Address m_peerAddress;   //!< Peer address
+    uint16_t m_peerPort;         //!< Peer port
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param tuple the four-tuple
+     * \return the hash of the four-tuple
+     */
+    size_t operator() (const FourTuple &tuple) const;
+  };
+
+  /**
+   * \brief Container of the end points indexed by four-tuple.
+   */
+  typedef std::unordered_multimap<FourTuple, Ipv6EndPoint *, FourTupleHash> Connections;
+
+  /**
+   * \brief Add a newly allocated end point to the demux.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Update the tables after the addresses of an end point changed.
+   * \param endPoint the end point
+   * \param localAddress the previous local address
+   * \param peerAddress the previous peer address
+   * \param peerPort the previous peer port
+   */
+  void Rehash (Ipv6EndPoint *endPoint, Ipv6Address localAddress,
+               Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Remove an end point from the connection table.
+   * \param endPoint the end point
+   * \param tuple the four-tuple the end point is stored with
+   */
+  void RemoveConnection (Ipv6EndPoint *endPoint, const FourTuple &tuple);
+
+  /**
+   * \brief Check if an end point may match packets of more than one peer.
+   * \param localAddress local address of the end point
+   * \param peerAddress peer address of the end point
+   * \param peerPort peer port of the end point
+   * \return true if the end point belongs to the listening table
+   */
+  static bool IsListening (Ipv6Address localAddress, Ipv6Address peerAddress, uint16_t peerPort);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -172,6 +258,21 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The IPv6 end points indexed by four-tuple.
+   */
+  Connections m_connections;
+
+  /**
+   * \brief The IPv6 end points with a wildcard address or peer, by local port.
+   */
+  std::map<uint16_t, EndPoints> m_listening;
+
+  /**
+   * \brief The number of IPv6 end points using each local port.
+   */
+  std::map<uint16_t, uint32_t> m_ports;
 };
 
 } /* namespace ns3 */
@@ -23,6 +23,7 @@
 #include "ns3/simulator.h"
 
 #include "ipv6-end-point.h"
+#include "ipv6-end-point-demux.h"
 
 namespace ns3
 {
@@ -30,7 +31,8 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE ("Ipv6EndPoint");
 
 Ipv6EndPoint::Ipv6EndPoint (Ipv6Address addr, uint16_t port)
-  : m_localAddr (addr),
+  : m_demux (0),
+    m_localAddr (addr),
     m_localPort (port),
     m_peerAddr (Ipv6Address::GetAny ()),
     m_peerPort (0),
@@ -56,7 +58,12 @@ Ipv6Address Ipv6EndPoint::GetLocalAddress ()
 
 void Ipv6EndPoint::SetLocalAddress (Ipv6Address addr)
 {
+  Ipv6Address previous = m_localAddr;
   m_localAddr = addr;
+  if (m_demux != 0)
+    {
+      m_demux->Rehash (this, previous, m_peerAddr, m_peerPort);
+    }
 }
 
 uint16_t Ipv6EndPoint::GetLocalPort ()
@@ -92,8 +99,14 @@ Ptr<NetDevice> Ipv6EndPoint::GetBoundNetDevice (void)
 
 void Ipv6EndPoint::SetPeer (Ipv6Address addr, uint16_t port)
 {
+  Ipv6Address previousAddr = m_peerAddr;
+  uint16_t previousPort = m_peerPort;
   m_peerAddr = addr;
   m_peerPort = port;
+  if (m_demux != 0)
+    {
+      m_demux->Rehash (this, m_localAddr, previousAddr, previousPort);
+    }
 }
 
 void Ipv6EndPoint::SetRxCallback (Callback<void, Ptr<Packet>, Ipv6Header, uint16_t, Ptr<Ipv6Interface> > callback)
@@ -34,6 +34,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv6EndPointDemux;
 
 /**
  * \ingroup ipv6
@@ -192,6 +193,13 @@ public:
   bool IsRxEnabled (void);
 
 private:
+  friend class Ipv6EndPointDemux;
+
+  /**
+   * \brief The demux this end point belongs to (if any).
+   */
+  Ipv6EndPointDemux *m_demux;
+
   /**
    * \brief The local address.
    */
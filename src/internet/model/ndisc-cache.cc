@@ -50,6 +50,7 @@ TypeId NdiscCache::GetTypeId ()
 } 
 
 NdiscCache::NdiscCache ()
+  : m_inverseCacheValid (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -94,28 +95,42 @@ NdiscCache::Entry* NdiscCache::Lookup (Ipv6Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
 
-  if (m_ndCache.find (dst) != m_ndCache.end ())
+  CacheI it = m_ndCache.find (dst);
+  if (it != m_ndCache.end ())
     {
-      NdiscCache::Entry* entry = m_ndCache[dst];
-      return entry;
+      return it->second;
     }
   return 0;
 }
 
+void NdiscCache::IndexInverse ()
+{
+  if (m_inverseCacheValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION_NOARGS ();
+  m_inverseCache.clear ();
+  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+    {
+      m_inverseCache[i->second->GetMacAddress ()].push_back (i->second);
+    }
+  m_inverseCacheValid = true;
+}
+
 std::list<NdiscCache::Entry*> NdiscCache::LookupInverse (Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
 
-  std::list<NdiscCache::Entry *> entryList;
-  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+  /* called for every packet received from a router: look up an index
+   * rather than scan the entries */
+  IndexInverse ();
+  InverseCache::const_iterator it = m_inverseCache.find (dst);
+  if (it != m_inverseCache.end ())
     {
-      NdiscCache::Entry *entry = (*i).second;
-      if (entry->GetMacAddress () == dst)
-        {
-          entryList.push_back (entry);
-        }
+      return it->second;
     }
-  return entryList;
+  return std::list<NdiscCache::Entry *> ();
 }
 
 
@@ -127,6 +142,7 @@ NdiscCache::Entry* NdiscCache::Add (Ipv6Address to)
   NdiscCache::Entry* entry = new NdiscCache::Entry (this);
   entry->SetIpv6Address (to);
   m_ndCache[to] = entry;
+  m_inverseCacheValid = false;
   return entry;
 }
 
@@ -134,15 +150,13 @@ void NdiscCache::Remove (NdiscCache::Entry* entry)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+  CacheI i = m_ndCache.find (entry->GetIpv6Address ());
+  if (i != m_ndCache.end () && (*i).second == entry)
     {
-      if ((*i).second == entry)
-        {
-          m_ndCache.erase (i);
-          entry->ClearWaitingPacket ();
-          delete entry;
-          return;
-        }
+      m_ndCache.erase (i);
+      m_inverseCacheValid = false;
+      entry->ClearWaitingPacket ();
+      delete entry;
     }
 }
 
@@ -156,6 +170,8 @@ void NdiscCache::Flush ()
     }
 
   m_ndCache.erase (m_ndCache.begin (), m_ndCache.end ());
+  m_inverseCache.clear ();
+  m_inverseCacheValid = false;
 }
 
 void NdiscCache::SetUnresQlen (uint32_t unresQlen)
@@ -267,6 +283,13 @@ void NdiscCache::Entry::ClearWaitingPacket ()
 void NdiscCache::Entry::FunctionReachableTimeout ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  Time expiry = m_lastReachabilityConfirmation + m_ndCache->m_icmpv6->GetReachableTime ();
+  if (expiry > Simulator::Now ())
+    {
+      /* confirmed since the timer started */
+      m_nudTimer.Schedule (expiry - Simulator::Now ());
+      return;
+    }
   this->MarkStale ();
 }
 
@@ -405,6 +428,12 @@ void NdiscCache::Entry::SetIpv6Address (Ipv6Address ipv6Address)
   m_ipv6Address = ipv6Address;
 }
 
+Ipv6Address NdiscCache::Entry::GetIpv6Address (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_ipv6Address;
+}
+
 Time NdiscCache::Entry::GetLastReachabilityConfirmation () const
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -432,11 +461,10 @@ void NdiscCache::Entry::UpdateReachableTimer ()
   if (m_state == REACHABLE)
     {
       m_lastReachabilityConfirmation = Simulator::Now ();
-      if (m_nudTimer.IsRunning ())
+      if (!m_nudTimer.IsRunning ())
         {
-          m_nudTimer.Cancel ();
+          m_nudTimer.Schedule ();
         }
-      m_nudTimer.Schedule ();
     }
 }
 
@@ -501,7 +529,7 @@ std::list<NdiscCache::Ipv6PayloadHeaderPair> NdiscCache::Entry::MarkReachable (A
 {
   NS_LOG_FUNCTION (this << mac);
   m_state = REACHABLE;
-  m_macAddress = mac;
+  SetMacAddress (mac);
   return m_waiting;
 }
 
@@ -527,7 +555,7 @@ std::list<NdiscCache::Ipv6PayloadHeaderPair> NdiscCache::Entry::MarkStale (Addre
 {
   NS_LOG_FUNCTION (this << mac);
   m_state = STALE;
-  m_macAddress = mac;
+  SetMacAddress (mac);
   return m_waiting;
 }
 
@@ -589,7 +617,11 @@ Address NdiscCache::Entry::GetMacAddress () const
 void NdiscCache::Entry::SetMacAddress (Address mac)
 {
   NS_LOG_FUNCTION (this << mac << int(m_state));
-  m_macAddress = mac;
+  if (mac != m_macAddress)
+    {
+      m_macAddress = mac;
+      m_ndCache->m_inverseCacheValid = false;
+    }
 }
 
 } /* namespace ns3 */
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
@@ -291,6 +292,10 @@ public:
 
     /**
      * \brief Update the reachable timer.
+     *
+     * Called for every packet received from the neighbor: only the time of
+     * the confirmation is recorded, the running timer is pushed back when
+     * it expires.
      */
     void UpdateReachableTimer ();
 
@@ -342,6 +347,12 @@ public:
      */
     void SetIpv6Address (Ipv6Address ipv6Address);
 
+    /**
+     * \brief Get the IPv6 address.
+     * \return the IPv6 address
+     */
+    Ipv6Address GetIpv6Address (void) const;
+
 private:
     /**
      * \brief The IPv6 address.
@@ -412,6 +423,11 @@ private:
    */
   typedef sgi::hash_map<Ipv6Address, NdiscCache::Entry *, Ipv6AddressHash>::iterator CacheI;
 
+  /**
+   * \brief Neighbor Discovery Cache entries, by MAC address
+   */
+  typedef std::map<Address, std::list<NdiscCache::Entry *> > InverseCache;
+
   /**
    * \brief Copy constructor.
    *
@@ -456,6 +472,22 @@ private:
    * \brief Max number of packet stored in m_waiting.
    */
   uint32_t m_unresQlen;
+
+  /**
+   * \brief Index the entries by MAC address, unless they did not change
+   * since the last call.
+   */
+  void IndexInverse ();
+
+  /**
+   * \brief The entries, by MAC address.
+   */
+  InverseCache m_inverseCache;
+
+  /**
+   * \brief Whether m_inverseCache indexes the current entries.
+   */
+  bool m_inverseCacheValid;
 };
 
 } /* namespace ns3 */
@@ -0,0 +1,657 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-bbr.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/tcp-socket-base.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpBbr");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpBbr);
+
+/// Pacing gains of the phases of PROBE_BW
+static const double g_pacingGainCycle[] = { 5.0 / 4, 3.0 / 4, 1, 1, 1, 1, 1, 1 };
+/// Number of phases of PROBE_BW
+static const uint32_t g_cycleLength = sizeof (g_pacingGainCycle) / sizeof (g_pacingGainCycle[0]);
+/// Growth of the bandwidth, over a round, which is considered significant in startup
+static const double g_fullBwThresh = 5.0 / 4;
+/// Rounds without a significant growth after which startup is over
+static const uint32_t g_fullBwCount = 3;
+/// Minimum cWnd, and cWnd in PROBE_RTT, in segments
+static const uint32_t g_minCwndSegments = 4;
+/// The pacing rate is set slightly below the bandwidth, to keep the queue small
+static const double g_pacingMargin = 0.99;
+
+const char* const
+TcpBbr::BbrModeName[TcpBbr::BBR_PROBE_RTT + 1] =
+{
+  "STARTUP", "DRAIN", "PROBE_BW", "PROBE_RTT"
+};
+
+TypeId
+TcpBbr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpBbr")
+    .SetParent<TcpCongestionOps> ()
+    .AddConstructor<TcpBbr> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("HighGain",
+                   "Pacing and cwnd gain in startup (2/ln(2) doubles the rate every round)",
+                   DoubleValue (2.885),
+                   MakeDoubleAccessor (&TcpBbr::m_highGain),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("CwndGain",
+                   "Cwnd gain in PROBE_BW, as a multiple of the bandwidth-delay product",
+                   DoubleValue (2.0),
+                   MakeDoubleAccessor (&TcpBbr::m_cwndGain),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("BwWindowLength",
+                   "Length of the bandwidth filter, in round trips",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&TcpBbr::m_bwWindowLength),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RttWindowLength",
+                   "Validity of the minimum RTT, after which it is probed again",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&TcpBbr::m_rttWindowLength),
+                   MakeTimeChecker ())
+    .AddAttribute ("ProbeRttDuration",
+                   "Minimum time spent in PROBE_RTT",
+                   TimeValue (MilliSeconds (200)),
+                   MakeTimeAccessor (&TcpBbr::m_probeRttDuration),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+TcpBbr::TcpBbr ()
+  : TcpCongestionOps (),
+    m_highGain (2.885),
+    m_cwndGain (2.0),
+    m_bwWindowLength (10),
+    m_rttWindowLength (Seconds (10)),
+    m_probeRttDuration (MilliSeconds (200)),
+    m_maxBwFilter (10, DataRate (0), 0),
+    m_minRtt (Time::Max ()),
+    m_minRttStamp (Seconds (0)),
+    m_roundCount (0),
+    m_nextRttDelivered (0),
+    m_roundStart (false),
+    m_mode (BBR_STARTUP),
+    m_pacingGain (2.885),
+    m_currentCwndGain (2.885),
+    m_fullBw (0),
+    m_fullBwCount (0),
+    m_fullBwReached (false),
+    m_cycleIndex (0),
+    m_cycleStamp (Seconds (0)),
+    m_probeRttDoneStamp (Seconds (0)),
+    m_probeRttRoundDone (false),
+    m_idleRestart (false),
+    m_packetConservation (false),
+    m_priorCwnd (0),
+    m_prevCongState (TcpSocketState::CA_OPEN),
+    m_hasSeenRtt (false),
+    m_initialized (false),
+    m_tsb (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+TcpBbr::TcpBbr (const TcpBbr& sock)
+  : TcpCongestionOps (sock),
+    m_highGain (sock.m_highGain),
+    m_cwndGain (sock.m_cwndGain),
+    m_bwWindowLength (sock.m_bwWindowLength),
+    m_rttWindowLength (sock.m_rttWindowLength),
+    m_probeRttDuration (sock.m_probeRttDuration),
+    m_maxBwFilter (sock.m_bwWindowLength, DataRate (0), 0),
+    m_minRtt (Time::Max ()),
+    m_minRttStamp (Seconds (0)),
+    m_roundCount (0),
+    m_nextRttDelivered (0),
+    m_roundStart (false),
+    m_mode (BBR_STARTUP),
+    m_pacingGain (sock.m_highGain),
+    m_currentCwndGain (sock.m_highGain),
+    m_fullBw (0),
+    m_fullBwCount (0),
+    m_fullBwReached (false),
+    m_cycleIndex (0),
+    m_cycleStamp (Seconds (0)),
+    m_probeRttDoneStamp (Seconds (0)),
+    m_probeRttRoundDone (false),
+    m_idleRestart (false),
+    m_packetConservation (false),
+    m_priorCwnd (0),
+    m_prevCongState (TcpSocketState::CA_OPEN),
+    m_hasSeenRtt (false),
+    m_initialized (false),
+    m_tsb (sock.m_tsb)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+  m_uv->SetStream (sock.m_uv->GetStream ());
+}
+
+TcpBbr::~TcpBbr (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+TcpBbr::GetName () const
+{
+  return "TcpBbr";
+}
+
+Ptr<TcpCongestionOps>
+TcpBbr::Fork (void)
+{
+  return CopyObject<TcpBbr> (this);
+}
+
+int64_t
+TcpBbr::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uv->SetStream (stream);
+  return 1;
+}
+
+TcpBbr::BbrMode_t
+TcpBbr::GetMode (void) const
+{
+  return m_mode;
+}
+
+DataRate
+TcpBbr::GetBandwidth (void) const
+{
+  return m_maxBwFilter.GetBest ();
+}
+
+Time
+TcpBbr::GetMinRtt (void) const
+{
+  return m_minRtt;
+}
+
+bool
+TcpBbr::IsFullBwReached (void) const
+{
+  return m_fullBwReached;
+}
+
+void
+TcpBbr::SetSocketBase (Ptr<TcpSocketBase> tsb)
+{
+  NS_LOG_FUNCTION (this << tsb);
+  m_tsb = tsb;
+  // The model is enforced by the pacing rate: cWnd is only a safety cap
+  tsb->SetPacingStatus (true);
+}
+
+bool
+TcpBbr::SetsPacingRate (void) const
+{
+  return true;
+}
+
+bool
+TcpBbr::HasCongControl (void) const
+{
+  return true;
+}
+
+void
+TcpBbr::Init (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+  m_maxBwFilter.SetWindowLength (m_bwWindowLength);
+  m_minRttStamp = Simulator::Now ();
+  m_cycleStamp = Simulator::Now ();
+  ResetStartupMode ();
+
+  // As Linux, assume an RTT of 1 ms until the first sample
+  DataRate bw (static_cast<uint64_t> (tcb->m_cWnd * 8.0 / MilliSeconds (1).GetSeconds ()));
+  tcb->m_pacingRate = std::min (DataRate (static_cast<uint64_t> (bw.GetBitRate () * m_highGain)),
+                                tcb->m_maxPacingRate);
+  m_initialized = true;
+}
+
+void
+TcpBbr::SetMode (BbrMode_t mode)
+{
+  if (mode != m_mode)
+    {
+      NS_LOG_DEBUG (BbrModeName[m_mode] << " -> " << BbrModeName[mode]);
+      m_mode = mode;
+    }
+}
+
+uint32_t
+TcpBbr::Inflight (Ptr<const TcpSocketState> tcb, DataRate bw, double gain) const
+{
+  if (m_minRtt == Time::Max ())
+    {
+      return tcb->m_initialCWnd * tcb->m_segmentSize;
+    }
+  double bdp = bw.GetBitRate () / 8.0 * m_minRtt.GetSeconds ();
+  return static_cast<uint32_t> (bdp * gain);
+}
+
+void
+TcpBbr::SetPacingRate (Ptr<TcpSocketState> tcb, DataRate bw, double gain)
+{
+  DataRate rate (static_cast<uint64_t> (bw.GetBitRate () * gain * g_pacingMargin));
+  rate = std::min (rate, tcb->m_maxPacingRate);
+  if (m_fullBwReached || rate > tcb->m_pacingRate)
+    {
+      tcb->m_pacingRate = rate;
+    }
+}
+
+void
+TcpBbr::UpdateBw (const TcpRateSample &rs)
+{
+  m_roundStart = false;
+  if (rs.m_interval.IsZero ())
+    {
+      return;
+    }
+
+  // A round trip ends when the data sent at its start is delivered
+  if (rs.m_priorDelivered >= m_nextRttDelivered)
+    {
+      m_nextRttDelivered = rs.m_totalDelivered;
+      m_roundCount++;
+      m_roundStart = true;
+      m_packetConservation = false;
+    }
+
+  // The samples limited by the application, or by PROBE_RTT, underestimate
+  // the bandwidth: they are used only if they raise it
+  bool appLimited = rs.m_isAppLimited || m_mode == BBR_PROBE_RTT;
+  if (!appLimited || rs.m_deliveryRate >= m_maxBwFilter.GetBest ())
+    {
+      m_maxBwFilter.Update (m_roundCount, rs.m_deliveryRate);
+    }
+}
+
+void
+TcpBbr::AdvanceCyclePhase (void)
+{
+  m_cycleIndex = (m_cycleIndex + 1) % g_cycleLength;
+  m_cycleStamp = Simulator::Now ();
+}
+
+void
+TcpBbr::UpdateCyclePhase (Ptr<TcpSocketState> tcb, const TcpRateSample &rs)
+{
+  if (m_mode != BBR_PROBE_BW)
+    {
+      return;
+    }
+
+  bool fullLength = Simulator::Now () - m_cycleStamp > m_minRtt;
+  double gain = g_pacingGainCycle[m_cycleIndex];
+  bool next;
+  if (gain == 1)
+    {
+      next = fullLength;
+    }
+  else if (gain > 1)
+    {
+      // Probe until the extra data is in flight, or the queue overflows
+      next = fullLength && (rs.m_priorInFlight >= Inflight (tcb, GetBandwidth (), gain)
+                            || tcb->m_congState >= TcpSocketState::CA_RECOVERY);
+    }
+  else
+    {
+      // Drain until the queue is empty
+      next = fullLength || rs.m_priorInFlight <= Inflight (tcb, GetBandwidth (), 1);
+    }
+  if (next)
+    {
+      AdvanceCyclePhase ();
+    }
+}
+
+void
+TcpBbr::CheckFullBwReached (const TcpRateSample &rs)
+{
+  if (m_fullBwReached || !m_roundStart || rs.m_isAppLimited)
+    {
+      return;
+    }
+
+  DataRate bw = GetBandwidth ();
+  if (bw.GetBitRate () >= m_fullBw.GetBitRate () * g_fullBwThresh)
+    {
+      m_fullBw = bw;
+      m_fullBwCount = 0;
+      return;
+    }
+  m_fullBwReached = ++m_fullBwCount >= g_fullBwCount;
+  if (m_fullBwReached)
+    {
+      NS_LOG_INFO ("Full bandwidth reached at " << bw);
+    }
+}
+
+void
+TcpBbr::CheckDrain (Ptr<TcpSocketState> tcb, const TcpRateSample &rs)
+{
+  if (m_mode == BBR_STARTUP && m_fullBwReached)
+    {
+      SetMode (BBR_DRAIN);
+      tcb->m_ssThresh = Inflight (tcb, GetBandwidth (), 1);
+    }
+  if (m_mode == BBR_DRAIN && rs.m_bytesInFlight <= Inflight (tcb, GetBandwidth (), 1))
+    {
+      ResetProbeBwMode ();
+    }
+}
+
+void
+TcpBbr::UpdateMinRtt (Ptr<TcpSocketState> tcb, const TcpRateSample &rs)
+{
+  Time now = Simulator::Now ();
+  bool expired = now > m_minRttStamp + m_rttWindowLength;
+  if (!rs.m_rtt.IsZero () && (rs.m_rtt <= m_minRtt || expired))
+    {
+      m_minRtt = rs.m_rtt;
+      m_minRttStamp = now;
+    }
+
+  if (m_probeRttDuration.IsStrictlyPositive () && expired && !m_idleRestart
+      && m_mode != BBR_PROBE_RTT)
+    {
+      SetMode (BBR_PROBE_RTT);
+      SaveCwnd (tcb);
+      m_probeRttDoneStamp = Time (0);
+    }
+
+  if (m_mode == BBR_PROBE_RTT)
+    {
+      // The rate samples of this small flight must not lower the bandwidth
+      m_tsb->GetTxBuffer ()->MarkAppLimited (rs.m_bytesInFlight);
+
+      // Wait for the flight to drain to the PROBE_RTT cWnd, then stay there
+      // for ProbeRttDuration and at least a round trip
+      if (m_probeRttDoneStamp.IsZero ()
+          && rs.m_bytesInFlight <= g_minCwndSegments * tcb->m_segmentSize)
+        {
+          m_probeRttDoneStamp = now + m_probeRttDuration;
+          m_probeRttRoundDone = false;
+          m_nextRttDelivered = rs.m_totalDelivered;
+        }
+      else if (!m_probeRttDoneStamp.IsZero ())
+        {
+          if (m_roundStart)
+            {
+              m_probeRttRoundDone = true;
+            }
+          if (m_probeRttRoundDone && now > m_probeRttDoneStamp)
+            {
+              m_minRttStamp = now;
+              tcb->m_cWnd = std::max (tcb->m_cWnd.Get (), m_priorCwnd);
+              ResetMode ();
+            }
+        }
+    }
+
+  if (rs.m_delivered > 0)
+    {
+      m_idleRestart = false;
+    }
+}
+
+void
+TcpBbr::UpdateGains (void)
+{
+  switch (m_mode)
+    {
+    case BBR_STARTUP:
+      m_pacingGain = m_highGain;
+      m_currentCwndGain = m_highGain;
+      break;
+    case BBR_DRAIN:
+      m_pacingGain = 1 / m_highGain;
+      m_currentCwndGain = m_highGain;
+      break;
+    case BBR_PROBE_BW:
+      m_pacingGain = g_pacingGainCycle[m_cycleIndex];
+      m_currentCwndGain = m_cwndGain;
+      break;
+    case BBR_PROBE_RTT:
+      m_pacingGain = 1;
+      m_currentCwndGain = 1;
+      break;
+    }
+}
+
+void
+TcpBbr::ResetStartupMode (void)
+{
+  SetMode (BBR_STARTUP);
+}
+
+void
+TcpBbr::ResetProbeBwMode (void)
+{
+  SetMode (BBR_PROBE_BW);
+  // Start at a random phase other than the one which drains
+  m_cycleIndex = g_cycleLength - 1 - m_uv->GetInteger (0, g_cycleLength - 2);
+  AdvanceCyclePhase ();
+}
+
+void
+TcpBbr::ResetMode (void)
+{
+  if (!m_fullBwReached)
+    {
+      ResetStartupMode ();
+    }
+  else
+    {
+      ResetProbeBwMode ();
+    }
+}
+
+void
+TcpBbr::SaveCwnd (Ptr<const TcpSocketState> tcb)
+{
+  if (m_prevCongState < TcpSocketState::CA_RECOVERY && m_mode != BBR_PROBE_RTT)
+    {
+      m_priorCwnd = tcb->m_cWnd;
+    }
+  else
+    {
+      m_priorCwnd = std::max (m_priorCwnd, tcb->m_cWnd.Get ());
+    }
+}
+
+bool
+TcpBbr::SetCwndToRecoverOrRestore (Ptr<TcpSocketState> tcb, const TcpRateSample &rs,
+                                   uint32_t *newCwnd)
+{
+  TcpSocketState::TcpCongState_t state = tcb->m_congState;
+  uint32_t cwnd = tcb->m_cWnd;
+
+  if (state == TcpSocketState::CA_RECOVERY && m_prevCongState != TcpSocketState::CA_RECOVERY)
+    {
+      // First round of recovery: send one segment for each one delivered
+      m_packetConservation = true;
+      m_nextRttDelivered = rs.m_totalDelivered;
+      cwnd = rs.m_bytesInFlight + rs.m_ackedSacked;
+    }
+  else if (m_prevCongState >= TcpSocketState::CA_RECOVERY
+           && state < TcpSocketState::CA_RECOVERY)
+    {
+      cwnd = std::max (cwnd, m_priorCwnd);
+      m_packetConservation = false;
+    }
+  m_prevCongState = state;
+
+  if (m_packetConservation)
+    {
+      *newCwnd = std::max (cwnd, rs.m_bytesInFlight + rs.m_ackedSacked);
+      return true;
+    }
+  *newCwnd = cwnd;
+  return false;
+}
+
+void
+TcpBbr::SetCwnd (Ptr<TcpSocketState> tcb, const TcpRateSample &rs, DataRate bw, double gain)
+{
+  uint32_t minCwnd = g_minCwndSegments * tcb->m_segmentSize;
+  uint32_t cwnd = tcb->m_cWnd;
+
+  if (rs.m_ackedSacked > 0 && !SetCwndToRecoverOrRestore (tcb, rs, &cwnd))
+    {
+      // Budget for the ACKs which are delayed or stretched
+      uint32_t target = Inflight (tcb, bw, gain) + 3 * tcb->m_segmentSize;
+      if (m_mode == BBR_PROBE_BW && m_cycleIndex == 0)
+        {
+          target += 2 * tcb->m_segmentSize;
+        }
+
+      // Grow towards the target; before the model is reliable, grow as in
+      // slow start
+      if (m_fullBwReached)
+        {
+          cwnd = std::min (cwnd + rs.m_ackedSacked, target);
+        }
+      else if (cwnd < target
+               || rs.m_totalDelivered < tcb->m_initialCWnd * tcb->m_segmentSize)
+        {
+          cwnd = cwnd + rs.m_ackedSacked;
+        }
+      cwnd = std::max (cwnd, minCwnd);
+    }
+
+  if (m_mode == BBR_PROBE_RTT)
+    {
+      cwnd = std::min (cwnd, minCwnd);
+    }
+  tcb->m_cWnd = cwnd;
+}
+
+void
+TcpBbr::CongControl (Ptr<TcpSocketState> tcb, const TcpRateSample &rs)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  if (!m_initialized)
+    {
+      Init (tcb);
+    }
+
+  UpdateBw (rs);
+  UpdateCyclePhase (tcb, rs);
+  CheckFullBwReached (rs);
+  CheckDrain (tcb, rs);
+  UpdateMinRtt (tcb, rs);
+  UpdateGains ();
+
+  // The first RTT sample gives a better initial pacing rate than cWnd/1ms
+  if (!m_hasSeenRtt && !rs.m_rtt.IsZero ())
+    {
+      m_hasSeenRtt = true;
+      DataRate bw (static_cast<uint64_t> (tcb->m_cWnd * 8.0 / rs.m_rtt.GetSeconds ()));
+      tcb->m_pacingRate = std::min (DataRate (static_cast<uint64_t> (bw.GetBitRate () * m_highGain)),
+                                    tcb->m_maxPacingRate);
+    }
+
+  DataRate bw = GetBandwidth ();
+  if (bw.GetBitRate () > 0)
+    {
+      SetPacingRate (tcb, bw, m_pacingGain);
+    }
+  SetCwnd (tcb, rs, bw, m_currentCwndGain);
+
+  NS_LOG_LOGIC (BbrModeName[m_mode] << " bw " << bw << " minRtt " << m_minRtt <<
+                " pacing " << tcb->m_pacingRate << " cWnd " << tcb->m_cWnd);
+}
+
+uint32_t
+TcpBbr::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << tcb << bytesInFlight);
+  // Losses do not change the model: remember cWnd to restore it after the
+  // recovery, and leave ssThresh alone
+  SaveCwnd (tcb);
+  return tcb->m_ssThresh;
+}
+
+void
+TcpBbr::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+  // cWnd is set in CongControl ()
+}
+
+void
+TcpBbr::CongestionStateSet (Ptr<TcpSocketState> tcb,
+                            const TcpSocketState::TcpCongState_t newState)
+{
+  NS_LOG_FUNCTION (this << tcb << newState);
+  if (newState == TcpSocketState::CA_LOSS)
+    {
+      // After a timeout, the bandwidth has to be confirmed again
+      m_prevCongState = TcpSocketState::CA_LOSS;
+      m_fullBw = DataRate (0);
+      m_roundStart = true;
+    }
+}
+
+void
+TcpBbr::CwndEvent (Ptr<TcpSocketState> tcb,
+                   const TcpSocketState::TcpCaEvent_t event)
+{
+  NS_LOG_FUNCTION (this << tcb << event);
+  if (event != TcpSocketState::CA_EVENT_TX_START)
+    {
+      return;
+    }
+
+  if (!m_initialized)
+    {
+      Init (tcb);
+      return;
+    }
+
+  // Restarting after idle: pace at the estimated bandwidth, and do not
+  // enter PROBE_RTT because the RTT samples are missing
+  m_idleRestart = true;
+  if (m_mode == BBR_PROBE_BW && GetBandwidth ().GetBitRate () > 0)
+    {
+      SetPacingRate (tcb, GetBandwidth (), 1);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,297 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCP_BBR_H
+#define TCP_BBR_H
+
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/random-variable-stream.h"
+#include "windowed-filter.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief BBR congestion control (version 1)
+ *
+ * BBR builds a model of the path from the delivery rate samples generated
+ * for every ACK: the bottleneck bandwidth is the windowed maximum of the
+ * delivery rate over the last BwWindowLength round trips, and the
+ * propagation delay is the minimum RTT seen over the last RttWindowLength.
+ * The sender paces at a multiple (the pacing gain) of the bandwidth, and
+ * cWnd is capped at a multiple (the cwnd gain) of the bandwidth-delay
+ * product.
+ *
+ * The gains follow a state machine, as in Linux net/ipv4/tcp_bbr.c:
+ * STARTUP doubles the sending rate every round until the bandwidth stops
+ * growing by 25% for three rounds; DRAIN empties the queue built in
+ * STARTUP; PROBE_BW cycles the pacing gain through 5/4, 3/4 and six rounds
+ * at 1, to probe for more bandwidth and drain the queue this creates; and
+ * PROBE_RTT, entered when the minimum RTT has not been refreshed in
+ * RttWindowLength, lowers cWnd to four segments for ProbeRttDuration and a
+ * round trip, to measure the propagation delay again.
+ *
+ * BBR sets the pacing rate itself, and enables pacing on the socket it is
+ * attached to. Losses do not reduce the model: in recovery, cWnd follows
+ * packet conservation, and the value before the recovery is restored at
+ * its end. ECN is not used. The long-term bandwidth estimation, used by
+ * Linux against token-bucket policers, and the compensation of ACK
+ * aggregation are not modeled.
+ */
+class TcpBbr : public TcpCongestionOps
+{
+public:
+  /**
+   * \brief The states of the BBR state machine
+   */
+  typedef enum
+  {
+    BBR_STARTUP,    //!< Ramp up the sending rate to find the bandwidth
+    BBR_DRAIN,      //!< Drain the queue built in startup
+    BBR_PROBE_BW,   //!< Probe for bandwidth by cycling the pacing gain
+    BBR_PROBE_RTT   //!< Reduce cWnd to measure the minimum RTT
+  } BbrMode_t;
+
+  /**
+   * \brief Literal names of the BBR states for use in log messages
+   */
+  static const char* const BbrModeName[BBR_PROBE_RTT + 1];
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpBbr ();
+
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpBbr (const TcpBbr& sock);
+
+  virtual ~TcpBbr (void);
+
+  virtual std::string GetName () const;
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                uint32_t bytesInFlight);
+  virtual void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                   const TcpSocketState::TcpCongState_t newState);
+  virtual void CwndEvent (Ptr<TcpSocketState> tcb,
+                          const TcpSocketState::TcpCaEvent_t event);
+  virtual void SetSocketBase (Ptr<TcpSocketBase> tsb);
+  virtual bool SetsPacingRate (void) const;
+  virtual bool HasCongControl (void) const;
+  virtual void CongControl (Ptr<TcpSocketState> tcb, const TcpRateSample &rs);
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variables used by this model
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Get the state of the state machine
+   * \return the current state
+   */
+  BbrMode_t GetMode (void) const;
+
+  /**
+   * \brief Get the estimated bottleneck bandwidth
+   * \return the windowed maximum of the delivery rate
+   */
+  DataRate GetBandwidth (void) const;
+
+  /**
+   * \brief Get the estimated propagation delay
+   * \return the minimum RTT, or Time::Max () if no RTT has been measured
+   */
+  Time GetMinRtt (void) const;
+
+  /**
+   * \brief Whether the bandwidth has stopped growing in startup
+   * \return true if the full bandwidth has been reached
+   */
+  bool IsFullBwReached (void) const;
+
+private:
+  /**
+   * \brief Max filter on the delivery rate, windowed in round trips
+   */
+  typedef WindowedFilter<DataRate, uint32_t, std::greater_equal<DataRate> > MaxBwFilter;
+
+  /**
+   * \brief Initialize the model, and the pacing rate from cWnd
+   * \param tcb internal congestion state
+   */
+  void Init (Ptr<TcpSocketState> tcb);
+
+  /**
+   * \brief Bytes in flight to reach a multiple of the bandwidth-delay product
+   * \param tcb internal congestion state
+   * \param bw bandwidth
+   * \param gain multiple of the BDP
+   * \return the target, or the initial cWnd if no RTT has been measured
+   */
+  uint32_t Inflight (Ptr<const TcpSocketState> tcb, DataRate bw, double gain) const;
+
+  /**
+   * \brief Set the pacing rate to a multiple of the bandwidth
+   *
+   * Until the full bandwidth is reached, the rate is only increased.
+   *
+   * \param tcb internal congestion state
+   * \param bw bandwidth
+   * \param gain pacing gain
+   */
+  void SetPacingRate (Ptr<TcpSocketState> tcb, DataRate bw, double gain);
+
+  /**
+   * \brief Count the round trips, and update the bandwidth filter
+   * \param rs rate sample of the ACK
+   */
+  void UpdateBw (const TcpRateSample &rs);
+
+  /**
+   * \brief Advance the pacing gain cycle of PROBE_BW, if its phase is over
+   * \param tcb internal congestion state
+   * \param rs rate sample of the ACK
+   */
+  void UpdateCyclePhase (Ptr<TcpSocketState> tcb, const TcpRateSample &rs);
+
+  /**
+   * \brief Move to the next phase of the pacing gain cycle
+   */
+  void AdvanceCyclePhase (void);
+
+  /**
+   * \brief Check whether the bandwidth has stopped growing in startup
+   * \param rs rate sample of the ACK
+   */
+  void CheckFullBwReached (const TcpRateSample &rs);
+
+  /**
+   * \brief Move from STARTUP to DRAIN, and from DRAIN to PROBE_BW
+   * \param tcb internal congestion state
+   * \param rs rate sample of the ACK
+   */
+  void CheckDrain (Ptr<TcpSocketState> tcb, const TcpRateSample &rs);
+
+  /**
+   * \brief Update the minimum RTT, and enter or leave PROBE_RTT
+   * \param tcb internal congestion state
+   * \param rs rate sample of the ACK
+   */
+  void UpdateMinRtt (Ptr<TcpSocketState> tcb, const TcpRateSample &rs);
+
+  /**
+   * \brief Set the gains of the current state
+   */
+  void UpdateGains (void);
+
+  /**
+   * \brief Enter STARTUP
+   */
+  void ResetStartupMode (void);
+
+  /**
+   * \brief Enter PROBE_BW, at a random phase of the cycle
+   */
+  void ResetProbeBwMode (void);
+
+  /**
+   * \brief Enter STARTUP or PROBE_BW, after PROBE_RTT
+   */
+  void ResetMode (void);
+
+  /**
+   * \brief Change the state of the state machine
+   * \param mode the new state
+   */
+  void SetMode (BbrMode_t mode);
+
+  /**
+   * \brief Remember cWnd before a recovery or PROBE_RTT
+   * \param tcb internal congestion state
+   */
+  void SaveCwnd (Ptr<const TcpSocketState> tcb);
+
+  /**
+   * \brief Apply packet conservation in recovery, and restore cWnd after it
+   * \param tcb internal congestion state
+   * \param rs rate sample of the ACK
+   * \param newCwnd output parameter, set to the new cWnd
+   * \return true if cWnd is set by packet conservation
+   */
+  bool SetCwndToRecoverOrRestore (Ptr<TcpSocketState> tcb, const TcpRateSample &rs,
+                                  uint32_t *newCwnd);
+
+  /**
+   * \brief Grow cWnd towards a multiple of the bandwidth-delay product
+   * \param tcb internal congestion state
+   * \param rs rate sample of the ACK
+   * \param bw bandwidth
+   * \param gain cwnd gain
+   */
+  void SetCwnd (Ptr<TcpSocketState> tcb, const TcpRateSample &rs, DataRate bw, double gain);
+
+  // Parameters
+  double m_highGain;            //!< Pacing and cwnd gain in startup
+  double m_cwndGain;            //!< Cwnd gain in PROBE_BW
+  uint32_t m_bwWindowLength;    //!< Length of the bandwidth filter, in round trips
+  Time m_rttWindowLength;       //!< Validity of the minimum RTT
+  Time m_probeRttDuration;      //!< Minimum duration of PROBE_RTT
+
+  // Model
+  MaxBwFilter m_maxBwFilter;    //!< Windowed maximum of the delivery rate
+  Time m_minRtt;                //!< Minimum RTT
+  Time m_minRttStamp;           //!< Time at which m_minRtt was measured
+  uint32_t m_roundCount;        //!< Count of round trips
+  uint64_t m_nextRttDelivered;  //!< Delivered bytes at which the next round starts
+  bool m_roundStart;            //!< The last ACK started a round trip
+
+  // State machine
+  BbrMode_t m_mode;             //!< Current state
+  double m_pacingGain;          //!< Current pacing gain
+  double m_currentCwndGain;     //!< Current cwnd gain
+  DataRate m_fullBw;            //!< Bandwidth of the last significant growth in startup
+  uint32_t m_fullBwCount;       //!< Rounds without a significant growth
+  bool m_fullBwReached;         //!< The bandwidth has stopped growing
+  uint32_t m_cycleIndex;        //!< Phase of the pacing gain cycle
+  Time m_cycleStamp;            //!< Start of the phase
+  Time m_probeRttDoneStamp;     //!< End of PROBE_RTT, zero if not scheduled yet
+  bool m_probeRttRoundDone;     //!< A round trip has elapsed in PROBE_RTT
+  bool m_idleRestart;           //!< Restarting after idle
+  bool m_packetConservation;    //!< Use packet conservation in the first round of recovery
+  uint32_t m_priorCwnd;         //!< cWnd before a recovery or PROBE_RTT
+  TcpSocketState::TcpCongState_t m_prevCongState; //!< Congestion state at the previous ACK
+  bool m_hasSeenRtt;            //!< The pacing rate has been set from an RTT sample
+  bool m_initialized;           //!< Init () has been called
+  Ptr<UniformRandomVariable> m_uv; //!< Random phase when entering PROBE_BW
+  Ptr<TcpSocketBase> m_tsb;     //!< Socket, to flag the samples of PROBE_RTT
+};
+
+} // namespace ns3
+
+#endif /* TCP_BBR_H */
@@ -113,6 +113,10 @@ public:
    * optional (congestion controls can not implement it) and the default
    * implementation does nothing.
    *
+   * When Accurate ECN has been negotiated (tcb->m_accEcn), the CE-marked
+   * bytes and packets newly reported by the ACK are available in
+   * tcb->m_ackedCeBytes and tcb->m_ackedCePackets.
+   *
    * \param tcb internal congestion state
    * \param segmentsAcked count of segments acked
    * \param rtt last rtt
@@ -172,6 +176,20 @@ public:
   {
   }
 
+  /**
+   * \brief Tell the socket whether this algorithm sets the pacing rate
+   *
+   * When pacing is enabled, the socket derives the pacing rate from cWnd
+   * and SRTT. An algorithm returning true writes tcb->m_pacingRate itself,
+   * and is responsible for keeping it below tcb->m_maxPacingRate.
+   *
+   * \return true if the algorithm sets the pacing rate
+   */
+  virtual bool SetsPacingRate (void) const
+  {
+    return false;
+  }
+
   /**
    * \brief Reduces congestion window on receipt of ECN Echo Flag
    *
@@ -180,6 +198,33 @@ public:
    virtual void ReduceCwnd (Ptr<TcpSocketState> tcb)
    {
    }
+
+  /**
+   * \brief Tell the socket whether this algorithm controls cWnd on every ACK
+   *
+   * An algorithm returning true receives a delivery rate sample through
+   * CongControl () for every ACK, and sets cWnd there; the socket does not
+   * set cWnd to ssThresh when entering the recovery.
+   *
+   * \return true if the algorithm implements CongControl ()
+   */
+  virtual bool HasCongControl (void) const
+  {
+    return false;
+  }
+
+  /**
+   * \brief Update the congestion state with the rate sample of an ACK
+   *
+   * Called once the ACK has been processed, and the segments lost marked,
+   * before the socket sends new data.
+   *
+   * \param tcb internal congestion state
+   * \param rs rate sample of the ACK
+   */
+  virtual void CongControl (Ptr<TcpSocketState> tcb, const TcpRateSample &rs)
+  {
+  }
 };
 
 /**
@@ -82,6 +82,12 @@ TcpDctcp::TcpDctcp (const TcpDctcp& sock)
   NS_LOG_FUNCTION (this);
   m_delayedAckReserved = (sock.m_delayedAckReserved);
   m_ceState = (sock.m_ceState);
+  m_ackedBytesEcn = 0;
+  m_ackedBytesTotal = 0;
+  m_priorRcvNxtFlag = false;
+  m_nextSeqFlag = false;
+  m_alpha = sock.m_alpha;
+  m_g = sock.m_g;
 }
 
 TcpDctcp::~TcpDctcp (void)
@@ -116,7 +122,12 @@ TcpDctcp::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time
 {
   NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
   m_ackedBytesTotal += segmentsAcked * tcb->m_segmentSize;
-  if (tcb->m_ecnState == TcpSocketState::ECN_ECE_RCVD)
+  if (tcb->m_accEcn)
+    {
+      // Accurate ECN reports the exact number of marked bytes
+      m_ackedBytesEcn += tcb->m_ackedCeBytes;
+    }
+  else if (tcb->m_ecnState == TcpSocketState::ECN_ECE_RCVD)
     {
       m_ackedBytesEcn += segmentsAcked * tcb->m_segmentSize;
     }
@@ -148,6 +159,12 @@ TcpDctcp::SetDctcpAlpha (double alpha)
   m_alpha = alpha;
 }
 
+double
+TcpDctcp::GetDctcpAlpha (void) const
+{
+  return m_alpha;
+}
+
 void
 TcpDctcp::Reset (Ptr<TcpSocketState> tcb)
 {
@@ -98,6 +98,14 @@ public:
   virtual void CwndEvent (Ptr<TcpSocketState> tcb,
                           const TcpSocketState::TcpCaEvent_t event);
 
+protected:
+  /**
+   * \brief Get the estimated fraction of bytes which encountered congestion
+   *
+   * \return the DCTCP alpha parameter
+   */
+  double GetDctcpAlpha (void) const;
+
 private:
   /**
    * \brief Changes state of m_ceState to true
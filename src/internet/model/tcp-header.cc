@@ -39,6 +39,7 @@ TcpHeader::TcpHeader ()
     m_ackNumber (0),
     m_length (5),
     m_flags (0),
+    m_ae (false),
     m_windowSize (0xffff),
     m_urgentPointer (0),
     m_calcChecksum (false),
@@ -115,6 +116,27 @@ TcpHeader::SetFlags (uint8_t flags)
   m_flags = flags;
 }
 
+void
+TcpHeader::SetAe (bool ae)
+{
+  m_ae = ae;
+}
+
+void
+TcpHeader::SetAce (uint8_t ace)
+{
+  m_ae = (ace & 0x4) != 0;
+  m_flags &= ~(CWR | ECE);
+  if (ace & 0x2)
+    {
+      m_flags |= CWR;
+    }
+  if (ace & 0x1)
+    {
+      m_flags |= ECE;
+    }
+}
+
 void
 TcpHeader::SetWindowSize (uint16_t windowSize)
 {
@@ -175,6 +197,18 @@ TcpHeader::GetFlags () const
   return m_flags;
 }
 
+bool
+TcpHeader::GetAe () const
+{
+  return m_ae;
+}
+
+uint8_t
+TcpHeader::GetAce () const
+{
+  return (m_ae ? 0x4 : 0) | ((m_flags & CWR) ? 0x2 : 0) | ((m_flags & ECE) ? 0x1 : 0);
+}
+
 uint16_t
 TcpHeader::GetWindowSize () const
 {
@@ -288,9 +322,9 @@ TcpHeader::Print (std::ostream &os)  const
 {
   os << m_sourcePort << " > " << m_destinationPort;
 
-  if (m_flags != 0)
+  if (m_flags != 0 || m_ae)
     {
-      os << " [" << FlagsToString (m_flags) << "]";
+      os << " [" << (m_ae ? (m_flags != 0 ? "AE|" : "AE") : "") << FlagsToString (m_flags) << "]";
     }
 
   os << " Seq=" << m_sequenceNumber << " Ack=" << m_ackNumber << " Win=" << m_windowSize;
@@ -319,7 +353,7 @@ TcpHeader::Serialize (Buffer::Iterator start)  const
   i.WriteHtonU16 (m_destinationPort);
   i.WriteHtonU32 (m_sequenceNumber.GetValue ());
   i.WriteHtonU32 (m_ackNumber.GetValue ());
-  i.WriteHtonU16 (GetLength () << 12 | m_flags); //reserved bits are all zero
+  i.WriteHtonU16 (GetLength () << 12 | (m_ae ? 0x100 : 0) | m_flags); //other reserved bits are all zero
   i.WriteHtonU16 (m_windowSize);
   i.WriteHtonU16 (0);
   i.WriteHtonU16 (m_urgentPointer);
@@ -367,6 +401,7 @@ TcpHeader::Deserialize (Buffer::Iterator start)
   m_ackNumber = i.ReadNtohU32 ();
   uint16_t field = i.ReadNtohU16 ();
   m_flags = field & 0xFF;
+  m_ae = (field & 0x100) != 0;
   m_length = field >> 12;
   m_windowSize = i.ReadNtohU16 ();
   i.Next (2);
@@ -532,6 +567,7 @@ operator== (const TcpHeader &lhs, const TcpHeader &rhs)
     && lhs.m_sequenceNumber  == rhs.m_sequenceNumber
     && lhs.m_ackNumber       == rhs.m_ackNumber
     && lhs.m_flags           == rhs.m_flags
+    && lhs.m_ae              == rhs.m_ae
     && lhs.m_windowSize      == rhs.m_windowSize
     && lhs.m_urgentPointer   == rhs.m_urgentPointer
     );
@@ -114,6 +114,27 @@ public:
    */
   void SetFlags (uint8_t flags);
 
+  /**
+   * \brief Set the AE (Accurate ECN) flag of the header
+   *
+   * AE is the former NS (ECN-nonce) bit, the highest of the reserved bits
+   * preceding the eight TCP flags (RFC 3540 is historic).
+   *
+   * \param ae the value of the AE flag
+   */
+  void SetAe (bool ae);
+
+  /**
+   * \brief Set the ACE field of the header
+   *
+   * With Accurate ECN, the AE, CWR and ECE flags (from the most to the least
+   * significant bit) form the 3-bit ACE counter of CE-marked packets. The
+   * other flags are left untouched.
+   *
+   * \param ace the ACE value (only the 3 least significant bits are used)
+   */
+  void SetAce (uint8_t ace);
+
   /**
    * \brief Set the window size
    * \param windowSize the window size for this TcpHeader
@@ -168,6 +189,18 @@ public:
    */
   uint8_t GetFlags () const;
 
+  /**
+   * \brief Get the AE (Accurate ECN) flag
+   * \return the value of the AE flag for this TcpHeader
+   */
+  bool GetAe () const;
+
+  /**
+   * \brief Get the ACE field, made of the AE, CWR and ECE flags
+   * \return the 3-bit ACE value for this TcpHeader
+   */
+  uint8_t GetAce () const;
+
   /**
    * \brief Get the window size
    * \return the window size for this TcpHeader
@@ -338,6 +371,7 @@ private:
   SequenceNumber32 m_ackNumber;       //!< ACK number
   uint8_t m_length;             //!< Length (really a uint4_t) in words.
   uint8_t m_flags;              //!< Flags (really a uint6_t)
+  bool m_ae;                    //!< AE flag (Accurate ECN)
   uint16_t m_windowSize;        //!< Window size
   uint16_t m_urgentPointer;     //!< Urgent pointer
 
@@ -722,6 +722,19 @@ TcpL4Protocol::RemoveSocket (Ptr<TcpSocketBase> socket)
   return false;
 }
 
+uint32_t
+TcpL4Protocol::GetNSockets (void) const
+{
+  return m_sockets.size ();
+}
+
+Ptr<TcpSocketBase>
+TcpL4Protocol::GetSocket (uint32_t index) const
+{
+  NS_ASSERT (index < m_sockets.size ());
+  return m_sockets[index];
+}
+
 void
 TcpL4Protocol::SetDownTarget (IpL4Protocol::DownTargetCallback callback)
 {
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-option-accecn.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpOptionAccEcn");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpOptionAccEcn);
+
+TcpOptionAccEcn::TcpOptionAccEcn ()
+  : TcpOption (),
+    m_kind (TcpOption::ACCECN0),
+    m_fields (3),
+    m_e0b (0),
+    m_ceb (0),
+    m_e1b (0)
+{
+}
+
+TcpOptionAccEcn::~TcpOptionAccEcn ()
+{
+}
+
+TypeId
+TcpOptionAccEcn::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpOptionAccEcn")
+    .SetParent<TcpOption> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpOptionAccEcn> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpOptionAccEcn::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+TcpOptionAccEcn::Print (std::ostream &os) const
+{
+  os << "[accecn" << (m_kind == TcpOption::ACCECN0 ? "0" : "1");
+  if (HasField (0))
+    {
+      os << " e0b=" << m_e0b;
+    }
+  if (HasField (1))
+    {
+      os << " ceb=" << m_ceb;
+    }
+  if (HasField (2))
+    {
+      os << " e1b=" << m_e1b;
+    }
+  os << "]";
+}
+
+uint32_t
+TcpOptionAccEcn::GetSerializedSize (void) const
+{
+  return 2 + 3 * m_fields;
+}
+
+void
+TcpOptionAccEcn::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteU8 (GetKind ()); // Kind
+  i.WriteU8 (GetSerializedSize ()); // Length
+  for (uint8_t pos = 0; pos < m_fields; ++pos)
+    {
+      uint32_t value = FieldAt (pos) & COUNTER_MASK;
+      i.WriteU8 ((value >> 16) & 0xFF);
+      i.WriteHtonU16 (value & 0xFFFF);
+    }
+}
+
+uint32_t
+TcpOptionAccEcn::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+
+  uint8_t readKind = i.ReadU8 ();
+  if (readKind != TcpOption::ACCECN0 && readKind != TcpOption::ACCECN1)
+    {
+      NS_LOG_WARN ("Malformed AccECN option");
+      return 0;
+    }
+  m_kind = readKind;
+
+  uint8_t size = i.ReadU8 ();
+  if (size < 2 || size > 11 || (size - 2) % 3 != 0)
+    {
+      NS_LOG_WARN ("Malformed AccECN option, wrong length " << static_cast<uint32_t> (size));
+      return 0;
+    }
+  m_fields = (size - 2) / 3;
+
+  for (uint8_t pos = 0; pos < m_fields; ++pos)
+    {
+      uint32_t value = i.ReadU8 () << 16;
+      value |= i.ReadNtohU16 ();
+      FieldAt (pos) = value;
+    }
+  return GetSerializedSize ();
+}
+
+uint8_t
+TcpOptionAccEcn::GetKind (void) const
+{
+  return m_kind;
+}
+
+void
+TcpOptionAccEcn::SetOrder (uint8_t kind)
+{
+  NS_ASSERT (kind == TcpOption::ACCECN0 || kind == TcpOption::ACCECN1);
+  m_kind = kind;
+}
+
+void
+TcpOptionAccEcn::SetFieldCount (uint8_t n)
+{
+  NS_ASSERT (n <= 3);
+  m_fields = n;
+}
+
+uint8_t
+TcpOptionAccEcn::GetFieldCount (void) const
+{
+  return m_fields;
+}
+
+void
+TcpOptionAccEcn::SetE0b (uint32_t bytes)
+{
+  m_e0b = bytes & COUNTER_MASK;
+}
+
+void
+TcpOptionAccEcn::SetCeb (uint32_t bytes)
+{
+  m_ceb = bytes & COUNTER_MASK;
+}
+
+void
+TcpOptionAccEcn::SetE1b (uint32_t bytes)
+{
+  m_e1b = bytes & COUNTER_MASK;
+}
+
+uint32_t
+TcpOptionAccEcn::GetE0b (void) const
+{
+  return m_e0b;
+}
+
+uint32_t
+TcpOptionAccEcn::GetCeb (void) const
+{
+  return m_ceb;
+}
+
+uint32_t
+TcpOptionAccEcn::GetE1b (void) const
+{
+  return m_e1b;
+}
+
+bool
+TcpOptionAccEcn::HasField (uint8_t field) const
+{
+  NS_ASSERT (field <= 2);
+  // ECEB is always second; EE0B is first with ACCECN0 and last with ACCECN1
+  if (field == 1)
+    {
+      return m_fields >= 2;
+    }
+  bool first = (field == 0) == (m_kind == TcpOption::ACCECN0);
+  return first ? m_fields >= 1 : m_fields >= 3;
+}
+
+uint32_t &
+TcpOptionAccEcn::FieldAt (uint8_t pos)
+{
+  NS_ASSERT (pos <= 2);
+  if (pos == 1)
+    {
+      return m_ceb;
+    }
+  bool e0b = (pos == 0) == (m_kind == TcpOption::ACCECN0);
+  return e0b ? m_e0b : m_e1b;
+}
+
+uint32_t
+TcpOptionAccEcn::FieldAt (uint8_t pos) const
+{
+  return const_cast<TcpOptionAccEcn *> (this)->FieldAt (pos);
+}
+
+} // namespace ns3
@@ -24,6 +24,7 @@
 #include "tcp-option-ts.h"
 #include "tcp-option-sack-permitted.h"
 #include "tcp-option-sack.h"
+#include "tcp-option-accecn.h"
 
 #include "ns3/type-id.h"
 #include "ns3/log.h"
@@ -80,6 +81,8 @@ TcpOption::CreateOption (uint8_t kind)
     { TcpOption::WINSCALE,      TcpOptionWinScale::GetTypeId () },
     { TcpOption::SACKPERMITTED, TcpOptionSackPermitted::GetTypeId () },
     { TcpOption::SACK,          TcpOptionSack::GetTypeId () },
+    { TcpOption::ACCECN0,       TcpOptionAccEcn::GetTypeId () },
+    { TcpOption::ACCECN1,       TcpOptionAccEcn::GetTypeId () },
     { TcpOption::UNKNOWN,  TcpOptionUnknown::GetTypeId () }
   };
 
@@ -107,6 +110,8 @@ TcpOption::IsKindKnown (uint8_t kind)
     case SACKPERMITTED:
     case SACK:
     case TS:
+    case ACCECN0:
+    case ACCECN1:
       // Do not add UNKNOWN here
       return true;
     }
@@ -61,6 +61,8 @@ public:
     SACKPERMITTED = 4,          //!< SACKPERMITTED
     SACK = 5,                   //!< SACK
     TS = 8,                     //!< TS
+    ACCECN0 = 172,              //!< AccECN, EE0B field first
+    ACCECN1 = 174,              //!< AccECN, EE1B field first
     UNKNOWN = 255               //!< not a standardized value; for unknown recv'd options
   };
 
@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-prague.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpPrague");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpPrague);
+
+TypeId TcpPrague::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpPrague")
+    .SetParent<TcpDctcp> ()
+    .AddConstructor<TcpPrague> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("RttTarget",
+                   "Flows with a shorter RTT increase their window as if "
+                   "their RTT was this one",
+                   TimeValue (MilliSeconds (25)),
+                   MakeTimeAccessor (&TcpPrague::m_rttTarget),
+                   MakeTimeChecker ())
+    .AddAttribute ("ClassicEcnDetection",
+                   "Fall back to a Reno-friendly response when a classic "
+                   "ECN AQM is detected at the bottleneck",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpPrague::m_classicDetection),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ClassicEcnQueueDelay",
+                   "Queuing delay above which the bottleneck is considered "
+                   "to run a classic ECN AQM",
+                   TimeValue (MilliSeconds (5)),
+                   MakeTimeAccessor (&TcpPrague::m_classicThreshold),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+std::string TcpPrague::GetName () const
+{
+  return "TcpPrague";
+}
+
+TcpPrague::TcpPrague ()
+  : TcpDctcp (),
+    m_classicDetection (true),
+    m_classicScore (0.0),
+    m_classicEcn (false),
+    m_roundStarted (false),
+    m_cWndCnt (0.0),
+    m_cwrPending (false),
+    m_cwrPriorCwnd (0),
+    m_cwrTarget (0),
+    m_cwrAcked (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpPrague::TcpPrague (const TcpPrague& sock)
+  : TcpDctcp (sock),
+    m_rttTarget (sock.m_rttTarget),
+    m_classicThreshold (sock.m_classicThreshold),
+    m_classicDetection (sock.m_classicDetection),
+    m_classicScore (0.0),
+    m_classicEcn (false),
+    m_roundStarted (false),
+    m_cWndCnt (0.0),
+    m_cwrPending (false),
+    m_cwrPriorCwnd (0),
+    m_cwrTarget (0),
+    m_cwrAcked (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpPrague::~TcpPrague (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<TcpCongestionOps> TcpPrague::Fork (void)
+{
+  NS_LOG_FUNCTION (this);
+  return CopyObject<TcpPrague> (this);
+}
+
+bool
+TcpPrague::IsClassicEcn (void) const
+{
+  return m_classicEcn;
+}
+
+void
+TcpPrague::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+  // Do not grow the window while it is being reduced
+  if (m_cwrPending)
+    {
+      return;
+    }
+  TcpNewReno::IncreaseWindow (tcb, segmentsAcked);
+}
+
+void
+TcpPrague::CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked);
+  if (segmentsAcked == 0)
+    {
+      return;
+    }
+
+  double factor = 1.0;
+  if (!m_classicEcn && !m_srtt.IsZero () && m_srtt < m_rttTarget)
+    {
+      double ratio = m_srtt.GetSeconds () / m_rttTarget.GetSeconds ();
+      factor = ratio * ratio;
+    }
+  m_cWndCnt += factor * segmentsAcked * tcb->m_segmentSize * tcb->m_segmentSize / tcb->m_cWnd.Get ();
+  if (m_cWndCnt >= 1.0)
+    {
+      uint32_t adder = static_cast<uint32_t> (m_cWndCnt);
+      tcb->m_cWnd += adder;
+      m_cWndCnt -= adder;
+      NS_LOG_INFO ("In CongAvoid, updated to cwnd " << tcb->m_cWnd <<
+                   " ssthresh " << tcb->m_ssThresh);
+    }
+}
+
+void
+TcpPrague::ReduceCwnd (Ptr<TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+  if (m_cwrPending)
+    {
+      // complete the previous reduction first
+      tcb->m_cWnd = m_cwrTarget;
+      m_cwrPending = false;
+    }
+
+  if (m_classicEcn)
+    {
+      tcb->m_cWnd = std::max (tcb->m_cWnd.Get () / 2, 2 * tcb->m_segmentSize);
+      return;
+    }
+
+  uint32_t target = static_cast<uint32_t> ((1 - GetDctcpAlpha () / 2.0) * tcb->m_cWnd);
+  target = std::max (target, 2 * tcb->m_segmentSize);
+  if (target < tcb->m_cWnd)
+    {
+      NS_LOG_INFO ("Reducing cwnd from " << tcb->m_cWnd << " to " << target <<
+                   " over the next round");
+      m_cwrPending = true;
+      m_cwrPriorCwnd = tcb->m_cWnd;
+      m_cwrTarget = target;
+      m_cwrAcked = 0;
+    }
+}
+
+void
+TcpPrague::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time &rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+  TcpDctcp::PktsAcked (tcb, segmentsAcked, rtt);
+
+  if (!rtt.IsZero ())
+    {
+      if (m_minRtt.IsZero () || rtt < m_minRtt)
+        {
+          m_minRtt = rtt;
+        }
+      m_srtt = m_srtt.IsZero () ? rtt : (m_srtt * 7 + rtt) / 8;
+    }
+
+  if (!m_roundStarted)
+    {
+      m_roundEnd = tcb->m_nextTxSequence;
+      m_roundStarted = true;
+    }
+  else if (tcb->m_lastAckedSeq >= m_roundEnd)
+    {
+      UpdateClassicEcn ();
+      m_roundEnd = tcb->m_nextTxSequence;
+    }
+
+  if (m_cwrPending)
+    {
+      // Each ACK removes its share of the reduction, which is complete
+      // once a full window has been acknowledged
+      m_cwrAcked += segmentsAcked * tcb->m_segmentSize;
+      if (m_cwrAcked >= m_cwrPriorCwnd)
+        {
+          tcb->m_cWnd = m_cwrTarget;
+          tcb->m_ssThresh = m_cwrTarget;
+          m_cwrPending = false;
+        }
+      else
+        {
+          uint64_t reduction = static_cast<uint64_t> (m_cwrPriorCwnd - m_cwrTarget) * m_cwrAcked / m_cwrPriorCwnd;
+          tcb->m_cWnd = m_cwrPriorCwnd - static_cast<uint32_t> (reduction);
+        }
+    }
+}
+
+void
+TcpPrague::CongestionStateSet (Ptr<TcpSocketState> tcb,
+                               const TcpSocketState::TcpCongState_t newState)
+{
+  NS_LOG_FUNCTION (this << tcb << newState);
+  if (newState == TcpSocketState::CA_RECOVERY || newState == TcpSocketState::CA_LOSS)
+    {
+      // the loss response supersedes the ECN one
+      m_cwrPending = false;
+      m_cWndCnt = 0.0;
+    }
+}
+
+void
+TcpPrague::UpdateClassicEcn (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_classicDetection || m_srtt.IsZero ())
+    {
+      return;
+    }
+
+  double sample = (m_srtt - m_minRtt > m_classicThreshold) ? 1.0 : 0.0;
+  m_classicScore += (sample - m_classicScore) / 8.0;
+  if (!m_classicEcn && m_classicScore > 0.75)
+    {
+      NS_LOG_INFO ("Classic ECN AQM detected, queuing delay " << m_srtt - m_minRtt);
+      m_classicEcn = true;
+    }
+  else if (m_classicEcn && m_classicScore < 0.25)
+    {
+      NS_LOG_INFO ("Classic ECN AQM no longer detected");
+      m_classicEcn = false;
+    }
+}
+
+} // namespace ns3
@@ -156,68 +156,72 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end () && i->first <= tailSeq)
-    {
-      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      if (lastByteSeq > headSeq)
-        {
-          if (i->first > headSeq && lastByteSeq < tailSeq)
-            { // Rare case: Existing packet is embedded fully in the new packet
-              m_size -= i->second->GetSize ();
-              m_data.erase (i++);
-              continue;
-            }
-          if (i->first <= headSeq)
-            { // Incoming head is overlapped
-              headSeq = lastByteSeq;
-            }
-          if (lastByteSeq >= tailSeq)
-            { // Incoming tail is overlapped
-              tailSeq = i->first;
-            }
-        }
-      ++i;
-    }
-  // We now know how much we are going to store, trim the packet
   if (headSeq >= tailSeq)
     {
       NS_LOG_LOGIC ("Nothing to buffer");
       return false; // Nothing to buffer anyway
     }
-  else
-    {
-      uint32_t start = headSeq - tcph.GetSequenceNumber ();
-      uint32_t length = tailSeq - headSeq;
-      p = p->CreateFragment (start, length);
-      NS_ASSERT (length == p->GetSize ());
-    }
-  // Insert packet into buffer
-  NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
 
-  if (headSeq > m_nextRxSeq)
+  // Start from the first block that ends at, or after, the packet head
+  BlockIterator i = m_blocks.upper_bound (headSeq);
+  if (i != m_blocks.begin ())
     {
-      // Generate a new SACK block
-      UpdateSackList (headSeq, tailSeq);
+      BlockIterator prev = i;
+      --prev;
+      if (prev->second >= headSeq)
+        {
+          i = prev;
+        }
     }
 
-  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
-  // Update variables
-  m_size += p->GetSize ();      // Occupancy
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  // Store the holes between the blocks that overlap (or are adjacent to)
+  // the packet, and coalesce these blocks with the packet
+  SequenceNumber32 blockHead = headSeq;
+  SequenceNumber32 blockTail = tailSeq;
+  SequenceNumber32 seq = headSeq;
+  uint32_t oldSize = m_size;
+  while (i != m_blocks.end () && i->first <= tailSeq)
     {
-      if (i->first < m_nextRxSeq)
+      if (i->first > seq)
+        {
+          AddFragment (p, tcph.GetSequenceNumber (), seq, i->first);
+        }
+      if (i->first < blockHead)
         {
-          continue;
+          blockHead = i->first;
         }
-      else if (i->first > m_nextRxSeq)
+      if (i->second > seq)
         {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+          seq = i->second;
+        }
+      if (i->second > blockTail)
+        {
+          blockTail = i->second;
+        }
+      m_blocks.erase (i++);
+    }
+  if (seq < tailSeq)
+    {
+      AddFragment (p, tcph.GetSequenceNumber (), seq, tailSeq);
+    }
+  m_blocks[blockHead] = blockTail;
+
+  if (m_size == oldSize)
+    {
+      NS_LOG_LOGIC ("Nothing to buffer, the data is already in the buffer");
+      return false;
+    }
+
+  if (blockHead > m_nextRxSeq)
+    {
+      // Generate a new SACK block
+      UpdateSackList (blockHead, blockTail);
+    }
+  else if (blockTail > m_nextRxSeq)
+    {
+      // The block is in sequence: it is available to the application
+      m_availBytes += blockTail - m_nextRxSeq.Get ();
+      m_nextRxSeq = blockTail;
       ClearSackList (m_nextRxSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -228,6 +232,22 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   return true;
 }
 
+void
+TcpRxBuffer::AddFragment (Ptr<Packet> p, const SequenceNumber32 &seq,
+                          const SequenceNumber32 &head, const SequenceNumber32 &tail)
+{
+  NS_LOG_FUNCTION (this << p << seq << head << tail);
+
+  uint32_t length = tail - head;
+  Ptr<Packet> fragment = p->CreateFragment (head - seq, length);
+  NS_ASSERT (length == fragment->GetSize ());
+  NS_ASSERT (m_data.find (head) == m_data.end ()); // Shouldn't be there yet
+  m_data[head] = fragment;
+  m_size += length;
+
+  NS_LOG_LOGIC ("Buffered packet of seqno=" << head << " len=" << length);
+}
+
 uint32_t
 TcpRxBuffer::GetSackListSize () const
 {
@@ -272,54 +292,24 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
   //     following SACK blocks in the SACK option may be listed in
   //     arbitrary order.
 
-  m_sackList.push_front (current);
-
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
+  // The block is the whole contiguous block of data around the new segment,
+  // so the blocks already in the list are either part of it, or disjoint.
   TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
-  ++it;
-
-  // Iterates until we examined all blocks in the list (maximum 4)
   while (it != m_sackList.end ())
     {
-      TcpOptionSack::SackBlock current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
-        {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
+      if (it->first >= head && it->second <= tail)
         {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
+          it = m_sackList.erase (it);
         }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      else
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          NS_ASSERT (it->second < head || it->first > tail);
+          ++it;
         }
-
-      ++it;
     }
 
+  m_sackList.push_front (current);
+
   // Since the maximum blocks that fits into a TCP header are 4, there's no
   // point on maintaining the others.
   if (m_sackList.size () > 4)
@@ -328,9 +318,7 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
     }
 
   // Please note that, if a block b is discarded and then a block contiguos
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
+  // to b is received, the b part is reported again, as part of the new block.
 }
 
 void
@@ -338,16 +326,19 @@ TcpRxBuffer::ClearSackList (const SequenceNumber32 &seq)
 {
   NS_LOG_FUNCTION (this << seq);
 
-  TcpOptionSack::SackList::iterator it;
-  for (it = m_sackList.begin (); it != m_sackList.end (); ++it)
+  TcpOptionSack::SackList::iterator it = m_sackList.begin ();
+  while (it != m_sackList.end ())
     {
-      TcpOptionSack::SackBlock block = *it;
-      NS_ASSERT (block.first < block.second);
+      NS_ASSERT (it->first < it->second);
 
-      if (block.second <= seq)
+      if (it->second <= seq)
         {
           it = m_sackList.erase (it);
         }
+      else
+        {
+          ++it;
+        }
     }
 }
 
@@ -366,7 +357,11 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return 0;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
+  NS_ASSERT (m_blocks.size () && m_blocks.begin ()->first == m_data.begin ()->first);
+  SequenceNumber32 blockTail = m_blocks.begin ()->second;
+  m_blocks.erase (m_blocks.begin ());
+
+  Ptr<Packet> outPkt = 0; // The packet that contains all the data to return
   BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
@@ -374,9 +369,10 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
       // Check if we send the whole pkt or just a partial
       uint32_t pktSize = i->second->GetSize ();
+      Ptr<Packet> part;
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
+          part = i->second;
           m_data.erase (i);
           m_size -= pktSize;
           m_availBytes -= pktSize;
@@ -384,14 +380,30 @@ TcpRxBuffer::Extract (uint32_t maxSize)
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
+          part = i->second->CreateFragment (0, extractSize);
           m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
           m_data.erase (i);
           m_size -= extractSize;
           m_availBytes -= extractSize;
           extractSize = 0;
         }
+
+      if (outPkt == 0)
+        { // The first part is returned as it is, without copying it
+          outPkt = part;
+        }
+      else
+        {
+          outPkt->AddAtEnd (part);
+        }
     }
+
+  // The head block now starts at the first byte not extracted
+  if (m_data.size () && m_data.begin ()->first < blockTail)
+    {
+      m_blocks[m_data.begin ()->first] = blockTail;
+    }
+
   if (outPkt->GetSize () == 0)
     {
       NS_LOG_LOGIC ("Nothing extracted.");
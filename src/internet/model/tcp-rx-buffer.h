@@ -53,6 +53,19 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * Data blocks
+ * -----------
+ *
+ * The received packets are stored as they arrive, keyed by their first
+ * sequence number. Besides them, the buffer keeps the map of the contiguous
+ * blocks of data received: every time a packet fills a hole, or it is
+ * adjacent to a block, the blocks are coalesced. Therefore, finding the
+ * overlaps of an incoming packet, advancing RCV.NXT and building the SACK
+ * block that contains the packet cost O(log n) in the number of blocks,
+ * instead of walking all the buffered packets. The packets themselves are
+ * never merged: Extract returns the stored packet (or a fragment of it)
+ * without copying the data, when it covers the requested amount.
+ *
  * SACK list
  * ---------
  *
@@ -139,9 +152,8 @@ public:
   /**
    * Insert a packet into the buffer and update the availBytes counter to
    * reflect the number of bytes ready to send to the application. This
-   * function handles overlap by triming the head of the inputted packet and
-   * removing data from the buffer that overlaps the tail of the inputted
-   * packet
+   * function handles overlap by storing only the parts of the inputted
+   * packet that fill the holes between the data already in the buffer
    *
    * \param p packet
    * \param tcph packet's TCP header
@@ -179,6 +191,10 @@ private:
   /**
    * \brief Update the sack list, with the block seq starting at the beginning
    *
+   * The block is the whole contiguous block of data which contains the
+   * segment that triggered the update; the blocks previously reported that
+   * are part of it are removed from the list.
+   *
    * Note: the maximum size of the block list is 4. Caller is free to
    * drop blocks at the end to accomodate header size; from RFC 2018:
    *
@@ -211,8 +227,21 @@ private:
 
   TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
+  /**
+   * \brief Store a part of a packet in the buffer
+   *
+   * \param p packet
+   * \param seq sequence number of the first byte of p
+   * \param head sequence number of the first byte to store
+   * \param tail sequence number after the last byte to store
+   */
+  void AddFragment (Ptr<Packet> p, const SequenceNumber32 &seq,
+                    const SequenceNumber32 &head, const SequenceNumber32 &tail);
+
   /// container for data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  /// container for the contiguous blocks of data
+  typedef std::map<SequenceNumber32, SequenceNumber32>::iterator BlockIterator;
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
@@ -220,6 +249,7 @@ private:
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
   std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  std::map<SequenceNumber32, SequenceNumber32> m_blocks; //!< Contiguous blocks of data, from their first sequence to the sequence after their last byte
 };
 
 } //namepsace ns3
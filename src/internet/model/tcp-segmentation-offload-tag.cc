@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-segmentation-offload-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TcpSegmentationOffloadTag);
+
+TcpSegmentationOffloadTag::TcpSegmentationOffloadTag ()
+  : m_segmentSize (0)
+{
+}
+
+TcpSegmentationOffloadTag::TcpSegmentationOffloadTag (uint32_t segmentSize)
+  : m_segmentSize (segmentSize)
+{
+}
+
+void
+TcpSegmentationOffloadTag::SetSegmentSize (uint32_t segmentSize)
+{
+  m_segmentSize = segmentSize;
+}
+
+uint32_t
+TcpSegmentationOffloadTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+TypeId
+TcpSegmentationOffloadTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpSegmentationOffloadTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpSegmentationOffloadTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpSegmentationOffloadTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+TcpSegmentationOffloadTag::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+TcpSegmentationOffloadTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_segmentSize);
+}
+
+void
+TcpSegmentationOffloadTag::Deserialize (TagBuffer i)
+{
+  m_segmentSize = i.ReadU32 ();
+}
+
+void
+TcpSegmentationOffloadTag::Print (std::ostream &os) const
+{
+  os << "TSO segment size=" << m_segmentSize;
+}
+
+} // namespace ns3
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TCP_SEGMENTATION_OFFLOAD_TAG_H
+#define TCP_SEGMENTATION_OFFLOAD_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Marks a TCP super-segment, spanning several segments
+ *
+ * With segmentation offload (see the TsoSegments attribute of
+ * TcpSocketBase), the socket hands down a single packet carrying several
+ * full-sized segments, with this tag holding the segment size. The packet
+ * travels as a whole until an interface whose MTU is too small for it,
+ * where Ipv4L3Protocol splits it into regular TCP segments instead of
+ * fragmenting it.
+ */
+class TcpSegmentationOffloadTag : public Tag
+{
+public:
+  TcpSegmentationOffloadTag ();
+
+  /**
+   * \brief Constructor
+   * \param segmentSize the size of the segments to split the payload into
+   */
+  TcpSegmentationOffloadTag (uint32_t segmentSize);
+
+  /**
+   * \brief Set the segment size
+   * \param segmentSize the size of the segments to split the payload into
+   */
+  void SetSegmentSize (uint32_t segmentSize);
+
+  /**
+   * \brief Get the segment size
+   * \return the size of the segments to split the payload into
+   */
+  uint32_t GetSegmentSize (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint32_t m_segmentSize; //!< Size of the segments
+};
+
+} // namespace ns3
+
+#endif /* TCP_SEGMENTATION_OFFLOAD_TAG_H */
@@ -51,6 +51,8 @@
 #include "tcp-option-ts.h"
 #include "tcp-option-sack-permitted.h"
 #include "tcp-option-sack.h"
+#include "tcp-option-accecn.h"
+#include "tcp-segmentation-offload-tag.h"
 #include "rtt-estimator.h"
 #include "tcp-congestion-ops.h"
 
@@ -62,6 +64,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("TcpSocketBase");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpSocketBase);
+NS_OBJECT_ENSURE_REGISTERED (TcpSocketState);
 
 TypeId
 TcpSocketBase::GetTypeId (void)
@@ -135,10 +138,50 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("Rack",
+                   "Mark segments lost by time, as RACK does (RFC 8985)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_rackEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Tlp",
+                   "Send Tail Loss Probes (RFC 8985); needs Rack and Sack",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_tlpEnabled),
+                   MakeBooleanChecker ())
     .AddAttribute ("UseEcn", "True to use ECN functionality",
                     BooleanValue (false),
                     MakeBooleanAccessor (&TcpSocketBase::m_ecn),
                     MakeBooleanChecker ())
+    .AddAttribute ("UseAccEcn",
+                   "True to negotiate Accurate ECN feedback, when using ECN",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_accEcnEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TsoSegments",
+                   "Maximum number of segments handed down to IPv4 in a single "
+                   "super-segment, which is split where the MTU requires it "
+                   "(1 disables segmentation offload)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_tsoSegments),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("HeaderPrediction",
+                   "Process the common segments of an established connection "
+                   "through the header prediction fast path",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpSocketBase::m_headerPrediction),
+                   MakeBooleanChecker ())
+    .AddAttribute ("GroSegments",
+                   "Maximum number of in-order data segments coalesced by the "
+                   "receiver and processed as one (1 disables receive offload)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_groSegments),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("GroTimeout",
+                   "Time a receive aggregate waits for more segments (0 "
+                   "coalesces only the segments received at the same instant)",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TcpSocketBase::m_groTimeout),
+                   MakeTimeChecker (Seconds (0)))
     .AddTraceSource ("RTO",
                      "Retransmission timeout",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_rto),
@@ -155,6 +198,10 @@ TcpSocketBase::GetTypeId (void)
                      "Highest sequence number ever sent in socket's life time",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_highTxMarkTrace),
                      "ns3::SequenceNumber32TracedValueCallback")
+    .AddTraceSource ("PacingRate",
+                     "The current TCP pacing rate",
+                     MakeTraceSourceAccessor (&TcpSocketBase::m_pacingRateTrace),
+                     "ns3::TcpSocketState::DataRateTracedValueCallback")
     .AddTraceSource ("State",
                      "TCP state",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_state),
@@ -233,6 +280,29 @@ TcpSocketState::GetTypeId (void)
     .SetParent<Object> ()
     .SetGroupName ("Internet")
     .AddConstructor <TcpSocketState> ()
+    .AddAttribute ("EnablePacing", "Pace the transmission of data segments",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketState::m_pacing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxPacingRate", "Upper bound of the pacing rate",
+                   DataRateValue (DataRate ("4Gb/s")),
+                   MakeDataRateAccessor (&TcpSocketState::m_maxPacingRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("PacingSsRatio",
+                   "Percentage of cWnd/SRTT used as pacing rate in slow start",
+                   UintegerValue (200),
+                   MakeUintegerAccessor (&TcpSocketState::m_pacingSsRatio),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("PacingCaRatio",
+                   "Percentage of cWnd/SRTT used as pacing rate in congestion avoidance",
+                   UintegerValue (120),
+                   MakeUintegerAccessor (&TcpSocketState::m_pacingCaRatio),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("PaceInitialWindow",
+                   "Pace the initial window, before any RTT has been measured",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketState::m_paceInitialWindow),
+                   MakeBooleanChecker ())
     .AddTraceSource ("CongestionWindow",
                      "The TCP connection's congestion window",
                      MakeTraceSourceAccessor (&TcpSocketState::m_cWnd),
@@ -257,6 +327,10 @@ TcpSocketState::GetTypeId (void)
                      "Next sequence number to send (SND.NXT)",
                      MakeTraceSourceAccessor (&TcpSocketState::m_nextTxSequence),
                      "ns3::SequenceNumber32TracedValueCallback")
+    .AddTraceSource ("PacingRate",
+                     "The current TCP pacing rate",
+                     MakeTraceSourceAccessor (&TcpSocketState::m_pacingRate),
+                     "ns3::TcpSocketState::DataRateTracedValueCallback")
   ;
   return tid;
 }
@@ -271,9 +345,18 @@ TcpSocketState::TcpSocketState (void)
     m_lastAckedSeq (0),
     m_congState (CA_OPEN),
     m_ecnState (ECN_DISABLED),
+    m_accEcn (false),
+    m_ackedCeBytes (0),
+    m_ackedCePackets (0),
     m_highTxMark (0),
     // Change m_nextTxSequence for non-zero initial sequence number
     m_nextTxSequence (0),
+    m_pacing (false),
+    m_maxPacingRate (DataRate ("4Gb/s")),
+    m_pacingRate (DataRate ("4Gb/s")),
+    m_pacingSsRatio (0),
+    m_pacingCaRatio (0),
+    m_paceInitialWindow (false),
     m_rcvTimestampValue (0),
     m_rcvTimestampEchoReply (0)
 {
@@ -289,8 +372,17 @@ TcpSocketState::TcpSocketState (const TcpSocketState &other)
     m_lastAckedSeq (other.m_lastAckedSeq),
     m_congState (other.m_congState),
     m_ecnState (other.m_ecnState),
+    m_accEcn (other.m_accEcn),
+    m_ackedCeBytes (other.m_ackedCeBytes),
+    m_ackedCePackets (other.m_ackedCePackets),
     m_highTxMark (other.m_highTxMark),
     m_nextTxSequence (other.m_nextTxSequence),
+    m_pacing (other.m_pacing),
+    m_maxPacingRate (other.m_maxPacingRate),
+    m_pacingRate (other.m_pacingRate),
+    m_pacingSsRatio (other.m_pacingSsRatio),
+    m_pacingCaRatio (other.m_pacingCaRatio),
+    m_paceInitialWindow (other.m_paceInitialWindow),
     m_rcvTimestampValue (other.m_rcvTimestampValue),
     m_rcvTimestampEchoReply (other.m_rcvTimestampEchoReply)
 {
@@ -308,6 +400,24 @@ TcpSocketState::EcnStateName[TcpSocketState::ECN_CWR_SENT+1] =
   "ECN_DISABLED", "ECN_IDLE", "ECN_CE_RCVD", "ECN_ECE_SENT", "ECN_ECE_RCVD", "ECN_CWR_SENT"
 };
 
+TcpInfo::TcpInfo ()
+  : m_state (TcpSocket::CLOSED),
+    m_congState (TcpSocketState::CA_OPEN),
+    m_ecnState (TcpSocketState::ECN_DISABLED),
+    m_segmentSize (0),
+    m_cWnd (0),
+    m_ssThresh (0),
+    m_bytesInFlight (0),
+    m_sackedBytes (0),
+    m_lostBytes (0),
+    m_rWnd (0),
+    m_deliveryRate (0),
+    m_bytesDelivered (0),
+    m_retransSegments (0),
+    m_ecnCeRcvd (0),
+    m_ecnCeEchoed (0)
+{
+}
 
 TcpSocketBase::TcpSocketBase (void)
   : TcpSocket (),
@@ -324,6 +434,9 @@ TcpSocketBase::TcpSocketBase (void)
     m_synRetries (0),
     m_dataRetrCount (0),
     m_dataRetries (0),
+    m_retransSegments (0),
+    m_ecnCeRcvd (0),
+    m_ecnCeEchoed (0),
     m_rto (Seconds (0.0)),
     m_minRto (Time::Max ()),
     m_clockGranularity (Seconds (0.001)),
@@ -360,17 +473,43 @@ TcpSocketBase::TcpSocketBase (void)
     m_timestampEnabled (true),
     m_timestampToEcho (0),
     m_sendPendingDataEvent (),
+    m_pacingEvent (),
+    m_tsoSegments (1),
+    m_headerPrediction (true),
+    m_headerPredicted (false),
+    m_fastPathAcks (0),
+    m_fastPathData (0),
+    m_slowPathSegments (0),
+    m_groSegments (1),
+    m_groTimeout (Seconds (0)),
+    m_groPacket (0),
+    m_groEcn (0),
+    m_groCount (0),
+    m_groEvent (),
     // Set m_recover to the initial sequence number
     m_recover (0),
     m_retxThresh (3),
     m_limitedTx (false),
+    m_rackEnabled (false),
+    m_tlpEnabled (false),
+    m_rackEvent (),
+    m_tlpEvent (),
+    m_tlpOutstanding (false),
+    m_tlpEndSeq (0),
     m_congestionControl (0),
     m_isFirstPartialAck (true),
     m_ecn(false),
     m_ecnEchoSeq (0),
     m_ecnCESeq (0),
-    m_ecnCWRSeq (0)
-    
+    m_ecnCWRSeq (0),
+    m_accEcnEnabled (false),
+    m_synEcn (0),
+    m_rAccEcnCep (5),
+    m_rAccEcnCeb (0),
+    m_rAccEcnE0b (1),
+    m_rAccEcnE1b (1),
+    m_sAccEcnCep (5),
+    m_sAccEcnCeb (0)
 {
   NS_LOG_FUNCTION (this);
   m_rxBuffer = CreateObject<TcpRxBuffer> ();
@@ -402,6 +541,10 @@ TcpSocketBase::TcpSocketBase (void)
   ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
                                           MakeCallback (&TcpSocketBase::UpdateHighTxMark, this));
   NS_ASSERT (ok == true);
+
+  ok = m_tcb->TraceConnectWithoutContext ("PacingRate",
+                                          MakeCallback (&TcpSocketBase::UpdatePacingRateTrace, this));
+  NS_ASSERT (ok == true);
 }
 
 TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
@@ -415,6 +558,9 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_synRetries (sock.m_synRetries),
     m_dataRetrCount (sock.m_dataRetrCount),
     m_dataRetries (sock.m_dataRetries),
+    m_retransSegments (0),
+    m_ecnCeRcvd (0),
+    m_ecnCeEchoed (0),
     m_rto (sock.m_rto),
     m_minRto (sock.m_minRto),
     m_clockGranularity (sock.m_clockGranularity),
@@ -446,15 +592,41 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_sndWindShift (sock.m_sndWindShift),
     m_timestampEnabled (sock.m_timestampEnabled),
     m_timestampToEcho (sock.m_timestampToEcho),
+    m_tsoSegments (sock.m_tsoSegments),
+    m_headerPrediction (sock.m_headerPrediction),
+    m_headerPredicted (false),
+    m_fastPathAcks (0),
+    m_fastPathData (0),
+    m_slowPathSegments (0),
+    m_groSegments (sock.m_groSegments),
+    m_groTimeout (sock.m_groTimeout),
+    m_groPacket (0),
+    m_groEcn (0),
+    m_groCount (0),
+    m_groEvent (),
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_rackEnabled (sock.m_rackEnabled),
+    m_tlpEnabled (sock.m_tlpEnabled),
+    m_rackEvent (),
+    m_tlpEvent (),
+    m_tlpOutstanding (false),
+    m_tlpEndSeq (sock.m_tlpEndSeq),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
     m_ecn (sock.m_ecn),
     m_ecnEchoSeq (sock.m_ecnEchoSeq),
-    m_ecnCWRSeq (sock.m_ecnCWRSeq)
+    m_ecnCWRSeq (sock.m_ecnCWRSeq),
+    m_accEcnEnabled (sock.m_accEcnEnabled),
+    m_synEcn (sock.m_synEcn),
+    m_rAccEcnCep (sock.m_rAccEcnCep),
+    m_rAccEcnCeb (sock.m_rAccEcnCeb),
+    m_rAccEcnE0b (sock.m_rAccEcnE0b),
+    m_rAccEcnE1b (sock.m_rAccEcnE1b),
+    m_sAccEcnCep (sock.m_sAccEcnCep),
+    m_sAccEcnCeb (sock.m_sAccEcnCeb)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Invoked the copy constructor");
@@ -504,6 +676,10 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
                                           MakeCallback (&TcpSocketBase::UpdateHighTxMark, this));
   NS_ASSERT (ok == true);
+
+  ok = m_tcb->TraceConnectWithoutContext ("PacingRate",
+                                          MakeCallback (&TcpSocketBase::UpdatePacingRateTrace, this));
+  NS_ASSERT (ok == true);
 }
 
 TcpSocketBase::~TcpSocketBase (void)
@@ -1220,11 +1396,28 @@ TcpSocketBase::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
                                          m_endPoint->GetLocalPort ());
   TcpHeader tcpHeader;
   packet->PeekHeader (tcpHeader);
-  if (header.GetEcn() == Ipv4Header::ECN_CE && m_ecnCESeq < tcpHeader.GetAckNumber ())
+  if (m_groCount > 0 && !GroCanExtend (packet, tcpHeader, header.GetEcn ()))
+    {
+      GroFlush ();
+    }
+  if (tcpHeader.GetFlags () & TcpHeader::SYN)
+    {
+      m_synEcn = header.GetEcn ();
+    }
+  if (header.GetEcn () == Ipv4Header::ECN_CE)
+    {
+      ++m_ecnCeRcvd;
+    }
+  if (m_tcb->m_accEcn)
+    {
+      // The feedback is carried by the counters, not by the ECN state machine
+      UpdateAccEcnCounters (header.GetEcn (), packet->GetSize () - tcpHeader.GetSerializedSize ());
+    }
+  else if (header.GetEcn() == Ipv4Header::ECN_CE && m_ecnCESeq < tcpHeader.GetSequenceNumber ())
     {
       NS_LOG_INFO ("Received CE flag is valid");
       NS_LOG_DEBUG (TcpSocketState::EcnStateName[m_tcb->m_ecnState] << " -> ECN_CE_RCVD");
-      m_ecnCESeq = tcpHeader.GetAckNumber ();
+      m_ecnCESeq = tcpHeader.GetSequenceNumber ();
       m_tcb->m_ecnState = TcpSocketState::ECN_CE_RCVD; 
       m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_ECN_IS_CE);
     }
@@ -1232,6 +1425,10 @@ TcpSocketBase::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
     {
       m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_ECN_NO_CE);
     }
+  if (GroHold (packet, tcpHeader, header.GetEcn (), fromAddress, toAddress))
+    {
+      return;
+    }
   DoForwardUp (packet, fromAddress, toAddress);
 }
 
@@ -1251,11 +1448,27 @@ TcpSocketBase::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
 
   TcpHeader tcpHeader;
   packet->PeekHeader (tcpHeader);
-  if (header.GetEcn() == Ipv6Header::ECN_CE && m_ecnCESeq < tcpHeader.GetAckNumber ())
+  if (m_groCount > 0 && !GroCanExtend (packet, tcpHeader, header.GetEcn ()))
+    {
+      GroFlush ();
+    }
+  if (tcpHeader.GetFlags () & TcpHeader::SYN)
+    {
+      m_synEcn = header.GetEcn ();
+    }
+  if (header.GetEcn () == Ipv6Header::ECN_CE)
+    {
+      ++m_ecnCeRcvd;
+    }
+  if (m_tcb->m_accEcn)
+    {
+      UpdateAccEcnCounters (header.GetEcn (), packet->GetSize () - tcpHeader.GetSerializedSize ());
+    }
+  else if (header.GetEcn() == Ipv6Header::ECN_CE && m_ecnCESeq < tcpHeader.GetSequenceNumber ())
     {
       NS_LOG_INFO ("Received CE flag is valid");
       NS_LOG_DEBUG (TcpSocketState::EcnStateName[m_tcb->m_ecnState] << " -> ECN_CE_RCVD");
-      m_ecnCESeq = tcpHeader.GetAckNumber ();
+      m_ecnCESeq = tcpHeader.GetSequenceNumber ();
       m_tcb->m_ecnState = TcpSocketState::ECN_CE_RCVD;  
       m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_ECN_IS_CE);
     }
@@ -1263,6 +1476,10 @@ TcpSocketBase::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
     {
       m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_ECN_NO_CE);
     }
+  if (GroHold (packet, tcpHeader, header.GetEcn (), fromAddress, toAddress))
+    {
+      return;
+    }
   DoForwardUp (packet, fromAddress, toAddress);
 }
 
@@ -1292,6 +1509,94 @@ TcpSocketBase::ForwardIcmp6 (Ipv6Address icmpSource, uint8_t icmpTtl,
     }
 }
 
+bool
+TcpSocketBase::GroCanExtend (Ptr<const Packet> packet, const TcpHeader &tcpHeader,
+                             uint8_t ecn) const
+{
+  uint8_t flags = tcpHeader.GetFlags () & ~(TcpHeader::ECE | TcpHeader::CWR);
+  if (m_groSegments <= 1 || m_state != ESTABLISHED || flags != TcpHeader::ACK
+      || packet->GetSize () <= tcpHeader.GetSerializedSize ()
+      || tcpHeader.HasOption (TcpOption::SACK))
+    {
+      return false;
+    }
+
+  if (m_groCount == 0)
+    {
+      // Out-of-order segments are not coalesced, so that each one is
+      // acknowledged at once as RFC 5681 requires
+      return tcpHeader.GetSequenceNumber () == m_rxBuffer->NextRxSequence ()
+             && m_rxBuffer->Size () == m_rxBuffer->Available ();
+    }
+
+  return ecn == m_groEcn
+         && tcpHeader.GetFlags () == m_groHeader.GetFlags ()
+         && tcpHeader.GetAce () == m_groHeader.GetAce ()
+         && tcpHeader.GetAckNumber () == m_groHeader.GetAckNumber ()
+         && tcpHeader.GetSequenceNumber () == m_groHeader.GetSequenceNumber () + m_groPacket->GetSize ();
+}
+
+bool
+TcpSocketBase::GroHold (Ptr<Packet> packet, const TcpHeader &tcpHeader, uint8_t ecn,
+                        const Address &fromAddress, const Address &toAddress)
+{
+  if (!GroCanExtend (packet, tcpHeader, ecn))
+    {
+      return false;
+    }
+
+  Ptr<Packet> payload = packet->Copy ();
+  TcpHeader header;
+  payload->RemoveHeader (header);
+
+  if (m_groCount == 0)
+    {
+      // The aggregate keeps the options of its first segment, whose
+      // timestamp is the one to echo (RFC 7323)
+      m_groPacket = payload;
+      m_groHeader = tcpHeader;
+      m_groEcn = ecn;
+      m_groFrom = fromAddress;
+      m_groTo = toAddress;
+      m_groEvent = Simulator::Schedule (m_groTimeout, &TcpSocketBase::GroFlush, this);
+    }
+  else
+    {
+      m_groPacket->AddAtEnd (payload);
+      m_groHeader.SetWindowSize (tcpHeader.GetWindowSize ());
+    }
+
+  NS_LOG_LOGIC (this << " holding seq " << tcpHeader.GetSequenceNumber () <<
+                " in an aggregate of " << m_groCount + 1 << " segments");
+  if (++m_groCount >= m_groSegments)
+    {
+      GroFlush ();
+    }
+  return true;
+}
+
+void
+TcpSocketBase::GroFlush (void)
+{
+  NS_LOG_FUNCTION (this << m_groCount);
+
+  m_groEvent.Cancel ();
+  if (m_groCount == 0)
+    {
+      return;
+    }
+
+  // The aggregate counts as the segments it carries for the delayed ACK,
+  // so that it is acknowledged at once if it holds more than one
+  m_delAckCount += m_groCount - 1;
+
+  Ptr<Packet> packet = m_groPacket;
+  packet->AddHeader (m_groHeader);
+  m_groPacket = 0;
+  m_groCount = 0;
+  DoForwardUp (packet, m_groFrom, m_groTo);
+}
+
 void
 TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
                             const Address &toAddress)
@@ -1321,7 +1626,7 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
       if (m_state == ESTABLISHED && !(tcpHeader.GetFlags () & TcpHeader::RST))
         {
           // Check if the sender has responded to ECN echo by reducing the Congestion Window
-          if (tcpHeader.GetFlags () & TcpHeader::CWR )
+          if (!m_tcb->m_accEcn && (tcpHeader.GetFlags () & TcpHeader::CWR))
             {
               // Check if a packet with CE bit set is received. If there is no CE bit set, then change the state to ECN_IDLE to 
               // stop sending ECN Echo messages. If there is CE bit set, the packet should continue sending ECN Echo messages
@@ -1349,6 +1654,15 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
 
   m_rxTrace (packet, tcpHeader, this);
 
+  if (m_state == ESTABLISHED)
+    {
+      if (m_headerPrediction && ProcessFastPath (packet, tcpHeader))
+        {
+          return;
+        }
+      ++m_slowPathSegments;
+    }
+
   if (tcpHeader.GetFlags () & TcpHeader::SYN)
     {
       /* The window field in a segment where the SYN bit is set (i.e., a <SYN>
@@ -1666,6 +1980,15 @@ TcpSocketBase::EnterRecovery ()
   NS_LOG_DEBUG (TcpSocketState::TcpCongStateName[m_tcb->m_congState] <<
                 " -> CA_RECOVERY");
 
+  // RFC 3168, Section 6.1.2: the window is reduced at most once per window
+  // of data, for a loss or for an ECN Echo. While the segment carrying the
+  // CWR flag is not acknowledged, the window has already been reduced for
+  // this window of data (the state may have moved from CA_CWR to
+  // CA_DISORDER meanwhile), and the recovery keeps it, as Linux does in
+  // tcp_enter_recovery.
+  bool ecnReduced = m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED
+    && m_highRxAckMark.Get () <= m_ecnCWRSeq.Get ();
+
   // RFC 6675, point (4):
   // (4) Invoke fast retransmit and enter loss recovery as follows:
   // (4.1) RecoveryPoint = HighData
@@ -1675,9 +1998,19 @@ TcpSocketBase::EnterRecovery ()
   m_tcb->m_congState = TcpSocketState::CA_RECOVERY;
 
   // (4.2) ssthresh = cwnd = (FlightSize / 2)
-  m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb,
-                                                        BytesInFlight ());
-  m_tcb->m_cWnd = m_tcb->m_ssThresh;
+  if (ecnReduced)
+    {
+      NS_LOG_INFO ("Window already reduced in response to an ECN Echo");
+    }
+  else
+    {
+      m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb,
+                                                            BytesInFlight ());
+      if (!m_congestionControl->HasCongControl ())
+        {
+          m_tcb->m_cWnd = m_tcb->m_ssThresh;
+        }
+    }
 
   NS_LOG_INFO (m_dupAckCount << " dupack. Enter fast recovery mode." <<
                "Reset cwnd to " << m_tcb->m_cWnd << ", ssthresh to " <<
@@ -1699,16 +2032,18 @@ TcpSocketBase::DupAck ()
   // NOTE: We count also the dupAcks received in CA_RECOVERY
   ++m_dupAckCount;
 
-  if (m_tcb->m_congState == TcpSocketState::CA_OPEN)
+  if (m_tcb->m_congState == TcpSocketState::CA_OPEN
+      || m_tcb->m_congState == TcpSocketState::CA_CWR)
     {
-      // From Open we go Disorder
+      // From Open (or CWR) we go Disorder
       NS_ASSERT_MSG (m_dupAckCount == 1, "From OPEN->DISORDER but with " <<
                      m_dupAckCount << " dup ACKs");
 
+      NS_LOG_DEBUG (TcpSocketState::TcpCongStateName[m_tcb->m_congState] <<
+                    " -> DISORDER");
+
       m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_DISORDER);
       m_tcb->m_congState = TcpSocketState::CA_DISORDER;
-
-      NS_LOG_DEBUG ("OPEN -> DISORDER");
     }
 
   if (m_tcb->m_congState == TcpSocketState::CA_DISORDER)
@@ -1765,6 +2100,14 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   NS_ASSERT (0 != (tcpHeader.GetFlags () & TcpHeader::ACK));
   NS_ASSERT (m_tcb->m_segmentSize > 0);
 
+  if (m_headerPredicted)
+    {
+      ReceivedPredictedAck (packet, tcpHeader);
+      return;
+    }
+
+  uint32_t priorInFlight = m_bytesInFlight.Get ();
+
   // RFC 6675, Section 5, 1st paragraph:
   // Upon the receipt of any ACK containing SACK information, the
   // scoreboard MUST be updated via the Update () routine (done in ReadOptions)
@@ -1773,8 +2116,13 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 
   SequenceNumber32 ackNumber = tcpHeader.GetAckNumber ();
 
-  if (ackNumber > m_txBuffer->HeadSequence () && (m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED) && (tcpHeader.GetFlags () & TcpHeader::ECE))
+  if (m_tcb->m_accEcn)
+    {
+      ProcessAccEcnFeedback (tcpHeader);
+    }
+  else if (ackNumber > m_txBuffer->HeadSequence () && (m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED) && (tcpHeader.GetFlags () & TcpHeader::ECE))
         {
+          ++m_ecnCeEchoed;
           if (m_ecnEchoSeq < tcpHeader.GetAckNumber ())
             {
               NS_LOG_INFO ("Received ECN Echo is valid");
@@ -1788,6 +2136,21 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   // are inside the function ProcessAck
   ProcessAck (ackNumber, scoreboardUpdated);
 
+  // RFC 8985: the segments lost by time must be marked before the scoreboard
+  // is queried for the next segment to send
+  if (m_rackEnabled && m_sackEnabled)
+    {
+      RackDetectLoss ();
+    }
+
+  ProcessRateSample (priorInFlight);
+
+  // The CE counts of this ACK have been passed to the congestion control,
+  // with the newly acked segments or with the duplicate ACK: they must not
+  // be reported again with the next ACK
+  m_tcb->m_ackedCeBytes = 0;
+  m_tcb->m_ackedCePackets = 0;
+
   // RFC 6675, Section 5, point (C), try to send more data. NB: (C) is implemented
   // inside SendPendingData
   SendPendingData (m_connected);
@@ -1955,6 +2318,21 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
               NS_LOG_DEBUG (segsAcked << " segments acked in CA_DISORDER, ack of " <<
                             ackNumber << " exiting CA_DISORDER -> CA_OPEN");
             }
+          // The window has been reduced once in response to an ECN Echo;
+          // the reduction lasts until the segment carrying the CWR flag
+          // is acknowledged
+          else if (m_tcb->m_congState == TcpSocketState::CA_CWR)
+            {
+              m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt);
+              if (ackNumber > m_ecnCWRSeq)
+                {
+                  m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_COMPLETE_CWR);
+                  m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
+                  m_tcb->m_congState = TcpSocketState::CA_OPEN;
+                  NS_LOG_DEBUG (segsAcked << " segments acked in CA_CWR, ack of " <<
+                                ackNumber << " exiting CA_CWR -> CA_OPEN");
+                }
+            }
           // RFC 6675, Section 5:
           // Once a TCP is in the loss recovery phase, the following procedure
           // MUST be used for each arriving ACK:
@@ -2009,6 +2387,149 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
     }
 }
 
+bool
+TcpSocketBase::ProcessFastPath (Ptr<Packet> packet, const TcpHeader& tcpHeader)
+{
+  NS_LOG_FUNCTION (this << tcpHeader);
+
+  // The prediction: only ACK (PSH is not honoured), nothing that needs the
+  // generic code, and the window and sequence number we expect
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::ECE | TcpHeader::CWR);
+  uint32_t receivedWindow = static_cast<uint32_t> (tcpHeader.GetWindowSize ()) << m_sndWindShift;
+  if (tcpflags != TcpHeader::ACK
+      || receivedWindow != m_rWnd.Get () || receivedWindow == 0
+      || tcpHeader.GetSequenceNumber () != m_rxBuffer->NextRxSequence ()
+      || tcpHeader.HasOption (TcpOption::SACK)
+      || (m_timestampEnabled && !tcpHeader.HasOption (TcpOption::TS))
+      || m_persistEvent.IsRunning ())
+    {
+      return false;
+    }
+
+  // No new ECN feedback: no ECE or CWR, or with AccECN no new CE count
+  if (m_tcb->m_accEcn)
+    {
+      if (tcpHeader.GetAce () != (m_sAccEcnCep & 0x7))
+        {
+          return false;
+        }
+      Ptr<const TcpOptionAccEcn> option;
+      if (tcpHeader.HasOption (TcpOption::ACCECN0))
+        {
+          option = DynamicCast<const TcpOptionAccEcn> (tcpHeader.GetOption (TcpOption::ACCECN0));
+        }
+      else if (tcpHeader.HasOption (TcpOption::ACCECN1))
+        {
+          option = DynamicCast<const TcpOptionAccEcn> (tcpHeader.GetOption (TcpOption::ACCECN1));
+        }
+      if (option != 0 && option->HasField (1)
+          && ((option->GetCeb () - m_sAccEcnCeb) & TcpOptionAccEcn::COUNTER_MASK) != 0)
+        {
+          return false;
+        }
+    }
+  else if (tcpHeader.GetFlags () & (TcpHeader::ECE | TcpHeader::CWR))
+    {
+      return false;
+    }
+
+  SequenceNumber32 ackNumber = tcpHeader.GetAckNumber ();
+  SequenceNumber32 headSequence = m_txBuffer->HeadSequence ();
+  if (packet->GetSize () == 0)
+    {
+      // Pure ACK of new data, in the Open state
+      if (ackNumber <= headSequence || ackNumber > m_tcb->m_highTxMark
+          || m_tcb->m_congState != TcpSocketState::CA_OPEN)
+        {
+          return false;
+        }
+      ++m_fastPathAcks;
+    }
+  else
+    {
+      // In-order data, while we have nothing outstanding or to send, and
+      // no ECN Echo to send
+      if (ackNumber != headSequence || headSequence != m_tcb->m_highTxMark
+          || m_txBuffer->Size () != 0
+          || m_rxBuffer->Size () != m_rxBuffer->Available ()
+          || tcpHeader.GetSequenceNumber () + packet->GetSize () > m_rxBuffer->MaxRxSequence ()
+          || m_tcb->m_ecnState == TcpSocketState::ECN_CE_RCVD
+          || m_tcb->m_ecnState == TcpSocketState::ECN_ECE_SENT)
+        {
+          return false;
+        }
+      ++m_fastPathData;
+    }
+
+  if (m_timestampEnabled)
+    {
+      ProcessOptionTimestamp (tcpHeader.GetOption (TcpOption::TS),
+                              tcpHeader.GetSequenceNumber ());
+    }
+  EstimateRtt (tcpHeader);
+  UpdateWindowSize (tcpHeader);
+
+  // ReceivedAck may be overridden, so it is still called; it takes its
+  // own fast path for the predicted segment
+  m_headerPredicted = true;
+  ReceivedAck (packet, tcpHeader);
+  m_headerPredicted = false;
+  return true;
+}
+
+void
+TcpSocketBase::ReceivedPredictedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
+{
+  NS_LOG_FUNCTION (this << tcpHeader);
+
+  SequenceNumber32 ackNumber = tcpHeader.GetAckNumber ();
+  m_tcb->m_lastAckedSeq = ackNumber;
+
+  if (packet->GetSize () > 0)
+    {
+      // Nothing is outstanding: ProcessAck () would have nothing to do
+      ReceivedData (packet, tcpHeader);
+      return;
+    }
+
+  // As ProcessAck () for a new ACK in CA_OPEN
+  uint32_t priorInFlight = m_bytesInFlight.Get ();
+  uint32_t bytesAcked = ackNumber - m_txBuffer->HeadSequence ();
+  uint32_t segsAcked  = bytesAcked / m_tcb->m_segmentSize;
+  m_bytesAckedNotProcessed += bytesAcked % m_tcb->m_segmentSize;
+  if (m_bytesAckedNotProcessed >= m_tcb->m_segmentSize)
+    {
+      segsAcked += 1;
+      m_bytesAckedNotProcessed -= m_tcb->m_segmentSize;
+    }
+  NS_LOG_DEBUG (segsAcked << " segments acked in the fast path, ack of " << ackNumber);
+  m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt);
+  m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+  m_dupAckCount = 0;
+  NewAck (ackNumber, true);
+
+  if (m_rackEnabled && m_sackEnabled)
+    {
+      RackDetectLoss ();
+    }
+  ProcessRateSample (priorInFlight);
+  SendPendingData (m_connected);
+}
+
+void
+TcpSocketBase::ProcessRateSample (uint32_t priorInFlight)
+{
+  NS_LOG_FUNCTION (this << priorInFlight);
+
+  TcpRateSample rs = m_txBuffer->GenerateRateSample ();
+  if (m_congestionControl->HasCongControl ())
+    {
+      rs.m_priorInFlight = priorInFlight;
+      rs.m_bytesInFlight = BytesInFlight ();
+      m_congestionControl->CongControl (m_tcb, rs);
+    }
+}
+
 /* Received a packet upon LISTEN state. */
 void
 TcpSocketBase::ProcessListen (Ptr<Packet> packet, const TcpHeader& tcpHeader,
@@ -2072,6 +2593,7 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       /* Check if we recieved an ECN SYN packet. Change the ECN state of receiver to ECN_IDLE if the traffic is ECN capable and 
        * sender has sent ECN SYN packet
        */
+      m_tcb->m_accEcn = IsAccEcnSyn (tcpHeader);
       if (m_ecn && (tcpHeader.GetFlags () & (TcpHeader::CWR | TcpHeader::ECE)) == (TcpHeader::CWR | TcpHeader::ECE))
         {
           NS_LOG_INFO ("Received ECN SYN packet");
@@ -2096,12 +2618,23 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       m_rxBuffer->SetNextRxSequence (tcpHeader.GetSequenceNumber () + SequenceNumber32 (1));
       m_tcb->m_highTxMark = ++m_tcb->m_nextTxSequence;
       m_txBuffer->SetHeadSequence (m_tcb->m_nextTxSequence);
+
+      /* A SYN-ACK with an ACE field other than 0b000 (no ECN) and 0b001 (classic ECN) accepts AccECN;
+       * it is known before the ACK is sent, which starts the AccECN feedback
+       */
+      m_tcb->m_accEcn = m_ecn && m_accEcnEnabled && tcpHeader.GetAce () > 1;
       SendEmptyPacket (TcpHeader::ACK);
 
       /* Check if we received an ECN SYN-ACK packet. Change the ECN state of sender to ECN_IDLE if receiver has sent an ECN SYN-ACK 
        * packet and the  traffic is ECN Capable
        */
-      if (m_ecn && (tcpHeader.GetFlags () & (TcpHeader::CWR | TcpHeader::ECE)) == (TcpHeader::ECE))
+      if (m_tcb->m_accEcn)
+        {
+          NS_LOG_INFO ("Received AccECN SYN-ACK packet.");
+          m_tcb->m_ecnState = TcpSocketState::ECN_IDLE;
+          NS_LOG_DEBUG (TcpSocketState::EcnStateName[m_tcb->m_ecnState] << " -> ECN_IDLE");
+        }
+      else if (m_ecn && (tcpHeader.GetFlags () & (TcpHeader::CWR | TcpHeader::ECE)) == (TcpHeader::ECE))
         {
           NS_LOG_INFO ("Received ECN SYN-ACK packet.");
           m_tcb->m_ecnState = TcpSocketState::ECN_IDLE;
@@ -2181,6 +2714,7 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
       /* Check if we received an ECN SYN packet. Change the ECN state of receiver to ECN_IDLE if sender has sent an ECN SYN 
        * packet and the  traffic is ECN Capable
        */
+      m_tcb->m_accEcn = IsAccEcnSyn (tcpHeader);
       if (m_ecn && (tcpHeader.GetFlags () & (TcpHeader::CWR | TcpHeader::ECE)) == (TcpHeader::CWR | TcpHeader::ECE))
         {
           NS_LOG_INFO ("Received ECN SYN packet");
@@ -2503,7 +3037,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     {
       SocketIpTosTag ipTosTag;
       NS_LOG_LOGIC (" ECT bits should be set on pure ACK and SYN packets in DCTCP");
-      if (m_congestionControl->GetName () == "TcpDctcp" && (GetIpTos () & 0x3) == 0)
+      if (IsL4S () && (GetIpTos () & 0x3) == 0)
         { 
           ipTosTag.SetTos (GetIpTos () | 0x1);
         }
@@ -2515,7 +3049,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     }
   else
     {
-      if (m_congestionControl->GetName () == "TcpDctcp")
+      if (IsL4S ())
         {
           SocketIpTosTag ipTosTag;
           ipTosTag.SetTos (0x1);
@@ -2526,7 +3060,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
   if (IsManualIpv6Tclass ())
     {
       SocketIpv6TclassTag ipTclassTag;
-      if (m_congestionControl->GetName () == "TcpDctcp" && (GetIpv6Tclass () & 0x3) == 0)
+      if (IsL4S () && (GetIpv6Tclass () & 0x3) == 0)
         {
           ipTclassTag.SetTclass (GetIpv6Tclass () | 0x1);
         }
@@ -2538,7 +3072,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     }
   else
     {
-      if (m_congestionControl->GetName () == "TcpDctcp")
+      if (IsL4S ())
         {
           SocketIpv6TclassTag ipTclassTag;
           ipTclassTag.SetTclass (0x1);
@@ -2616,6 +3150,16 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
           AddOptionSackPermitted (header);
         }
 
+      if (m_ecn && m_accEcnEnabled && (flags & (TcpHeader::CWR | TcpHeader::ECE)) == (TcpHeader::CWR | TcpHeader::ECE))
+        { // An AccECN SYN carries AE, CWR and ECE
+          header.SetAe (true);
+        }
+      else if ((flags & TcpHeader::ACK) && m_tcb->m_accEcn)
+        { // The ACE field of an AccECN SYN-ACK echoes the IP-ECN field of the SYN
+          static const uint8_t synAckAce[4] = { 0x2, 0x3, 0x4, 0x6 };
+          header.SetAce (synAckAce[m_synEcn & 0x3]);
+        }
+
       if (m_synCount == 0)
         { // No more connection retries, give up
           NS_LOG_LOGIC ("Connection failed.");
@@ -2811,6 +3355,7 @@ TcpSocketBase::CompleteFork (Ptr<Packet> p, const TcpHeader& h,
   /* Check if we received an ECN SYN packet. Change the ECN state of receiver to ECN_IDLE if sender has sent an ECN SYN 
    * packet and the traffic is ECN Capable
    */
+  m_tcb->m_accEcn = IsAccEcnSyn (h);
   if (m_ecn && (h.GetFlags () & (TcpHeader::CWR | TcpHeader::ECE)) == (TcpHeader::CWR | TcpHeader::ECE))
     {
       SendEmptyPacket (TcpHeader::SYN | TcpHeader::ACK | TcpHeader::ECE);
@@ -2851,10 +3396,8 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       isRetransmission = true;
     }
 
-  Ptr<Packet> p = m_txBuffer->CopyFromSequence (maxSize, seq);
-  uint32_t sz = p->GetSize (); // Size of packet
+  Ptr<Packet> p = m_txBuffer->CopyFromSequence (std::min (maxSize, m_tcb->m_segmentSize), seq);
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
-  uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
 
   if (withAck)
     {
@@ -2868,7 +3411,10 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       NS_LOG_INFO ("Backoff mechanism by reducing CWND  by half because we've received ECN Echo");
       m_congestionControl->ReduceCwnd (m_tcb);
       m_tcb->m_ssThresh = m_tcb->m_cWnd;
-      flags |= TcpHeader::CWR; 
+      if (!m_tcb->m_accEcn)
+        { // With AccECN, the CWR flag is part of the ACE field
+          flags |= TcpHeader::CWR;
+        }
       m_ecnCWRSeq = seq;
       m_tcb->m_ecnState = TcpSocketState::ECN_CWR_SENT;
       NS_LOG_DEBUG (TcpSocketState::EcnStateName[m_tcb->m_ecnState] << " -> ECN_CWR_SENT");
@@ -2881,6 +3427,26 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
         }
     }
 
+  // A super-segment is built one segment at a time, so that the scoreboard
+  // keeps one item per segment. Like RFC 3168 asks, CWR is only sent on a
+  // single segment.
+  if (maxSize > m_tcb->m_segmentSize && !(flags & TcpHeader::CWR))
+    {
+      while (p->GetSize () < maxSize
+             && m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (p->GetSize ())) > 0)
+        {
+          uint32_t s = std::min (maxSize - p->GetSize (), m_tcb->m_segmentSize);
+          p->AddAtEnd (m_txBuffer->CopyFromSequence (s, seq + SequenceNumber32 (p->GetSize ())));
+        }
+    }
+  uint32_t sz = p->GetSize (); // Size of packet
+  uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
+  if (sz > m_tcb->m_segmentSize)
+    {
+      TcpSegmentationOffloadTag tsoTag (m_tcb->m_segmentSize);
+      p->AddPacketTag (tsoTag);
+    }
+
   /*
    * Add tags for each socket option.
    * Note that currently the socket adds both IPv4 tag and IPv6 tag
@@ -2894,7 +3460,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       if (m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED && (GetIpTos () & 0x3) == 0 && !isRetransmission)
         { 
           //Classic traffic have ECT0 flags whereas L4S have ECT1 flags set
-          if (m_congestionControl->GetName () == "TcpDctcp")
+          if (IsL4S ())
             {
               ipTosTag.SetTos (GetIpTos () | 0x1);
             }
@@ -2915,7 +3481,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
         {
           SocketIpTosTag ipTosTag;
           //Classic traffic have ECT0 flags whereas L4S have ECT1 flags set
-          if (m_congestionControl->GetName () == "TcpDctcp")
+          if (IsL4S ())
             {
               ipTosTag.SetTos (0x1);
             }
@@ -2933,7 +3499,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       if (m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED && (GetIpv6Tclass () & 0x3) == 0 && !isRetransmission)
         {
           //Classic traffic have ECT0 flags whereas L4S have ECT1 flags set
-          if (m_congestionControl->GetName () == "TcpDctcp")
+          if (IsL4S ())
             {
               ipTclassTag.SetTclass (GetIpv6Tclass () | 0x1);
             }
@@ -2954,7 +3520,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
         {
           SocketIpv6TclassTag ipTclassTag;
           //Classic traffic have ECT0 flags whereas L4S have ECT1 flags set
-          if (m_congestionControl->GetName () == "TcpDctcp")
+          if (IsL4S ())
             {
               ipTclassTag.SetTclass (0x1);
             }
@@ -3049,6 +3615,10 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
     }
 
   UpdateRttHistory (seq, sz, isRetransmission);
+  if (isRetransmission)
+    {
+      ++m_retransSegments;
+    }
 
   // Notify the application of the data being sent unless this is a retransmit
   if (seq + sz > m_tcb->m_highTxMark)
@@ -3058,6 +3628,11 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
     }
   // Update highTxMark
   m_tcb->m_highTxMark = std::max (seq + sz, m_tcb->m_highTxMark.Get ());
+
+  if (!isRetransmission)
+    {
+      ScheduleTlp ();
+    }
   return sz;
 }
 
@@ -3101,6 +3676,20 @@ TcpSocketBase::SendPendingData (bool withAck)
       return false; // Is this the right way to handle this condition?
     }
 
+  // Until the first RTT sample, the initial window is sent as a burst
+  // unless PaceInitialWindow is set
+  bool pace = m_tcb->m_pacing
+    && (m_tcb->m_paceInitialWindow || m_rtt->GetNSamples () > 0);
+  if (pace)
+    {
+      if (m_pacingEvent.IsRunning ())
+        {
+          NS_LOG_INFO ("Pacing timer running; wait for it to expire");
+          return 0;
+        }
+      UpdatePacingRate ();
+    }
+
   uint32_t nPacketsSent = 0;
   uint32_t availableWindow = AvailableWindow ();
 
@@ -3152,6 +3741,14 @@ TcpSocketBase::SendPendingData (bool withAck)
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
 
+          // With segmentation offload, new data goes down in super-segments
+          // of as many full segments as the window allows
+          if (m_tsoSegments > 1 && m_endPoint != 0 && next == m_tcb->m_highTxMark
+              && availableWindow >= 2 * m_tcb->m_segmentSize)
+            {
+              s = std::min (availableWindow / m_tcb->m_segmentSize, m_tsoSegments) * m_tcb->m_segmentSize;
+            }
+
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
           //       retransmitted segment unless NextSeg () rule (4) was
@@ -3184,6 +3781,16 @@ TcpSocketBase::SendPendingData (bool withAck)
                         " size " << sz);
 
           ++nPacketsSent;
+
+          if (pace)
+            {
+              // A single segment per pacing interval: the timer sends the
+              // next one
+              Time gap = m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz);
+              NS_LOG_DEBUG ("Pacing at " << m_tcb->m_pacingRate << ", next segment in " << gap);
+              m_pacingEvent = Simulator::Schedule (gap, &TcpSocketBase::NotifyPacingPerformed, this);
+              break;
+            }
         }
 
       // (C.4) The estimate of the amount of data outstanding in the
@@ -3201,9 +3808,48 @@ TcpSocketBase::SendPendingData (bool withAck)
     {
       NS_LOG_DEBUG ("SendPendingData sent " << nPacketsSent << " segments");
     }
+
+  // All the data has been sent, and the window is not full: the delivery
+  // rate is limited by the application until this flight is delivered
+  if (m_tcb->m_highTxMark >= m_txBuffer->TailSequence ()
+      && m_bytesInFlight.Get () < m_tcb->m_cWnd)
+    {
+      m_txBuffer->MarkAppLimited (m_bytesInFlight.Get ());
+    }
   return nPacketsSent;
 }
 
+void
+TcpSocketBase::UpdatePacingRate (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_congestionControl->SetsPacingRate ())
+    {
+      return;
+    }
+
+  Time srtt = m_rtt->GetEstimate ();
+  if (srtt.IsZero ())
+    {
+      return;
+    }
+
+  // Like Linux, pace faster in slow start so that the window can still
+  // double every RTT
+  uint16_t ratio = m_tcb->m_cWnd < m_tcb->m_ssThresh / 2 ? m_tcb->m_pacingSsRatio
+                                                         : m_tcb->m_pacingCaRatio;
+  double bps = m_tcb->m_cWnd * 8.0 * ratio / 100.0 / srtt.GetSeconds ();
+  DataRate rate (std::max (static_cast<uint64_t> (bps), static_cast<uint64_t> (1)));
+  m_tcb->m_pacingRate = std::min (rate, m_tcb->m_maxPacingRate);
+}
+
+void
+TcpSocketBase::NotifyPacingPerformed (void)
+{
+  NS_LOG_FUNCTION (this);
+  SendPendingData (m_connected);
+}
+
 uint32_t
 TcpSocketBase::UnAckDataCount () const
 {
@@ -3484,6 +4130,14 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
                     (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
       m_retxEvent.Cancel ();
     }
+
+  // RFC 8985, Section 7.2: the probe timer is restarted by an ACK of new
+  // data, and the episode ends when the probe is acknowledged
+  if (m_tlpOutstanding && ack >= m_tlpEndSeq)
+    {
+      m_tlpOutstanding = false;
+    }
+  ScheduleTlp ();
 }
 
 // Retransmit timeout
@@ -3548,6 +4202,10 @@ TcpSocketBase::ReTxTimeout ()
   // Reset dupAckCount
   m_dupAckCount = 0;
 
+  // The probe did not help
+  m_tlpEvent.Cancel ();
+  m_tlpOutstanding = false;
+
   // Please don't reset highTxMark, it is used for retransmission detection
 
   // When a TCP sender detects segment loss using the retransmission timer
@@ -3641,7 +4299,7 @@ TcpSocketBase::PersistTimeout ()
     {
       SocketIpTosTag ipTosTag;
       //Classic traffic have ECT0 flags whereas L4S have ECT1 flags set
-      if (m_congestionControl->GetName () == "TcpDctcp")
+      if (IsL4S ())
         {  
           ipTosTag.SetTos (0x1);
         }
@@ -3653,7 +4311,7 @@ TcpSocketBase::PersistTimeout ()
  
       SocketIpv6TclassTag ipTclassTag;
       //Classic traffic have ECT0 flags whereas L4S have ECT1 flags set
-      if (m_congestionControl->GetName () == "TcpDctcp")
+      if (IsL4S ())
         {
           ipTclassTag.SetTclass (0x1);
         }
@@ -3748,6 +4406,123 @@ TcpSocketBase::DoRetransmit ()
   NS_LOG_DEBUG ("retxing seq " << m_txBuffer->HeadSequence ());
 }
 
+void
+TcpSocketBase::RackDetectLoss (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time timeout;
+  bool lost = m_txBuffer->RackDetectLoss (m_rtt->GetEstimate (),
+                                          m_tcb->m_congState == TcpSocketState::CA_RECOVERY,
+                                          m_retxThresh, &timeout);
+
+  m_rackEvent.Cancel ();
+  if (timeout.IsStrictlyPositive ())
+    {
+      NS_LOG_LOGIC ("RACK reordering timer expires in " << timeout.GetSeconds () << " s");
+      m_rackEvent = Simulator::Schedule (timeout, &TcpSocketBase::RackTimeout, this);
+    }
+
+  // RFC 8985, Section 6.2: a loss detected by RACK starts the recovery, as
+  // the dupAck threshold does
+  if (lost
+      && (m_tcb->m_congState == TcpSocketState::CA_OPEN
+          || m_tcb->m_congState == TcpSocketState::CA_CWR
+          || m_tcb->m_congState == TcpSocketState::CA_DISORDER)
+      && m_highRxAckMark >= m_recover)
+    {
+      NS_LOG_INFO ("RACK detected a loss");
+      EnterRecovery ();
+    }
+}
+
+void
+TcpSocketBase::RackTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+  RackDetectLoss ();
+  SendPendingData (m_connected);
+}
+
+void
+TcpSocketBase::ScheduleTlp (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_tlpEnabled || !m_rackEnabled || !m_sackEnabled)
+    {
+      return;
+    }
+
+  m_tlpEvent.Cancel ();
+  if (m_tlpOutstanding
+      || (m_tcb->m_congState != TcpSocketState::CA_OPEN
+          && m_tcb->m_congState != TcpSocketState::CA_CWR)
+      || m_txBuffer->HeadSequence () >= m_tcb->m_highTxMark
+      || !m_retxEvent.IsRunning ())
+    {
+      return;
+    }
+
+  // RFC 8985, Section 7.2. The delayed ACK timeout of the peer is not
+  // known: use ours.
+  Time srtt = m_rtt->GetEstimate ();
+  Time pto = srtt.IsZero () ? Seconds (1) : srtt + srtt;
+  if (UnAckDataCount () <= m_tcb->m_segmentSize)
+    {
+      pto += m_delAckTimeout;
+    }
+
+  if (pto >= Simulator::GetDelayLeft (m_retxEvent))
+    {
+      NS_LOG_LOGIC ("The RTO expires before the probe timeout " << pto.GetSeconds ());
+      return;
+    }
+
+  NS_LOG_LOGIC ("Schedule a Tail Loss Probe in " << pto.GetSeconds () << " s");
+  m_tlpEvent = Simulator::Schedule (pto, &TcpSocketBase::TlpTimeout, this);
+}
+
+void
+TcpSocketBase::TlpTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if ((m_tcb->m_congState != TcpSocketState::CA_OPEN
+       && m_tcb->m_congState != TcpSocketState::CA_CWR)
+      || m_txBuffer->HeadSequence () >= m_tcb->m_highTxMark)
+    {
+      return;
+    }
+
+  // RFC 8985, Section 7.3: send one new segment, if available and allowed
+  // by the receiver window, or retransmit the last one
+  SequenceNumber32 seq;
+  uint32_t sz;
+  if (m_txBuffer->SizeFromSequence (m_tcb->m_highTxMark) > 0
+      && m_rWnd.Get () >= UnAckDataCount () + m_tcb->m_segmentSize)
+    {
+      seq = m_tcb->m_highTxMark;
+      sz = SendDataPacket (seq, m_tcb->m_segmentSize, m_connected);
+      m_tcb->m_nextTxSequence = std::max (m_tcb->m_nextTxSequence.Get (), seq + sz);
+    }
+  else
+    {
+      // The last segment may be shorter than a full segment: start from
+      // its first byte, as it was sent
+      seq = m_txBuffer->LastSentSequence ();
+      sz = SendDataPacket (seq, m_tcb->m_segmentSize, true);
+    }
+
+  NS_LOG_INFO ("Tail Loss Probe [" << seq << ";" << seq + sz << ")");
+  m_tlpOutstanding = true;
+  m_tlpEndSeq = m_tcb->m_highTxMark;
+
+  // The RTO is restarted after the probe
+  m_retxEvent.Cancel ();
+  m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+}
+
 void
 TcpSocketBase::CancelAllTimers ()
 {
@@ -3757,6 +4532,13 @@ TcpSocketBase::CancelAllTimers ()
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
+  m_pacingEvent.Cancel ();
+  m_rackEvent.Cancel ();
+  m_tlpEvent.Cancel ();
+  // A pending receive aggregate has not been acknowledged yet
+  m_groEvent.Cancel ();
+  m_groPacket = 0;
+  m_groCount = 0;
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -3948,6 +4730,11 @@ TcpSocketBase::AddOptions (TcpHeader& header)
     {
       AddOptionTimestamp (header);
     }
+
+  if (m_tcb->m_accEcn && (header.GetFlags () & (TcpHeader::SYN | TcpHeader::ACK)) == TcpHeader::ACK)
+    {
+      AddOptionAccEcn (header);
+    }
 }
 
 void
@@ -4097,6 +4884,101 @@ TcpSocketBase::ProcessOptionTimestamp (const Ptr<const TcpOption> option,
                m_timestampToEcho << " and Echo="     << ts->GetEcho ());
 }
 
+void
+TcpSocketBase::ProcessAccEcnFeedback (const TcpHeader& tcpHeader)
+{
+  NS_LOG_FUNCTION (this << tcpHeader);
+
+  uint32_t cePackets = (tcpHeader.GetAce () - m_sAccEcnCep) & 0x7;
+  m_sAccEcnCep += cePackets;
+
+  uint32_t ceBytes = cePackets * m_tcb->m_segmentSize;
+  Ptr<const TcpOptionAccEcn> option;
+  if (tcpHeader.HasOption (TcpOption::ACCECN0))
+    {
+      option = DynamicCast<const TcpOptionAccEcn> (tcpHeader.GetOption (TcpOption::ACCECN0));
+    }
+  else if (tcpHeader.HasOption (TcpOption::ACCECN1))
+    {
+      option = DynamicCast<const TcpOptionAccEcn> (tcpHeader.GetOption (TcpOption::ACCECN1));
+    }
+  if (option != 0 && option->HasField (1))
+    {
+      // The byte counter does not wrap as quickly as the ACE field
+      ceBytes = (option->GetCeb () - m_sAccEcnCeb) & TcpOptionAccEcn::COUNTER_MASK;
+      m_sAccEcnCeb += ceBytes;
+    }
+  else
+    {
+      m_sAccEcnCeb += ceBytes;
+    }
+
+  m_tcb->m_ackedCePackets += cePackets;
+  m_tcb->m_ackedCeBytes += ceBytes;
+  m_ecnCeEchoed += cePackets;
+
+  if (ceBytes > 0 || cePackets > 0)
+    {
+      NS_LOG_INFO ("AccECN feedback of " << cePackets << " CE packets, " <<
+                   ceBytes << " CE bytes");
+      if (m_ecnEchoSeq < tcpHeader.GetAckNumber ())
+        {
+          m_ecnEchoSeq = tcpHeader.GetAckNumber ();
+          m_tcb->m_ecnState = TcpSocketState::ECN_ECE_RCVD;
+          NS_LOG_DEBUG (TcpSocketState::EcnStateName[m_tcb->m_ecnState] << " -> ECN_ECE_RCVD");
+        }
+    }
+}
+
+void
+TcpSocketBase::AddOptionAccEcn (TcpHeader& header)
+{
+  NS_LOG_FUNCTION (this << header);
+
+  header.SetAce (m_rAccEcnCep & 0x7);
+
+  Ptr<TcpOptionAccEcn> option = CreateObject<TcpOptionAccEcn> ();
+  // Put first the counter of the codepoint in use, in case the option
+  // would have to be truncated
+  option->SetOrder (m_rAccEcnE1b > m_rAccEcnE0b ? TcpOption::ACCECN1 : TcpOption::ACCECN0);
+  option->SetE0b (m_rAccEcnE0b);
+  option->SetCeb (m_rAccEcnCeb);
+  option->SetE1b (m_rAccEcnE1b);
+
+  header.AppendOption (option);
+  NS_LOG_INFO (m_node->GetId () << " Add option AccECN, ace=" <<
+               static_cast<uint32_t> (header.GetAce ()) << " ceb=" << m_rAccEcnCeb);
+}
+
+void
+TcpSocketBase::UpdateAccEcnCounters (uint8_t ecn, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (ecn) << size);
+
+  switch (ecn)
+    {
+    case Ipv4Header::ECN_CE:
+      ++m_rAccEcnCep;
+      m_rAccEcnCeb += size;
+      break;
+    case Ipv4Header::ECN_ECT0:
+      m_rAccEcnE0b += size;
+      break;
+    case Ipv4Header::ECN_ECT1:
+      m_rAccEcnE1b += size;
+      break;
+    default:
+      break;
+    }
+}
+
+bool
+TcpSocketBase::IsAccEcnSyn (const TcpHeader& tcpHeader) const
+{
+  return m_ecn && m_accEcnEnabled && tcpHeader.GetAe ()
+         && (tcpHeader.GetFlags () & (TcpHeader::CWR | TcpHeader::ECE)) == (TcpHeader::CWR | TcpHeader::ECE);
+}
+
 void
 TcpSocketBase::AddOptionTimestamp (TcpHeader& header)
 {
@@ -4194,6 +5076,51 @@ TcpSocketBase::GetRxBuffer (void) const
   return m_rxBuffer;
 }
 
+uint64_t
+TcpSocketBase::GetFastPathAcks (void) const
+{
+  return m_fastPathAcks;
+}
+
+uint64_t
+TcpSocketBase::GetFastPathData (void) const
+{
+  return m_fastPathData;
+}
+
+uint64_t
+TcpSocketBase::GetSlowPathSegments (void) const
+{
+  return m_slowPathSegments;
+}
+
+TcpInfo
+TcpSocketBase::GetTcpInfo (void) const
+{
+  TcpInfo info;
+  info.m_state = m_state.Get ();
+  info.m_congState = m_tcb->m_congState.Get ();
+  info.m_ecnState = m_tcb->m_ecnState.Get ();
+  info.m_segmentSize = m_tcb->m_segmentSize;
+  info.m_cWnd = m_tcb->m_cWnd.Get ();
+  info.m_ssThresh = m_tcb->m_ssThresh.Get ();
+  info.m_bytesInFlight = m_bytesInFlight.Get ();
+  info.m_sackedBytes = m_txBuffer->GetSackedBytes ();
+  info.m_lostBytes = m_txBuffer->GetLostBytes ();
+  info.m_rWnd = m_rWnd.Get ();
+  info.m_srtt = m_rtt->GetEstimate ();
+  info.m_rttVar = m_rtt->GetVariation ();
+  info.m_lastRtt = m_lastRtt.Get ();
+  info.m_rto = m_rto.Get ();
+  info.m_pacingRate = m_tcb->m_pacingRate.Get ();
+  info.m_deliveryRate = m_txBuffer->GetDeliveryRate ();
+  info.m_bytesDelivered = m_txBuffer->GetDelivered ();
+  info.m_retransSegments = m_retransSegments;
+  info.m_ecnCeRcvd = m_ecnCeRcvd;
+  info.m_ecnCeEchoed = m_ecnCeEchoed;
+  return info;
+}
+
 void
 TcpSocketBase::UpdateCwnd (uint32_t oldValue, uint32_t newValue)
 {
@@ -4234,6 +5161,12 @@ TcpSocketBase::UpdateHighTxMark (SequenceNumber32 oldValue, SequenceNumber32 new
   m_highTxMarkTrace (oldValue, newValue);
 }
 
+void
+TcpSocketBase::UpdatePacingRateTrace (DataRate oldValue, DataRate newValue)
+{
+  m_pacingRateTrace (oldValue, newValue);
+}
+
 void
 TcpSocketBase::SetCongestionControlAlgorithm (Ptr<TcpCongestionOps> algo)
 {
@@ -4266,6 +5199,20 @@ TcpSocketBase::SetEcn()
   m_ecn = true;
 }
 
+void
+TcpSocketBase::SetPacingStatus (bool pacing)
+{
+  NS_LOG_FUNCTION (this << pacing);
+  m_tcb->m_pacing = pacing;
+}
+
+bool
+TcpSocketBase::IsL4S (void) const
+{
+  std::string name = m_congestionControl->GetName ();
+  return name == "TcpDctcp" || name == "TcpPrague";
+}
+
 //RttHistory methods
 RttHistory::RttHistory (SequenceNumber32 s, uint32_t c, Time t)
   : seq (s),
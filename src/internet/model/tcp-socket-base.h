@@ -33,6 +33,7 @@
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-interface.h"
 #include "ns3/event-id.h"
+#include "ns3/data-rate.h"
 #include "tcp-tx-buffer.h"
 #include "tcp-rx-buffer.h"
 #include "rtt-estimator.h"
@@ -182,6 +183,16 @@ public:
   typedef void (* EcnStatesTracedValueCallback)(const EcnState_t oldValue,
                                               const EcnState_t newValue);
 
+  /**
+   * \ingroup tcp
+   * TracedValue Callback signature for the pacing rate
+   *
+   * \param [in] oldValue original value of the traced variable
+   * \param [in] newValue new value of the traced variable
+   */
+  typedef void (* DataRateTracedValueCallback)(const DataRate oldValue,
+                                               const DataRate newValue);
+
   /**
    * \brief Literal names of TCP states for use in log messages
    */
@@ -205,9 +216,20 @@ public:
 
   TracedValue<TcpCongState_t> m_congState;    //!< State in the Congestion state machine
   TracedValue<EcnState_t> m_ecnState;        //!< Current ECN State, represented as combination of EcnState values
+  bool                   m_accEcn;          //!< Accurate ECN feedback negotiated
+  uint32_t               m_ackedCeBytes;    //!< With AccECN, CE-marked bytes newly reported by the last ACK
+  uint32_t               m_ackedCePackets;  //!< With AccECN, CE-marked packets newly reported by the last ACK
   TracedValue<SequenceNumber32> m_highTxMark; //!< Highest seqno ever sent, regardless of ReTx
   TracedValue<SequenceNumber32> m_nextTxSequence; //!< Next seqnum to be sent (SND.NXT), ReTx pushes it back
 
+  // Pacing
+  bool                   m_pacing;            //!< Pace the transmission of data segments
+  DataRate               m_maxPacingRate;     //!< Upper bound of the pacing rate
+  TracedValue<DataRate>  m_pacingRate;        //!< Current pacing rate
+  uint16_t               m_pacingSsRatio;     //!< Percentage of cWnd/SRTT to pace at in slow start
+  uint16_t               m_pacingCaRatio;     //!< Percentage of cWnd/SRTT to pace at in congestion avoidance
+  bool                   m_paceInitialWindow; //!< Pace the initial window, before any RTT sample
+
   uint32_t               m_rcvTimestampValue;     //!< Receiver Timestamp value 
   uint32_t               m_rcvTimestampEchoReply; //!< Sender Timestamp echoed by the receiver
 
@@ -232,6 +254,42 @@ public:
   }
 };
 
+/**
+ * \ingroup tcp
+ *
+ * \brief Snapshot of the state of a TCP connection
+ *
+ * The equivalent of Linux struct tcp_info, filled by
+ * TcpSocketBase::GetTcpInfo. Reading it costs a copy of the fields, while
+ * the traced values fire their callbacks at every change: it is meant to
+ * sample many connections at a regular interval (see TcpInfoHelper).
+ */
+struct TcpInfo
+{
+  TcpInfo ();
+
+  TcpSocket::TcpStates_t m_state;               //!< TCP state
+  TcpSocketState::TcpCongState_t m_congState;   //!< Congestion state
+  TcpSocketState::EcnState_t m_ecnState;        //!< ECN state
+  uint32_t m_segmentSize;     //!< Segment size
+  uint32_t m_cWnd;            //!< Congestion window, in bytes
+  uint32_t m_ssThresh;        //!< Slow start threshold, in bytes
+  uint32_t m_bytesInFlight;   //!< Bytes in flight
+  uint32_t m_sackedBytes;     //!< Bytes SACKed and not yet acknowledged
+  uint32_t m_lostBytes;       //!< Bytes marked lost and not SACKed
+  uint32_t m_rWnd;            //!< Window advertised by the peer
+  Time m_srtt;                //!< Smoothed RTT
+  Time m_rttVar;              //!< RTT variation
+  Time m_lastRtt;             //!< Last RTT sample
+  Time m_rto;                 //!< Retransmission timeout
+  DataRate m_pacingRate;      //!< Pacing rate
+  DataRate m_deliveryRate;    //!< Delivery rate (see TcpTxBuffer::GetDeliveryRate)
+  uint64_t m_bytesDelivered;  //!< Bytes acknowledged or SACKed so far
+  uint32_t m_retransSegments; //!< Segments retransmitted so far
+  uint32_t m_ecnCeRcvd;       //!< CE-marked segments received so far
+  uint32_t m_ecnCeEchoed;     //!< CE marks echoed by the peer so far
+};
+
 /**
  * \ingroup socket
  * \ingroup tcp
@@ -434,6 +492,31 @@ public:
    */
   Ptr<TcpRxBuffer> GetRxBuffer (void) const;
 
+  /**
+   * \brief Get the number of pure ACKs processed by the header prediction fast path
+   * \return the number of predicted ACKs
+   */
+  uint64_t GetFastPathAcks (void) const;
+
+  /**
+   * \brief Get the number of data segments processed by the header prediction fast path
+   * \return the number of predicted data segments
+   */
+  uint64_t GetFastPathData (void) const;
+
+  /**
+   * \brief Get the number of segments received in ESTABLISHED that missed the fast path
+   * \return the number of segments processed by the generic code
+   */
+  uint64_t GetSlowPathSegments (void) const;
+
+  /**
+   * \brief Get a snapshot of the state of the connection
+   * \return the current values of the congestion control variables, RTT
+   * estimates and counters of the socket
+   */
+  TcpInfo GetTcpInfo (void) const;
+
   /**
    * \brief Callback pointer for cWnd trace chaining
    */
@@ -464,6 +547,11 @@ public:
    */
   TracedCallback<SequenceNumber32, SequenceNumber32> m_nextTxSequenceTrace;
 
+  /**
+   * \brief Callback pointer for pacing rate trace chaining
+   */
+  TracedCallback<DataRate, DataRate> m_pacingRateTrace;
+
   /**
    * \brief Callback function to hook to TcpSocketState congestion window
    * \param oldValue old cWnd value
@@ -508,6 +596,13 @@ public:
    */
   void UpdateNextTxSequence (SequenceNumber32 oldValue, SequenceNumber32 newValue);
 
+  /**
+   * \brief Callback function to hook to TcpSocketState pacing rate
+   * \param oldValue old pacing rate
+   * \param newValue new pacing rate
+   */
+  void UpdatePacingRateTrace (DataRate oldValue, DataRate newValue);
+
   /**
    * \brief Install a congestion control algorithm on this socket
    *
@@ -519,6 +614,13 @@ public:
    * \brief Sets the variable m_ecn true to use ECN functionality
    */
   void SetEcn();
+
+  /**
+   * \brief Enable or disable the pacing of data segments
+   *
+   * \param pacing true to pace the transmissions
+   */
+  void SetPacingStatus (bool pacing);
   
   // Necessary implementations of null functions from ns3::Socket
   virtual enum SocketErrno GetErrno (void) const;    // returns m_errno
@@ -678,6 +780,47 @@ protected:
   virtual void DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
                             const Address &toAddress);
 
+  /**
+   * \brief Check if a segment continues the pending receive aggregate
+   *
+   * A segment continues the aggregate if it can be coalesced (see GroHold),
+   * starts where the aggregate ends, and carries the same ACK number, flags
+   * and ECN codepoint. Without a pending aggregate, a segment can start one
+   * if it is the next in-order segment and no out-of-order data is buffered.
+   *
+   * \param packet the incoming packet, with its TCP header
+   * \param tcpHeader the TCP header of the packet
+   * \param ecn the ECN codepoint of the IP header
+   * \returns true if the segment can be appended to the aggregate
+   */
+  bool GroCanExtend (Ptr<const Packet> packet, const TcpHeader &tcpHeader, uint8_t ecn) const;
+
+  /**
+   * \brief Hold an in-order data segment in the receive aggregate
+   *
+   * Only data segments of an established connection, with no flag other
+   * than ACK and the ECN feedback ones, and no SACK option, are coalesced.
+   * The aggregate is passed to DoForwardUp when it reaches GroSegments
+   * segments, when GroTimeout expires, or when a segment that does not
+   * continue it arrives; since the segments of an aggregate share the ECN
+   * codepoint, every change of the CE marking is seen by the ECN state
+   * machine at the right sequence number.
+   *
+   * \param packet the incoming packet, with its TCP header
+   * \param tcpHeader the TCP header of the packet
+   * \param ecn the ECN codepoint of the IP header
+   * \param fromAddress the address of the sender of packet
+   * \param toAddress the address of the receiver of packet
+   * \returns true if the segment was held, false if it has to be processed now
+   */
+  bool GroHold (Ptr<Packet> packet, const TcpHeader &tcpHeader, uint8_t ecn,
+                const Address &fromAddress, const Address &toAddress);
+
+  /**
+   * \brief Process the pending receive aggregate as a single segment
+   */
+  void GroFlush (void);
+
   /**
    * \brief Called by the L3 protocol when it received an ICMP packet to pass on to TCP.
    *
@@ -710,6 +853,21 @@ protected:
    */
   uint32_t SendPendingData (bool withAck = false);
 
+  /**
+   * \brief Recompute the pacing rate from the congestion window and SRTT
+   *
+   * The rate is cWnd/SRTT scaled by PacingSsRatio while the window is below
+   * half of the slow start threshold, and by PacingCaRatio afterwards, capped
+   * at MaxPacingRate. Nothing is done when the congestion control sets the
+   * rate itself (see TcpCongestionOps::SetsPacingRate).
+   */
+  void UpdatePacingRate (void);
+
+  /**
+   * \brief Expiration of the pacing timer: send the next segment
+   */
+  void NotifyPacingPerformed (void);
+
   /**
    * \brief Extract at most maxSize bytes from the TxBuffer at sequence seq, add the
    *        TCP header, and send to TcpL4Protocol
@@ -813,6 +971,32 @@ protected:
    */
   void ProcessEstablished (Ptr<Packet> packet, const TcpHeader& tcpHeader); // Received a packet upon ESTABLISHED state
 
+  /**
+   * \brief Header prediction fast path, for a packet received in ESTABLISHED
+   *
+   * Van Jacobson's header prediction, as in tcp_rcv_established() in Linux:
+   * the segment is predicted if it carries no flag other than ACK (and PSH),
+   * no SACK block, no new ECN feedback, the same window as before, and the
+   * next expected sequence number. Two cases are then handled without the
+   * option parsing, the state machine and the congestion state checks of
+   * the generic code: a pure ACK of new data in the Open state, and in-order
+   * data while the receiver has no data outstanding or to send. The segment
+   * is still passed to ReceivedAck, which hands it to ReceivedPredictedAck.
+   *
+   * \param packet the packet, without the TCP header
+   * \param tcpHeader the packet's TCP header
+   * \returns true if the segment has been processed
+   */
+  bool ProcessFastPath (Ptr<Packet> packet, const TcpHeader& tcpHeader);
+
+  /**
+   * \brief Process the ACK (and the data) of a segment predicted by ProcessFastPath
+   *
+   * \param packet the packet, without the TCP header
+   * \param tcpHeader the packet's TCP header
+   */
+  void ReceivedPredictedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader);
+
   /**
    * \brief Received a packet upon LISTEN state.
    *
@@ -1016,6 +1200,47 @@ protected:
    */
   virtual void DoRetransmit (void);
 
+  /**
+   * \brief Mark the segments lost by time (RACK, RFC 8985)
+   *
+   * Run the detection in the Tx buffer, arm the reordering timer for the
+   * segments which may still be delivered, and enter the recovery if some
+   * segment has been marked lost.
+   */
+  void RackDetectLoss (void);
+
+  /**
+   * \brief Generate the delivery rate sample of an ACK
+   *
+   * The sample is passed to the congestion control, if it implements
+   * TcpCongestionOps::CongControl ().
+   *
+   * \param priorInFlight bytes in flight before the ACK was processed
+   */
+  void ProcessRateSample (uint32_t priorInFlight);
+
+  /**
+   * \brief The reordering window of a segment expired: detect losses again
+   */
+  void RackTimeout (void);
+
+  /**
+   * \brief Arm the Tail Loss Probe timer (RFC 8985, Section 7)
+   *
+   * The probe timeout is two SRTT, plus the delayed ACK timeout if a single
+   * segment is in flight. The timer is not armed if the RTO expires first,
+   * outside the Open and CWR states, or while a probe is outstanding.
+   */
+  void ScheduleTlp (void);
+
+  /**
+   * \brief Send a Tail Loss Probe
+   *
+   * The probe is a new segment, if the windows allow it, or the
+   * retransmission of the last segment sent.
+   */
+  void TlpTimeout (void);
+
   /** \brief Add options to TcpHeader
    *
    * Test each option, and if it is enabled on our side, add it
@@ -1126,6 +1351,43 @@ protected:
    */
   void AddOptionTimestamp (TcpHeader& header);
 
+  /**
+   * \brief Read the Accurate ECN feedback of an ACK
+   *
+   * The increase of the CE packet counter is decoded from the ACE field,
+   * the increase of the CE byte counter from the AccECN option if present.
+   * The newly reported CE bytes are accumulated in the m_ackedCeBytes field
+   * of the TcpSocketState, for the congestion control, and an increase
+   * triggers the once per window reduction as an ECN Echo would.
+   *
+   * \param tcpHeader the header of the ACK
+   */
+  void ProcessAccEcnFeedback (const TcpHeader& tcpHeader);
+
+  /**
+   * \brief Add the AccECN option and the ACE field to the header
+   *
+   * \param header TcpHeader where the method should add the feedback
+   */
+  void AddOptionAccEcn (TcpHeader& header);
+
+  /**
+   * \brief Count a received segment in the AccECN receiver counters
+   *
+   * \param ecn the ECN codepoint of the IP header
+   * \param size the payload size of the segment
+   */
+  void UpdateAccEcnCounters (uint8_t ecn, uint32_t size);
+
+  /**
+   * \brief Check if a SYN requests Accurate ECN
+   *
+   * \param tcpHeader the header of the SYN
+   * \return true if AccECN is enabled on this socket and the SYN has the
+   * AE, CWR and ECE flags set
+   */
+  bool IsAccEcnSyn (const TcpHeader& tcpHeader) const;
+
   /**
    * \brief Performs a safe subtraction between a and b (a-b)
    *
@@ -1137,6 +1399,17 @@ protected:
    */
   static uint32_t SafeSubtraction (uint32_t a, uint32_t b);
 
+  /**
+   * \brief Check if the congestion control is a scalable one
+   *
+   * The packets of scalable congestion controls (DCTCP, Prague) carry the
+   * ECT(1) codepoint, which classifies them as L4S traffic; the others
+   * carry ECT(0).
+   *
+   * \return true if the packets of this socket should be marked ECT(1)
+   */
+  bool IsL4S (void) const;
+
 protected:
   // Counters and events
   EventId           m_retxEvent;       //!< Retransmission event
@@ -1152,6 +1425,9 @@ protected:
   uint32_t          m_synRetries;      //!< Number of connection attempts
   uint32_t          m_dataRetrCount;   //!< Count of remaining data retransmission attempts
   uint32_t          m_dataRetries;     //!< Number of data retransmission attempts
+  uint32_t          m_retransSegments; //!< Data segments retransmitted
+  uint32_t          m_ecnCeRcvd;       //!< CE-marked segments received
+  uint32_t          m_ecnCeEchoed;     //!< CE marks echoed by the peer (ECE ACKs, or AccECN count)
   TracedValue<Time> m_rto;             //!< Retransmit timeout
   Time              m_minRto;          //!< minimum value of the Retransmit timeout
   Time              m_clockGranularity; //!< Clock Granularity used in RTO calcs
@@ -1205,12 +1481,40 @@ protected:
   uint32_t m_timestampToEcho;     //!< Timestamp to echo
 
   EventId m_sendPendingDataEvent; //!< micro-delay event to send pending data
+  EventId m_pacingEvent;          //!< Pacing event: send the next segment at the pacing rate
+  uint32_t m_tsoSegments;         //!< Maximum number of segments in a super-segment
+
+  // Header prediction
+  bool     m_headerPrediction;  //!< Use the header prediction fast path
+  bool     m_headerPredicted;   //!< The segment in ReceivedAck has been predicted
+  uint64_t m_fastPathAcks;      //!< Pure ACKs processed by the fast path
+  uint64_t m_fastPathData;      //!< Data segments processed by the fast path
+  uint64_t m_slowPathSegments;  //!< Segments in ESTABLISHED processed by the generic code
+
+  // Receive offload
+  uint32_t    m_groSegments; //!< Maximum number of segments in a receive aggregate
+  Time        m_groTimeout;  //!< Time a receive aggregate waits for more segments
+  Ptr<Packet> m_groPacket;   //!< Payload of the pending aggregate
+  TcpHeader   m_groHeader;   //!< TCP header of the pending aggregate
+  uint8_t     m_groEcn;      //!< ECN codepoint of the pending aggregate
+  uint32_t    m_groCount;    //!< Segments in the pending aggregate
+  Address     m_groFrom;     //!< Source address of the pending aggregate
+  Address     m_groTo;       //!< Destination address of the pending aggregate
+  EventId     m_groEvent;    //!< Flush of the pending aggregate
 
   // Fast Retransmit and Recovery
   SequenceNumber32       m_recover;      //!< Previous highest Tx seqnum for fast recovery
   uint32_t               m_retxThresh;   //!< Fast Retransmit threshold
   bool                   m_limitedTx;    //!< perform limited transmit
 
+  // Time-based loss detection (RFC 8985)
+  bool             m_rackEnabled;    //!< Mark segments lost by time (RACK)
+  bool             m_tlpEnabled;     //!< Send Tail Loss Probes
+  EventId          m_rackEvent;      //!< RACK reordering timer
+  EventId          m_tlpEvent;       //!< Tail Loss Probe timer
+  bool             m_tlpOutstanding; //!< A probe has been sent and not acknowledged
+  SequenceNumber32 m_tlpEndSeq;      //!< SND.NXT when the probe was sent
+
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control informations
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
@@ -1230,6 +1534,16 @@ protected:
   TracedValue<SequenceNumber32> m_ecnEchoSeq; //!< Sequence number of the last received ECN Echo
   TracedValue<SequenceNumber32> m_ecnCESeq;   //!< Sequence number of the last received Congestion Experienced
   TracedValue<SequenceNumber32> m_ecnCWRSeq;  //!< Sequence number of the last sent CWR 
+
+  // Accurate ECN
+  bool                     m_accEcnEnabled;   //!< Negotiate AccECN feedback when using ECN
+  uint8_t                  m_synEcn;          //!< IP ECN codepoint of the last received SYN
+  uint32_t                 m_rAccEcnCep;      //!< Receiver count of CE packets
+  uint32_t                 m_rAccEcnCeb;      //!< Receiver count of CE payload bytes
+  uint32_t                 m_rAccEcnE0b;      //!< Receiver count of ECT(0) payload bytes
+  uint32_t                 m_rAccEcnE1b;      //!< Receiver count of ECT(1) payload bytes
+  uint32_t                 m_sAccEcnCep;      //!< Sender count of CE packets reported
+  uint32_t                 m_sAccEcnCeb;      //!< Sender count of CE bytes reported
 };
 
 /**
@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <vector>
 
 #include "ns3/packet.h"
 #include "ns3/log.h"
@@ -38,7 +39,11 @@ TcpTxItem::TcpTxItem ()
     m_lost (false),
     m_retrans (false),
     m_lastSent (Time::Min ()),
-    m_sacked (false)
+    m_sacked (false),
+    m_delivered (0),
+    m_deliveredTime (Time::Min ()),
+    m_firstSentTime (Time::Min ()),
+    m_isAppLimited (false)
 {
 }
 
@@ -47,7 +52,11 @@ TcpTxItem::TcpTxItem (const TcpTxItem &other)
     m_lost (other.m_lost),
     m_retrans (other.m_retrans),
     m_lastSent (other.m_lastSent),
-    m_sacked (other.m_sacked)
+    m_sacked (other.m_sacked),
+    m_delivered (other.m_delivered),
+    m_deliveredTime (other.m_deliveredTime),
+    m_firstSentTime (other.m_firstSentTime),
+    m_isAppLimited (other.m_isAppLimited)
 {
 }
 
@@ -112,17 +121,23 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_sackedBytes (0), m_lostBytes (0),
+    m_rackXmitTs (Time::Min ()), m_rackEndSeq (n), m_rackRtt (Time (0)),
+    m_rackMinRtt (Time::Max ()), m_rackFack (n), m_rackReorderingSeen (false),
+    m_rateDelivered (0), m_rateDeliveredTime (Time::Min ()),
+    m_rateFirstSentTime (Time::Min ()), m_rateAppLimited (0), m_rateLastRate (0)
 {
 }
 
 TcpTxBuffer::~TcpTxBuffer (void)
 {
+  SentList::iterator sentIt;
   PacketList::iterator it;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  for (sentIt = m_sentList.begin (); sentIt != m_sentList.end (); ++sentIt)
     {
-      TcpTxItem *item = *it;
+      TcpTxItem *item = sentIt->second;
       m_sentSize -= item->m_packet->GetSize ();
       delete item;
     }
@@ -147,6 +162,16 @@ TcpTxBuffer::TailSequence (void) const
   return m_firstByteSeq + SequenceNumber32 (m_size);
 }
 
+SequenceNumber32
+TcpTxBuffer::LastSentSequence (void) const
+{
+  if (m_sentList.empty ())
+    {
+      return m_firstByteSeq;
+    }
+  return m_sentList.rbegin ()->first;
+}
+
 uint32_t
 TcpTxBuffer::Size (void) const
 {
@@ -179,7 +204,7 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
 
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  ClearScoreboard ();
 }
 
 bool
@@ -242,14 +267,16 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
       return Create<Packet> ();
     }
 
-  TcpTxItem *outItem = 0;
+  SentList::iterator outIt;
+  bool retrans = false;
+  bool idle = m_sentSize == 0;
 
   if (m_firstByteSeq + m_sentSize >= seq + s)
     {
       // already sent this block completely
-      outItem = GetTransmittedSegment (s, seq);
-      NS_ASSERT (outItem != 0);
-      outItem->m_retrans = true;
+      outIt = GetTransmittedSegment (s, seq);
+      NS_ASSERT (outIt != m_sentList.end ());
+      retrans = true;
 
       NS_LOG_DEBUG ("Retransmitting [" << seq << ";" << seq + s << "|" << s <<
                     "] from " << *this);
@@ -260,9 +287,9 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
                            "Requesting a piece of new data with an hole");
 
       // this is the first time we transmit this block
-      outItem = GetNewSegment (s);
-      NS_ASSERT (outItem != 0);
-      NS_ASSERT (outItem->m_retrans == false);
+      outIt = GetNewSegment (s);
+      NS_ASSERT (outIt != m_sentList.end ());
+      NS_ASSERT (outIt->second->m_retrans == false);
 
       NS_LOG_DEBUG ("New segment [" << seq << ";" << seq + s << "|" << s <<
                     "] from " << *this);
@@ -277,15 +304,34 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
                     m_firstByteSeq + m_sentSize + amount <<"|" << amount <<
                     "] from " << *this);
 
-      outItem = GetNewSegment (amount);
-      NS_ASSERT (outItem != 0);
+      outIt = GetNewSegment (amount);
+      NS_ASSERT (outIt != m_sentList.end ());
 
       // Now get outItem from the sent list (there will be a merge)
       return CopyFromSequence (numBytes, seq);
     }
 
+  TcpTxItem *outItem = outIt->second;
+  RemoveFromScoreboard (*outIt);
+  if (retrans)
+    {
+      outItem->m_retrans = true;
+    }
   outItem->m_lost = false;
   outItem->m_lastSent = Simulator::Now ();
+
+  // A new flight starts when nothing is outstanding: the sampling intervals
+  // must not include the idle time
+  if (idle)
+    {
+      m_rateFirstSentTime = Simulator::Now ();
+      m_rateDeliveredTime = Simulator::Now ();
+    }
+  outItem->m_delivered = m_rateDelivered;
+  outItem->m_deliveredTime = m_rateDeliveredTime;
+  outItem->m_firstSentTime = m_rateFirstSentTime;
+  outItem->m_isAppLimited = m_rateAppLimited != 0;
+  AddToScoreboard (*outIt);
   Ptr<Packet> toRet = outItem->m_packet->Copy ();
 
   NS_ASSERT (toRet->GetSize () == s);
@@ -293,7 +339,7 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
   return toRet;
 }
 
-TcpTxItem*
+TcpTxBuffer::SentList::iterator
 TcpTxBuffer::GetNewSegment (uint32_t numBytes)
 {
   NS_LOG_FUNCTION (this << numBytes);
@@ -311,53 +357,292 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  SentList::iterator sentIt = m_sentList.insert (m_sentList.end (),
+                                                 std::make_pair (startOfAppList, item));
   m_sentSize += item->m_packet->GetSize ();
+  AddToScoreboard (*sentIt);
 
-  return item;
+  return sentIt;
 }
 
-TcpTxItem*
+TcpTxBuffer::SentList::iterator
 TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &seq)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
   NS_ASSERT (seq >= m_firstByteSeq);
   NS_ASSERT (numBytes <= m_sentSize);
 
-  bool listEdited = false;
+  // The item that contains seq is the last one starting at or before seq
+  SentList::iterator it = m_sentList.upper_bound (seq);
+  NS_ASSERT (it != m_sentList.begin ());
+  --it;
 
-  TcpTxItem *item = GetPacketFromList (m_sentList, m_firstByteSeq, numBytes, seq, &listEdited);
+  TcpTxItem *item = it->second;
+  RemoveFromScoreboard (*it);
 
-  if (listEdited && m_highestSack.second >= m_firstByteSeq)
+  if (it->first < seq)
     {
-      m_highestSack = GetHighestSacked ();
+      // seq is in the middle of the item: split the beginning, which keeps
+      // the position of the item in the map
+      TcpTxItem *firstPart = new TcpTxItem ();
+      SplitItems (*firstPart, *item, seq - it->first);
+      it->second = firstPart;
+      AddToScoreboard (*it);
+
+      it = m_sentList.insert (++it, std::make_pair (seq, item));
     }
 
-  return item;
+  while (item->m_packet->GetSize () < numBytes)
+    {
+      // The item does not contain the requested end. Merge the item that
+      // follows into it
+      SentList::iterator next = it;
+      ++next;
+      NS_ASSERT_MSG (next != m_sentList.end (), "Requested a block beyond the sent data");
+
+      RemoveFromScoreboard (*next);
+      MergeItems (*item, *next->second);
+      delete next->second;
+      m_sentList.erase (next);
+    }
+
+  if (item->m_packet->GetSize () > numBytes)
+    {
+      // the end is inside the item: split it, the first part is the block
+      TcpTxItem *firstPart = new TcpTxItem ();
+      SplitItems (*firstPart, *item, numBytes);
+      it->second = firstPart;
+
+      SentList::iterator next = it;
+      next = m_sentList.insert (++next, std::make_pair (seq + numBytes, item));
+      AddToScoreboard (*next);
+    }
+
+  AddToScoreboard (*it);
+  NS_LOG_INFO ("Retrieved item starting at " << seq << " of " <<
+               it->second->m_packet->GetSize () << " bytes");
+
+  return it;
 }
 
-std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
-TcpTxBuffer::GetHighestSacked () const
+SequenceNumber32
+TcpTxBuffer::GetHighestSacked (void) const
+{
+  if (m_sackedItems.empty ())
+    {
+      return m_firstByteSeq;
+    }
+
+  SentList::const_reverse_iterator it = m_sackedItems.rbegin ();
+  return it->first + it->second->m_packet->GetSize ();
+}
+
+void
+TcpTxBuffer::AddToScoreboard (const SentList::value_type &segment)
+{
+  TcpTxItem *item = segment.second;
+  uint32_t size = item->m_packet->GetSize ();
+
+  if (item->m_sacked)
+    {
+      m_sackedItems.insert (m_sackedItems.end (), segment);
+      m_sackedBytes += size;
+      return;
+    }
+
+  if (item->m_lost)
+    {
+      m_lostBytes += size;
+    }
+
+  SentList &index = item->m_retrans ? m_retxItems :
+    (item->m_lost ? m_lostItems : m_unretxItems);
+  index.insert (index.end (), segment);
+}
+
+void
+TcpTxBuffer::RemoveFromScoreboard (const SentList::value_type &segment)
+{
+  TcpTxItem *item = segment.second;
+  uint32_t size = item->m_packet->GetSize ();
+
+  if (item->m_sacked)
+    {
+      NS_ASSERT (m_sackedItems.count (segment.first) == 1);
+      m_sackedItems.erase (segment.first);
+      m_sackedBytes -= size;
+      return;
+    }
+
+  if (item->m_lost)
+    {
+      m_lostBytes -= size;
+    }
+
+  SentList &index = item->m_retrans ? m_retxItems :
+    (item->m_lost ? m_lostItems : m_unretxItems);
+  NS_ASSERT (index.count (segment.first) == 1);
+  index.erase (segment.first);
+}
+
+void
+TcpTxBuffer::ClearScoreboard (void)
+{
+  m_sackedItems.clear ();
+  m_retxItems.clear ();
+  m_lostItems.clear ();
+  m_unretxItems.clear ();
+  m_sackedBytes = 0;
+  m_lostBytes = 0;
+}
+
+void
+TcpTxBuffer::RackUpdate (const SentList::value_type &segment)
+{
+  TcpTxItem *item = segment.second;
+  SequenceNumber32 endSeq = segment.first + item->m_packet->GetSize ();
+  Time rtt = Simulator::Now () - item->m_lastSent;
+
+  // RFC 8985, Section 6.2: a retransmitted segment delivered faster than the
+  // minimum RTT was probably delivered by its original transmission
+  if (item->m_retrans && rtt < m_rackMinRtt)
+    {
+      return;
+    }
+
+  m_rackMinRtt = std::min (m_rackMinRtt, rtt);
+
+  if (!item->m_retrans && endSeq < m_rackFack)
+    {
+      NS_LOG_INFO ("Reordering seen: " << endSeq << " delivered after " << m_rackFack);
+      m_rackReorderingSeen = true;
+    }
+  m_rackFack = std::max (m_rackFack, endSeq);
+
+  if (item->m_lastSent > m_rackXmitTs
+      || (item->m_lastSent == m_rackXmitTs && endSeq > m_rackEndSeq))
+    {
+      m_rackXmitTs = item->m_lastSent;
+      m_rackEndSeq = endSeq;
+      m_rackRtt = rtt;
+    }
+}
+
+void
+TcpTxBuffer::RateDelivered (const TcpTxItem *item, uint32_t bytes)
+{
+  m_rateDelivered += bytes;
+  m_rateSample.m_ackedSacked += bytes;
+
+  // Keep the stamps of the most recently sent segment delivered
+  if (m_rateSample.m_priorTime != Time::Min ()
+      && item->m_delivered < m_rateSample.m_priorDelivered)
+    {
+      return;
+    }
+  m_rateSample.m_priorDelivered = item->m_delivered;
+  m_rateSample.m_priorTime = item->m_deliveredTime;
+  m_rateSample.m_isAppLimited = item->m_isAppLimited;
+  m_rateSample.m_rtt = item->m_retrans ? Time (0) : Simulator::Now () - item->m_lastSent;
+  m_rateFirstSentTime = item->m_lastSent;
+  m_rateSample.m_sendElapsed = item->m_lastSent - item->m_firstSentTime;
+}
+
+TcpRateSample
+TcpTxBuffer::GenerateRateSample (void)
 {
   NS_LOG_FUNCTION (this);
 
-  PacketList::const_iterator it;
-  std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32> ret;
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+  TcpRateSample rs = m_rateSample;
+  m_rateSample = TcpRateSample ();
 
-  ret = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  if (m_rateAppLimited != 0 && m_rateDelivered > m_rateAppLimited)
+    {
+      m_rateAppLimited = 0;
+    }
+  if (rs.m_ackedSacked > 0)
+    {
+      m_rateDeliveredTime = Simulator::Now ();
+    }
+  rs.m_totalDelivered = m_rateDelivered;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  if (rs.m_priorTime == Time::Min ())
+    {
+      rs.m_sendElapsed = Time (0);
+      return rs;
+    }
+  rs.m_delivered = m_rateDelivered - rs.m_priorDelivered;
+  rs.m_ackElapsed = Simulator::Now () - rs.m_priorTime;
+  Time interval = std::max (rs.m_sendElapsed, rs.m_ackElapsed);
+
+  // An interval shorter than the minimum RTT comes from ACK compression, or
+  // from a flight whose start has not been seen: the rate would be overestimated
+  if (interval < m_rackMinRtt || interval.IsZero ())
+    {
+      NS_LOG_LOGIC ("Rate sample interval " << interval << " below the minimum RTT");
+      return rs;
+    }
+  rs.m_interval = interval;
+  rs.m_deliveryRate = DataRate (static_cast<uint64_t> (rs.m_delivered * 8 / interval.GetSeconds ()));
+
+  // The application-limited samples are kept only if they show a higher rate
+  if (!rs.m_isAppLimited || rs.m_deliveryRate >= m_rateLastRate)
+    {
+      m_rateLastRate = rs.m_deliveryRate;
+    }
+  NS_LOG_LOGIC ("Rate sample: " << rs.m_delivered << " bytes in " << interval <<
+                ", " << rs.m_deliveryRate << (rs.m_isAppLimited ? " (app-limited)" : ""));
+  return rs;
+}
+
+void
+TcpTxBuffer::MarkAppLimited (uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << bytesInFlight);
+  m_rateAppLimited = std::max (m_rateDelivered + bytesInFlight, static_cast<uint64_t> (1));
+}
+
+uint64_t
+TcpTxBuffer::GetDelivered (void) const
+{
+  return m_rateDelivered;
+}
+
+DataRate
+TcpTxBuffer::GetDeliveryRate (void) const
+{
+  return m_rateLastRate;
+}
+
+uint32_t
+TcpTxBuffer::GetSackedBytes (void) const
+{
+  return m_sackedBytes;
+}
+
+uint32_t
+TcpTxBuffer::GetLostBytes (void) const
+{
+  return m_lostBytes;
+}
+
+TcpTxItem*
+TcpTxBuffer::GetFirstUnsacked (const SequenceNumber32 &seq, SequenceNumber32 *start) const
+{
+  const SentList *indexes[] = { &m_retxItems, &m_lostItems, &m_unretxItems };
+  TcpTxItem *item = 0;
+
+  for (uint32_t i = 0; i < 3; ++i)
     {
-      const TcpTxItem *item = *it;
-      if (item->m_sacked)
+      SentList::const_iterator it = indexes[i]->lower_bound (seq);
+      if (it != indexes[i]->end () && (item == 0 || it->first < *start))
         {
-          ret = std::make_pair (it, beginOfCurrentPacket);
+          *start = it->first;
+          item = it->second;
         }
-      beginOfCurrentPacket += item->m_packet->GetSize ();
     }
 
-  return ret;
+  return item;
 }
 
 
@@ -373,6 +658,10 @@ TcpTxBuffer::SplitItems (TcpTxItem &t1, TcpTxItem &t2, uint32_t size) const
   t1.m_lastSent = t2.m_lastSent;
   t1.m_retrans = t2.m_retrans;
   t1.m_lost = t2.m_lost;
+  t1.m_delivered = t2.m_delivered;
+  t1.m_deliveredTime = t2.m_deliveredTime;
+  t1.m_firstSentTime = t2.m_firstSentTime;
+  t1.m_isAppLimited = t2.m_isAppLimited;
 }
 
 TcpTxItem*
@@ -565,6 +854,10 @@ TcpTxBuffer::MergeItems (TcpTxItem &t1, TcpTxItem &t2) const
   if (t1.m_lastSent < t2.m_lastSent)
     {
       t1.m_lastSent = t2.m_lastSent;
+      t1.m_delivered = t2.m_delivered;
+      t1.m_deliveredTime = t2.m_deliveredTime;
+      t1.m_firstSentTime = t2.m_firstSentTime;
+      t1.m_isAppLimited = t2.m_isAppLimited;
     }
   if (t2.m_lost)
     {
@@ -589,7 +882,8 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Scan the buffer and discard packets
   uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
   uint32_t pktSize;
-  PacketList::iterator i = m_sentList.begin ();
+  bool neverSent = false;
+  SentList::iterator i = m_sentList.begin ();
   while (m_size > 0 && offset > 0)
     {
       if (i == m_sentList.end ())
@@ -598,18 +892,25 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           NS_ASSERT (p != 0);
           i = m_sentList.begin ();
           NS_ASSERT (i != m_sentList.end ());
+          neverSent = true;
         }
-      TcpTxItem *item = *i;
+      TcpTxItem *item = i->second;
       Ptr<Packet> p = item->m_packet;
       pktSize = p->GetSize ();
+      RemoveFromScoreboard (*i);
 
       if (offset >= pktSize)
         { // This packet is behind the seqnum. Remove this packet from the buffer
+          if (!item->m_sacked && !neverSent)
+            {
+              RackUpdate (*i);
+              RateDelivered (item, pktSize);
+            }
           m_size -= pktSize;
           m_sentSize -= pktSize;
           offset -= pktSize;
           m_firstByteSeq += pktSize;
-          i = m_sentList.erase (i);
+          m_sentList.erase (i++);
           delete item;
           NS_LOG_INFO ("While removing up to " << seq <<
                        ".Removed one packet of size " << pktSize <<
@@ -618,12 +919,19 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
         }
       else if (offset > 0)
         { // Part of the packet is behind the seqnum. Fragment
+          if (!item->m_sacked && !neverSent)
+            {
+              RateDelivered (item, offset);
+            }
           pktSize -= offset;
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
+          m_sentList.erase (i);
+          i = m_sentList.insert (m_sentList.begin (), std::make_pair (m_firstByteSeq.Get (), item));
+          AddToScoreboard (*i);
           NS_LOG_INFO ("Fragmented one packet by size " << offset <<
                        ", new size=" << pktSize);
           break;
@@ -637,21 +945,19 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 
   if (!m_sentList.empty ())
     {
-      TcpTxItem *head = m_sentList.front ();
+      SentList::iterator headIt = m_sentList.begin ();
+      TcpTxItem *head = headIt->second;
       if (head->m_sacked)
         {
           // It is not possible to have the UNA sacked; otherwise, it would
           // have been ACKed. This is, most likely, our wrong guessing
           // when crafting the SACK option for a non-SACK receiver.
+          RemoveFromScoreboard (*headIt);
           head->m_sacked = false;
+          AddToScoreboard (*headIt);
         }
     }
 
-  if (m_highestSack.second <= m_firstByteSeq)
-    {
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
-    }
-
   NS_LOG_DEBUG ("Discarded up to " << seq);
   NS_LOG_LOGIC ("Buffer status after discarding data " << *this);
   NS_ASSERT (m_firstByteSeq >= seq);
@@ -671,122 +977,105 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
       TcpTxItem *item;
       const TcpOptionSack::SackBlock b = (*option_it);
 
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+      // Only the items starting inside the block can be mapped over it,
+      // and only if they end inside the block
+      SentList::iterator item_it = m_sentList.lower_bound (b.first);
+      if (item_it == m_sentList.end ()
+          || item_it->first + item_it->second->m_packet->GetSize () > b.second)
+        {
+          NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
+                       "], not found in the sackboard");
+          continue;
+        }
+      modified = true;
+
+      // Skip the items already SACKed: look for the next item not SACKed,
+      // until the end of the block
+      SequenceNumber32 beginOfCurrentPacket;
+      item = GetFirstUnsacked (b.first, &beginOfCurrentPacket);
 
-      while (item_it != m_sentList.end ())
+      while (item != 0)
         {
-          item = *item_it;
           current = item->m_packet;
+          SequenceNumber32 endOfCurrentPacket = beginOfCurrentPacket + current->GetSize ();
 
           // Check the boundary of this packet ... only mark as sacked if
           // it is precisely mapped over the option
-          if (beginOfCurrentPacket >= b.first
-              && beginOfCurrentPacket + current->GetSize () <= b.second)
-            {
-              if (item->m_sacked)
-                {
-                  NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
-                               ", checking sentList for block " << beginOfCurrentPacket <<
-                               ";" << beginOfCurrentPacket + current->GetSize () <<
-                               "], found in the sackboard already sacked");
-                }
-              else
-                {
-                  item->m_sacked = true;
-                  NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
-                               ", checking sentList for block " << beginOfCurrentPacket <<
-                               ";" << beginOfCurrentPacket + current->GetSize () <<
-                               "], found in the sackboard, sacking");
-                  if (m_highestSack.second <= beginOfCurrentPacket + current->GetSize ())
-                    {
-                      PacketList::iterator new_it = item_it;
-                      m_highestSack = std::make_pair (++new_it, beginOfCurrentPacket+current->GetSize ());
-                    }
-                }
-              modified = true;
-            }
-          else if (beginOfCurrentPacket + current->GetSize () > b.second)
+          if (endOfCurrentPacket > b.second)
             {
-              // we missed the block. It's useless to iterate again; Say "ciao"
-              // to the loop for optimization purposes
-              NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
-                           ", checking sentList for block " << beginOfCurrentPacket <<
-                           ";" << beginOfCurrentPacket + current->GetSize () <<
-                           "], not found, breaking loop");
               break;
             }
 
-          beginOfCurrentPacket += current->GetSize ();
-          ++item_it;
+          SentList::value_type segment (beginOfCurrentPacket, item);
+          RemoveFromScoreboard (segment);
+          item->m_sacked = true;
+          AddToScoreboard (segment);
+          RackUpdate (segment);
+          RateDelivered (item, current->GetSize ());
+          NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
+                       ", checking sentList for block " << beginOfCurrentPacket <<
+                       ";" << endOfCurrentPacket << "], found in the sackboard, sacking");
+
+          item = GetFirstUnsacked (endOfCurrentPacket, &beginOfCurrentPacket);
         }
     }
 
-  NS_ASSERT ((*(m_sentList.begin ()))->m_sacked == false);
+  NS_ASSERT (m_sentList.begin ()->second->m_sacked == false);
 
   return modified;
 }
 
 bool
-TcpTxBuffer::IsLost (const SequenceNumber32 &seq, const PacketList::const_iterator &segment,
-                     uint32_t dupThresh, uint32_t segmentSize) const
+TcpTxBuffer::GetLossBound (uint32_t dupThresh, uint32_t segmentSize,
+                           SequenceNumber32 *bound) const
 {
-  NS_LOG_FUNCTION (this << seq << dupThresh << segmentSize);
+  NS_LOG_FUNCTION (this << dupThresh << segmentSize);
   uint32_t count = 0;
   uint32_t bytes = 0;
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  Ptr<const Packet> current;
-  SequenceNumber32 beginOfCurrentPacket = seq;
-
-  NS_LOG_INFO ("Checking if seq=" << seq << " is lost from the buffer ");
-
-  if ((*segment)->m_lost == true)
-    {
-      NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-      return true;
-    }
-
-  if ((*segment)->m_sacked == true)
-    {
-      NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-      return false;
-    }
+  SentList::const_reverse_iterator it;
 
   // From RFC 6675:
   // > The routine returns true when either dupThresh discontiguous SACKed
   // > sequences have arrived above 'seq' or more than (dupThresh - 1) * SMSS bytes
   // > with sequence numbers greater than 'SeqNum' have been SACKed.  Otherwise, the
   // > routine returns false.
-  for (it = segment; it != m_highestSack.first; ++it)
+  // The SACKed segments above a sequence only grow when the sequence
+  // decreases; walk them from the highest, until the condition is met.
+  for (it = m_sackedItems.rbegin (); it != m_sackedItems.rend (); ++it)
     {
-      if (beginOfCurrentPacket >= m_highestSack.second)
+      ++count;
+      bytes += it->second->m_packet->GetSize ();
+      if ((count >= dupThresh) || (bytes > (dupThresh-1) * segmentSize))
         {
-          NS_LOG_INFO ("seq=" << seq << " is not lost because there are no sacked segment ahead");
-          return false;
+          NS_LOG_INFO ("Segments before " << it->first << " are lost because of " <<
+                       count << " sacked blocks ahead");
+          *bound = it->first;
+          return true;
         }
+    }
 
-      item = *it;
-      current = item->m_packet;
+  return false;
+}
 
-      if (item->m_sacked)
-        {
-          NS_LOG_INFO ("Segment [" << beginOfCurrentPacket << ", " <<
-                       beginOfCurrentPacket+item->m_packet->GetSize () <<
-                       "] found to be SACKed");
-          ++count;
-          bytes += current->GetSize ();
-          if ((count >= dupThresh) || (bytes > (dupThresh-1) * segmentSize))
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of 3 sacked blocks ahead");
-              return true;
-            }
-        }
+bool
+TcpTxBuffer::IsLost (const SentList::value_type &segment, bool hasBound,
+                     const SequenceNumber32 &bound) const
+{
+  NS_LOG_FUNCTION (this << segment.first << hasBound << bound);
 
-      beginOfCurrentPacket += current->GetSize ();
+  if (segment.second->m_lost == true)
+    {
+      NS_LOG_INFO ("seq=" << segment.first << " is lost because of lost flag");
+      return true;
     }
 
-  return false;
+  if (segment.second->m_sacked == true)
+    {
+      NS_LOG_INFO ("seq=" << segment.first << " is not lost because of sacked flag");
+      return false;
+    }
+
+  return hasBound && segment.first < bound;
 }
 
 bool
@@ -795,28 +1084,21 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq, uint32_t dupThresh,
 {
   NS_LOG_FUNCTION (this << seq << dupThresh);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
-  if (seq >= m_highestSack.second)
+  if (m_sackedItems.empty () || seq >= GetHighestSacked ())
     {
       return false;
     }
 
-  // This O(n) method is called only once, and outside this class.
-  // It should not harm the performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Search for the first segment at or after seq
+  SentList::const_iterator it = m_sentList.lower_bound (seq);
+  if (it == m_sentList.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          return IsLost (beginOfCurrentPacket, it, dupThresh, segmentSize);
-        }
-
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      return false;
     }
 
-  return false;
+  SequenceNumber32 bound;
+  bool hasBound = GetLossBound (dupThresh, segmentSize, &bound);
+  return IsLost (*it, hasBound, bound);
 }
 
 bool
@@ -839,33 +1121,30 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  SequenceNumber32 bound;
+  bool hasBound = GetLossBound (dupThresh, segmentSize, &bound);
+  bool found = false;
+
+  // The segments neither retransmitted nor SACKed are indexed: the first one
+  // marked lost satisfies (1.c), and so does the first one not marked lost
+  // if it is before the loss boundary.
+  if (!m_lostItems.empty ())
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
+      *seq = m_lostItems.begin ()->first;
+      found = true;
+    }
+  if (!m_unretxItems.empty ())
+    {
+      SentList::const_iterator it = m_unretxItems.begin ();
+      if (IsLost (*it, hasBound, bound) && (!found || it->first < *seq))
         {
-          if (IsLost (beginOfCurrentPkt, it, dupThresh, segmentSize))
-            {
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
+          *seq = it->first;
+          found = true;
         }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+    }
+  if (found)
+    {
+      return true;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -886,9 +1165,11 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  // Rule (1) failed, so no segment is marked lost: S3 is the first one not
+  // retransmitted and not SACKed
+  if (isRecovery && !m_unretxItems.empty ())
     {
-      *seq = seqPerRule3;
+      *seq = m_unretxItems.begin ()->first;
       return true;
     }
 
@@ -910,53 +1191,136 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
 uint32_t
 TcpTxBuffer::BytesInFlight (uint32_t dupThresh, uint32_t segmentSize) const
 {
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  uint32_t size = 0; // "pipe" in RFC
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
+  SequenceNumber32 bound;
+  bool hasBound = GetLossBound (dupThresh, segmentSize, &bound);
 
   // After initializing pipe to zero, the following steps are taken for each
   // octet 'S1' in the sequence space between HighACK and HighData that has not
   // been SACKed:
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // (a) If IsLost (S1) returns false: Pipe is incremented by 1 octet.
+  // (b) If S1 <= HighRxt: Pipe is incremented by 1 octet.
+  // (NOTE: we use the m_retrans flag instead of keeping and updating
+  // another variable). Only if the item is not marked as lost
+  //
+  // Hence, an octet neither SACKed nor marked as lost is counted, unless it
+  // is before the loss boundary and it has not been retransmitted.
+  uint32_t size = m_sentSize - m_sackedBytes - m_lostBytes; // "pipe" in RFC
+
+  if (hasBound)
     {
-      item = *it;
-      if (!item->m_sacked)
+      SentList::const_iterator it;
+      for (it = m_unretxItems.begin (); it != m_unretxItems.end () && it->first < bound; ++it)
         {
-          // (a) If IsLost (S1) returns false: Pipe is incremented by 1 octet.
-          if (!IsLost (beginOfCurrentPkt, it, dupThresh, segmentSize))
-            {
-              size += item->m_packet->GetSize ();
-            }
-          // (b) If S1 <= HighRxt: Pipe is incremented by 1 octet.
-          // (NOTE: we use the m_retrans flag instead of keeping and updating
-          // another variable). Only if the item is not marked as lost
-          else if (item->m_retrans && !item->m_lost)
-            {
-              size += item->m_packet->GetSize ();
-            }
+          size -= it->second->m_packet->GetSize ();
         }
-      beginOfCurrentPkt += item->m_packet->GetSize ();
     }
 
   return size;
 }
 
+bool
+TcpTxBuffer::RackDetectLoss (const Time &srtt, bool isRecovery, uint32_t dupThresh,
+                             Time *timeout)
+{
+  NS_LOG_FUNCTION (this << srtt << isRecovery << dupThresh);
+
+  *timeout = Time (0);
+  if (m_rackXmitTs == Time::Min ())
+    {
+      // Nothing delivered yet
+      return false;
+    }
+
+  // RFC 8985, Section 6.2, step 4
+  Time reoWnd = Time (0);
+  if (m_rackReorderingSeen || (!isRecovery && m_sackedItems.size () < dupThresh))
+    {
+      reoWnd = std::min (m_rackMinRtt / 4, srtt);
+    }
+
+  // RFC 8985, Section 6.2, step 5: a segment is lost if it was sent before
+  // the most recently sent segment delivered, and RACK.rtt + RACK.reo_wnd
+  // has elapsed since its transmission
+  Time now = Simulator::Now ();
+  Time next = Time::Max ();
+  std::vector<SentList::value_type> lost;
+  SentList::const_iterator it;
+
+  // The retransmissions are not in order of transmission time
+  for (it = m_retxItems.begin (); it != m_retxItems.end (); ++it)
+    {
+      TcpTxItem *item = it->second;
+      SequenceNumber32 endSeq = it->first + item->m_packet->GetSize ();
+      if (item->m_lastSent > m_rackXmitTs
+          || (item->m_lastSent == m_rackXmitTs && endSeq >= m_rackEndSeq))
+        {
+          continue;
+        }
+
+      Time remaining = item->m_lastSent + m_rackRtt + reoWnd - now;
+      if (remaining.IsStrictlyPositive ())
+        {
+          next = std::min (next, remaining);
+        }
+      else
+        {
+          lost.push_back (*it);
+        }
+    }
+
+  // The first transmissions are in order: stop at the first one not lost
+  for (it = m_unretxItems.begin (); it != m_unretxItems.end (); ++it)
+    {
+      TcpTxItem *item = it->second;
+      SequenceNumber32 endSeq = it->first + item->m_packet->GetSize ();
+      if (item->m_lastSent > m_rackXmitTs
+          || (item->m_lastSent == m_rackXmitTs && endSeq >= m_rackEndSeq))
+        {
+          break;
+        }
+
+      Time remaining = item->m_lastSent + m_rackRtt + reoWnd - now;
+      if (remaining.IsStrictlyPositive ())
+        {
+          next = std::min (next, remaining);
+          break;
+        }
+      lost.push_back (*it);
+    }
+
+  for (std::vector<SentList::value_type>::iterator l = lost.begin (); l != lost.end (); ++l)
+    {
+      NS_LOG_INFO ("RACK marks seq=" << l->first << " as lost");
+      RemoveFromScoreboard (*l);
+      l->second->m_lost = true;
+      l->second->m_retrans = false;
+      AddToScoreboard (*l);
+    }
+
+  if (next != Time::Max ())
+    {
+      *timeout = next;
+    }
+
+  return !lost.empty ();
+}
+
 void
 TcpTxBuffer::ResetScoreboard ()
 {
   NS_LOG_FUNCTION (this);
 
-  PacketList::iterator it;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
+  SentList sacked;
+  SentList::iterator it;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  sacked.swap (m_sackedItems);
+  m_sackedBytes = 0;
+
+  for (it = sacked.begin (); it != sacked.end (); ++it)
     {
-      (*it)->m_sacked = false;
-      beginOfCurrentPkt += (*it)->m_packet->GetSize ();
+      it->second->m_sacked = false;
+      AddToScoreboard (*it);
     }
-
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
 }
 
 void
@@ -968,26 +1332,28 @@ TcpTxBuffer::ResetSentList ()
   // Keep the head; it will then marked as retransmitted.
   while (m_sentList.size () > 1)
     {
-      item = m_sentList.back ();
+      SentList::iterator last = --m_sentList.end ();
+      item = last->second;
       item->m_retrans = item->m_sacked = false;
       m_appList.push_front (item);
-      m_sentList.pop_back ();
+      m_sentList.erase (last);
     }
 
+  ClearScoreboard ();
+
   if (m_sentList.size () > 0)
     {
-      item = m_sentList.back ();
+      item = m_sentList.begin ()->second;
       item->m_lost = true;
       item->m_sacked = false;
       item->m_retrans = false;
       m_sentSize = item->m_packet->GetSize ();
+      AddToScoreboard (*m_sentList.begin ());
     }
   else
     {
       m_sentSize = 0;
     }
-
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
 }
 
 void
@@ -996,9 +1362,11 @@ TcpTxBuffer::ResetLastSegmentSent ()
   NS_LOG_FUNCTION (this);
   if (!m_sentList.empty ())
     {
-      TcpTxItem *item = m_sentList.back ();
+      SentList::iterator last = --m_sentList.end ();
+      TcpTxItem *item = last->second;
 
-      m_sentList.pop_back ();
+      RemoveFromScoreboard (*last);
+      m_sentList.erase (last);
       m_sentSize -= item->m_packet->GetSize ();
       m_appList.insert (m_appList.begin (), item);
     }
@@ -1009,11 +1377,13 @@ TcpTxBuffer::SetSentListLost ()
 {
   NS_LOG_FUNCTION (this);
 
-  PacketList::iterator it;
+  SentList::iterator it;
 
   for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
-      (*it)->m_lost = true;
+      RemoveFromScoreboard (*it);
+      it->second->m_lost = true;
+      AddToScoreboard (*it);
     }
 }
 
@@ -1028,7 +1398,7 @@ TcpTxBuffer::IsHeadRetransmitted () const
     }
 
   NS_ASSERT (m_sentList.size () > 0);
-  return m_sentList.front ()->m_retrans;
+  return m_sentList.begin ()->second->m_retrans;
 }
 
 Ptr<const TcpOptionSack>
@@ -1043,20 +1413,22 @@ TcpTxBuffer::CraftSackOption (const SequenceNumber32 &seq, uint8_t available) co
   NS_LOG_INFO ("Crafting a SACK block, available bytes: " << (uint32_t) available <<
                " from seq: " << seq << " buffer starts at seq " << m_firstByteSeq);
 
-  PacketList::const_iterator it;
-  if (m_highestSack.first == m_sentList.end ())
+  // Start after the highest SACKed segment, if it is not the last one sent
+  SentList::const_iterator it = m_sentList.begin ();
+  if (!m_sackedItems.empty ())
     {
-      it = m_sentList.begin ();
-    }
-  else
-    {
-      it = m_highestSack.first;
-      beginOfCurrentPacket = m_highestSack.second;
+      SentList::const_iterator highest = m_sentList.find (m_sackedItems.rbegin ()->first);
+      NS_ASSERT (highest != m_sentList.end ());
+      if (++highest != m_sentList.end ())
+        {
+          it = highest;
+          beginOfCurrentPacket = it->first;
+        }
     }
 
   while (it != m_sentList.end ())
     {
-      item = *it;
+      item = it->second;
       current = item->m_packet;
 
       SequenceNumber32 endOfCurrentPacket = beginOfCurrentPacket + current->GetSize ();
@@ -1103,7 +1475,7 @@ TcpTxBuffer::CraftSackOption (const SequenceNumber32 &seq, uint8_t available) co
                   return sackBlock;
                 }
 
-              item = *it;
+              item = it->second;
               current = item->m_packet;
               endOfCurrentPacket = beginOfCurrentPacket;
               beginOfCurrentPacket -= current->GetSize ();
@@ -1124,21 +1496,40 @@ TcpTxBuffer::CraftSackOption (const SequenceNumber32 &seq, uint8_t available) co
   return sackBlock;
 }
 
+TcpRateSample::TcpRateSample ()
+  : m_deliveryRate (0),
+    m_isAppLimited (false),
+    m_interval (Time (0)),
+    m_sendElapsed (Time (0)),
+    m_ackElapsed (Time (0)),
+    m_delivered (0),
+    m_priorDelivered (0),
+    m_priorTime (Time::Min ()),
+    m_rtt (Time (0)),
+    m_totalDelivered (0),
+    m_ackedSacked (0),
+    m_priorInFlight (0),
+    m_bytesInFlight (0)
+{
+}
+
 std::ostream &
 operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf)
 {
+  TcpTxBuffer::SentList::const_iterator sentIt;
   TcpTxBuffer::PacketList::const_iterator it;
   std::stringstream ss;
   SequenceNumber32 beginOfCurrentPacket = tcpTxBuf.m_firstByteSeq;
   uint32_t sentSize = 0, appSize = 0;
 
   Ptr<Packet> p;
-  for (it = tcpTxBuf.m_sentList.begin (); it != tcpTxBuf.m_sentList.end (); ++it)
+  for (sentIt = tcpTxBuf.m_sentList.begin (); sentIt != tcpTxBuf.m_sentList.end (); ++sentIt)
     {
-      p = (*it)->m_packet;
+      p = sentIt->second->m_packet;
+      NS_ASSERT (sentIt->first == beginOfCurrentPacket);
       ss << "[" << beginOfCurrentPacket << ";"
          << beginOfCurrentPacket + p->GetSize () << "|" << p->GetSize () << "|";
-      (*it)->Print (ss);
+      sentIt->second->Print (ss);
       ss << "]";
       sentSize += p->GetSize ();
       beginOfCurrentPacket += p->GetSize ();
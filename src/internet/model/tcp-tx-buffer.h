@@ -22,10 +22,13 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <map>
+
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
 #include "ns3/nstime.h"
+#include "ns3/data-rate.h"
 #include "ns3/tcp-option-sack.h"
 
 namespace ns3 {
@@ -62,6 +65,43 @@ public:
   Time m_lastSent;      //!< Timestamp of the time at which the segment has
                         //   been sent last time
   bool m_sacked;        //!< Indicates if the segment has been SACKed
+
+  // Delivery rate state of the connection when the segment was sent
+  uint64_t m_delivered;   //!< Bytes delivered by the connection
+  Time m_deliveredTime;   //!< Time of the last delivery of the connection
+  Time m_firstSentTime;   //!< Send time of the first segment of the sampling interval
+  bool m_isAppLimited;    //!< Connection application-limited
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Delivery rate sample, generated for every ACK
+ *
+ * The sample measures the bytes delivered between the transmission of the
+ * most recently sent segment acknowledged by the ACK, and its delivery. The
+ * interval is the longest between the "send phase" and the "ACK phase" of
+ * that flight of data, as in draft-cheng-iccrg-delivery-rate-estimation.
+ * When no segment has been delivered, or the interval is shorter than the
+ * minimum RTT, the sample is not valid: its interval and rate are zero.
+ */
+struct TcpRateSample
+{
+  TcpRateSample ();
+
+  DataRate m_deliveryRate;    //!< Delivery rate, zero if the sample is not valid
+  bool m_isAppLimited;        //!< The sample was taken while application-limited
+  Time m_interval;            //!< Length of the sampling interval, zero if not valid
+  Time m_sendElapsed;         //!< Send phase of the interval
+  Time m_ackElapsed;          //!< ACK phase of the interval
+  uint64_t m_delivered;       //!< Bytes delivered over the interval
+  uint64_t m_priorDelivered;  //!< Bytes delivered by the connection when the segment was sent
+  Time m_priorTime;           //!< Delivery time of the connection when the segment was sent
+  Time m_rtt;                 //!< RTT of the segment, zero if retransmitted or not valid
+  uint64_t m_totalDelivered;  //!< Bytes delivered by the connection so far
+  uint32_t m_ackedSacked;     //!< Bytes newly acknowledged or SACKed by the ACK
+  uint32_t m_priorInFlight;   //!< Bytes in flight before the ACK (set by the socket)
+  uint32_t m_bytesInFlight;   //!< Bytes in flight after the ACK (set by the socket)
 };
 
 /**
@@ -81,9 +121,10 @@ public:
  * class is allowed to return only ordered (using "<" as operator) subsets
  * (e.g. 1,2 or 2,3 or 1,2,3).
  *
- * The data structure underlying this is composed by two distinct packet lists.
- * The first (SentList) is initially empty, and it contains the packets
- * returned by the method CopyFromSequence. The second (AppList) is initially
+ * The data structure underlying this is composed by two distinct packet
+ * containers. The first (SentList) is initially empty, and it maps the first
+ * sequence number of the packets returned by the method CopyFromSequence to
+ * the packets themselves. The second (AppList) is initially
  * empty, and it contains the packets coming from the applications, but that
  * are not transmitted yet as segments. To discover how the chunks are managed
  * and retrieved from these lists, check CopyFromSequence documentation.
@@ -101,23 +142,69 @@ public:
  * the existing classes. In particular, instead of keeping raw pointers to
  * packets in TcpTxBuffer we added the capability to store some flags
  * associated with every segment sent. This is done through the use of the
- * class TcpTxItem: instead of storing a list of packets, we store a list of
- * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * class TcpTxItem: instead of storing a list of packets, we store the sent
+ * TcpTxItem in a map, keyed by the sequence number of their first byte. Each
+ * item has different flags (check the corresponding documentation) and
+ * maintaining the scoreboard is a matter of looking up the items covered by
+ * a SACK block and set the SACK flag on them.
+ *
+ * Scoreboard indexes
+ * ------------------
  *
- * Inefficiencies
- * --------------
+ * The algorithms outlined in RFC 6675 are written as walks over the whole
+ * sequence space, which makes every ACK cost O(window) with large windows.
+ * Besides the sent map, the buffer keeps four indexes of the sent items,
+ * again keyed by sequence number:
  *
- * The algorithms outlined in RFC 6675 are full of inefficiencies. In
- * particular, traveling all the sent list each time it is needed to compute
- * the bytes in flight is expensive. We try to overcome the issue by
- * maintaining a pointer to the highest sequence SACKed; in this way, we can
- * avoid traveling all the list in some cases. Another option could be keeping
- * a count of each critical value (e.g., the number of packets sacked).
- * However, this would be different from the algorithms in RFC. There are some
- * other possible improvements; if you wish, take a look and try  to add some
- * earlier exit conditions in the loops.
+ * - the SACKed items;
+ * - the items not SACKed and retransmitted;
+ * - the items not SACKed, not retransmitted and marked lost (after an RTO);
+ * - the items not SACKed, not retransmitted and not marked lost.
+ *
+ * together with the number of SACKed bytes, and of the bytes marked lost
+ * and not SACKed. The RFC 6675 IsLost () test is monotone: if a segment is
+ * lost because of the SACKed segments above it, so are all the segments
+ * before it. Walking the SACKed index down from the highest SACKed item
+ * for at most dupThresh items gives the boundary under which the segments
+ * are lost, and therefore:
+ *
+ * - Update () costs O(log n) per SACK block and per newly SACKed item, as
+ *   the items already SACKed are skipped;
+ * - IsLost () and NextSeg () cost O(log n + dupThresh);
+ * - BytesInFlight () costs O(dupThresh) plus the segments deemed lost and not
+ *   retransmitted yet (the ones NextSeg () is about to return);
+ * - the retrieval of a segment to retransmit costs O(log n).
+ *
+ * Every change to the flags, the size or the sequence number of a sent item
+ * must be surrounded by RemoveFromScoreboard () and AddToScoreboard (), so
+ * that the indexes and the counters stay consistent.
+ *
+ * RACK
+ * ----
+ *
+ * Besides the RFC 6675 rules, the buffer can mark segments lost by time, as
+ * RACK (RFC 8985) does. Every time a segment is SACKed or cumulatively
+ * acknowledged, the buffer remembers the transmission time of the most
+ * recently sent segment delivered (RACK.xmit_ts) and its RTT. A segment sent
+ * before it, and not delivered yet, is lost if RACK.rtt plus a reordering
+ * window has elapsed since it was sent. The detection is run by the socket
+ * through RackDetectLoss (); the lost segments are marked with the lost flag,
+ * so that NextSeg () returns them for retransmission and BytesInFlight ()
+ * does not count them. The first transmissions are sent in sequence order,
+ * hence the walk over the items not retransmitted stops at the first one
+ * which is not lost yet.
+ *
+ * Delivery rate
+ * -------------
+ *
+ * Every sent item is stamped with the count of bytes delivered by the
+ * connection, and the time of the last delivery. When the item is SACKed or
+ * cumulatively acknowledged, the stamps of the most recently sent item
+ * delivered by the ACK are kept; GenerateRateSample (), called by the socket
+ * once the ACK has been processed, turns them into a TcpRateSample. The
+ * application-limited periods, marked by the socket through
+ * MarkAppLimited (), taint the samples taken until the data sent in them
+ * has been delivered.
  *
  * \see Size
  * \see SizeFromSequence
@@ -152,6 +239,17 @@ public:
    */
   SequenceNumber32 TailSequence (void) const;
 
+  /**
+   * \brief Get the sequence number of the last segment sent
+   *
+   * This is the first byte of the highest segment in the sent list, i.e.,
+   * the segment that a Tail Loss Probe retransmits.
+   *
+   * \returns the first byte's sequence number of the last segment sent, or
+   * the head sequence if nothing has been sent
+   */
+  SequenceNumber32 LastSentSequence (void) const;
+
   /**
    * \brief Returns total number of bytes in this buffer
    * \returns total number of bytes in this Tx buffer
@@ -269,6 +367,74 @@ public:
    */
   uint32_t BytesInFlight (uint32_t dupThresh, uint32_t segmentSize) const;
 
+  /**
+   * \brief Mark the segments lost by time, as RACK does (RFC 8985)
+   *
+   * A segment not delivered yet is lost if it was sent before the most
+   * recently sent segment which was delivered, and more than the RTT of the
+   * latter plus the reordering window has elapsed since its transmission.
+   * The reordering window is a quarter of the minimum RTT, capped at srtt;
+   * it is zero when no reordering has been seen, and either the socket is
+   * in recovery or dupThresh segments have been SACKed.
+   *
+   * \param srtt smoothed RTT of the connection
+   * \param isRecovery true if the socket congestion state is in recovery mode
+   * \param dupThresh dupAck threshold
+   * \param timeout output parameter, set to the time after which a segment
+   * not lost yet should be considered again, or zero
+   * \return true if some segment has been marked lost
+   */
+  bool RackDetectLoss (const Time &srtt, bool isRecovery, uint32_t dupThresh,
+                       Time *timeout);
+
+  /**
+   * \brief Generate the delivery rate sample of the last ACK
+   *
+   * The segments delivered since the previous call are accounted; the
+   * state of the sample is reset for the next ACK.
+   *
+   * \return the rate sample
+   */
+  TcpRateSample GenerateRateSample (void);
+
+  /**
+   * \brief Mark the connection application-limited
+   *
+   * The samples are application-limited until the bytes currently in
+   * flight have been delivered.
+   *
+   * \param bytesInFlight bytes in flight
+   */
+  void MarkAppLimited (uint32_t bytesInFlight);
+
+  /**
+   * \brief Get the bytes delivered (acknowledged or SACKed) so far
+   * \return the bytes delivered by the connection
+   */
+  uint64_t GetDelivered (void) const;
+
+  /**
+   * \brief Get the delivery rate of the connection
+   *
+   * It is the rate of the last sample which was not application-limited,
+   * or of an application-limited one with a higher rate.
+   *
+   * \return the delivery rate, zero if no valid sample has been taken yet
+   */
+  DataRate GetDeliveryRate (void) const;
+
+  /**
+   * \brief Get the bytes SACKed by the receiver and not yet acknowledged
+   * \return the size of the SACKed segments
+   */
+  uint32_t GetSackedBytes (void) const;
+
+  /**
+   * \brief Get the bytes marked lost and not SACKed
+   * \return the size of the lost segments
+   */
+  uint32_t GetLostBytes (void) const;
+
   /**
    * \brief Set the entire sent list as lost (typically after an RTO)
    *
@@ -320,17 +486,75 @@ private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::map<SequenceNumber32, TcpTxItem*> SentList; //!< container for sent items, keyed by their first sequence number
 
   /**
-   * \brief Check if a segment is lost per RFC 6675
-   * \param seq sequence to check
-   * \param segment Iterator pointing at seq
+   * \brief Find the boundary of the segments lost per RFC 6675
+   *
+   * A segment which is not SACKed is lost when dupThresh SACKed segments, or
+   * more than (dupThresh - 1) * segmentSize SACKed bytes, are above it. The
+   * function walks the SACKed items down from the highest one, until the
+   * condition is met.
+   *
    * \param dupThresh dupAck threshold
    * \param segmentSize segment size
+   * \param bound output parameter, set to the sequence under which the
+   * segments not SACKed are lost
+   * \return true if bound has been set, false if no segment is lost by SACK
+   */
+  bool GetLossBound (uint32_t dupThresh, uint32_t segmentSize, SequenceNumber32 *bound) const;
+
+  /**
+   * \brief Check if a segment is lost per RFC 6675
+   * \param segment the sent item to check, with its sequence number
+   * \param hasBound the return value of GetLossBound
+   * \param bound the boundary set by GetLossBound
    * \return true if the sequence is supposed to be lost, false otherwise
    */
-  bool IsLost (const SequenceNumber32 &seq, const PacketList::const_iterator &segment, uint32_t dupThresh,
-               uint32_t segmentSize) const;
+  bool IsLost (const SentList::value_type &segment, bool hasBound,
+               const SequenceNumber32 &bound) const;
+
+  /**
+   * \brief Add a sent item to the scoreboard indexes and counters
+   * \param segment the sent item, with its sequence number
+   */
+  void AddToScoreboard (const SentList::value_type &segment);
+
+  /**
+   * \brief Remove a sent item from the scoreboard indexes and counters
+   *
+   * It must be called with the flags and the size that were used to add it.
+   *
+   * \param segment the sent item, with its sequence number
+   */
+  void RemoveFromScoreboard (const SentList::value_type &segment);
+
+  /**
+   * \brief Clear the scoreboard indexes and counters
+   */
+  void ClearScoreboard (void);
+
+  /**
+   * \brief Update the RACK state with a segment just delivered
+   * \param segment the sent item, with its sequence number
+   */
+  void RackUpdate (const SentList::value_type &segment);
+
+  /**
+   * \brief Update the delivery rate state with a segment just delivered
+   * \param item the sent item
+   * \param bytes bytes of the item delivered (less than its size if
+   * partially acknowledged)
+   */
+  void RateDelivered (const TcpTxItem *item, uint32_t bytes);
+
+  /**
+   * \brief Find the first sent item not SACKed, starting at or after seq
+   * \param seq sequence from which to search
+   * \param start output parameter, set to the first sequence of the item
+   * \return the item, or 0 if all the items after seq are SACKed
+   */
+  TcpTxItem* GetFirstUnsacked (const SequenceNumber32 &seq, SequenceNumber32 *start) const;
 
   /**
    * \brief Get a block of data not transmitted yet and move it into SentList
@@ -344,25 +568,23 @@ private:
    * \see GetPacketFromList
    * \param numBytes number of bytes to copy
    *
-   * \return the item that contains the right packet
+   * \return the position of the item that contains the right packet
    */
-  TcpTxItem* GetNewSegment (uint32_t numBytes);
+  SentList::iterator GetNewSegment (uint32_t numBytes);
 
   /**
    * \brief Get a block of data previously transmitted
    *
    * This is clearly a retransmission, and if everything is going well,
    * the block requested is matching perfectly with another one requested
-   * in the past. If not, fragmentation or merge are required. We manage
-   * both inside GetPacketFromList.
-   *
-   * \see GetPacketFromList
+   * in the past. If not, the items at the boundaries of the block are split,
+   * and the items inside the block are merged, as in GetPacketFromList.
    *
    * \param numBytes number of bytes to copy
    * \param seq sequence requested
-   * \returns the item that contains the right packet
+   * \returns the position of the item that contains the right packet
    */
-  TcpTxItem* GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &seq);
+  SentList::iterator GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &seq);
 
   /**
    * \brief Get a block (which is returned as Packet) from a list
@@ -462,22 +684,40 @@ private:
   void SplitItems (TcpTxItem &t1, TcpTxItem &t2, uint32_t size) const;
 
   /**
-   * \brief Find the highest SACK byte
-   * \return a pair with the highest byte and an iterator inside m_sentList
+   * \brief Get the highest SACKed byte
+   * \return the sequence after the highest SACKed byte, or the head sequence
+   * if nothing is SACKed
    */
-  std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
-  GetHighestSacked () const;
+  SequenceNumber32 GetHighestSacked (void) const;
 
   PacketList m_appList;  //!< Buffer for application data
-  PacketList m_sentList; //!< Buffer for sent (but not acked) data
+  SentList m_sentList;   //!< Buffer for sent (but not acked) data
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_size;       //!< Size of all data in this buffer
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
 
-  std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
-
+  SentList m_sackedItems;   //!< Sent items SACKed
+  SentList m_retxItems;     //!< Sent items not SACKed, retransmitted
+  SentList m_lostItems;     //!< Sent items not SACKed nor retransmitted, marked lost
+  SentList m_unretxItems;   //!< Sent items not SACKed nor retransmitted, not marked lost
+  uint32_t m_sackedBytes;   //!< Size of the SACKed items
+  uint32_t m_lostBytes;     //!< Size of the items marked lost and not SACKed
+
+  Time m_rackXmitTs;              //!< Transmission time of the most recently sent segment delivered
+  SequenceNumber32 m_rackEndSeq;  //!< End sequence of that segment
+  Time m_rackRtt;                 //!< RTT measured on that segment
+  Time m_rackMinRtt;              //!< Minimum RTT measured on the delivered segments
+  SequenceNumber32 m_rackFack;    //!< Highest end sequence delivered
+  bool m_rackReorderingSeen;      //!< A segment has been delivered below m_rackFack
+
+  uint64_t m_rateDelivered;       //!< Bytes delivered by the connection
+  Time m_rateDeliveredTime;       //!< Time of the last delivery
+  Time m_rateFirstSentTime;       //!< Send time of the most recently sent segment delivered
+  uint64_t m_rateAppLimited;      //!< End of the application-limited period (in delivered bytes), or 0
+  TcpRateSample m_rateSample;     //!< Sample being built for the current ACK
+  DataRate m_rateLastRate;        //!< Rate of the connection, see GetDeliveryRate ()
 };
 
 /**
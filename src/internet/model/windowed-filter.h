@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef WINDOWED_FILTER_H
+#define WINDOWED_FILTER_H
+
+#include <functional>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Running maximum (or minimum) of a measurement over a time window
+ *
+ * Kathleen Nichols' algorithm, as in Linux lib/win_minmax.c: the filter keeps
+ * the best, second best and third best measurements, taken in successive
+ * sub-windows, so that when the best one ages out of the window the next
+ * one is promoted in constant time and memory.
+ *
+ * The window can be measured in any unit T (time, or round trips) which
+ * supports subtraction and division by an integer. A new measurement
+ * replaces an older one if Compare (new, old) holds: std::greater_equal
+ * gives a max filter, std::less_equal a min filter.
+ *
+ * \tparam V type of the measurements
+ * \tparam T type of the timestamps
+ * \tparam Compare comparison between measurements
+ */
+template <class V, class T, class Compare>
+class WindowedFilter
+{
+public:
+  /**
+   * \brief Constructor
+   * \param windowLength length of the window
+   * \param zeroValue measurement returned before any update
+   * \param zeroTime timestamp of that measurement
+   */
+  WindowedFilter (T windowLength, V zeroValue, T zeroTime)
+    : m_windowLength (windowLength)
+  {
+    Reset (zeroTime, zeroValue);
+  }
+
+  /**
+   * \brief Set the length of the window
+   * \param windowLength length of the window
+   */
+  void SetWindowLength (T windowLength)
+  {
+    m_windowLength = windowLength;
+  }
+
+  /**
+   * \brief Forget the measurements, and start again from one
+   * \param time timestamp of the measurement
+   * \param value the measurement
+   * \return the best measurement, that is value
+   */
+  V Reset (T time, V value)
+  {
+    m_samples[0].m_time = m_samples[1].m_time = m_samples[2].m_time = time;
+    m_samples[0].m_value = m_samples[1].m_value = m_samples[2].m_value = value;
+    return value;
+  }
+
+  /**
+   * \brief Add a measurement
+   *
+   * The timestamps must not decrease across the updates.
+   *
+   * \param time timestamp of the measurement
+   * \param value the measurement
+   * \return the best measurement in the window
+   */
+  V Update (T time, V value)
+  {
+    Compare better;
+    if (better (value, m_samples[0].m_value)
+        || time - m_samples[2].m_time > m_windowLength)
+      {
+        // New best, or nothing left in the window
+        return Reset (time, value);
+      }
+
+    Sample sample = { time, value };
+    if (better (value, m_samples[1].m_value))
+      {
+        m_samples[2] = m_samples[1] = sample;
+      }
+    else if (better (value, m_samples[2].m_value))
+      {
+        m_samples[2] = sample;
+      }
+    return UpdateSubWindows (sample);
+  }
+
+  /**
+   * \brief Get the best measurement in the window
+   * \return the best measurement
+   */
+  V GetBest (void) const
+  {
+    return m_samples[0].m_value;
+  }
+
+  /**
+   * \brief Get the timestamp of the best measurement
+   * \return the timestamp of the best measurement
+   */
+  T GetBestTime (void) const
+  {
+    return m_samples[0].m_time;
+  }
+
+private:
+  /**
+   * \brief A measurement with its timestamp
+   */
+  struct Sample
+  {
+    T m_time;   //!< Timestamp
+    V m_value;  //!< Measurement
+  };
+
+  /**
+   * \brief Age the best measurements, as the window slides
+   * \param sample the last measurement
+   * \return the best measurement in the window
+   */
+  V UpdateSubWindows (const Sample &sample)
+  {
+    T elapsed = sample.m_time - m_samples[0].m_time;
+    if (elapsed > m_windowLength)
+      {
+        // The best measurement is out of the window: promote the second
+        // and the third best, and check the new best again
+        m_samples[0] = m_samples[1];
+        m_samples[1] = m_samples[2];
+        m_samples[2] = sample;
+        if (sample.m_time - m_samples[0].m_time > m_windowLength)
+          {
+            m_samples[0] = m_samples[1];
+            m_samples[1] = m_samples[2];
+            m_samples[2] = sample;
+          }
+      }
+    else if (m_samples[1].m_time == m_samples[0].m_time
+             && elapsed > m_windowLength / 4)
+      {
+        // A quarter of the window has passed without a second best: take
+        // one from the second quarter
+        m_samples[2] = m_samples[1] = sample;
+      }
+    else if (m_samples[2].m_time == m_samples[1].m_time
+             && elapsed > m_windowLength / 2)
+      {
+        // Same for the third best, in the second half of the window
+        m_samples[2] = sample;
+      }
+    return m_samples[0].m_value;
+  }
+
+  T m_windowLength;     //!< Length of the window
+  Sample m_samples[3];  //!< Best, second best and third best measurements
+};
+
+} // namespace ns3
+
+#endif /* WINDOWED_FILTER_H */
@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lookups of the Ipv4EndPointDemux
+ *
+ * The exact matches, found in the connection table, must take precedence
+ * over the end points with wildcards, also after the peer of an end point
+ * is set or the end point is deallocated, and the end points with
+ * wildcards must be returned in the usual order of preference.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Lookups in the IPv4 end point demux")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  Ipv4Address other ("10.0.0.3");
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->AddAddress (Ipv4InterfaceAddress (local, Ipv4Mask ("255.255.255.0")));
+
+  Ipv4EndPoint *listener = demux.Allocate (50000);
+  Ipv4EndPoint *bound = demux.Allocate (local, 50000);
+  Ipv4EndPointDemux::EndPoints res = demux.Lookup (local, 50000, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (res.size (), 1u, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (res.front (), bound, "Local address match not preferred");
+
+  // Connections as created by a listening socket
+  std::vector<Ipv4EndPoint *> connections;
+  for (uint16_t port = 1000; port < 1100; port++)
+    {
+      connections.push_back (demux.Allocate (local, 50000, peer, port));
+    }
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 50000, peer, 1000), 0,
+                         "Duplicate connection allocated");
+  res = demux.Lookup (local, 50000, peer, 1042, interface);
+  NS_TEST_ASSERT_MSG_EQ (res.size (), 1u, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (res.front (), connections[42], "Exact match not found");
+  res = demux.Lookup (local, 50000, other, 1042, interface);
+  NS_TEST_ASSERT_MSG_EQ (res.front (), bound, "Unknown peer not sent to the listener");
+
+  connections[42]->SetRxEnabled (false);
+  res = demux.Lookup (local, 50000, peer, 1042, interface);
+  NS_TEST_ASSERT_MSG_EQ (res.front (), bound, "End point with disabled Rx returned");
+
+  demux.DeAllocate (connections[43]);
+  res = demux.Lookup (local, 50000, peer, 1043, interface);
+  NS_TEST_ASSERT_MSG_EQ (res.front (), bound, "Deallocated end point returned");
+
+  // A socket connecting from the wildcard address
+  Ipv4EndPoint *client = demux.Allocate ();
+  uint16_t clientPort = client->GetLocalPort ();
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (clientPort), true, "Ephemeral port not in use");
+  client->SetPeer (other, 80);
+  res = demux.Lookup (local, clientPort, other, 80, interface);
+  NS_TEST_ASSERT_MSG_EQ (res.size (), 1u, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (res.front (), client, "All but local address match not found");
+  client->SetLocalAddress (local);
+  res = demux.Lookup (local, clientPort, other, 80, interface);
+  NS_TEST_ASSERT_MSG_EQ (res.front (), client, "Exact match not found after SetLocalAddress");
+  res = demux.Lookup (local, clientPort, peer, 80, interface);
+  NS_TEST_ASSERT_MSG_EQ (res.empty (), true, "Connected end point matches another peer");
+  demux.DeAllocate (client);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (clientPort), false, "Ephemeral port still in use");
+
+  // Broadcasts go to all the end points with a wildcard peer
+  res = demux.Lookup (Ipv4Address ("10.0.0.255"), 50000, peer, 2000, interface);
+  NS_TEST_ASSERT_MSG_EQ (res.size (), 2u, "Wrong number of matches for a broadcast");
+  NS_TEST_ASSERT_MSG_EQ (res.front (), listener, "Broadcast not sent to the listener");
+  NS_TEST_ASSERT_MSG_EQ (res.back (), bound, "Broadcast not sent to the bound end point");
+
+  demux.DeAllocate (bound);
+  res = demux.Lookup (local, 50000, other, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (res.front (), listener, "Wildcard listener not found");
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, 50001, peer, 1000, interface).empty (), true,
+                         "Match on an unused port");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lookups of the Ipv6EndPointDemux
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Lookups in the IPv6 end point demux")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+  Ipv6Address local ("2001:db8::1");
+  Ipv6Address peer ("2001:db8::2");
+  Ipv6Address other ("2001:db8::3");
+
+  Ipv6EndPoint *listener = demux.Allocate (50000);
+  std::vector<Ipv6EndPoint *> connections;
+  for (uint16_t port = 1000; port < 1100; port++)
+    {
+      connections.push_back (demux.Allocate (local, 50000, peer, port));
+    }
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 50000, peer, 1000), 0,
+                         "Duplicate connection allocated");
+  Ipv6EndPointDemux::EndPoints res = demux.Lookup (local, 50000, peer, 1042, 0);
+  NS_TEST_ASSERT_MSG_EQ (res.size (), 1u, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (res.front (), connections[42], "Exact match not found");
+  res = demux.Lookup (local, 50000, other, 1042, 0);
+  NS_TEST_ASSERT_MSG_EQ (res.front (), listener, "Unknown peer not sent to the listener");
+
+  demux.DeAllocate (connections[42]);
+  res = demux.Lookup (local, 50000, peer, 1042, 0);
+  NS_TEST_ASSERT_MSG_EQ (res.front (), listener, "Deallocated end point returned");
+
+  Ipv6EndPoint *client = demux.Allocate ();
+  uint16_t clientPort = client->GetLocalPort ();
+  client->SetPeer (other, 80);
+  client->SetLocalAddress (local);
+  res = demux.Lookup (local, clientPort, other, 80, 0);
+  NS_TEST_ASSERT_MSG_EQ (res.size (), 1u, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (res.front (), client, "Exact match not found after SetPeer");
+  res = demux.Lookup (local, clientPort, peer, 80, 0);
+  NS_TEST_ASSERT_MSG_EQ (res.empty (), true, "Connected end point matches another peer");
+  demux.DeAllocate (client);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (clientPort), false, "Ephemeral port still in use");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief End point demux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite () : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+  }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
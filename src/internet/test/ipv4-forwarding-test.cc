@@ -26,6 +26,7 @@
 #include "ns3/simple-net-device.h"
 #include "ns3/socket.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 
 #include "ns3/log.h"
 #include "ns3/node.h"
@@ -36,6 +37,7 @@
 #include "ns3/icmpv4-l4-protocol.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-routing-helper.h"
 
@@ -52,10 +54,15 @@ using namespace ns3;
  * \ingroup tests
  *
  * \brief IPv4 Forwarding Test
+ *
+ * Forwards datagrams, with and without the route cache of the forwarding
+ * node, and checks that they are no longer forwarded once the route is
+ * removed or forwarding is disabled.
  */
 class Ipv4ForwardingTest : public TestCase
 {
   Ptr<Packet> m_receivedPacket; //!< Received packet
+  bool m_routeCache;            //!< Whether the forwarding node caches the routes
 
   /**
    * \brief Send data.
@@ -72,7 +79,11 @@ class Ipv4ForwardingTest : public TestCase
 
 public:
   virtual void DoRun (void);
-  Ipv4ForwardingTest ();
+  /**
+   * Constructor
+   * \param routeCache whether the forwarding node caches the routes
+   */
+  Ipv4ForwardingTest (bool routeCache);
 
   /**
    * \brief Receive data.
@@ -81,8 +92,9 @@ public:
   void ReceivePkt (Ptr<Socket> socket);
 };
 
-Ipv4ForwardingTest::Ipv4ForwardingTest ()
-  : TestCase ("UDP socket implementation")
+Ipv4ForwardingTest::Ipv4ForwardingTest (bool routeCache)
+  : TestCase (routeCache ? "UDP socket implementation, route cache" : "UDP socket implementation"),
+    m_routeCache (routeCache)
 {
 }
 
@@ -139,6 +151,10 @@ Ipv4ForwardingTest::DoRun (void)
   Ptr<Node> fwNode = CreateObject<Node> ();
 
   internet.Install (fwNode);
+  if (m_routeCache)
+    {
+      fwNode->GetObject<Ipv4L3Protocol> ()->SetAttribute ("RouteCacheSize", UintegerValue (16));
+    }
   Ptr<SimpleNetDevice> fwDev1, fwDev2;
   { // first interface
     fwDev1 = CreateObject<SimpleNetDevice> ();
@@ -204,6 +220,25 @@ Ipv4ForwardingTest::DoRun (void)
   // Unicast test
   SendData (txSocket, "10.0.0.2");
   NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv4 Forwarding on");
+  SendData (txSocket, "10.0.0.2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv4 Forwarding on, second datagram");
+
+  // Without its route, the datagram is dropped, even if the route was cached
+  Ptr<Ipv4StaticRouting> fwStaticRouting = Ipv4RoutingHelper::GetRouting <Ipv4StaticRouting> (fwNode->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  for (uint32_t i = 0; i < fwStaticRouting->GetNRoutes (); i++)
+    {
+      if (fwStaticRouting->GetRoute (i).GetDestNetwork () == Ipv4Address ("10.0.0.0"))
+        {
+          fwStaticRouting->RemoveRoute (i);
+          break;
+        }
+    }
+  SendData (txSocket, "10.0.0.2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 0, "IPv4 Forwarding without route");
+  fwStaticRouting->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask (0xffff0000U),
+                                      fwNode->GetObject<Ipv4> ()->GetInterfaceForDevice (fwDev1));
+  SendData (txSocket, "10.0.0.2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv4 Forwarding with route restored");
 
   m_receivedPacket->RemoveAllByteTags ();
   m_receivedPacket = 0;
@@ -234,7 +269,8 @@ private:
 Ipv4ForwardingTestSuite::Ipv4ForwardingTestSuite ()
   : TestSuite ("ipv4-forwarding", UNIT)
 {
-  AddTestCase (new Ipv4ForwardingTest, TestCase::QUICK);
+  AddTestCase (new Ipv4ForwardingTest (false), TestCase::QUICK);
+  AddTestCase (new Ipv4ForwardingTest (true), TestCase::QUICK);
 }
 
 static Ipv4ForwardingTestSuite g_ipv4forwardingTestSuite; //!< Static variable for test initialization
@@ -15,6 +15,8 @@
  */
 
 #include <vector>
+#include <set>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -42,6 +44,9 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/tcp-header.h"
+#include "ns3/nstime.h"
 
 using namespace ns3;
 
@@ -1244,6 +1249,359 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting parallel and incremental computation test
+ *
+ * Builds two disconnected networks: a ring of six routers with a LAN
+ * between two of them and a third router, and a line of three routers.
+ * Checks that the routes computed by several threads, and the number of
+ * route changes notified, are those of one thread, and that after a link
+ * of the ring goes down, the incremental recomputation gives the routes of
+ * a complete one while leaving the routing tables of the line alone.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingRecomputeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Print the routes of the nodes
+   * \param nodes the nodes
+   * \returns the routes of every node
+   */
+  std::vector<std::string> GetRoutes (NodeContainer nodes);
+
+  /**
+   * \brief Connect two nodes with a point-to-point link
+   * \param a a node
+   * \param b the other node
+   * \param network the address of the /30 network of the link
+   */
+  void Link (Ptr<Node> a, Ptr<Node> b, const char *network);
+
+  /**
+   * \brief Compute all the routes again, without the incremental update
+   */
+  void FullRecompute (void);
+
+  /**
+   * \param node a node
+   * \returns the global routing protocol of the node
+   */
+  Ptr<Ipv4GlobalRouting> GetGlobalRouting (Ptr<Node> node);
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase ()
+  : TestCase ("Global routing computed by several threads and recomputed incrementally")
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingRecomputeTestCase::GetRoutes (NodeContainer nodes)
+{
+  std::vector<std::string> routes;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = GetGlobalRouting (nodes.Get (i));
+      std::ostringstream oss;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          oss << *routing->GetRoute (j) << std::endl;
+        }
+      routes.push_back (oss.str ());
+    }
+  return routes;
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::Link (Ptr<Node> a, Ptr<Node> b, const char *network)
+{
+  Ptr<SimpleChannel> channel = CreateObject <SimpleChannel> ();
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  NetDeviceContainer net = simpleHelper.Install (a, channel);
+  net.Add (simpleHelper.Install (b, channel));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase (network, "255.255.255.252");
+  ipv4.Assign (net);
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::FullRecompute (void)
+{
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingRecomputeTestCase::GetGlobalRouting (Ptr<Node> node)
+{
+  return node->GetObject<Ipv4L3Protocol> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun (void)
+{
+  NodeContainer ring;
+  ring.Create (6);
+  NodeContainer lanHost;
+  lanHost.Create (1);
+  NodeContainer line;
+  line.Create (3);
+  NodeContainer all (ring, lanHost, line);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (all);
+
+  Link (ring.Get (0), ring.Get (1), "10.1.0.0");
+  Link (ring.Get (1), ring.Get (2), "10.1.0.4");
+  Link (ring.Get (2), ring.Get (3), "10.1.0.8");
+  Link (ring.Get (3), ring.Get (4), "10.1.0.12");
+  Link (ring.Get (4), ring.Get (5), "10.1.0.16");
+  Link (ring.Get (5), ring.Get (0), "10.1.0.20");
+  Link (line.Get (0), line.Get (1), "10.2.0.0");
+  Link (line.Get (1), line.Get (2), "10.2.0.4");
+
+  Ptr<SimpleChannel> channel = CreateObject <SimpleChannel> ();
+  SimpleNetDeviceHelper simpleHelper;
+  NetDeviceContainer lan = simpleHelper.Install (ring.Get (0), channel);
+  lan.Add (simpleHelper.Install (ring.Get (3), channel));
+  lan.Add (simpleHelper.Install (lanHost.Get (0), channel));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.3.0.0", "255.255.255.0");
+  ipv4.Assign (lan);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::string> serial = GetRoutes (all);
+  uint64_t generation = Ipv4RoutingProtocol::GetRoutesGeneration ();
+  FullRecompute ();
+  uint64_t serialChanges = Ipv4RoutingProtocol::GetRoutesGeneration () - generation;
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (3));
+  generation = Ipv4RoutingProtocol::GetRoutesGeneration ();
+  FullRecompute ();
+  NS_TEST_EXPECT_MSG_EQ (Ipv4RoutingProtocol::GetRoutesGeneration () - generation, serialChanges,
+                         "Changes of the routes lost with threads");
+  std::vector<std::string> parallel = GetRoutes (all);
+  for (uint32_t i = 0; i < all.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (parallel[i], serial[i], "Routes of node " << i << " differ with threads");
+    }
+
+  // Nothing changed: no routing table is touched, the manual routes stay
+  Ptr<Ipv4GlobalRouting> routing = GetGlobalRouting (ring.Get (4));
+  uint32_t nRoutes = routing->GetNRoutes ();
+  routing->AddHostRouteTo (Ipv4Address ("192.168.0.1"), 1);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (routing->GetNRoutes (), nRoutes + 1, "Routes recomputed without any change");
+
+  // A link of the ring goes down: only the routers of the ring and the LAN
+  // are affected
+  routing = GetGlobalRouting (line.Get (1));
+  nRoutes = routing->GetNRoutes ();
+  routing->AddHostRouteTo (Ipv4Address ("192.168.0.2"), 1);
+  Ptr<Ipv4L3Protocol> ip1 = ring.Get (1)->GetObject<Ipv4L3Protocol> ();
+  ip1->SetDown (ip1->GetInterfaceForAddress (Ipv4Address ("10.1.0.5")));
+  Ptr<Ipv4L3Protocol> ip2 = ring.Get (2)->GetObject<Ipv4L3Protocol> ();
+  ip2->SetDown (ip2->GetInterfaceForAddress (Ipv4Address ("10.1.0.6")));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::string> incremental = GetRoutes (all);
+  NS_TEST_EXPECT_MSG_EQ (routing->GetNRoutes (), nRoutes + 1, "Routes of a router not affected by the change recomputed");
+
+  FullRecompute ();
+  std::vector<std::string> full = GetRoutes (all);
+  for (uint32_t i = 0; i < ring.GetN () + lanHost.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (incremental[i], full[i], "Routes of node " << i << " differ from a full recomputation");
+      NS_TEST_EXPECT_MSG_NE (incremental[i], serial[i], "Routes of node " << i << " not updated");
+    }
+  for (uint32_t i = ring.GetN () + lanHost.GetN (); i < all.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (full[i], serial[i], "Routes of node " << i << " changed");
+    }
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting flow ECMP test
+ *
+ * Connects a leaf to another one through four spines, and checks that with
+ * FlowEcmpRouting the packets of a TCP flow always take the same route,
+ * that the flows are spread over the four routes, that UDP datagrams sent
+ * by the leaf are hashed without their ports, that the hash seed changes
+ * the routes of the flows, and that with flowlets a flow keeps its route
+ * within a burst and moves after an idle gap.
+ */
+class Ipv4GlobalRoutingFlowEcmpTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingFlowEcmpTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Look up the route of a packet sent by the first leaf
+   * \param protocol the transport protocol
+   * \param sourcePort the source port
+   * \returns the gateway of the route
+   */
+  Ipv4Address GetGateway (uint8_t protocol, uint16_t sourcePort);
+
+  /**
+   * \brief Record the gateway of a TCP flow
+   * \param sourcePort the source port of the flow
+   */
+  void RecordGateway (uint16_t sourcePort);
+
+  Ptr<Ipv4GlobalRouting> m_routing;       //!< Global routing of the first leaf
+  Ipv4Address m_destination;              //!< Address behind the second leaf
+  std::vector<Ipv4Address> m_gateways;    //!< Recorded gateways
+};
+
+Ipv4GlobalRoutingFlowEcmpTestCase::Ipv4GlobalRoutingFlowEcmpTestCase ()
+  : TestCase ("Global routing selects ECMP routes by flow and by flowlet")
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingFlowEcmpTestCase::GetGateway (uint8_t protocol, uint16_t sourcePort)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (sourcePort);
+  tcpHeader.SetDestinationPort (5000);
+  p->AddHeader (tcpHeader);
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.0.0.1"));
+  header.SetDestination (m_destination);
+  header.SetProtocol (protocol);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = m_routing->RouteOutput (p, header, 0, sockerr);
+  NS_ASSERT (route != 0);
+  return route->GetGateway ();
+}
+
+void
+Ipv4GlobalRoutingFlowEcmpTestCase::RecordGateway (uint16_t sourcePort)
+{
+  m_gateways.push_back (GetGateway (6, sourcePort));
+}
+
+void
+Ipv4GlobalRoutingFlowEcmpTestCase::DoRun (void)
+{
+  NodeContainer leaves;
+  leaves.Create (2);
+  NodeContainer spines;
+  spines.Create (4);
+  NodeContainer host;
+  host.Create (1);
+  NodeContainer all (leaves, spines, host);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (all);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < spines.GetN (); i++)
+    {
+      for (uint32_t j = 0; j < leaves.GetN (); j++)
+        {
+          Ptr<SimpleChannel> channel = CreateObject <SimpleChannel> ();
+          NetDeviceContainer net = simpleHelper.Install (leaves.Get (j), channel);
+          net.Add (simpleHelper.Install (spines.Get (i), channel));
+          ipv4.Assign (net);
+          ipv4.NewNetwork ();
+        }
+    }
+  Ptr<SimpleChannel> channel = CreateObject <SimpleChannel> ();
+  NetDeviceContainer net = simpleHelper.Install (leaves.Get (1), channel);
+  net.Add (simpleHelper.Install (host.Get (0), channel));
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer hostInterfaces = ipv4.Assign (net);
+  m_destination = hostInterfaces.GetAddress (1);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  m_routing = leaves.Get (0)->GetObject<Ipv4L3Protocol> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+  m_routing->SetAttribute ("FlowEcmpRouting", BooleanValue (true));
+
+  // Every flow sticks to its route, and the flows use all the routes
+  std::vector<Ipv4Address> routes;
+  std::set<Ipv4Address> used;
+  for (uint16_t port = 1000; port < 1100; port++)
+    {
+      routes.push_back (GetGateway (6, port));
+      used.insert (routes.back ());
+      for (uint32_t k = 0; k < 3; k++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (GetGateway (6, port), routes.back (), "Flow " << port << " changed route");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (used.size (), 4, "Flows not spread over all the routes");
+
+  // The UDP header is not there yet: all the datagrams take the same route
+  used.clear ();
+  for (uint16_t port = 1000; port < 1100; port++)
+    {
+      used.insert (GetGateway (17, port));
+    }
+  NS_TEST_EXPECT_MSG_EQ (used.size (), 1, "UDP datagrams hashed on their payload");
+
+  // Another seed moves flows
+  m_routing->SetAttribute ("EcmpHashSeed", UintegerValue (1));
+  uint32_t moved = 0;
+  for (uint16_t port = 1000; port < 1100; port++)
+    {
+      moved += GetGateway (6, port) != routes[port - 1000] ? 1 : 0;
+    }
+  NS_TEST_EXPECT_MSG_GT (moved, 0, "Routes of the flows independent of the seed");
+
+  // Flowlets: bursts of packets 100 us apart, separated by 10 ms gaps
+  m_routing->SetAttribute ("FlowletTimeout", TimeValue (MilliSeconds (1)));
+  for (uint32_t burst = 0; burst < 20; burst++)
+    {
+      for (uint32_t k = 0; k < 5; k++)
+        {
+          Simulator::Schedule (MilliSeconds (10 * burst) + MicroSeconds (100 * k),
+                               &Ipv4GlobalRoutingFlowEcmpTestCase::RecordGateway, this, 1000);
+        }
+    }
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_gateways.size (), 100, "Missing packets");
+  used.clear ();
+  for (uint32_t i = 0; i < m_gateways.size (); i++)
+    {
+      if (i % 5 != 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_gateways[i], m_gateways[i - 1], "Route changed within a flowlet");
+        }
+      used.insert (m_gateways[i]);
+    }
+  NS_TEST_EXPECT_MSG_GT (used.size (), 1, "Flowlets never moved");
+
+  m_routing = 0;
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1625,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingFlowEcmpTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -43,6 +43,7 @@
 #include <string>
 #include <sstream>
 #include <limits>
+#include <algorithm>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -265,6 +266,131 @@ Ipv4HeaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 Header checksum update Test: rewriting the TTL and TOS
+ * bytes of a received header, as a router does, must produce the same
+ * bytes as building the header from scratch.
+ */
+class Ipv4HeaderChecksumUpdateTest : public TestCase
+{
+  /**
+   * \brief Build a header carrying a checksum.
+   * \param ttl The TTL field.
+   * \param tos The TOS field.
+   * \param fragment True to make the header a non-first fragment.
+   * \returns a packet holding the serialized header.
+   */
+  Ptr<Packet> MakeHeader (uint8_t ttl, uint8_t tos, bool fragment);
+
+  /**
+   * \brief Compare the serialized headers of two packets.
+   * \param a The first packet.
+   * \param b The second packet.
+   * \returns true if the bytes are the same.
+   */
+  bool SameBytes (Ptr<Packet> a, Ptr<Packet> b);
+
+public:
+  virtual void DoRun (void);
+  Ipv4HeaderChecksumUpdateTest ();
+};
+
+Ipv4HeaderChecksumUpdateTest::Ipv4HeaderChecksumUpdateTest ()
+  : TestCase ("IPv4 Header checksum update Test")
+{
+}
+
+Ptr<Packet>
+Ipv4HeaderChecksumUpdateTest::MakeHeader (uint8_t ttl, uint8_t tos, bool fragment)
+{
+  Ptr<Packet> p = Create<Packet> ();
+  Ipv4Header ipHeader;
+  ipHeader.EnableChecksum ();
+  ipHeader.SetSource (Ipv4Address ("10.1.2.3"));
+  ipHeader.SetDestination (Ipv4Address ("192.168.200.17"));
+  ipHeader.SetProtocol (6);
+  ipHeader.SetPayloadSize (1460);
+  ipHeader.SetIdentification (0xbeef);
+  ipHeader.SetTtl (ttl);
+  ipHeader.SetTos (tos);
+  if (fragment)
+    {
+      ipHeader.SetMoreFragments ();
+      ipHeader.SetFragmentOffset (1480);
+    }
+  p->AddHeader (ipHeader);
+  return p;
+}
+
+bool
+Ipv4HeaderChecksumUpdateTest::SameBytes (Ptr<Packet> a, Ptr<Packet> b)
+{
+  uint8_t bytesA[20];
+  uint8_t bytesB[20];
+  if (a->GetSize () != 20 || b->GetSize () != 20)
+    {
+      return false;
+    }
+  a->CopyData (bytesA, 20);
+  b->CopyData (bytesB, 20);
+  return std::equal (bytesA, bytesA + 20, bytesB);
+}
+
+void
+Ipv4HeaderChecksumUpdateTest::DoRun (void)
+{
+  for (uint32_t ttl = 1; ttl < 256; ttl += 7)
+    {
+      for (uint32_t tos = 0; tos < 256; tos += 13)
+        {
+          bool fragment = (ttl & 1);
+          Ptr<Packet> p = MakeHeader (ttl, tos, fragment);
+          Ipv4Header ipHeader;
+          ipHeader.EnableChecksum ();
+          p->RemoveHeader (ipHeader);
+          NS_TEST_ASSERT_MSG_EQ (ipHeader.IsChecksumOk (), true, "Bad checksum in the original header");
+
+          // forward: decrement the TTL, then mark congestion
+          ipHeader.SetTtl (ttl - 1);
+          ipHeader.SetEcn (Ipv4Header::ECN_CE);
+          p->AddHeader (ipHeader);
+          Ptr<Packet> expected = MakeHeader (ttl - 1, (tos & 0xfc) | Ipv4Header::ECN_CE, fragment);
+          NS_TEST_ASSERT_MSG_EQ (SameBytes (p, expected), true,
+                                 "Updated header differs for ttl " << ttl << " tos " << tos);
+
+          // a change of another field makes the header compute the checksum again
+          Ipv4Header copy;
+          copy.EnableChecksum ();
+          p->RemoveHeader (copy);
+          NS_TEST_ASSERT_MSG_EQ (copy.IsChecksumOk (), true, "Bad checksum in the updated header");
+          copy.SetDscp (Ipv4Header::DSCP_AF41);
+          copy.SetDestination (Ipv4Address ("10.9.8.7"));
+          p->AddHeader (copy);
+          expected = Create<Packet> ();
+          Ipv4Header fresh;
+          fresh.EnableChecksum ();
+          fresh.SetSource (copy.GetSource ());
+          fresh.SetDestination (Ipv4Address ("10.9.8.7"));
+          fresh.SetProtocol (6);
+          fresh.SetPayloadSize (1460);
+          fresh.SetIdentification (0xbeef);
+          fresh.SetTtl (ttl - 1);
+          fresh.SetTos ((Ipv4Header::DSCP_AF41 << 2) | Ipv4Header::ECN_CE);
+          if (fragment)
+            {
+              fresh.SetMoreFragments ();
+              fresh.SetFragmentOffset (1480);
+            }
+          expected->AddHeader (fresh);
+          NS_TEST_ASSERT_MSG_EQ (SameBytes (p, expected), true,
+                                 "Rewritten header differs for ttl " << ttl << " tos " << tos);
+        }
+    }
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -277,6 +403,7 @@ public:
   Ipv4HeaderTestSuite () : TestSuite ("ipv4-header", UNIT)
   {
     AddTestCase (new Ipv4HeaderTest, TestCase::QUICK);
+    AddTestCase (new Ipv4HeaderChecksumUpdateTest, TestCase::QUICK);
   }
 };
 
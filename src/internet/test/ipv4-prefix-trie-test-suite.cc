@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-prefix-trie.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4PrefixTrie Test
+ *
+ * Inserts random prefixes of every length, duplicates and non-contiguous
+ * masks included, and checks that the lookups of random addresses, inside
+ * the prefixes or not, return the same values as a linear scan.
+ */
+class Ipv4PrefixTrieTestCase : public TestCase
+{
+public:
+  Ipv4PrefixTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4PrefixTrieTestCase::Ipv4PrefixTrieTestCase ()
+  : TestCase ("Lookups of the prefix trie match a linear scan")
+{
+}
+
+void
+Ipv4PrefixTrieTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  std::vector<Ipv4Address> networks;
+  std::vector<Ipv4Mask> masks;
+  Ipv4PrefixTrie trie;
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      Ipv4Mask mask;
+      uint32_t kind = rng->GetInteger (0, 19);
+      if (kind == 0)
+        {
+          // non-contiguous
+          mask = Ipv4Mask (rng->GetInteger (0, 0xffffffff) | 0x80000000);
+        }
+      else
+        {
+          uint32_t length = rng->GetInteger (0, 32);
+          mask = Ipv4Mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+        }
+      Ipv4Address network;
+      if (kind == 1 && !networks.empty ())
+        {
+          // same network as a previous prefix
+          network = networks[rng->GetInteger (0, networks.size () - 1)];
+        }
+      else
+        {
+          // few distinct leading bits, to get nested prefixes
+          network = Ipv4Address ((rng->GetInteger (0, 15) << 28) | rng->GetInteger (0, 0x0fffffff));
+        }
+      network = network.CombineMask (mask);
+      networks.push_back (network);
+      masks.push_back (mask);
+      trie.Insert (network, mask, i);
+    }
+
+  std::vector<uint32_t> values;
+  for (uint32_t i = 0; i < 10000; i++)
+    {
+      uint32_t address = (rng->GetInteger (0, 15) << 28) | rng->GetInteger (0, 0x0fffffff);
+      if (i % 2 == 0)
+        {
+          // inside a prefix
+          uint32_t p = rng->GetInteger (0, networks.size () - 1);
+          address = networks[p].Get () | (address & ~masks[p].Get ());
+        }
+      Ipv4Address dest (address);
+      std::vector<uint32_t> expected;
+      for (uint32_t p = 0; p < networks.size (); p++)
+        {
+          if (masks[p].IsMatch (dest, networks[p]))
+            {
+              expected.push_back (p);
+            }
+        }
+      trie.Lookup (dest, values);
+      NS_TEST_ASSERT_MSG_EQ (values.size (), expected.size (), "Wrong number of matches for " << dest);
+      for (uint32_t v = 0; v < values.size (); v++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (values[v], expected[v], "Wrong match for " << dest);
+        }
+    }
+
+  trie.Clear ();
+  trie.Lookup (Ipv4Address ("10.0.0.1"), values);
+  NS_TEST_EXPECT_MSG_EQ (values.size (), 0, "Matches in an empty trie");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4PrefixTrie TestSuite
+ */
+class Ipv4PrefixTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4PrefixTrieTestSuite () : TestSuite ("ipv4-prefix-trie", UNIT)
+  {
+    AddTestCase (new Ipv4PrefixTrieTestCase (), TestCase::QUICK);
+  }
+};
+
+static Ipv4PrefixTrieTestSuite g_ipv4PrefixTrieTestSuite; //!< Static variable for test initialization
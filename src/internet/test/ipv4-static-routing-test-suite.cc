@@ -22,6 +22,9 @@
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-route.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
 #include "ns3/packet.h"
@@ -201,6 +204,103 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting route selection Test
+ *
+ * Checks the rules of Ipv4StaticRouting::LookupStatic: longest prefix
+ * first, then lowest metric, the last route of the table winning ties,
+ * except for host routes where the first one wins; non-contiguous masks
+ * compete by the number of their leading ones; the output device filters
+ * the routes; removed routes are not used anymore.
+ */
+class Ipv4StaticRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the gateway of the route to a destination
+   * \param routing the routing protocol
+   * \param dest the destination
+   * \param oif the output device, if any
+   * \return the gateway, 0.0.0.0 if there is no route
+   */
+  Ipv4Address Gateway (Ptr<Ipv4StaticRouting> routing, std::string dest, Ptr<NetDevice> oif = 0);
+};
+
+Ipv4StaticRoutingLookupTestCase::Ipv4StaticRoutingLookupTestCase ()
+  : TestCase ("Static routing route selection")
+{
+}
+
+Ipv4Address
+Ipv4StaticRoutingLookupTestCase::Gateway (Ptr<Ipv4StaticRouting> routing, std::string dest, Ptr<NetDevice> oif)
+{
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address (dest.c_str ()));
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = routing->RouteOutput (0, header, oif, sockerr);
+  return route ? route->GetGateway () : Ipv4Address::GetZero ();
+}
+
+void
+Ipv4StaticRoutingLookupTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<SimpleNetDevice> dev1 = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> dev2 = CreateObject<SimpleNetDevice> ();
+  node->AddDevice (dev1);
+  node->AddDevice (dev2);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  uint32_t if1 = ipv4->AddInterface (dev1);
+  ipv4->AddAddress (if1, Ipv4InterfaceAddress (Ipv4Address ("10.1.1.1"), Ipv4Mask ("255.255.255.0")));
+  ipv4->SetUp (if1);
+  uint32_t if2 = ipv4->AddInterface (dev2);
+  ipv4->AddAddress (if2, Ipv4InterfaceAddress (Ipv4Address ("10.1.2.1"), Ipv4Mask ("255.255.255.0")));
+  ipv4->SetUp (if2);
+
+  Ipv4StaticRoutingHelper helper;
+  Ptr<Ipv4StaticRouting> routing = helper.GetStaticRouting (ipv4);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), Ipv4Address ("10.1.1.2"), if1, 5);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("10.1.1.3"), if1, 5);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("10.1.2.3"), if2, 1);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("10.1.2.4"), if2, 1);
+  routing->AddHostRouteTo (Ipv4Address ("10.2.3.4"), Ipv4Address ("10.1.1.5"), if1, 10);
+  routing->AddHostRouteTo (Ipv4Address ("10.2.3.4"), Ipv4Address ("10.1.2.5"), if2, 0);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.3.0.5"), Ipv4Mask ("255.255.0.255"), Ipv4Address ("10.1.1.7"), if1, 0);
+  routing->SetDefaultRoute (Ipv4Address ("10.1.2.9"), if2);
+
+  NS_TEST_EXPECT_MSG_EQ (Gateway (routing, "10.9.9.9"), Ipv4Address ("10.1.1.2"), "Only the /8 matches");
+  NS_TEST_EXPECT_MSG_EQ (Gateway (routing, "10.2.9.9"), Ipv4Address ("10.1.2.4"), "Lowest metric, then last route");
+  NS_TEST_EXPECT_MSG_EQ (Gateway (routing, "10.2.3.4"), Ipv4Address ("10.1.1.5"), "First host route");
+  NS_TEST_EXPECT_MSG_EQ (Gateway (routing, "10.3.7.5"), Ipv4Address ("10.1.1.7"), "Non-contiguous mask longer than the /8");
+  NS_TEST_EXPECT_MSG_EQ (Gateway (routing, "10.3.7.6"), Ipv4Address ("10.1.1.2"), "Non-contiguous mask does not match");
+  NS_TEST_EXPECT_MSG_EQ (Gateway (routing, "192.168.1.1"), Ipv4Address ("10.1.2.9"), "Default route");
+  NS_TEST_EXPECT_MSG_EQ (Gateway (routing, "10.1.1.8"), Ipv4Address ("0.0.0.0"), "Route of the interface");
+  NS_TEST_EXPECT_MSG_EQ (Gateway (routing, "10.9.9.9", dev2), Ipv4Address ("10.1.2.9"), "The /8 is not on the device");
+  NS_TEST_EXPECT_MSG_EQ (Gateway (routing, "10.2.9.9", dev1), Ipv4Address ("10.1.1.3"), "Only /16 on the device");
+
+  for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+    {
+      if (routing->GetRoute (i).GetGateway () == Ipv4Address ("10.1.1.5"))
+        {
+          routing->RemoveRoute (i);
+          break;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (Gateway (routing, "10.2.3.4"), Ipv4Address ("10.1.2.5"), "Removed host route still used");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -217,6 +317,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingLookupTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite ipv4StaticRoutingTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <list>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ndisc-cache.h"
+#include "ns3/neighbor-cache-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief ArpCache and NdiscCache inverse lookup Test
+ *
+ * Checks that the entries found by MAC address follow the additions,
+ * the changes of MAC address and the removals.
+ */
+class NeighborCacheInverseTestCase : public TestCase
+{
+public:
+  NeighborCacheInverseTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+NeighborCacheInverseTestCase::NeighborCacheInverseTestCase ()
+  : TestCase ("Inverse lookups of the ARP and NDISC caches")
+{
+}
+
+void
+NeighborCacheInverseTestCase::DoRun (void)
+{
+  Mac48Address mac1 ("00:00:00:00:00:01");
+  Mac48Address mac2 ("00:00:00:00:00:02");
+
+  Ptr<ArpCache> arp = CreateObject<ArpCache> ();
+  ArpCache::Entry *a1 = arp->Add (Ipv4Address ("10.0.0.1"));
+  a1->SetMacAddress (mac1);
+  ArpCache::Entry *a2 = arp->Add (Ipv4Address ("10.0.0.2"));
+  a2->SetMacAddress (mac1);
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac1).size (), 2, "Two ARP entries for the MAC address");
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac2).size (), 0, "No ARP entry for the MAC address");
+  a2->SetMacAddress (mac2);
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac1).size (), 1, "ARP entry not moved");
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac2).front (), a2, "ARP entry not moved");
+  arp->Remove (a1);
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac1).size (), 0, "ARP entry not removed");
+  NS_TEST_EXPECT_MSG_EQ (arp->Lookup (Ipv4Address ("10.0.0.1")), 0, "ARP entry not removed");
+  arp->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac2).size (), 0, "ARP cache not flushed");
+  arp->Dispose ();
+
+  Ptr<NdiscCache> ndisc = CreateObject<NdiscCache> ();
+  NdiscCache::Entry *n1 = ndisc->Add (Ipv6Address ("2001:1::1"));
+  n1->SetMacAddress (mac1);
+  NdiscCache::Entry *n2 = ndisc->Add (Ipv6Address ("2001:1::2"));
+  n2->SetMacAddress (mac1);
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac1).size (), 2, "Two NDISC entries for the MAC address");
+  n2->MarkStale (mac2);
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac1).size (), 1, "NDISC entry not moved");
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac2).front (), n2, "NDISC entry not moved");
+  ndisc->Remove (n1);
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac1).size (), 0, "NDISC entry not removed");
+  NS_TEST_EXPECT_MSG_EQ (ndisc->Lookup (Ipv6Address ("2001:1::1")), 0, "NDISC entry not removed");
+  ndisc->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac2).size (), 0, "NDISC cache not flushed");
+  ndisc->Dispose ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief NeighborCacheHelper Test
+ *
+ * Attaches three dual-stack nodes to a channel and checks that, once the
+ * caches are populated, every interface knows the addresses of the others
+ * and a datagram is delivered without any ARP exchange, while ARP is used
+ * when the caches are not populated.
+ */
+class NeighborCacheHelperTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param populate whether to populate the caches
+   */
+  NeighborCacheHelperTestCase (bool populate);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Count the ARP packets
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender
+   * \param to the destination
+   * \param packetType the type of packet
+   */
+  void ReceiveArp (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                   const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+  /**
+   * \brief Count the datagrams
+   * \param socket the receiving socket
+   */
+  void ReceiveData (Ptr<Socket> socket);
+
+  /**
+   * \brief Send a datagram
+   * \param socket the sending socket
+   */
+  void SendData (Ptr<Socket> socket);
+
+  bool m_populate;           //!< Whether to populate the caches
+  uint32_t m_arpPackets;     //!< ARP packets received
+  uint32_t m_dataPackets;    //!< Datagrams received
+};
+
+NeighborCacheHelperTestCase::NeighborCacheHelperTestCase (bool populate)
+  : TestCase (populate ? "Neighbor caches populated from the topology" : "Neighbor caches filled by ARP"),
+    m_populate (populate),
+    m_arpPackets (0),
+    m_dataPackets (0)
+{
+}
+
+void
+NeighborCacheHelperTestCase::ReceiveArp (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                         const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  m_arpPackets++;
+}
+
+void
+NeighborCacheHelperTestCase::ReceiveData (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_dataPackets++;
+    }
+}
+
+void
+NeighborCacheHelperTestCase::SendData (Ptr<Socket> socket)
+{
+  socket->Send (Create<Packet> (100));
+}
+
+void
+NeighborCacheHelperTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  SimpleNetDeviceHelper simpleHelper;
+  NetDeviceContainer devices = simpleHelper.Install (nodes, channel);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer ipv4Interfaces = ipv4.Assign (devices);
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  Ipv6InterfaceContainer ipv6Interfaces = ipv6.Assign (devices);
+
+  if (m_populate)
+    {
+      NeighborCacheHelper::PopulateNeighborCache ();
+
+      for (uint32_t i = 0; i < nodes.GetN (); i++)
+        {
+          Ptr<Ipv4L3Protocol> ip = nodes.Get (i)->GetObject<Ipv4L3Protocol> ();
+          Ptr<ArpCache> arpCache = ip->GetInterface (ip->GetInterfaceForDevice (devices.Get (i)))->GetArpCache ();
+          Ptr<Ipv6L3Protocol> ip6 = nodes.Get (i)->GetObject<Ipv6L3Protocol> ();
+          Ptr<NdiscCache> ndiscCache = ip6->GetInterface (ip6->GetInterfaceForDevice (devices.Get (i)))->GetNdiscCache ();
+          for (uint32_t j = 0; j < nodes.GetN (); j++)
+            {
+              ArpCache::Entry *arpEntry = arpCache->Lookup (ipv4Interfaces.GetAddress (j));
+              NdiscCache::Entry *ndiscEntry = ndiscCache->Lookup (ipv6Interfaces.GetAddress (j, 1));
+              if (i == j)
+                {
+                  NS_TEST_EXPECT_MSG_EQ (arpEntry, 0, "ARP entry for the node itself");
+                  NS_TEST_EXPECT_MSG_EQ (ndiscEntry, 0, "NDISC entry for the node itself");
+                  continue;
+                }
+              NS_TEST_ASSERT_MSG_NE (arpEntry, 0, "Missing ARP entry of node " << j << " on node " << i);
+              NS_TEST_EXPECT_MSG_EQ (arpEntry->IsPermanent (), true, "ARP entry not permanent");
+              NS_TEST_EXPECT_MSG_EQ (arpEntry->GetMacAddress (), devices.Get (j)->GetAddress (), "Wrong MAC address");
+              NS_TEST_ASSERT_MSG_NE (ndiscEntry, 0, "Missing NDISC entry of node " << j << " on node " << i);
+              NS_TEST_EXPECT_MSG_EQ (ndiscEntry->IsPermanent (), true, "NDISC entry not permanent");
+              NS_TEST_EXPECT_MSG_EQ (ndiscEntry->GetMacAddress (), devices.Get (j)->GetAddress (), "Wrong MAC address");
+              // link-local address
+              NS_TEST_EXPECT_MSG_NE (ndiscCache->Lookup (ipv6Interfaces.GetAddress (j, 0)), 0, "Missing NDISC entry of the link-local address");
+            }
+        }
+    }
+
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodes.Get (i)->RegisterProtocolHandler (MakeCallback (&NeighborCacheHelperTestCase::ReceiveArp, this),
+                                              ArpL3Protocol::PROT_NUMBER, devices.Get (i));
+    }
+  Ptr<Socket> rxSocket = Socket::CreateSocket (nodes.Get (2), UdpSocketFactory::GetTypeId ());
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&NeighborCacheHelperTestCase::ReceiveData, this));
+  Ptr<Socket> txSocket = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  txSocket->Connect (InetSocketAddress (ipv4Interfaces.GetAddress (2), 1234));
+  Simulator::Schedule (Seconds (1), &NeighborCacheHelperTestCase::SendData, this, txSocket);
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_dataPackets, 1, "Datagram not delivered");
+  if (m_populate)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_arpPackets, 0, "ARP used with populated caches");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_GT (m_arpPackets, 0, "ARP not used");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Neighbor caches TestSuite
+ */
+class NeighborCacheTestSuite : public TestSuite
+{
+public:
+  NeighborCacheTestSuite () : TestSuite ("neighbor-cache", UNIT)
+  {
+    AddTestCase (new NeighborCacheInverseTestCase (), TestCase::QUICK);
+    AddTestCase (new NeighborCacheHelperTestCase (false), TestCase::QUICK);
+    AddTestCase (new NeighborCacheHelperTestCase (true), TestCase::QUICK);
+  }
+};
+
+static NeighborCacheTestSuite g_neighborCacheTestSuite; //!< Static variable for test initialization
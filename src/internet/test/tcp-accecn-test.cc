@@ -0,0 +1,366 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "tcp-error-model.h"
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/buffer.h"
+#include "ns3/error-model.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-option-accecn.h"
+#include "ns3/tcp-congestion-ops.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpAccEcnTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the ACE field of the TCP header, and its serialization
+ */
+class TcpAccEcnHeaderTest : public TestCase
+{
+public:
+  TcpAccEcnHeaderTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpAccEcnHeaderTest::TcpAccEcnHeaderTest ()
+  : TestCase ("AccECN ACE field of the TCP header")
+{
+}
+
+void
+TcpAccEcnHeaderTest::DoRun (void)
+{
+  for (uint8_t ace = 0; ace < 8; ++ace)
+    {
+      TcpHeader header;
+      header.SetFlags (TcpHeader::ACK | TcpHeader::PSH);
+      header.SetAce (ace);
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (header.GetAce ()), static_cast<uint32_t> (ace), "ACE value not kept");
+      uint8_t otherFlags = header.GetFlags () & (TcpHeader::ACK | TcpHeader::PSH);
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (otherFlags), static_cast<uint32_t> (TcpHeader::ACK | TcpHeader::PSH),
+                             "Other flags modified by SetAce");
+
+      Buffer buffer;
+      buffer.AddAtStart (header.GetSerializedSize ());
+      header.Serialize (buffer.Begin ());
+
+      // AE is the least significant bit of the byte holding the data offset
+      Buffer::Iterator i = buffer.Begin ();
+      i.Next (12);
+      bool ae = (i.ReadU8 () & 0x01) != 0;
+      bool expectedAe = (ace & 0x4) != 0;
+      NS_TEST_ASSERT_MSG_EQ (ae, expectedAe, "AE bit not serialized");
+
+      TcpHeader copy;
+      copy.Deserialize (buffer.Begin ());
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (copy.GetAce ()), static_cast<uint32_t> (ace), "ACE value not deserialized");
+      NS_TEST_ASSERT_MSG_EQ ((header == copy), true, "Headers differ after deserialization");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the serialization of the AccECN option
+ */
+class TcpAccEcnOptionTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param kind ACCECN0 or ACCECN1
+   * \param fields number of counters in the option
+   */
+  TcpAccEcnOptionTest (uint8_t kind, uint8_t fields);
+
+private:
+  virtual void DoRun (void);
+
+  uint8_t m_kind;   //!< Field order
+  uint8_t m_fields; //!< Number of counters
+};
+
+TcpAccEcnOptionTest::TcpAccEcnOptionTest (uint8_t kind, uint8_t fields)
+  : TestCase ("AccECN option of kind " + std::to_string (kind) + " with " + std::to_string (fields) + " fields"),
+    m_kind (kind),
+    m_fields (fields)
+{
+}
+
+void
+TcpAccEcnOptionTest::DoRun (void)
+{
+  Ptr<TcpOptionAccEcn> option = CreateObject<TcpOptionAccEcn> ();
+  option->SetOrder (m_kind);
+  option->SetFieldCount (m_fields);
+  option->SetE0b (0x123456);
+  option->SetCeb (0x1ABCDEF);   // wraps to 24 bits
+  option->SetE1b (0x000102);
+
+  NS_TEST_ASSERT_MSG_EQ (option->GetSerializedSize (), 2u + 3 * m_fields, "Wrong option length");
+
+  TcpHeader header;
+  header.SetFlags (TcpHeader::ACK);
+  NS_TEST_ASSERT_MSG_EQ (header.AppendOption (option), true, "Option not appended");
+
+  Buffer buffer;
+  buffer.AddAtStart (header.GetSerializedSize ());
+  header.Serialize (buffer.Begin ());
+
+  Buffer::Iterator i = buffer.Begin ();
+  i.Next (20);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (i.ReadU8 ()), static_cast<uint32_t> (m_kind), "Wrong kind on the wire");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (i.ReadU8 ()), 2u + 3 * m_fields, "Wrong length on the wire");
+  if (m_fields > 0)
+    {
+      uint32_t first = i.ReadU8 () << 16;
+      first |= i.ReadNtohU16 ();
+      uint32_t expected = (m_kind == TcpOption::ACCECN0) ? 0x123456 : 0x000102;
+      NS_TEST_ASSERT_MSG_EQ (first, expected, "Wrong first field");
+    }
+
+  TcpHeader copy;
+  copy.Deserialize (buffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (copy.HasOption (m_kind), true, "Option not deserialized");
+  Ptr<const TcpOptionAccEcn> read = DynamicCast<const TcpOptionAccEcn> (copy.GetOption (m_kind));
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (read->GetFieldCount ()), static_cast<uint32_t> (m_fields), "Wrong field count");
+
+  bool e0bFirst = (m_kind == TcpOption::ACCECN0);
+  bool hasE0b = (m_fields >= (e0bFirst ? 1 : 3));
+  bool hasCeb = (m_fields >= 2);
+  bool hasE1b = (m_fields >= (e0bFirst ? 3 : 1));
+  NS_TEST_ASSERT_MSG_EQ (read->HasField (0), hasE0b, "Wrong presence of EE0B");
+  NS_TEST_ASSERT_MSG_EQ (read->HasField (1), hasCeb, "Wrong presence of ECEB");
+  NS_TEST_ASSERT_MSG_EQ (read->HasField (2), hasE1b, "Wrong presence of EE1B");
+  if (read->HasField (0))
+    {
+      NS_TEST_ASSERT_MSG_EQ (read->GetE0b (), 0x123456u, "Wrong EE0B");
+    }
+  if (read->HasField (1))
+    {
+      NS_TEST_ASSERT_MSG_EQ (read->GetCeb (), 0xABCDEFu, "Wrong ECEB");
+    }
+  if (read->HasField (2))
+    {
+      NS_TEST_ASSERT_MSG_EQ (read->GetE1b (), 0x000102u, "Wrong EE1B");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the AccECN negotiation, and the fallback to classic ECN
+ */
+class TcpAccEcnNegotiationTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param receiverAccEcn whether the receiver supports AccECN
+   * \param desc description
+   */
+  TcpAccEcnNegotiationTest (bool receiverAccEcn, const std::string &desc);
+
+protected:
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void ConfigureProperties ();
+  virtual void FinalChecks ();
+
+private:
+  bool m_receiverAccEcn;     //!< Whether the receiver supports AccECN
+  bool m_synChecked;         //!< SYN seen
+  bool m_synAckChecked;      //!< SYN-ACK seen
+  uint32_t m_optionAcks;     //!< ACKs of the receiver with the AccECN option
+};
+
+TcpAccEcnNegotiationTest::TcpAccEcnNegotiationTest (bool receiverAccEcn, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_receiverAccEcn (receiverAccEcn),
+    m_synChecked (false),
+    m_synAckChecked (false),
+    m_optionAcks (0)
+{
+}
+
+void
+TcpAccEcnNegotiationTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetEcn (SENDER);
+  SetEcn (RECEIVER);
+  GetSenderSocket ()->SetAttribute ("UseAccEcn", BooleanValue (true));
+  GetReceiverSocket ()->SetAttribute ("UseAccEcn", BooleanValue (m_receiverAccEcn));
+}
+
+void
+TcpAccEcnNegotiationTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER && (h.GetFlags () & TcpHeader::SYN))
+    {
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (h.GetAce ()), 0x7u, "An AccECN SYN carries AE, CWR and ECE");
+      m_synChecked = true;
+    }
+  else if (who == RECEIVER && (h.GetFlags () & TcpHeader::SYN))
+    {
+      // The SYN was sent Not-ECT
+      uint32_t expected = m_receiverAccEcn ? 0x2 : 0x1;
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (h.GetAce ()), expected, "Wrong ACE field on the SYN-ACK");
+      m_synAckChecked = true;
+    }
+  else if (who == RECEIVER && (h.GetFlags () & TcpHeader::ACK))
+    {
+      if (h.HasOption (TcpOption::ACCECN0) || h.HasOption (TcpOption::ACCECN1))
+        {
+          ++m_optionAcks;
+        }
+    }
+}
+
+void
+TcpAccEcnNegotiationTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_synChecked, true, "No SYN sent");
+  NS_TEST_ASSERT_MSG_EQ (m_synAckChecked, true, "No SYN-ACK sent");
+  NS_TEST_ASSERT_MSG_EQ (GetTcb (SENDER)->m_accEcn, m_receiverAccEcn, "Wrong AccECN negotiation at the sender");
+  NS_TEST_ASSERT_MSG_EQ (GetTcb (RECEIVER)->m_accEcn, m_receiverAccEcn, "Wrong AccECN negotiation at the receiver");
+  bool ecnEnabled = (GetTcb (SENDER)->m_ecnState != TcpSocketState::ECN_DISABLED);
+  NS_TEST_ASSERT_MSG_EQ (ecnEnabled, true, "ECN should be enabled in both cases");
+  if (m_receiverAccEcn)
+    {
+      NS_TEST_ASSERT_MSG_GT (m_optionAcks, 0u, "The ACKs should carry the AccECN option");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_optionAcks, 0u, "The AccECN option should not be sent with classic ECN");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the sender learns the exact number of CE-marked bytes
+ *
+ * Three segments are CE-marked. When the segment before them is lost, their
+ * marks are reported by duplicate ACKs, and each one must still be counted
+ * once, as TcpDctcp sums the reported bytes in its count of marked bytes.
+ */
+class TcpAccEcnFeedbackTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param loss whether the segment before the marked ones is lost
+   * \param desc description
+   */
+  TcpAccEcnFeedbackTest (bool loss, const std::string &desc);
+
+protected:
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void ConfigureProperties ();
+  virtual void FinalChecks ();
+
+private:
+  bool m_loss;                       //!< Whether the segment before the marked ones is lost
+  Ptr<TcpAccEcnRecorder> m_recorder; //!< Congestion control of the sender
+};
+
+TcpAccEcnFeedbackTest::TcpAccEcnFeedbackTest (bool loss, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_loss (loss)
+{
+}
+
+Ptr<TcpSocketMsgBase>
+TcpAccEcnFeedbackTest::CreateSenderSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateSenderSocket (node);
+  m_recorder = CreateObject<TcpAccEcnRecorder> ();
+  socket->SetCongestionControlAlgorithm (m_recorder);
+  return socket;
+}
+
+Ptr<ErrorModel>
+TcpAccEcnFeedbackTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpCeMarkingErrorModel> errorModel = CreateObject<TcpCeMarkingErrorModel> ();
+  errorModel->AddSeqToMark (SequenceNumber32 (1001));
+  errorModel->AddSeqToMark (SequenceNumber32 (2001));
+  errorModel->AddSeqToMark (SequenceNumber32 (3001));
+  if (m_loss)
+    {
+      errorModel->AddSeqToKill (SequenceNumber32 (501));
+    }
+  return errorModel;
+}
+
+void
+TcpAccEcnFeedbackTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetEcn (SENDER);
+  SetEcn (RECEIVER);
+  GetSenderSocket ()->SetAttribute ("UseAccEcn", BooleanValue (true));
+  GetReceiverSocket ()->SetAttribute ("UseAccEcn", BooleanValue (true));
+}
+
+void
+TcpAccEcnFeedbackTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (GetTcb (SENDER)->m_accEcn, true, "AccECN not negotiated");
+  NS_TEST_ASSERT_MSG_EQ (m_recorder->m_cePackets, 3u, "Wrong number of CE packets reported");
+  NS_TEST_ASSERT_MSG_EQ (m_recorder->m_ceBytes, 3 * GetSegSize (SENDER), "Wrong number of CE bytes reported");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP AccECN TestSuite
+ */
+class TcpAccEcnTestSuite : public TestSuite
+{
+public:
+  TcpAccEcnTestSuite () : TestSuite ("tcp-accecn-test", UNIT)
+  {
+    AddTestCase (new TcpAccEcnHeaderTest (), TestCase::QUICK);
+    for (uint8_t fields = 0; fields <= 3; ++fields)
+      {
+        AddTestCase (new TcpAccEcnOptionTest (TcpOption::ACCECN0, fields), TestCase::QUICK);
+        AddTestCase (new TcpAccEcnOptionTest (TcpOption::ACCECN1, fields), TestCase::QUICK);
+      }
+    AddTestCase (new TcpAccEcnNegotiationTest (true, "AccECN negotiated"), TestCase::QUICK);
+    AddTestCase (new TcpAccEcnNegotiationTest (false, "Fallback to classic ECN"), TestCase::QUICK);
+    AddTestCase (new TcpAccEcnFeedbackTest (false, "Exact CE bytes reported to the congestion control"), TestCase::QUICK);
+    AddTestCase (new TcpAccEcnFeedbackTest (true, "Exact CE bytes reported by duplicate ACKs"), TestCase::QUICK);
+  }
+};
+
+static TcpAccEcnTestSuite g_tcpAccEcnTest; //!< static var for test initialization
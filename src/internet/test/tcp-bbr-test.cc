@@ -0,0 +1,369 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/config.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-bbr.h"
+#include "ns3/windowed-filter.h"
+
+#include <set>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpBbrTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the windowed max and min filters
+ *
+ * The best measurement must be replaced by a better one at once, and by
+ * the second and third best as it ages out of the window.
+ */
+class WindowedFilterTestCase : public TestCase
+{
+public:
+  WindowedFilterTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WindowedFilterTestCase::WindowedFilterTestCase ()
+  : TestCase ("Windowed max and min filters")
+{
+}
+
+void
+WindowedFilterTestCase::DoRun (void)
+{
+  // Max filter over 10 rounds
+  WindowedFilter<uint32_t, uint32_t, std::greater_equal<uint32_t> > maxFilter (10, 0, 0);
+  NS_TEST_ASSERT_MSG_EQ (maxFilter.Update (1, 100), 100u, "New maximum not taken");
+  NS_TEST_ASSERT_MSG_EQ (maxFilter.Update (2, 50), 100u, "Lower measurement taken");
+  NS_TEST_ASSERT_MSG_EQ (maxFilter.Update (4, 80), 100u, "Lower measurement taken");
+  NS_TEST_ASSERT_MSG_EQ (maxFilter.Update (7, 60), 100u, "Lower measurement taken");
+  NS_TEST_ASSERT_MSG_EQ (maxFilter.Update (10, 40), 100u, "Maximum expired too early");
+  // The maximum of round 1 is out of the window: the second best, measured
+  // in the second quarter of the window, is promoted
+  uint32_t best = maxFilter.Update (12, 30);
+  NS_TEST_ASSERT_MSG_EQ (best, 80u, "Second best not promoted");
+  NS_TEST_ASSERT_MSG_EQ (maxFilter.GetBestTime (), 4u, "Wrong time of the best measurement");
+  NS_TEST_ASSERT_MSG_EQ (maxFilter.Update (13, 200), 200u, "New maximum not taken");
+  // Nothing measured for a whole window
+  NS_TEST_ASSERT_MSG_EQ (maxFilter.Update (30, 10), 10u, "Stale maximum kept");
+
+  // Min filter over one second
+  WindowedFilter<Time, Time, std::less_equal<Time> > minFilter (Seconds (1), Time::Max (), Time (0));
+  NS_TEST_ASSERT_MSG_EQ (minFilter.Update (Seconds (0.1), MilliSeconds (20)), MilliSeconds (20),
+                         "New minimum not taken");
+  NS_TEST_ASSERT_MSG_EQ (minFilter.Update (Seconds (0.5), MilliSeconds (30)), MilliSeconds (20),
+                         "Higher measurement taken");
+  NS_TEST_ASSERT_MSG_EQ (minFilter.Update (Seconds (0.9), MilliSeconds (25)), MilliSeconds (20),
+                         "Higher measurement taken");
+  NS_TEST_ASSERT_MSG_EQ (minFilter.Update (Seconds (1.2), MilliSeconds (40)), MilliSeconds (25),
+                         "Second best not promoted");
+  NS_TEST_ASSERT_MSG_EQ (minFilter.Update (Seconds (1.6), MilliSeconds (40)), MilliSeconds (25),
+                         "Minimum expired too early");
+  NS_TEST_ASSERT_MSG_EQ (minFilter.Update (Seconds (2), MilliSeconds (50)), MilliSeconds (40),
+                         "Expired minimum kept");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the delivery rate samples generated by the TcpTxBuffer
+ *
+ * Ten segments of 1000 bytes are sent at time 0. Half of them is
+ * acknowledged after 100 ms: 5000 bytes in 100 ms. Five new segments are
+ * sent, and the first ten are acknowledged at 200 ms: 10000 bytes delivered
+ * since the transmission of the tenth segment, in 200 ms. The application
+ * is then marked limited, and the samples of the segments sent afterwards
+ * must be flagged.
+ */
+class TcpRateSampleTestCase : public TestCase
+{
+public:
+  TcpRateSampleTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** \brief Send the first ten segments */
+  void SendFirstFlight ();
+  /** \brief Acknowledge half of them, and send five more */
+  void AckHalf ();
+  /** \brief Acknowledge the first ten segments */
+  void AckFirstFlight ();
+  /** \brief Acknowledge everything */
+  void AckAll ();
+
+  Ptr<TcpTxBuffer> m_txBuf;   //!< Buffer under test
+};
+
+TcpRateSampleTestCase::TcpRateSampleTestCase ()
+  : TestCase ("Delivery rate samples of the TcpTxBuffer")
+{
+}
+
+void
+TcpRateSampleTestCase::DoRun (void)
+{
+  m_txBuf = CreateObject<TcpTxBuffer> (1);
+  m_txBuf->SetMaxBufferSize (100000);
+  Simulator::Schedule (Seconds (0), &TcpRateSampleTestCase::SendFirstFlight, this);
+  Simulator::Schedule (MilliSeconds (100), &TcpRateSampleTestCase::AckHalf, this);
+  Simulator::Schedule (MilliSeconds (200), &TcpRateSampleTestCase::AckFirstFlight, this);
+  Simulator::Schedule (MilliSeconds (300), &TcpRateSampleTestCase::AckAll, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_txBuf = 0;
+}
+
+void
+TcpRateSampleTestCase::SendFirstFlight ()
+{
+  m_txBuf->Add (Create<Packet> (20000));
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      m_txBuf->CopyFromSequence (1000, SequenceNumber32 (1 + i * 1000));
+    }
+  TcpRateSample rs = m_txBuf->GenerateRateSample ();
+  NS_TEST_ASSERT_MSG_EQ (rs.m_interval.IsZero (), true, "Sample without deliveries is valid");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_deliveryRate.GetBitRate (), 0u, "Sample without deliveries has a rate");
+}
+
+void
+TcpRateSampleTestCase::AckHalf ()
+{
+  m_txBuf->DiscardUpTo (SequenceNumber32 (5001));
+  TcpRateSample rs = m_txBuf->GenerateRateSample ();
+  NS_TEST_ASSERT_MSG_EQ (rs.m_ackedSacked, 5000u, "Wrong bytes acknowledged");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_delivered, 5000u, "Wrong bytes delivered in the interval");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_interval, MilliSeconds (100), "Wrong interval");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_rtt, MilliSeconds (100), "Wrong RTT");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_deliveryRate, DataRate ("400kbps"), "Wrong delivery rate");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_isAppLimited, false, "Sample application-limited");
+  NS_TEST_ASSERT_MSG_EQ (m_txBuf->GetDeliveryRate (), DataRate ("400kbps"), "Rate not kept");
+
+  for (uint32_t i = 10; i < 15; ++i)
+    {
+      m_txBuf->CopyFromSequence (1000, SequenceNumber32 (1 + i * 1000));
+    }
+}
+
+void
+TcpRateSampleTestCase::AckFirstFlight ()
+{
+  m_txBuf->DiscardUpTo (SequenceNumber32 (10001));
+  TcpRateSample rs = m_txBuf->GenerateRateSample ();
+  NS_TEST_ASSERT_MSG_EQ (rs.m_ackedSacked, 5000u, "Wrong bytes acknowledged");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_delivered, 10000u, "Wrong bytes delivered in the interval");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_totalDelivered, 10000u, "Wrong bytes delivered in total");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_interval, MilliSeconds (200), "Wrong interval");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_deliveryRate, DataRate ("400kbps"), "Wrong delivery rate");
+
+  // Nothing more to send, with a window of 10 segments and 5 in flight
+  m_txBuf->MarkAppLimited (5000);
+  m_txBuf->CopyFromSequence (1000, SequenceNumber32 (15001));
+}
+
+void
+TcpRateSampleTestCase::AckAll ()
+{
+  m_txBuf->DiscardUpTo (SequenceNumber32 (16001));
+  TcpRateSample rs = m_txBuf->GenerateRateSample ();
+  NS_TEST_ASSERT_MSG_EQ (rs.m_ackedSacked, 6000u, "Wrong bytes acknowledged");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_isAppLimited, true, "Sample not application-limited");
+  // The segment was sent 200 ms after the first segment of its flight
+  NS_TEST_ASSERT_MSG_EQ (rs.m_interval, MilliSeconds (200), "Wrong interval");
+  // The application-limited sample shows a lower rate: the rate of the
+  // connection is not updated
+  NS_TEST_ASSERT_MSG_LT (rs.m_deliveryRate, DataRate ("400kbps"), "Wrong delivery rate");
+  NS_TEST_ASSERT_MSG_EQ (m_txBuf->GetDeliveryRate (), DataRate ("400kbps"),
+                         "Rate lowered by an application-limited sample");
+  NS_TEST_ASSERT_MSG_EQ (m_txBuf->GetDelivered (), 16000u, "Wrong bytes delivered in total");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the model built by BBR in a bulk transfer
+ *
+ * The sender is limited by a 10 Mb/s link, with 10 ms of propagation delay
+ * in each direction. BBR must leave STARTUP, estimate the bottleneck
+ * bandwidth and the propagation delay, keep cWnd around twice the
+ * bandwidth-delay product, and pace the segments at about the bottleneck
+ * rate. If the propagation delay grows during the transfer, the minimum RTT
+ * is no longer refreshed: with a short RttWindowLength, BBR must go through
+ * PROBE_RTT and measure the new delay.
+ */
+class TcpBbrTransferTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param rttWindow validity of the minimum RTT
+   * \param delayIncrease increase of the one-way delay, 1 s into the transfer
+   * \param desc description
+   */
+  TcpBbrTransferTest (Time rttWindow, Time delayIncrease, const std::string &desc);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void CWndTrace (uint32_t oldValue, uint32_t newValue);
+  virtual void QueueDrop (SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  /** \brief Increase the propagation delay of the channel */
+  void IncreaseDelay ();
+
+  Time m_rttWindow;                  //!< Validity of the minimum RTT
+  Time m_delayIncrease;              //!< Increase of the one-way delay
+  Ptr<TcpBbr> m_bbr;                 //!< Congestion control of the sender
+  std::set<TcpBbr::BbrMode_t> m_modes; //!< States visited
+  uint32_t m_drops;                  //!< Segments dropped by the bottleneck
+  uint32_t m_maxCwnd;                //!< Maximum cWnd after startup
+};
+
+TcpBbrTransferTest::TcpBbrTransferTest (Time rttWindow, Time delayIncrease,
+                                        const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_rttWindow (rttWindow),
+    m_delayIncrease (delayIncrease),
+    m_drops (0),
+    m_maxCwnd (0)
+{
+}
+
+void
+TcpBbrTransferTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetPropagationDelay (MilliSeconds (10));
+  SetTransmitStart (Seconds (1));
+  // About the bottleneck rate, so that the sender is never application-limited
+  SetAppPktCount (5000);
+  SetAppPktInterval (MicroSeconds (400));
+  if (m_delayIncrease.IsStrictlyPositive ())
+    {
+      Simulator::Schedule (Seconds (2), &TcpBbrTransferTest::IncreaseDelay, this);
+    }
+}
+
+void
+TcpBbrTransferTest::IncreaseDelay ()
+{
+  Config::Set ("/ChannelList/*/$ns3::SimpleChannel/Delay",
+               TimeValue (MilliSeconds (10) + m_delayIncrease));
+}
+
+void
+TcpBbrTransferTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  Config::Set ("/NodeList/*/DeviceList/*/$ns3::SimpleNetDevice/DataRate",
+               DataRateValue (DataRate ("10Mbps")));
+  SetInitialCwnd (SENDER, 10);
+  m_bbr = CreateObject<TcpBbr> ();
+  m_bbr->SetAttribute ("RttWindowLength", TimeValue (m_rttWindow));
+  m_bbr->AssignStreams (1);
+  GetSenderSocket ()->SetCongestionControlAlgorithm (m_bbr);
+}
+
+void
+TcpBbrTransferTest::CWndTrace (uint32_t oldValue, uint32_t newValue)
+{
+  m_modes.insert (m_bbr->GetMode ());
+  if (m_bbr->GetMode () == TcpBbr::BBR_PROBE_BW)
+    {
+      m_maxCwnd = std::max (m_maxCwnd, newValue);
+    }
+}
+
+void
+TcpBbrTransferTest::QueueDrop (SocketWho who)
+{
+  m_drops++;
+}
+
+void
+TcpBbrTransferTest::FinalChecks ()
+{
+  NS_LOG_INFO ("Bandwidth " << m_bbr->GetBandwidth () << ", min RTT " << m_bbr->GetMinRtt () <<
+               ", max cWnd " << m_maxCwnd << ", drops " << m_drops);
+
+  NS_TEST_ASSERT_MSG_EQ (m_bbr->IsFullBwReached (), true, "Startup not over");
+  NS_TEST_ASSERT_MSG_EQ (m_modes.count (TcpBbr::BBR_DRAIN), 1u, "DRAIN not visited");
+  NS_TEST_ASSERT_MSG_EQ (m_modes.count (TcpBbr::BBR_PROBE_BW), 1u, "PROBE_BW not visited");
+  bool probeRtt = m_modes.count (TcpBbr::BBR_PROBE_RTT) > 0;
+  bool expectProbeRtt = m_rttWindow < Seconds (1);
+  NS_TEST_ASSERT_MSG_EQ (probeRtt, expectProbeRtt, "Wrong visits to PROBE_RTT");
+
+  // The payload is about 90% of the 10 Mb/s on the wire
+  double bw = m_bbr->GetBandwidth ().GetBitRate ();
+  NS_TEST_ASSERT_MSG_GT (bw, 8e6, "Bandwidth underestimated");
+  NS_TEST_ASSERT_MSG_LT (bw, 10e6, "Bandwidth overestimated");
+  Time rtt = MilliSeconds (20) + 2 * m_delayIncrease;
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_bbr->GetMinRtt (), rtt, "Min RTT underestimated");
+  NS_TEST_ASSERT_MSG_LT (m_bbr->GetMinRtt (), rtt + MilliSeconds (2), "Min RTT overestimated");
+
+  // cwnd_gain * BDP, plus the ACK budget
+  double bdp = bw / 8 * m_bbr->GetMinRtt ().GetSeconds ();
+  NS_TEST_ASSERT_MSG_LT (m_maxCwnd, 2 * bdp + 6 * GetSegSize (SENDER), "cWnd above the target");
+  NS_TEST_ASSERT_MSG_EQ (m_drops, 0u, "Segments dropped by the bottleneck");
+
+  // Paced at the bandwidth, up to the gain of the current phase
+  double pacingRate = GetTcb (SENDER)->m_pacingRate.Get ().GetBitRate ();
+  NS_TEST_ASSERT_MSG_GT (pacingRate, 0.7 * bw, "Pacing rate too low");
+  NS_TEST_ASSERT_MSG_LT (pacingRate, 1.3 * bw, "Pacing rate too high");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief BBR TestSuite
+ */
+class TcpBbrTestSuite : public TestSuite
+{
+public:
+  TcpBbrTestSuite () : TestSuite ("tcp-bbr-test", UNIT)
+  {
+    AddTestCase (new TcpBbrTransferTest (Seconds (10), Time (0), "Bulk transfer reaching PROBE_BW"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpBbrTransferTest (MilliSeconds (500), MilliSeconds (5),
+                                         "Bulk transfer with PROBE_RTT"),
+                 TestCase::QUICK);
+    // After the transfers, which enable the packet metadata
+    AddTestCase (new WindowedFilterTestCase, TestCase::QUICK);
+    AddTestCase (new TcpRateSampleTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpBbrTestSuite g_tcpBbrTestSuite; //!< Static variable for test initialization
@@ -64,7 +64,14 @@ protected:
   virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
   virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
   virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual void FinalChecks ();
   void ConfigureProperties ();
+  /**
+   * \brief Trace the sequence number of the last CE mark accepted by the receiver
+   * \param oldValue old value
+   * \param newValue new value
+   */
+  void EcnCESeqTrace (SequenceNumber32 oldValue, SequenceNumber32 newValue);
 
 private:
   uint32_t m_cwndChangeCount;
@@ -73,6 +80,7 @@ private:
   uint32_t m_senderReceived;
   uint32_t m_receiverReceived;
   uint32_t m_testcase;
+  uint32_t m_ceCount;      //!< Number of CE marks accepted by the receiver
 };
 
 
@@ -85,7 +93,8 @@ private:
  * The SendDataPacket function of this class sends data packets numbered 1 and 2 with CE flags set
  * for test 5 to verify if ECE and CWR bits are correctly set by receiver and sender respectively. It
  * also sets CE flags on data packets 10 and 11 in test case 6 to check if sender reduces congestion window
- * by half and also only once per every window.
+ * by half and also only once per every window. Test case 7 marks both sets of packets, to check that
+ * the receiver accepts every new CE mark, not only the first one of the connection.
  *
  */
 class TcpSocketCongestedRouter : public TcpSocketMsgBase
@@ -201,11 +210,11 @@ TcpSocketCongestedRouter::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize
       SocketIpTosTag ipTosTag;
 
       NS_LOG_LOGIC (" ECT bits should not be set on retransmitted packets ");
-      if ( m_testcase == 5 && (m_dataPacketSent == 1  || m_dataPacketSent == 2) && !isRetransmission )
+      if ( (m_testcase == 5 || m_testcase == 7) && (m_dataPacketSent == 1  || m_dataPacketSent == 2) && !isRetransmission )
         {
           ipTosTag.SetTos (GetIpTos () | 0x3);
         }
-      else if ( m_testcase == 6 &&  ( m_dataPacketSent == 10 || m_dataPacketSent == 11 )  && !isRetransmission )
+      else if ( (m_testcase == 6 || m_testcase == 7) && ( m_dataPacketSent == 10 || m_dataPacketSent == 11 )  && !isRetransmission )
         {
           ipTosTag.SetTos (GetIpTos () | 0x3);
         }
@@ -225,11 +234,11 @@ TcpSocketCongestedRouter::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize
   else
     {
       SocketIpTosTag ipTosTag;
-      if ( m_testcase == 5 && (m_dataPacketSent == 1  || m_dataPacketSent == 2)  && !isRetransmission)
+      if ( (m_testcase == 5 || m_testcase == 7) && (m_dataPacketSent == 1  || m_dataPacketSent == 2)  && !isRetransmission)
         {
           ipTosTag.SetTos (0x3);
         }
-      else if ( m_testcase == 6 && ( m_dataPacketSent == 10 || m_dataPacketSent == 11 )  && !isRetransmission )
+      else if ( (m_testcase == 6 || m_testcase == 7) && ( m_dataPacketSent == 10 || m_dataPacketSent == 11 )  && !isRetransmission )
         {
           ipTosTag.SetTos (0x3);
         }
@@ -246,11 +255,11 @@ TcpSocketCongestedRouter::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize
   if (IsManualIpv6Tclass ())
     {
       SocketIpv6TclassTag ipTclassTag;
-      if ( m_testcase == 5 && (m_dataPacketSent == 1  || m_dataPacketSent == 2)  && !isRetransmission )
+      if ( (m_testcase == 5 || m_testcase == 7) && (m_dataPacketSent == 1  || m_dataPacketSent == 2)  && !isRetransmission )
         {
           ipTclassTag.SetTclass (GetIpv6Tclass () | 0x3);
         }
-      else if ( m_testcase == 6 && ( m_dataPacketSent == 10 || m_dataPacketSent == 11 )  && !isRetransmission)
+      else if ( (m_testcase == 6 || m_testcase == 7) && ( m_dataPacketSent == 10 || m_dataPacketSent == 11 )  && !isRetransmission)
         {
           ipTclassTag.SetTclass (GetIpv6Tclass () | 0x3);
         }
@@ -270,11 +279,11 @@ TcpSocketCongestedRouter::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize
   else
     {
       SocketIpv6TclassTag ipTclassTag;
-      if ( m_testcase == 5 && (m_dataPacketSent == 1  || m_dataPacketSent == 2)  && !isRetransmission)
+      if ( (m_testcase == 5 || m_testcase == 7) && (m_dataPacketSent == 1  || m_dataPacketSent == 2)  && !isRetransmission)
         {
           ipTclassTag.SetTclass (0x3);
         }
-      else if ( m_testcase == 6 &&( m_dataPacketSent == 10 || m_dataPacketSent == 11 )  && !isRetransmission)
+      else if ( (m_testcase == 6 || m_testcase == 7) && ( m_dataPacketSent == 10 || m_dataPacketSent == 11 )  && !isRetransmission)
         {
           ipTclassTag.SetTclass (0x3);
         }
@@ -397,7 +406,8 @@ TcpECNTest::TcpECNTest (uint32_t testcase, const std::string &desc)
     m_receiverSent (0),
     m_senderReceived (0),
     m_receiverReceived (0),
-    m_testcase (testcase)
+    m_testcase (testcase),
+    m_ceCount (0)
 {
 }
 
@@ -405,11 +415,11 @@ void
 TcpECNTest::ConfigureProperties ()
 {
   TcpGeneralTest::ConfigureProperties ();
-  if (m_testcase == 2 || m_testcase == 4 || m_testcase == 5 || m_testcase == 6)
+  if (m_testcase == 2 || m_testcase == 4 || m_testcase == 5 || m_testcase == 6 || m_testcase == 7)
     {
       SetEcn (SENDER);
     }
-  if (m_testcase == 3 || m_testcase == 4 ||m_testcase == 5 || m_testcase == 6)
+  if (m_testcase == 3 || m_testcase == 4 ||m_testcase == 5 || m_testcase == 6 || m_testcase == 7)
     {
       SetEcn (RECEIVER);
     }
@@ -438,7 +448,7 @@ TcpECNTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
       if (m_receiverReceived == 0)
         {
           NS_TEST_ASSERT_MSG_NE (((h.GetFlags ()) & TcpHeader::SYN), 0, "SYN should be received as first message at the receiver");
-          if (m_testcase == 2 || m_testcase == 4 || m_testcase == 5 ||m_testcase == 6)
+          if (m_testcase == 2 || m_testcase == 4 || m_testcase == 5 ||m_testcase == 6 || m_testcase == 7)
             {
               NS_TEST_ASSERT_MSG_NE (((h.GetFlags ()) & TcpHeader::ECE) && ((h.GetFlags ()) & TcpHeader::CWR), 0, "The flags ECE + CWR should be set in the TCP header of first message receieved at receiver when sender is ECN Capable");
             }
@@ -450,6 +460,12 @@ TcpECNTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
       else if (m_receiverReceived == 1)
         {
           NS_TEST_ASSERT_MSG_NE (((h.GetFlags ()) & TcpHeader::ACK), 0, "ACK should be received as second message at receiver");
+          if (m_testcase == 7)
+            {
+              // The receiver socket is now the one forked by the listener
+              GetReceiverSocket ()->TraceConnectWithoutContext ("EcnCESeq",
+                                                                MakeCallback (&TcpECNTest::EcnCESeqTrace, this));
+            }
         }
       else if (m_receiverReceived == 3 && m_testcase == 5)
         {
@@ -462,7 +478,7 @@ TcpECNTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
       if (m_senderReceived == 0)
         {
           NS_TEST_ASSERT_MSG_NE (((h.GetFlags ()) & TcpHeader::SYN) && ((h.GetFlags ()) & TcpHeader::ACK), 0, "SYN+ACK received as first message at sender");
-          if (m_testcase == 4 || m_testcase == 5 || m_testcase == 6)
+          if (m_testcase == 4 || m_testcase == 5 || m_testcase == 6 || m_testcase == 7)
             {
               NS_TEST_ASSERT_MSG_NE (((h.GetFlags ()) & TcpHeader::ECE), 0, "The flag ECE should be set in the TCP header of first message receieved at sender when both receiver and sender are ECN Capable");
             }
@@ -501,7 +517,7 @@ TcpECNTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
             {
               NS_TEST_ASSERT_MSG_EQ ((ipTosTag.GetTos ()), 0x2, "IP TOS should have ECT set if ECN negotiation between endpoints is successful");
             }
-          else if (m_testcase == 5)
+          else if (m_testcase == 5 || m_testcase == 7)
             {
               if (m_senderSent == 3 || m_senderSent == 4)
                 {
@@ -523,7 +539,7 @@ TcpECNTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
 Ptr<TcpSocketMsgBase>
 TcpECNTest::CreateSenderSocket (Ptr<Node> node)
 {
-  if (m_testcase == 5 || m_testcase == 6)
+  if (m_testcase == 5 || m_testcase == 6 || m_testcase == 7)
     {
       Ptr<TcpSocketCongestedRouter> socket = DynamicCast<TcpSocketCongestedRouter> (
           CreateSocket (node,
@@ -538,6 +554,22 @@ TcpECNTest::CreateSenderSocket (Ptr<Node> node)
     }
 }
 
+void
+TcpECNTest::EcnCESeqTrace (SequenceNumber32 oldValue, SequenceNumber32 newValue)
+{
+  NS_TEST_ASSERT_MSG_GT (newValue, oldValue, "CE marks should be accepted in sequence order");
+  m_ceCount++;
+}
+
+void
+TcpECNTest::FinalChecks ()
+{
+  if (m_testcase == 7)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_ceCount, 3, "The receiver should accept the CE marks of data packets 1, 2 and 10");
+    }
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -561,6 +593,8 @@ public:
                  TestCase::QUICK);
     AddTestCase (new TcpECNTest (6, "Congestion Window Reduction Test :ECN capable sender and ECN capable receiver"),
                  TestCase::QUICK);
+    AddTestCase (new TcpECNTest (7, "CE Acceptance Test of two congestion events: ECN capable sender and ECN capable receiver"),
+                 TestCase::QUICK);
   }
 } g_tcpECNTestSuite;
 
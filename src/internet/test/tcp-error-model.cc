@@ -166,5 +166,46 @@ TcpFlagErrorModel::DoReset (void)
   m_killNumber = 0;
 }
 
+NS_OBJECT_ENSURE_REGISTERED (TcpCeMarkingErrorModel);
+
+TypeId
+TcpCeMarkingErrorModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpCeMarkingErrorModel")
+    .SetParent<TcpSeqErrorModel> ()
+    .AddConstructor<TcpCeMarkingErrorModel> ()
+  ;
+  return tid;
+}
+
+bool
+TcpCeMarkingErrorModel::DoCorrupt (Ptr<Packet> p)
+{
+  Ipv4Header ipHeader;
+  TcpHeader tcpHeader;
+  p->RemoveHeader (ipHeader);
+  p->PeekHeader (tcpHeader);
+
+  std::set<SequenceNumber32>::iterator it = m_seqToMark.find (tcpHeader.GetSequenceNumber ());
+  if (it != m_seqToMark.end () && ipHeader.GetEcn () != Ipv4Header::ECN_NotECT)
+    {
+      ipHeader.SetEcn (Ipv4Header::ECN_CE);
+      m_seqToMark.erase (it);
+    }
+
+  bool toDrop = ShouldDrop (ipHeader, tcpHeader,
+                            p->GetSize () - tcpHeader.GetSerializedSize ());
+
+  p->AddHeader (ipHeader);
+  return toDrop;
+}
+
+void
+TcpCeMarkingErrorModel::DoReset (void)
+{
+  m_seqToKill.clear ();
+  m_seqToMark.clear ();
+}
+
 } //namespace ns3
 
@@ -23,6 +23,8 @@
 #include "ns3/tcp-header.h"
 #include "ns3/ipv4-header.h"
 
+#include <set>
+
 namespace ns3 {
 
 /**
@@ -174,6 +176,40 @@ private:
   virtual void DoReset (void);
 };
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Error model which sets the CE codepoint on the selected segments
+ *
+ * It also drops the segments selected with AddSeqToKill, as
+ * TcpSeqErrorModel does.
+ */
+class TcpCeMarkingErrorModel : public TcpSeqErrorModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Mark the segment with the given sequence number
+   * \param seq sequence number
+   */
+  void AddSeqToMark (const SequenceNumber32 &seq)
+  {
+    m_seqToMark.insert (seq);
+  }
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  std::set<SequenceNumber32> m_seqToMark; //!< Segments to mark
+};
+
 } // namespace ns3
 
 #endif // TCPERRORCHANNEL_H
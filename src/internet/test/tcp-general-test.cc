@@ -1221,3 +1221,15 @@ TcpSocketSmallAcks::Fork (void)
   return CopyObject<TcpSocketSmallAcks> (this);
 }
 
+
+NS_OBJECT_ENSURE_REGISTERED (TcpAccEcnRecorder);
+
+TypeId
+TcpAccEcnRecorder::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpAccEcnRecorder")
+    .SetParent<TcpNewReno> ()
+    .AddConstructor<TcpAccEcnRecorder> ()
+  ;
+  return tid;
+}
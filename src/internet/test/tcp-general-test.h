@@ -210,6 +210,39 @@ protected:
   SequenceNumber32 m_lastAckedSeq;  //!< Last sequence number ACKed.
 };
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Congestion control recording the AccECN feedback passed to PktsAcked
+ */
+class TcpAccEcnRecorder : public TcpNewReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpAccEcnRecorder ()
+    : TcpNewReno (),
+      m_ceBytes (0),
+      m_cePackets (0)
+  {
+  }
+
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time &rtt)
+  {
+    m_ceBytes += tcb->m_ackedCeBytes;
+    m_cePackets += tcb->m_ackedCePackets;
+  }
+
+  uint32_t m_ceBytes;   //!< CE bytes reported to the congestion control
+  uint32_t m_cePackets; //!< CE packets reported to the congestion control
+};
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "tcp-error-model.h"
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/error-model.h"
+
+#include <set>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpGroTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the ACKs and the ECN feedback of a receiver coalescing segments
+ *
+ * The channel has no rate limit, so that every window of the sender reaches
+ * the receiver as a burst of segments at the same instant. With receive
+ * offload, the receiver processes each burst in a few aggregates and sends
+ * one ACK per aggregate, instead of one every two segments. Some segments
+ * are CE-marked, in runs that start and end inside the bursts: an aggregate
+ * must never mix marked and unmarked segments, and the sender must learn
+ * the exact number of CE-marked segments and bytes through AccECN.
+ */
+class TcpGroTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param groSegments maximum segments in a receive aggregate
+   * \param groTimeout time an aggregate waits for more segments
+   * \param desc description
+   */
+  TcpGroTest (uint32_t groSegments, Time groTimeout, const std::string &desc);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  uint32_t m_groSegments;              //!< Maximum segments in a receive aggregate
+  Time m_groTimeout;                   //!< Time an aggregate waits for more segments
+  std::set<SequenceNumber32> m_marked; //!< Segments marked CE
+  Ptr<TcpAccEcnRecorder> m_recorder;    //!< Congestion control of the sender
+  uint32_t m_acks;                     //!< ACKs sent by the receiver
+  uint32_t m_aggregates;               //!< Data packets processed by the receiver
+  uint32_t m_maxAggregate;             //!< Largest data packet processed by the receiver
+  uint32_t m_mixedAggregates;          //!< Aggregates of marked and unmarked segments
+  SequenceNumber32 m_highAck;          //!< Highest ACK received by the sender
+};
+
+TcpGroTest::TcpGroTest (uint32_t groSegments, Time groTimeout, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_groSegments (groSegments),
+    m_groTimeout (groTimeout),
+    m_acks (0),
+    m_aggregates (0),
+    m_maxAggregate (0),
+    m_mixedAggregates (0),
+    m_highAck (1)
+{
+  // Runs of marks starting and ending inside the windows of the sender
+  m_marked.insert (SequenceNumber32 (2501));
+  m_marked.insert (SequenceNumber32 (3001));
+  m_marked.insert (SequenceNumber32 (3501));
+  m_marked.insert (SequenceNumber32 (6001));
+  m_marked.insert (SequenceNumber32 (20001));
+  m_marked.insert (SequenceNumber32 (20501));
+}
+
+void
+TcpGroTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetPropagationDelay (MilliSeconds (10));
+  SetTransmitStart (Seconds (1));
+  SetAppPktCount (100);
+  SetAppPktInterval (MicroSeconds (1));
+}
+
+void
+TcpGroTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  SetEcn (SENDER);
+  SetEcn (RECEIVER);
+  GetSenderSocket ()->SetAttribute ("UseAccEcn", BooleanValue (true));
+  GetReceiverSocket ()->SetAttribute ("UseAccEcn", BooleanValue (true));
+  GetReceiverSocket ()->SetAttribute ("GroSegments", UintegerValue (m_groSegments));
+  GetReceiverSocket ()->SetAttribute ("GroTimeout", TimeValue (m_groTimeout));
+}
+
+Ptr<TcpSocketMsgBase>
+TcpGroTest::CreateSenderSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateSenderSocket (node);
+  m_recorder = CreateObject<TcpAccEcnRecorder> ();
+  socket->SetCongestionControlAlgorithm (m_recorder);
+  return socket;
+}
+
+Ptr<ErrorModel>
+TcpGroTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpCeMarkingErrorModel> errorModel = CreateObject<TcpCeMarkingErrorModel> ();
+  for (std::set<SequenceNumber32>::const_iterator it = m_marked.begin (); it != m_marked.end (); ++it)
+    {
+      errorModel->AddSeqToMark (*it);
+    }
+  return errorModel;
+}
+
+void
+TcpGroTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER && p->GetSize () == 0 && h.GetFlags () & TcpHeader::ACK
+      && (h.GetFlags () & (TcpHeader::SYN | TcpHeader::FIN)) == 0)
+    {
+      ++m_acks;
+    }
+}
+
+void
+TcpGroTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER && p->GetSize () > 0)
+    {
+      ++m_aggregates;
+      m_maxAggregate = std::max (m_maxAggregate, p->GetSize ());
+
+      uint32_t segSize = GetSegSize (SENDER);
+      uint32_t marked = 0;
+      for (uint32_t offset = 0; offset < p->GetSize (); offset += segSize)
+        {
+          marked += m_marked.count (h.GetSequenceNumber () + offset);
+        }
+      uint32_t segments = (p->GetSize () + segSize - 1) / segSize;
+      if (marked != 0 && marked != segments)
+        {
+          ++m_mixedAggregates;
+        }
+    }
+  else if (who == SENDER && h.GetAckNumber () > m_highAck)
+    {
+      m_highAck = h.GetAckNumber ();
+    }
+}
+
+void
+TcpGroTest::FinalChecks ()
+{
+  uint32_t segments = GetPktCount ();
+  uint32_t segSize = GetSegSize (SENDER);
+  uint32_t marked = m_marked.size ();
+
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_highAck, SequenceNumber32 (1 + segments * segSize),
+                         "Not all the data was acknowledged");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_maxAggregate, m_groSegments * segSize,
+                               "Aggregate larger than GroSegments");
+  NS_TEST_ASSERT_MSG_EQ (m_mixedAggregates, 0, "Marked and unmarked segments coalesced");
+
+  if (m_groSegments > 1)
+    {
+      NS_TEST_ASSERT_MSG_LT (m_aggregates, segments / 2, "Segments were not coalesced");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (m_acks, m_aggregates + 1, "The receiver should ACK each aggregate");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_aggregates, segments, "Segments coalesced without offload");
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (m_acks, segments / 2, "The receiver should ACK every two segments");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (GetTcb (SENDER)->m_accEcn, true, "AccECN not negotiated");
+  NS_TEST_ASSERT_MSG_EQ (m_recorder->m_cePackets, marked, "Wrong number of CE packets reported");
+  NS_TEST_ASSERT_MSG_EQ (m_recorder->m_ceBytes, marked * segSize, "Wrong number of CE bytes reported");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP receive offload TestSuite
+ */
+class TcpGroTestSuite : public TestSuite
+{
+public:
+  TcpGroTestSuite () : TestSuite ("tcp-gro-test", UNIT)
+  {
+    AddTestCase (new TcpGroTest (1, Seconds (0), "ACK every two segments without offload"), TestCase::QUICK);
+    AddTestCase (new TcpGroTest (16, MicroSeconds (50), "ACK every aggregate with offload"), TestCase::QUICK);
+    AddTestCase (new TcpGroTest (4, MicroSeconds (50), "Aggregates limited by GroSegments"), TestCase::QUICK);
+  }
+};
+
+static TcpGroTestSuite g_tcpGroTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "tcp-error-model.h"
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpHeaderPredictionTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the hit ratio of the header prediction fast path
+ *
+ * In a bulk transfer without losses, almost every ACK received by the
+ * sender, and almost every data segment received by the receiver, must be
+ * predicted. A loss makes the duplicate ACKs and the out-of-order segments
+ * go through the generic code, and the transfer must complete as usual.
+ * Without header prediction, no segment takes the fast path.
+ */
+class TcpHeaderPredictionTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param prediction whether header prediction is enabled
+   * \param seqToDrop sequence number of the segment to drop (0 for none)
+   * \param desc description
+   */
+  TcpHeaderPredictionTest (bool prediction, uint32_t seqToDrop, const std::string &desc);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  bool m_prediction;           //!< Whether header prediction is enabled
+  uint32_t m_seqToDrop;        //!< Segment to drop
+  SequenceNumber32 m_highAck;  //!< Highest ACK received by the sender
+};
+
+TcpHeaderPredictionTest::TcpHeaderPredictionTest (bool prediction, uint32_t seqToDrop,
+                                                  const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_prediction (prediction),
+    m_seqToDrop (seqToDrop),
+    m_highAck (1)
+{
+}
+
+void
+TcpHeaderPredictionTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetPropagationDelay (MilliSeconds (10));
+  SetTransmitStart (Seconds (1));
+  SetAppPktCount (200);
+  SetAppPktInterval (MicroSeconds (1));
+}
+
+void
+TcpHeaderPredictionTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  GetSenderSocket ()->SetAttribute ("HeaderPrediction", BooleanValue (m_prediction));
+  GetReceiverSocket ()->SetAttribute ("HeaderPrediction", BooleanValue (m_prediction));
+}
+
+Ptr<ErrorModel>
+TcpHeaderPredictionTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpSeqErrorModel> errorModel = CreateObject<TcpSeqErrorModel> ();
+  if (m_seqToDrop != 0)
+    {
+      errorModel->AddSeqToKill (SequenceNumber32 (m_seqToDrop));
+    }
+  return errorModel;
+}
+
+void
+TcpHeaderPredictionTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER && h.GetAckNumber () > m_highAck)
+    {
+      m_highAck = h.GetAckNumber ();
+    }
+}
+
+void
+TcpHeaderPredictionTest::FinalChecks ()
+{
+  Ptr<TcpSocketBase> sender = GetSenderSocket ();
+  Ptr<TcpSocketBase> receiver = GetReceiverSocket ();
+
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_highAck, SequenceNumber32 (1 + GetPktCount () * GetPktSize ()),
+                               "Not all the data was acknowledged");
+
+  double senderHits = sender->GetFastPathAcks ();
+  double receiverHits = receiver->GetFastPathData ();
+  double senderRatio = senderHits / (senderHits + sender->GetSlowPathSegments ());
+  double receiverRatio = receiverHits / (receiverHits + receiver->GetSlowPathSegments ());
+  NS_LOG_INFO ("Sender: " << sender->GetFastPathAcks () << " predicted ACKs, " <<
+               sender->GetSlowPathSegments () << " slow path segments");
+  NS_LOG_INFO ("Receiver: " << receiver->GetFastPathData () << " predicted data, " <<
+               receiver->GetSlowPathSegments () << " slow path segments");
+
+  if (!m_prediction)
+    {
+      uint64_t hits = sender->GetFastPathAcks () + sender->GetFastPathData ()
+        + receiver->GetFastPathAcks () + receiver->GetFastPathData ();
+      NS_TEST_ASSERT_MSG_EQ (hits, 0, "Segments predicted without header prediction");
+      NS_TEST_ASSERT_MSG_GT (sender->GetSlowPathSegments (), 0, "ACKs not counted");
+      NS_TEST_ASSERT_MSG_GT (receiver->GetSlowPathSegments (), 0, "Data segments not counted");
+    }
+  else if (m_seqToDrop == 0)
+    {
+      NS_TEST_ASSERT_MSG_GT (senderRatio, 0.9, "Too few ACKs predicted");
+      NS_TEST_ASSERT_MSG_GT (receiverRatio, 0.9, "Too few data segments predicted");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_GT (sender->GetSlowPathSegments (), 3, "Duplicate ACKs predicted");
+      NS_TEST_ASSERT_MSG_GT (receiver->GetSlowPathSegments (), 1, "Out-of-order segments predicted");
+      NS_TEST_ASSERT_MSG_GT (senderRatio, 0.5, "Too few ACKs predicted");
+      NS_TEST_ASSERT_MSG_GT (receiverRatio, 0.5, "Too few data segments predicted");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP header prediction TestSuite
+ */
+class TcpHeaderPredictionTestSuite : public TestSuite
+{
+public:
+  TcpHeaderPredictionTestSuite () : TestSuite ("tcp-header-prediction-test", UNIT)
+  {
+    AddTestCase (new TcpHeaderPredictionTest (false, 0, "Generic processing only"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpHeaderPredictionTest (true, 0, "Bulk transfer on the fast path"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpHeaderPredictionTest (true, 20001, "Loss recovery on the slow path"),
+                 TestCase::QUICK);
+  }
+};
+
+static TcpHeaderPredictionTestSuite g_tcpHeaderPredictionTestSuite; //!< Static variable for test initialization
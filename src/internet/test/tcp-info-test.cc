@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "tcp-error-model.h"
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/tcp-info-helper.h"
+#include "ns3/buffer.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpInfoTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the TcpInfo snapshot, and the samples of the TcpInfoHelper
+ *
+ * After every ACK processed by the sender, the snapshot must agree with the
+ * congestion state of the socket. At the end of the transfer, it must count
+ * the delivered bytes and the retransmissions. The helper samples both
+ * nodes every 10 ms, as text or as binary blocks: every row must have all
+ * the columns, and the sender rows must show the delivered bytes growing.
+ */
+class TcpInfoTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param seqToDrop sequence number of the segment to drop (0 for none)
+   * \param format format of the samples
+   * \param desc description
+   */
+  TcpInfoTest (uint32_t seqToDrop, TcpInfoHelper::Format format, const std::string &desc);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void ProcessedAck (const Ptr<const TcpSocketState> tcb,
+                             const TcpHeader& h, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  /// Node id and delivered bytes of each sampled connection
+  typedef std::vector<std::pair<uint32_t, uint64_t> > DeliveredSamples;
+
+  /**
+   * \brief Read the text samples
+   * \param samples the node id and delivered bytes of the rows
+   */
+  void ReadText (DeliveredSamples &samples);
+
+  /**
+   * \brief Read the binary samples
+   * \param samples the node id and delivered bytes of the rows
+   */
+  void ReadBinary (DeliveredSamples &samples);
+
+  uint32_t m_seqToDrop;             //!< Segment to drop
+  TcpInfoHelper::Format m_format;   //!< Format of the samples
+  uint32_t m_acks;                  //!< ACKs processed by the sender
+  std::stringstream m_samples;      //!< Output of the helper
+};
+
+TcpInfoTest::TcpInfoTest (uint32_t seqToDrop, TcpInfoHelper::Format format,
+                          const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_seqToDrop (seqToDrop),
+    m_format (format),
+    m_acks (0)
+{
+}
+
+void
+TcpInfoTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetPropagationDelay (MilliSeconds (10));
+  SetTransmitStart (Seconds (1));
+  SetAppPktCount (200);
+  SetAppPktInterval (MicroSeconds (100));
+}
+
+void
+TcpInfoTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  TcpInfoHelper::SampleAllEvery (MilliSeconds (10), Create<OutputStreamWrapper> (&m_samples),
+                                 Seconds (3), m_format);
+}
+
+Ptr<ErrorModel>
+TcpInfoTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpSeqErrorModel> errorModel = CreateObject<TcpSeqErrorModel> ();
+  if (m_seqToDrop != 0)
+    {
+      errorModel->AddSeqToKill (SequenceNumber32 (m_seqToDrop));
+    }
+  return errorModel;
+}
+
+void
+TcpInfoTest::ProcessedAck (const Ptr<const TcpSocketState> tcb,
+                           const TcpHeader& h, SocketWho who)
+{
+  if (who != SENDER)
+    {
+      return;
+    }
+
+  ++m_acks;
+  TcpInfo info = GetSenderSocket ()->GetTcpInfo ();
+  NS_TEST_ASSERT_MSG_EQ (info.m_cWnd, tcb->m_cWnd.Get (), "Wrong cWnd");
+  NS_TEST_ASSERT_MSG_EQ (info.m_ssThresh, tcb->m_ssThresh.Get (), "Wrong ssThresh");
+  NS_TEST_ASSERT_MSG_EQ (info.m_congState, tcb->m_congState.Get (), "Wrong congestion state");
+  NS_TEST_ASSERT_MSG_EQ (info.m_segmentSize, tcb->m_segmentSize, "Wrong segment size");
+  NS_TEST_ASSERT_MSG_EQ (info.m_pacingRate, tcb->m_pacingRate.Get (), "Wrong pacing rate");
+  NS_TEST_ASSERT_MSG_EQ (info.m_bytesDelivered, GetSenderSocket ()->GetTxBuffer ()->GetDelivered (),
+                         "Wrong delivered bytes");
+}
+
+void
+TcpInfoTest::FinalChecks ()
+{
+  TcpInfo info = GetSenderSocket ()->GetTcpInfo ();
+  NS_LOG_INFO ("Sender: " << m_acks << " ACKs, " << info.m_bytesDelivered << " bytes delivered, " <<
+               info.m_retransSegments << " retransmissions, SRTT " << info.m_srtt);
+
+  NS_TEST_ASSERT_MSG_GT (m_acks, 0u, "No ACK processed");
+  uint64_t total = GetPktCount () * GetPktSize ();
+  NS_TEST_ASSERT_MSG_EQ (info.m_bytesDelivered, total, "Not all the data was delivered");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (info.m_srtt, MilliSeconds (20), "SRTT below the propagation delay");
+  NS_TEST_ASSERT_MSG_EQ (info.m_sackedBytes, 0u, "SACKed bytes left after the transfer");
+  NS_TEST_ASSERT_MSG_EQ (info.m_lostBytes, 0u, "Lost bytes left after the transfer");
+  if (m_seqToDrop == 0)
+    {
+      NS_TEST_ASSERT_MSG_EQ (info.m_retransSegments, 0u, "Retransmission without loss");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (info.m_retransSegments, 1u, "Retransmission not counted");
+    }
+  NS_TEST_ASSERT_MSG_EQ (GetReceiverSocket ()->GetTcpInfo ().m_retransSegments, 0u,
+                         "Retransmission counted at the receiver");
+
+  DeliveredSamples samples;
+  if (m_format == TcpInfoHelper::TEXT)
+    {
+      ReadText (samples);
+    }
+  else
+    {
+      ReadBinary (samples);
+    }
+
+  // The sender is on node 0, the receiver on node 1
+  uint32_t senderRows = 0;
+  uint32_t receiverRows = 0;
+  uint64_t lastDelivered = 0;
+  for (DeliveredSamples::const_iterator it = samples.begin (); it != samples.end (); ++it)
+    {
+      if (it->first == 0)
+        {
+          ++senderRows;
+          NS_TEST_ASSERT_MSG_GT_OR_EQ (it->second, lastDelivered, "Delivered bytes decreasing");
+          NS_TEST_ASSERT_MSG_LT_OR_EQ (it->second, total, "More bytes delivered than sent");
+          lastDelivered = it->second;
+        }
+      else
+        {
+          ++receiverRows;
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (senderRows, 10u, "Sender not sampled");
+  NS_TEST_ASSERT_MSG_GT (receiverRows, 10u, "Receiver not sampled");
+  NS_TEST_ASSERT_MSG_GT (lastDelivered, 0u, "No delivery sampled");
+}
+
+void
+TcpInfoTest::ReadText (DeliveredSamples &samples)
+{
+  std::string line;
+  std::getline (m_samples, line);
+  NS_TEST_ASSERT_MSG_EQ (line.substr (0, 6), "#time\t", "Header line missing");
+  while (std::getline (m_samples, line))
+    {
+      std::istringstream columns (line);
+      std::vector<std::string> values;
+      std::string value;
+      while (std::getline (columns, value, '\t'))
+        {
+          values.push_back (value);
+        }
+      NS_TEST_ASSERT_MSG_EQ (values.size (), 25u, "Wrong number of columns in " << line);
+      uint32_t node;
+      uint64_t delivered;
+      std::istringstream (values[1]) >> node;
+      std::istringstream (values[21]) >> delivered;
+      samples.push_back (std::make_pair (node, delivered));
+    }
+}
+
+void
+TcpInfoTest::ReadBinary (DeliveredSamples &samples)
+{
+  std::string data = m_samples.str ();
+  Buffer buffer;
+  buffer.AddAtStart (data.size ());
+  buffer.Begin ().Write (reinterpret_cast<const uint8_t *> (data.data ()), data.size ());
+  Buffer::Iterator it = buffer.Begin ();
+
+  NS_TEST_ASSERT_MSG_GT (it.GetRemainingSize (), 8u, "Header missing");
+  NS_TEST_ASSERT_MSG_EQ (it.ReadLsbtohU32 (), 0x49504354, "Wrong magic number");
+  NS_TEST_ASSERT_MSG_EQ (it.ReadLsbtohU16 (), 1, "Wrong version");
+  uint16_t nColumns = it.ReadLsbtohU16 ();
+  NS_TEST_ASSERT_MSG_EQ (nColumns, 23, "Wrong number of columns");
+  std::vector<uint8_t> sizes;
+  uint32_t rowSize = 0;
+  uint32_t deliveredOffset = 0;
+  for (uint16_t c = 0; c < nColumns; ++c)
+    {
+      sizes.push_back (it.ReadU8 ());
+      std::string name (it.ReadU8 (), 0);
+      it.Read (reinterpret_cast<uint8_t *> (&name[0]), name.size ());
+      if (name == "delivered")
+        {
+          NS_TEST_ASSERT_MSG_EQ (sizes.back (), 8, "Wrong size of the delivered bytes");
+          deliveredOffset = rowSize;
+        }
+      rowSize += sizes.back ();
+    }
+  NS_TEST_ASSERT_MSG_GT (deliveredOffset, 0u, "Column of the delivered bytes missing");
+
+  int64_t lastTime = 0;
+  while (!it.IsEnd ())
+    {
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (it.GetRemainingSize (), 16u, "Truncated block");
+      int64_t time = it.ReadLsbtohU64 ();
+      uint32_t node = it.ReadLsbtohU32 ();
+      uint32_t rows = it.ReadLsbtohU32 ();
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (time, lastTime, "Blocks not in time order");
+      NS_TEST_ASSERT_MSG_EQ (time % MilliSeconds (10).GetNanoSeconds (), 0, "Wrong sample time");
+      NS_TEST_ASSERT_MSG_GT (rows, 0u, "Empty block");
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (it.GetRemainingSize (), rows * rowSize, "Truncated block");
+      lastTime = time;
+
+      // The columns are stored one after the other: skip to the delivered bytes
+      Buffer::Iterator delivered = it;
+      delivered.Next (deliveredOffset * rows);
+      for (uint32_t r = 0; r < rows; ++r)
+        {
+          samples.push_back (std::make_pair (node, delivered.ReadLsbtohU64 ()));
+        }
+      it.Next (rowSize * rows);
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpInfo TestSuite
+ */
+class TcpInfoTestSuite : public TestSuite
+{
+public:
+  TcpInfoTestSuite () : TestSuite ("tcp-info-test", UNIT)
+  {
+    AddTestCase (new TcpInfoTest (0, TcpInfoHelper::TEXT, "Snapshot of a transfer without loss"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpInfoTest (20001, TcpInfoHelper::TEXT, "Snapshot of a transfer with a loss"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpInfoTest (20001, TcpInfoHelper::BINARY, "Binary samples of a transfer with a loss"),
+                 TestCase::QUICK);
+  }
+};
+
+static TcpInfoTestSuite g_tcpInfoTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,249 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/data-rate.h"
+#include "ns3/tcp-congestion-ops.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpPacingTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Congestion control that sets a fixed pacing rate
+ */
+class TcpFixedPacingRate : public TcpNewReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual bool SetsPacingRate (void) const
+  {
+    return true;
+  }
+
+  virtual void CwndEvent (Ptr<TcpSocketState> tcb,
+                          const TcpSocketState::TcpCaEvent_t event)
+  {
+    tcb->m_pacingRate = GetRate ();
+  }
+
+  /**
+   * \brief The rate set by this congestion control
+   * \return the pacing rate
+   */
+  static DataRate GetRate (void)
+  {
+    return DataRate ("2Mbps");
+  }
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TcpFixedPacingRate);
+
+TypeId
+TcpFixedPacingRate::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpFixedPacingRate")
+    .SetParent<TcpNewReno> ()
+    .AddConstructor<TcpFixedPacingRate> ()
+  ;
+  return tid;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the spacing of the data segments sent by a paced socket
+ *
+ * The channel has no rate limit, so that an unpaced sender transmits every
+ * window as a burst of segments at the same instant. With pacing, each data
+ * segment must be followed by a gap of at least its transmission time at
+ * the pacing rate, and no two segments leave at the same time once the
+ * first RTT sample is taken. The pacing rate is checked against cWnd/SRTT
+ * and the configured ratios, or against the rate set by the congestion
+ * control.
+ */
+class TcpPacingTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param pacing whether the sender paces
+   * \param congControl congestion control of the sender
+   * \param desc description
+   */
+  TcpPacingTest (bool pacing, TypeId congControl, const std::string &desc);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks ();
+
+  /**
+   * \brief Pacing rate trace of the sender socket
+   * \param oldValue old pacing rate
+   * \param newValue new pacing rate
+   */
+  void PacingRateTrace (DataRate oldValue, DataRate newValue);
+
+private:
+  bool m_pacing;            //!< Whether the sender paces
+  bool m_fixedRate;         //!< Whether the congestion control sets the rate
+  Time m_lastTx;            //!< Time of the last data segment
+  Time m_gap;               //!< Minimum gap after the last data segment
+  uint32_t m_burst;         //!< Segments sent at m_lastTx
+  uint32_t m_maxBurst;      //!< Largest burst of segments
+  uint32_t m_pacedSegments; //!< Segments sent while pacing
+  uint32_t m_rateChanges;   //!< Changes of the pacing rate seen on the socket
+};
+
+TcpPacingTest::TcpPacingTest (bool pacing, TypeId congControl, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_pacing (pacing),
+    m_fixedRate (congControl == TcpFixedPacingRate::GetTypeId ()),
+    m_lastTx (Seconds (-1)),
+    m_gap (Seconds (0)),
+    m_burst (0),
+    m_maxBurst (0),
+    m_pacedSegments (0),
+    m_rateChanges (0)
+{
+  m_congControlTypeId = congControl;
+}
+
+void
+TcpPacingTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetPropagationDelay (MilliSeconds (50));
+  SetTransmitStart (Seconds (1));
+  SetAppPktCount (200);
+  SetAppPktInterval (MicroSeconds (1));
+}
+
+void
+TcpPacingTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  GetTcb (SENDER)->m_pacing = m_pacing;
+  GetSenderSocket ()->TraceConnectWithoutContext ("PacingRate",
+                                                  MakeCallback (&TcpPacingTest::PacingRateTrace, this));
+}
+
+void
+TcpPacingTest::PacingRateTrace (DataRate oldValue, DataRate newValue)
+{
+  m_rateChanges++;
+}
+
+void
+TcpPacingTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != SENDER || p->GetSize () == 0)
+    {
+      return;
+    }
+
+  Time now = Simulator::Now ();
+  Time elapsed = now - m_lastTx;
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (elapsed, m_gap,
+                               "Data segment sent before the end of the pacing interval");
+
+  m_burst = elapsed.IsZero () ? m_burst + 1 : 1;
+  m_maxBurst = std::max (m_maxBurst, m_burst);
+  m_lastTx = now;
+  m_gap = Seconds (0);
+
+  Ptr<TcpSocketState> tcb = GetTcb (SENDER);
+  if (!m_pacing || GetRttEstimator (SENDER)->GetNSamples () == 0)
+    {
+      return;
+    }
+
+  DataRate rate = tcb->m_pacingRate.Get ();
+  if (m_fixedRate)
+    {
+      NS_TEST_ASSERT_MSG_EQ (rate, TcpFixedPacingRate::GetRate (),
+                             "Pacing rate not set by the congestion control");
+    }
+  else
+    {
+      Time srtt = GetRttEstimator (SENDER)->GetEstimate ();
+      uint16_t ratio = tcb->m_cWnd < tcb->m_ssThresh / 2 ? tcb->m_pacingSsRatio
+                                                         : tcb->m_pacingCaRatio;
+      double expected = tcb->m_cWnd * 8.0 * ratio / 100.0 / srtt.GetSeconds ();
+      NS_TEST_ASSERT_MSG_EQ_TOL (static_cast<double> (rate.GetBitRate ()), expected, 1.0,
+                                 "Pacing rate does not follow cWnd/SRTT");
+    }
+
+  m_gap = rate.CalculateBytesTxTime (p->GetSize ());
+  m_pacedSegments++;
+}
+
+void
+TcpPacingTest::FinalChecks ()
+{
+  if (m_pacing)
+    {
+      NS_TEST_ASSERT_MSG_GT (m_pacedSegments, 100, "Too few segments were paced");
+      NS_TEST_ASSERT_MSG_EQ (m_maxBurst, 1, "Segments were sent in a burst");
+      NS_TEST_ASSERT_MSG_GT (m_rateChanges, 0, "Pacing rate not traced");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_GT (m_maxBurst, 1, "Unpaced sender should send bursts");
+      NS_TEST_ASSERT_MSG_EQ (m_pacedSegments, 0, "Segments paced without pacing");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP pacing TestSuite
+ */
+class TcpPacingTestSuite : public TestSuite
+{
+public:
+  TcpPacingTestSuite () : TestSuite ("tcp-pacing-test", UNIT)
+  {
+    AddTestCase (new TcpPacingTest (false, TcpNewReno::GetTypeId (),
+                                    "Bursts without pacing"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpPacingTest (true, TcpNewReno::GetTypeId (),
+                                    "Segments paced at the cWnd over SRTT rate"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpPacingTest (true, TcpFixedPacingRate::GetTypeId (),
+                                    "Segments paced at the congestion control rate"),
+                 TestCase::QUICK);
+  }
+};
+
+static TcpPacingTestSuite g_tcpPacingTestSuite; //!< Static variable for test initialization
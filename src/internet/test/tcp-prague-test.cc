@@ -0,0 +1,325 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/tcp-prague.h"
+#include "ns3/double.h"
+#include "ns3/nstime.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpPragueTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Validates that Prague sets ECT(1) on all its packets
+ */
+class TcpPragueCodePointsTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   *
+   * \param desc Description about the test
+   */
+  TcpPragueCodePointsTest (const std::string &desc);
+
+protected:
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual Ptr<TcpSocketMsgBase> CreateReceiverSocket (Ptr<Node> node);
+  void ConfigureProperties ();
+
+private:
+  uint32_t m_senderSent;   //!< Number of packets sent by the sender
+  uint32_t m_receiverSent; //!< Number of packets sent by the receiver
+};
+
+TcpPragueCodePointsTest::TcpPragueCodePointsTest (const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_senderSent (0),
+    m_receiverSent (0)
+{
+}
+
+void
+TcpPragueCodePointsTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  SocketIpTosTag ipTosTag;
+  p->PeekPacketTag (ipTosTag);
+  if (who == SENDER)
+    {
+      m_senderSent++;
+      if (m_senderSent == 1)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((ipTosTag.GetTos ()), 0x1, "IP TOS should have ECT1 for SYN packet for Prague traffic");
+        }
+      if (m_senderSent == 3)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((ipTosTag.GetTos ()), 0x1, "IP TOS should have ECT1 for data packets for Prague traffic");
+        }
+    }
+  else
+    {
+      m_receiverSent++;
+      if (m_receiverSent == 1)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((ipTosTag.GetTos ()), 0x1, "IP TOS should have ECT1 for SYN+ACK packet for Prague traffic");
+        }
+      if (m_receiverSent == 2)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((ipTosTag.GetTos ()), 0x1, "IP TOS should have ECT1 for pure ACK packets for Prague traffic");
+        }
+    }
+}
+
+void
+TcpPragueCodePointsTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetEcn (SENDER);
+  SetEcn (RECEIVER);
+}
+
+Ptr<TcpSocketMsgBase>
+TcpPragueCodePointsTest::CreateSenderSocket (Ptr<Node> node)
+{
+  return TcpGeneralTest::CreateSocket (node, TcpSocketMsgBase::GetTypeId (), TcpPrague::GetTypeId ());
+}
+
+Ptr<TcpSocketMsgBase>
+TcpPragueCodePointsTest::CreateReceiverSocket (Ptr<Node> node)
+{
+  return TcpGeneralTest::CreateSocket (node, TcpSocketMsgBase::GetTypeId (), TcpPrague::GetTypeId ());
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Test that the window reduction of Prague is spread over the ACKs
+ * of the following round
+ */
+class TcpPragueReductionTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   *
+   * \param cWnd congestion window, in segments
+   * \param segmentSize segment size
+   * \param alpha DCTCP alpha
+   * \param name Name of the test
+   */
+  TcpPragueReductionTest (uint32_t cWnd, uint32_t segmentSize, double alpha, const std::string &name);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_cWnd;        //!< cWnd, in segments
+  uint32_t m_segmentSize; //!< segment size
+  double m_alpha;         //!< alpha
+};
+
+TcpPragueReductionTest::TcpPragueReductionTest (uint32_t cWnd, uint32_t segmentSize, double alpha, const std::string &name)
+  : TestCase (name),
+    m_cWnd (cWnd),
+    m_segmentSize (segmentSize),
+    m_alpha (alpha)
+{
+}
+
+void
+TcpPragueReductionTest::DoRun (void)
+{
+  Ptr<TcpSocketState> state = CreateObject <TcpSocketState> ();
+  state->m_cWnd = m_cWnd * m_segmentSize;
+  state->m_ssThresh = m_cWnd * m_segmentSize;
+  state->m_segmentSize = m_segmentSize;
+  state->m_nextTxSequence = SequenceNumber32 (1 + m_cWnd * m_segmentSize);
+  state->m_lastAckedSeq = SequenceNumber32 (1);
+  state->m_ecnState = TcpSocketState::ECN_IDLE;
+
+  Ptr<TcpPrague> cong = CreateObject <TcpPrague> ();
+  cong->SetAttribute ("DctcpAlphaOnInit", DoubleValue (m_alpha));
+
+  uint32_t prior = state->m_cWnd;
+  uint32_t target = static_cast<uint32_t> ((1 - m_alpha / 2.0) * prior);
+  cong->ReduceCwnd (state);
+  NS_TEST_ASSERT_MSG_EQ (state->m_cWnd.Get (), prior, "The reduction should not be applied at once");
+
+  // half of the window is acknowledged: half of the reduction is applied
+  uint32_t half = m_cWnd / 2;
+  state->m_lastAckedSeq = SequenceNumber32 (1 + half * m_segmentSize);
+  cong->PktsAcked (state, half, MilliSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (state->m_cWnd.Get (), prior - (prior - target) * half * m_segmentSize / prior,
+                         "Half of the reduction should be applied");
+
+  // no growth while the window is being reduced
+  uint32_t cWnd = state->m_cWnd;
+  cong->IncreaseWindow (state, half);
+  NS_TEST_ASSERT_MSG_EQ (state->m_cWnd.Get (), cWnd, "cWnd should not grow during the reduction");
+
+  state->m_lastAckedSeq = SequenceNumber32 (1 + m_cWnd * m_segmentSize);
+  cong->PktsAcked (state, m_cWnd - half, MilliSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (state->m_cWnd.Get (), target, "The whole reduction should be applied");
+  NS_TEST_ASSERT_MSG_EQ (state->m_ssThresh.Get (), target, "ssThresh should be set to the reduced window");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Test that the additive increase of Prague is scaled for RTTs
+ * shorter than the RTT target
+ */
+class TcpPragueRttIndependenceTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   *
+   * \param rtt RTT of the flow
+   * \param increase expected increase after a round, in bytes
+   * \param name Name of the test
+   */
+  TcpPragueRttIndependenceTest (Time rtt, uint32_t increase, const std::string &name);
+
+private:
+  virtual void DoRun (void);
+
+  Time m_rtt;          //!< RTT of the flow
+  uint32_t m_increase; //!< expected increase
+};
+
+TcpPragueRttIndependenceTest::TcpPragueRttIndependenceTest (Time rtt, uint32_t increase, const std::string &name)
+  : TestCase (name),
+    m_rtt (rtt),
+    m_increase (increase)
+{
+}
+
+void
+TcpPragueRttIndependenceTest::DoRun (void)
+{
+  Ptr<TcpSocketState> state = CreateObject <TcpSocketState> ();
+  state->m_cWnd = 10 * 1000;
+  state->m_ssThresh = 2 * 1000;
+  state->m_segmentSize = 1000;
+  state->m_ecnState = TcpSocketState::ECN_IDLE;
+
+  Ptr<TcpPrague> cong = CreateObject <TcpPrague> ();
+  cong->SetAttribute ("RttTarget", TimeValue (MilliSeconds (25)));
+  cong->PktsAcked (state, 1, m_rtt);
+  cong->IncreaseWindow (state, 10);
+  NS_TEST_ASSERT_MSG_EQ (state->m_cWnd.Get (), 10 * 1000 + m_increase, "Wrong additive increase");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Test that Prague falls back to a Reno-friendly response when the
+ * queuing delay reveals a classic ECN AQM
+ */
+class TcpPragueClassicEcnTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   *
+   * \param queueDelay queuing delay experienced by the flow
+   * \param classic whether a classic ECN AQM should be detected
+   * \param name Name of the test
+   */
+  TcpPragueClassicEcnTest (Time queueDelay, bool classic, const std::string &name);
+
+private:
+  virtual void DoRun (void);
+
+  Time m_queueDelay; //!< queuing delay
+  bool m_classic;    //!< expected detection
+};
+
+TcpPragueClassicEcnTest::TcpPragueClassicEcnTest (Time queueDelay, bool classic, const std::string &name)
+  : TestCase (name),
+    m_queueDelay (queueDelay),
+    m_classic (classic)
+{
+}
+
+void
+TcpPragueClassicEcnTest::DoRun (void)
+{
+  Ptr<TcpSocketState> state = CreateObject <TcpSocketState> ();
+  state->m_cWnd = 20 * 1000;
+  state->m_ssThresh = 2 * 1000;
+  state->m_segmentSize = 1000;
+  state->m_ecnState = TcpSocketState::ECN_IDLE;
+  state->m_lastAckedSeq = SequenceNumber32 (1);
+  state->m_nextTxSequence = SequenceNumber32 (1);
+
+  Ptr<TcpPrague> cong = CreateObject <TcpPrague> ();
+  cong->SetAttribute ("DctcpAlphaOnInit", DoubleValue (0.2));
+  cong->PktsAcked (state, 1, MilliSeconds (10));
+  for (uint32_t round = 0; round < 50; round++)
+    {
+      // one ACK per round
+      state->m_lastAckedSeq = state->m_nextTxSequence;
+      state->m_nextTxSequence = state->m_nextTxSequence + 1000;
+      cong->PktsAcked (state, 1, MilliSeconds (10) + m_queueDelay);
+    }
+  NS_TEST_ASSERT_MSG_EQ (cong->IsClassicEcn (), m_classic, "Wrong classic ECN AQM detection");
+
+  cong->ReduceCwnd (state);
+  if (m_classic)
+    {
+      NS_TEST_ASSERT_MSG_EQ (state->m_cWnd.Get (), 10 * 1000, "cWnd should be halved at once");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (state->m_cWnd.Get (), 20 * 1000, "The reduction should be spread over a round");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP Prague TestSuite
+ */
+class TcpPragueTestSuite : public TestSuite
+{
+public:
+  TcpPragueTestSuite () : TestSuite ("tcp-prague-test", UNIT)
+  {
+    AddTestCase (new TcpPragueCodePointsTest ("ECT Test : Check if ECT1 is set on Syn, Syn+Ack, Ack and Data packets for Prague packets"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpPragueReductionTest (10, 1000, 1.0, "Prague reduction spread over a round, alpha=1"), TestCase::QUICK);
+    AddTestCase (new TcpPragueReductionTest (20, 1446, 0.3, "Prague reduction spread over a round, alpha=0.3"), TestCase::QUICK);
+    AddTestCase (new TcpPragueRttIndependenceTest (MilliSeconds (50), 1000, "Unscaled increase above the RTT target"), TestCase::QUICK);
+    AddTestCase (new TcpPragueRttIndependenceTest (MicroSeconds (12500), 250, "Increase scaled by the squared RTT ratio below the RTT target"), TestCase::QUICK);
+    AddTestCase (new TcpPragueClassicEcnTest (MilliSeconds (20), true, "Classic ECN AQM detected"), TestCase::QUICK);
+    AddTestCase (new TcpPragueClassicEcnTest (MilliSeconds (1), false, "L4S AQM detected"), TestCase::QUICK);
+  }
+};
+
+static TcpPragueTestSuite g_tcpPragueTest; //!< static var for test initialization
@@ -0,0 +1,486 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "tcp-error-model.h"
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/queue.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/tcp-dctcp.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpRackTlpTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Completion time of a short flow with losses at its end
+ *
+ * A flow of 20 segments goes through a DualQ Coupled PI Square queue disc,
+ * in the Classic or in the L4S queue depending on the congestion control.
+ * Some segments at the end of the flow are dropped; with so few segments
+ * after them, there are not enough duplicate ACKs for a fast retransmit, and
+ * without RACK and TLP the sender waits for the RTO. The test checks
+ * whether an RTO happens, and that the flow completes before the minimum
+ * RTO when it does not.
+ */
+class TcpRackTlpTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param rack whether the sender uses RACK
+   * \param tlp whether the sender sends Tail Loss Probes
+   * \param congControl congestion control of the sender
+   * \param toDrop sequence numbers of the segments to drop
+   * \param expectRto whether an RTO is expected
+   * \param desc description
+   */
+  TcpRackTlpTest (bool rack, bool tlp, TypeId congControl,
+                  const std::vector<uint32_t> &toDrop, bool expectRto,
+                  const std::string &desc);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual Ptr<TcpSocketMsgBase> CreateReceiverSocket (Ptr<Node> node);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void BeforeRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  bool m_rack;                    //!< Whether the sender uses RACK
+  bool m_tlp;                     //!< Whether the sender sends Tail Loss Probes
+  std::vector<uint32_t> m_toDrop; //!< Sequence numbers of the segments to drop
+  bool m_expectRto;               //!< Whether an RTO is expected
+  uint32_t m_rtoCount;            //!< RTOs of the sender
+  Time m_completion;              //!< Flow completion time
+};
+
+TcpRackTlpTest::TcpRackTlpTest (bool rack, bool tlp, TypeId congControl,
+                                const std::vector<uint32_t> &toDrop, bool expectRto,
+                                const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_rack (rack),
+    m_tlp (tlp),
+    m_toDrop (toDrop),
+    m_expectRto (expectRto),
+    m_rtoCount (0),
+    m_completion (Seconds (0))
+{
+  m_congControlTypeId = congControl;
+}
+
+void
+TcpRackTlpTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetPropagationDelay (MilliSeconds (10));
+  SetTransmitStart (Seconds (1));
+  SetAppPktCount (20);
+  SetAppPktInterval (MicroSeconds (1));
+}
+
+void
+TcpRackTlpTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  SetEcn (SENDER);
+  SetEcn (RECEIVER);
+  GetSenderSocket ()->SetAttribute ("Rack", BooleanValue (m_rack));
+  GetSenderSocket ()->SetAttribute ("Tlp", BooleanValue (m_tlp));
+
+  // The bottleneck is the sender device, with the DualQ queue disc
+  Ptr<Node> node = GetSenderSocket ()->GetNode ();
+  for (uint32_t i = 0; i < node->GetNDevices (); ++i)
+    {
+      Ptr<SimpleNetDevice> device = DynamicCast<SimpleNetDevice> (node->GetDevice (i));
+      if (device == 0)
+        {
+          continue;
+        }
+      device->SetAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+      device->GetQueue ()->SetMaxPackets (1);
+
+      TrafficControlHelper tch;
+      tch.Uninstall (device);
+      tch.SetRootQueueDisc ("ns3::DualQCoupledPiSquareQueueDisc",
+                            "QueueLimit", UintegerValue (100));
+      tch.Install (device);
+    }
+
+  // The queue disc updates its probability forever
+  Simulator::Stop (Seconds (10));
+}
+
+Ptr<ErrorModel>
+TcpRackTlpTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpSeqErrorModel> errorModel = CreateObject<TcpSeqErrorModel> ();
+  for (std::vector<uint32_t>::const_iterator it = m_toDrop.begin (); it != m_toDrop.end (); ++it)
+    {
+      errorModel->AddSeqToKill (SequenceNumber32 (*it));
+    }
+  return errorModel;
+}
+
+Ptr<TcpSocketMsgBase>
+TcpRackTlpTest::CreateReceiverSocket (Ptr<Node> node)
+{
+  return CreateSocket (node, TcpSocketMsgBase::GetTypeId (), m_congControlTypeId);
+}
+
+void
+TcpRackTlpTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  uint32_t flowBytes = GetPktCount () * GetPktSize ();
+  if (who == SENDER && m_completion.IsZero ()
+      && h.GetAckNumber () >= SequenceNumber32 (1 + flowBytes))
+    {
+      m_completion = Simulator::Now () - GetStartTime ();
+      NS_LOG_INFO ("Flow completed in " << m_completion.GetSeconds () << " s");
+    }
+}
+
+void
+TcpRackTlpTest::BeforeRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  if (who == SENDER)
+    {
+      m_rtoCount++;
+    }
+}
+
+void
+TcpRackTlpTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_completion.IsZero (), false, "The flow did not complete");
+
+  if (m_expectRto)
+    {
+      NS_TEST_ASSERT_MSG_GT (m_rtoCount, 0, "The losses should be recovered by an RTO");
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (m_completion, GetMinRto (SENDER),
+                                   "The flow completed before the RTO");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rtoCount, 0, "The losses should be recovered without an RTO");
+      NS_TEST_ASSERT_MSG_LT (m_completion, GetMinRto (SENDER),
+                             "The flow did not complete before the RTO");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief The Tail Loss Probe retransmits the last segment as it was sent
+ *
+ * The application writes 1700 bytes at once, sent as three full segments
+ * of 500 bytes and a last one of 200 bytes; the last two are dropped. With
+ * no new data to send, the probe must retransmit the last segment from its
+ * first byte: one segment size before the highest sequence sent would be
+ * in the middle of the third segment.
+ */
+class TcpTlpProbeTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param desc description
+   */
+  TcpTlpProbeTest (const std::string &desc);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void BeforeRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  SequenceNumber32 m_highSent;   //!< Highest sequence number sent, plus one
+  SequenceNumber32 m_probeSeq;   //!< Sequence number of the first retransmission
+  uint32_t m_probeSize;          //!< Size of the first retransmission
+  uint32_t m_rtoCount;           //!< RTOs of the sender
+};
+
+TcpTlpProbeTest::TcpTlpProbeTest (const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_highSent (0),
+    m_probeSeq (0),
+    m_probeSize (0),
+    m_rtoCount (0)
+{
+}
+
+void
+TcpTlpProbeTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetPropagationDelay (MilliSeconds (10));
+  SetTransmitStart (Seconds (1));
+  SetAppPktSize (1700);
+  SetAppPktCount (1);
+}
+
+void
+TcpTlpProbeTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetSegmentSize (SENDER, 500);
+  SetSegmentSize (RECEIVER, 500);
+  SetInitialCwnd (SENDER, 10);
+  GetSenderSocket ()->SetAttribute ("Rack", BooleanValue (true));
+  GetSenderSocket ()->SetAttribute ("Tlp", BooleanValue (true));
+}
+
+Ptr<ErrorModel>
+TcpTlpProbeTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpSeqErrorModel> errorModel = CreateObject<TcpSeqErrorModel> ();
+  errorModel->AddSeqToKill (SequenceNumber32 (1001));
+  errorModel->AddSeqToKill (SequenceNumber32 (1501));
+  return errorModel;
+}
+
+void
+TcpTlpProbeTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != SENDER || p->GetSize () == 0)
+    {
+      return;
+    }
+
+  SequenceNumber32 end = h.GetSequenceNumber () + p->GetSize ();
+  if (end <= m_highSent && m_probeSize == 0)
+    {
+      NS_LOG_INFO ("Retransmission [" << h.GetSequenceNumber () << ";" << end << ")");
+      m_probeSeq = h.GetSequenceNumber ();
+      m_probeSize = p->GetSize ();
+    }
+  m_highSent = std::max (m_highSent, end);
+}
+
+void
+TcpTlpProbeTest::BeforeRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  if (who == SENDER)
+    {
+      m_rtoCount++;
+    }
+}
+
+void
+TcpTlpProbeTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_probeSeq, SequenceNumber32 (1501),
+                         "The probe does not start at the last segment");
+  NS_TEST_ASSERT_MSG_EQ (m_probeSize, 200, "The probe is not the last segment");
+  NS_TEST_ASSERT_MSG_EQ (m_rtoCount, 0, "The losses should be recovered without an RTO");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A loss in the window reduced for an ECN Echo does not reduce it again
+ *
+ * A segment is CE-marked and, shortly after it, another one is dropped.
+ * The sender reduces its window in response to the ECN Echo, and the loss
+ * is detected by RACK before the segment carrying the CWR flag is
+ * acknowledged. The sender enters the recovery, but, as RFC 3168 asks,
+ * the slow start threshold is reduced only once until the end of the
+ * recovery. Later ECN Echoes may reduce it again.
+ */
+class TcpRackCwrLossTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param desc description
+   */
+  TcpRackCwrLossTest (const std::string &desc);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void CongStateTrace (const TcpSocketState::TcpCongState_t oldValue,
+                               const TcpSocketState::TcpCongState_t newValue);
+  virtual void SsThreshTrace (uint32_t oldValue, uint32_t newValue);
+  virtual void BeforeRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  uint32_t m_cwrCount;        //!< Times the sender entered CA_CWR
+  uint32_t m_recoveryCount;   //!< Times the sender entered CA_RECOVERY
+  uint32_t m_reductionCount;  //!< Reductions of the slow start threshold, until the end of the recovery
+  bool m_recovered;           //!< Whether the sender exited CA_RECOVERY
+  uint32_t m_rtoCount;        //!< RTOs of the sender
+};
+
+TcpRackCwrLossTest::TcpRackCwrLossTest (const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_cwrCount (0),
+    m_recoveryCount (0),
+    m_reductionCount (0),
+    m_recovered (false),
+    m_rtoCount (0)
+{
+}
+
+void
+TcpRackCwrLossTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetPropagationDelay (MilliSeconds (10));
+  SetTransmitStart (Seconds (1));
+  SetAppPktCount (40);
+  SetAppPktInterval (MicroSeconds (1));
+}
+
+void
+TcpRackCwrLossTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  SetEcn (SENDER);
+  SetEcn (RECEIVER);
+  GetSenderSocket ()->SetAttribute ("Rack", BooleanValue (true));
+}
+
+Ptr<ErrorModel>
+TcpRackCwrLossTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpCeMarkingErrorModel> errorModel = CreateObject<TcpCeMarkingErrorModel> ();
+  errorModel->AddSeqToMark (SequenceNumber32 (1001));
+  errorModel->AddSeqToKill (SequenceNumber32 (2501));
+  return errorModel;
+}
+
+void
+TcpRackCwrLossTest::CongStateTrace (const TcpSocketState::TcpCongState_t oldValue,
+                                    const TcpSocketState::TcpCongState_t newValue)
+{
+  if (newValue == TcpSocketState::CA_CWR)
+    {
+      m_cwrCount++;
+    }
+  else if (newValue == TcpSocketState::CA_RECOVERY)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_cwrCount, 1, "The loss should be detected after the ECN Echo");
+      m_recoveryCount++;
+    }
+  else if (oldValue == TcpSocketState::CA_RECOVERY)
+    {
+      m_recovered = true;
+    }
+}
+
+void
+TcpRackCwrLossTest::SsThreshTrace (uint32_t oldValue, uint32_t newValue)
+{
+  if (newValue < oldValue && !m_recovered)
+    {
+      NS_LOG_INFO ("ssThresh " << oldValue << " -> " << newValue);
+      m_reductionCount++;
+    }
+}
+
+void
+TcpRackCwrLossTest::BeforeRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  if (who == SENDER)
+    {
+      m_rtoCount++;
+    }
+}
+
+void
+TcpRackCwrLossTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_GT (m_cwrCount, 0, "The sender should respond to the ECN Echo");
+  NS_TEST_ASSERT_MSG_EQ (m_recoveryCount, 1, "The sender should recover the loss");
+  NS_TEST_ASSERT_MSG_EQ (m_recovered, true, "The recovery should end");
+  NS_TEST_ASSERT_MSG_EQ (m_rtoCount, 0, "The loss should be recovered without an RTO");
+  NS_TEST_ASSERT_MSG_EQ (m_reductionCount, 1, "The window should be reduced only once");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP RACK and TLP TestSuite
+ */
+class TcpRackTlpTestSuite : public TestSuite
+{
+public:
+  TcpRackTlpTestSuite () : TestSuite ("tcp-rack-tlp-test", UNIT)
+  {
+    // The last two segments of the flow
+    std::vector<uint32_t> tail;
+    tail.push_back (9001);
+    tail.push_back (9501);
+
+    // A segment with only two segments after it
+    std::vector<uint32_t> nearTail;
+    nearTail.push_back (8501);
+
+    TypeId classic = TcpNewReno::GetTypeId ();
+    TypeId l4s = TcpDctcp::GetTypeId ();
+
+    AddTestCase (new TcpRackTlpTest (false, false, classic, tail, true,
+                                     "Classic tail loss, RTO"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpRackTlpTest (true, true, classic, tail, false,
+                                     "Classic tail loss, TLP"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpRackTlpTest (false, false, l4s, tail, true,
+                                     "L4S tail loss, RTO"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpRackTlpTest (true, true, l4s, tail, false,
+                                     "L4S tail loss, TLP"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpRackTlpTest (false, false, classic, nearTail, true,
+                                     "Classic loss with two SACKs, RTO"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpRackTlpTest (true, false, classic, nearTail, false,
+                                     "Classic loss with two SACKs, RACK"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpRackTlpTest (true, false, l4s, nearTail, false,
+                                     "L4S loss with two SACKs, RACK"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpTlpProbeTest ("TLP of a last segment shorter than the segment size"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpRackCwrLossTest ("Loss while the window is reduced for an ECN Echo"),
+                 TestCase::QUICK);
+  }
+};
+
+static TcpRackTlpTestSuite g_tcpRackTlpTestSuite; //!< Static variable for test initialization
@@ -20,6 +20,10 @@
 #include "ns3/log.h"
 
 #include "ns3/tcp-rx-buffer.h"
+#include "ns3/random-variable-stream.h"
+
+#include <vector>
+#include <algorithm>
 
 using namespace ns3;
 
@@ -44,6 +48,11 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+
+  /**
+   * \brief Test a segment that covers several holes and blocks.
+   */
+  void TestFillHoles ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +64,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestFillHoles ();
 }
 
 void
@@ -338,12 +348,313 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestFillHoles ()
+{
+  TcpRxBuffer rxBuf;
+  TcpOptionSack::SackList sackList;
+  TcpOptionSack::SackList::iterator it;
+  TcpHeader h;
+  uint8_t data[1000];
+
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      data[i] = static_cast<uint8_t> (i);
+    }
+
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf.SetMaxBufferSize (100000);
+
+  // Blocks [201;301), [401;501) and [601;701)
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      uint32_t offset = 200 + 200 * i;
+      h.SetSequenceNumber (SequenceNumber32 (1 + offset));
+      rxBuf.Add (Create<Packet> (data + offset, 100), h);
+    }
+
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 3,
+                         "SACK list should contain three elements");
+
+  // [151;651) fills two holes, and merges the three blocks in one
+  h.SetSequenceNumber (SequenceNumber32 (151));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (data + 150, 500), h), true,
+                         "The segment fills holes, and should be buffered");
+
+  uint32_t size = rxBuf.Size ();
+  NS_TEST_ASSERT_MSG_EQ (size, 550u, "Overlapping bytes stored more than once");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 0u, "No in-sequence data expected");
+
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 1,
+                         "SACK list should contain one element");
+  it = sackList.begin ();
+  NS_TEST_ASSERT_MSG_EQ (it->first, SequenceNumber32 (151),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (it->second, SequenceNumber32 (701),
+                         "SACK block different than expected");
+
+  // Data already in the buffer is discarded
+  h.SetSequenceNumber (SequenceNumber32 (301));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (data + 300, 100), h), false,
+                         "Duplicated data should not be buffered");
+
+  // The in-sequence segment makes the whole block available
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (Create<Packet> (data, 200), h);
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (701),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0,
+                         "SACK list should contain no element");
+
+  // Extract in two steps, and check the bytes
+  uint8_t out[1000];
+  Ptr<Packet> p = rxBuf.Extract (250);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 250, "Extracted size differs from expected");
+  p->CopyData (out, 250);
+  p = rxBuf.Extract (1000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 450, "Extracted size differs from expected");
+  p->CopyData (out + 250, 450);
+
+  for (uint32_t i = 0; i < 700; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (out[i]), static_cast<uint32_t> (data[i]),
+                             "Extracted data differs from the received one");
+    }
+
+  size = rxBuf.Size ();
+  NS_TEST_ASSERT_MSG_EQ (size, 0u, "The buffer should be empty");
+
+  // A new hole after the extracted data
+  h.SetSequenceNumber (SequenceNumber32 (801));
+  rxBuf.Add (Create<Packet> (data + 800, 100), h);
+  h.SetSequenceNumber (SequenceNumber32 (701));
+  rxBuf.Add (Create<Packet> (data + 700, 100), h);
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (901),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 200u, "In-sequence data not available");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Randomized differential test of the TcpRxBuffer reassembly
+ *
+ * Random segments, overlapping, duplicated, out of order or beyond the
+ * window, and random extractions are applied both to a TcpRxBuffer and to
+ * a reference that marks every received byte of the stream. After every
+ * step, the next sequence number, the size, the available bytes and the
+ * result of Add must be the same, the extracted bytes must be the ones
+ * sent, and the SACK list must respect RFC 2018: at most four blocks,
+ * each one a whole contiguous block of data above the next sequence
+ * number, the first one containing the segment just received.
+ */
+class TcpRxBufferReassemblyTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param stream the random stream to draw the steps from
+   */
+  TcpRxBufferReassemblyTestCase (int64_t stream);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Add a segment to the reference
+   * \param head offset of the first byte of the segment
+   * \param tail offset of the byte after the segment
+   * \returns true if new bytes are stored
+   */
+  bool RefAdd (uint32_t head, uint32_t tail);
+
+  /**
+   * \brief Check the SACK list of the buffer against the reference
+   * \param rxBuf the buffer under test
+   * \param step the current step, to report failures
+   */
+  void CheckSackList (Ptr<const TcpRxBuffer> rxBuf, uint32_t step);
+
+  static const uint32_t m_streamSize = 1000000; //!< Bytes of the stream
+  static const uint32_t m_maxBuffer = 20000;     //!< Buffer size
+  int64_t m_stream;                              //!< Random stream
+  std::vector<bool> m_received;                  //!< Reference received bytes
+  uint32_t m_nextRx;                             //!< Reference next byte expected
+  uint32_t m_extracted;                          //!< Reference bytes extracted
+  uint32_t m_size;                               //!< Reference bytes buffered
+};
+
+TcpRxBufferReassemblyTestCase::TcpRxBufferReassemblyTestCase (int64_t stream)
+  : TestCase ("TcpRxBuffer reassembly against a reference"),
+    m_stream (stream),
+    m_nextRx (0),
+    m_extracted (0),
+    m_size (0)
+{
+}
+
+bool
+TcpRxBufferReassemblyTestCase::RefAdd (uint32_t head, uint32_t tail)
+{
+  head = std::max (head, m_nextRx);
+  if (m_size > 0)
+    {
+      // The window starts at the first byte buffered
+      uint32_t first = m_extracted;
+      while (!m_received[first])
+        {
+          ++first;
+        }
+      tail = std::min (tail, first + m_maxBuffer);
+      head = std::min (head, tail);
+    }
+
+  bool stored = false;
+  for (uint32_t i = head; i < tail; ++i)
+    {
+      if (!m_received[i])
+        {
+          m_received[i] = true;
+          ++m_size;
+          stored = true;
+        }
+    }
+  while (m_nextRx < m_streamSize && m_received[m_nextRx])
+    {
+      ++m_nextRx;
+    }
+  return stored;
+}
+
+void
+TcpRxBufferReassemblyTestCase::CheckSackList (Ptr<const TcpRxBuffer> rxBuf, uint32_t step)
+{
+  TcpOptionSack::SackList list = rxBuf->GetSackList ();
+  TcpOptionSack::SackList::const_iterator it;
+  TcpOptionSack::SackList::const_iterator other;
+
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (list.size (), 4, "Too many SACK blocks at step " << step);
+  for (it = list.begin (); it != list.end (); ++it)
+    {
+      uint32_t head = it->first.GetValue () - 1;
+      uint32_t tail = it->second.GetValue () - 1;
+      NS_TEST_ASSERT_MSG_GT (head, m_nextRx, "SACK block not above the next sequence number at step " << step);
+      NS_TEST_ASSERT_MSG_LT (head, tail, "Empty SACK block at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (m_received[head - 1], false, "SACK block not whole at step " << step);
+      NS_TEST_ASSERT_MSG_EQ ((tail == m_streamSize || !m_received[tail]), true,
+                             "SACK block not whole at step " << step);
+      for (uint32_t i = head; i < tail; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_received[i], true, "SACK block with a hole at step " << step);
+        }
+      for (other = list.begin (); other != it; ++other)
+        {
+          NS_TEST_ASSERT_MSG_NE (other->first, it->first, "Repeated SACK block at step " << step);
+        }
+    }
+}
+
+void
+TcpRxBufferReassemblyTestCase::DoRun (void)
+{
+  const uint32_t steps = 3000;
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (m_stream);
+  Ptr<TcpRxBuffer> rxBuf = CreateObject<TcpRxBuffer> ();
+  std::vector<uint8_t> data (m_streamSize);
+  TcpHeader h;
+
+  for (uint32_t i = 0; i < m_streamSize; ++i)
+    {
+      data[i] = static_cast<uint8_t> (i % 251);
+    }
+  m_received.assign (m_streamSize, false);
+  m_nextRx = m_extracted = m_size = 0;
+
+  rxBuf->SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf->SetMaxBufferSize (m_maxBuffer);
+
+  for (uint32_t step = 0; step < steps && !IsStatusFailure (); ++step)
+    {
+      if (rng->GetInteger (0, 3) > 0)
+        {
+          // A segment at the next sequence number, overlapping the data
+          // already received, or in the window, or beyond it
+          uint32_t head;
+          uint32_t choice = rng->GetInteger (0, 2);
+          if (choice == 0)
+            {
+              head = m_nextRx;
+            }
+          else if (choice == 1)
+            {
+              head = m_nextRx > 3000 ? m_nextRx - rng->GetInteger (0, 3000) : 0;
+            }
+          else
+            {
+              head = m_nextRx + rng->GetInteger (0, m_maxBuffer + 3000);
+            }
+          head = std::min (head, m_streamSize - 1);
+          uint32_t tail = std::min (head + rng->GetInteger (1, 1460), m_streamSize);
+
+          h.SetSequenceNumber (SequenceNumber32 (1 + head));
+          bool added = rxBuf->Add (Create<Packet> (&data[head], tail - head), h);
+          bool refAdded = RefAdd (head, tail);
+          NS_TEST_ASSERT_MSG_EQ (added, refAdded, "Add differs at step " << step);
+
+          // RFC 2018: the first block contains the segment, unless the
+          // segment advanced the next sequence number
+          if (added && head > m_nextRx)
+            {
+              TcpOptionSack::SackList list = rxBuf->GetSackList ();
+              NS_TEST_ASSERT_MSG_EQ (list.empty (), false, "No SACK block at step " << step);
+              NS_TEST_ASSERT_MSG_LT_OR_EQ (list.front ().first, SequenceNumber32 (1 + head),
+                                           "The first SACK block misses the segment at step " << step);
+              NS_TEST_ASSERT_MSG_GT (list.front ().second, SequenceNumber32 (1 + head),
+                                     "The first SACK block misses the segment at step " << step);
+            }
+        }
+      else
+        {
+          uint32_t maxSize = rng->GetInteger (1, 4000);
+          uint32_t size = std::min (maxSize, m_nextRx - m_extracted);
+          Ptr<Packet> p = rxBuf->Extract (maxSize);
+          if (size == 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ ((p == 0), true, "Extracted data at step " << step);
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_EQ (p->GetSize (), size, "Extracted size differs at step " << step);
+              std::vector<uint8_t> out (size);
+              p->CopyData (&out[0], size);
+              NS_TEST_ASSERT_MSG_EQ (std::equal (out.begin (), out.end (), data.begin () + m_extracted),
+                                     true, "Extracted bytes differ at step " << step);
+              m_extracted += size;
+              m_size -= size;
+            }
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (rxBuf->NextRxSequence (), SequenceNumber32 (1 + m_nextRx),
+                             "Next sequence number differs at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (rxBuf->Size (), m_size, "Size differs at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (rxBuf->Available (), m_nextRx - m_extracted,
+                             "Available bytes differ at step " << step);
+      CheckSackList (rxBuf, step);
+    }
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -357,6 +668,7 @@ public:
     : TestSuite ("tcp-rx-buffer", UNIT)
   {
     AddTestCase (new TcpRxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpRxBufferReassemblyTestCase (1), TestCase::QUICK);
   }
 };
 static TcpRxBufferTestSuite  g_tcpRxBufferTestSuite;
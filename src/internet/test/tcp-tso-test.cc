@@ -0,0 +1,333 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/socket.h"
+#include "ns3/socket-factory.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/tcp-header.h"
+
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpTsoTestSuite");
+
+static const uint32_t SEGMENT_SIZE = 1000;   //!< TCP segment size
+static const uint32_t TRANSFER_SIZE = 50000; //!< Bytes to transfer
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the TCP segmentation offload against the normal mode
+ *
+ * A TCP sender behind a link with a 9000 bytes MTU sends to a receiver
+ * behind a router and a link with a 1500 bytes MTU. The transfer is run
+ * without and with segmentation offload. With offload, the sender hands
+ * down fewer, larger packets, but the router must forward exactly the same
+ * sequence of segments over the 1500 bytes link, and the transfer must
+ * complete at nearly the same time.
+ */
+class TcpTsoTest : public TestCase
+{
+public:
+  TcpTsoTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run a transfer
+   * \param tsoSegments value of the TsoSegments attribute of the sender
+   */
+  void RunTransfer (uint32_t tsoSegments);
+
+  /**
+   * \brief Send the data and close the sender socket
+   * \param socket the sending socket
+   */
+  void SendData (Ptr<Socket> socket);
+
+  /**
+   * \brief Accept a connection on the receiver
+   * \param socket the accepted socket
+   * \param from the address of the sender
+   */
+  void HandleAccept (Ptr<Socket> socket, const Address &from);
+
+  /**
+   * \brief Read the data received by the receiver
+   * \param socket the receiving socket
+   */
+  void HandleRead (Ptr<Socket> socket);
+
+  /**
+   * \brief Packets sent by the IPv4 layer of the sender
+   * \param packet the packet, with its IPv4 header
+   * \param ipv4 the IPv4 object
+   * \param interface the interface index
+   */
+  void SenderTx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  /**
+   * \brief Packets sent by the IPv4 layer of the router
+   * \param packet the packet, with its IPv4 header
+   * \param ipv4 the IPv4 object
+   * \param interface the interface index
+   */
+  void RouterTx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  uint32_t m_senderPackets;                   //!< Data packets sent by the sender
+  std::vector<uint32_t> m_forwardedSeqs;      //!< Sequence numbers forwarded by the router
+  std::vector<uint32_t> m_forwardedSizes;     //!< Payload sizes forwarded by the router
+  uint32_t m_forwardedFins;                   //!< FIN flags forwarded by the router
+  uint32_t m_rxBytes;                         //!< Bytes read by the receiver
+  Time m_completion;                          //!< Time the last byte was read
+};
+
+TcpTsoTest::TcpTsoTest ()
+  : TestCase ("TCP segmentation offload against the normal mode")
+{
+}
+
+void
+TcpTsoTest::SendData (Ptr<Socket> socket)
+{
+  socket->Send (Create<Packet> (TRANSFER_SIZE));
+  socket->Close ();
+}
+
+void
+TcpTsoTest::HandleAccept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpTsoTest::HandleRead, this));
+}
+
+void
+TcpTsoTest::HandleRead (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_rxBytes += packet->GetSize ();
+    }
+  if (m_rxBytes == TRANSFER_SIZE)
+    {
+      m_completion = Simulator::Now ();
+    }
+}
+
+void
+TcpTsoTest::SenderTx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  Ptr<Packet> p = packet->Copy ();
+  Ipv4Header ipHeader;
+  p->RemoveHeader (ipHeader);
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+  if (p->GetSize () > 0)
+    {
+      m_senderPackets++;
+    }
+}
+
+void
+TcpTsoTest::RouterTx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  Ptr<Packet> p = packet->Copy ();
+  Ipv4Header ipHeader;
+  p->RemoveHeader (ipHeader);
+  if (ipHeader.GetDestination () != Ipv4Address ("10.0.0.2"))
+    {
+      return;
+    }
+
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (packet->GetSize (), 1500u, "Packet larger than the MTU");
+  NS_TEST_ASSERT_MSG_EQ (ipHeader.GetPayloadSize (), p->GetSize (), "Wrong IPv4 payload size");
+  NS_TEST_ASSERT_MSG_EQ (ipHeader.IsLastFragment (), true, "Segment fragmented");
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+  if ((tcpHeader.GetFlags () & TcpHeader::FIN) != 0)
+    {
+      m_forwardedFins++;
+    }
+  if (p->GetSize () > 0)
+    {
+      m_forwardedSeqs.push_back (tcpHeader.GetSequenceNumber ().GetValue ());
+      m_forwardedSizes.push_back (p->GetSize ());
+    }
+}
+
+void
+TcpTsoTest::RunTransfer (uint32_t tsoSegments)
+{
+  m_senderPackets = 0;
+  m_forwardedSeqs.clear ();
+  m_forwardedSizes.clear ();
+  m_forwardedFins = 0;
+  m_rxBytes = 0;
+  m_completion = Seconds (0);
+
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+
+  // Receiver Node
+  Ptr<Node> rxNode = CreateObject<Node> ();
+  internet.Install (rxNode);
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  rxDev->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+  rxNode->AddDevice (rxDev);
+  {
+    Ptr<Ipv4> ipv4 = rxNode->GetObject<Ipv4> ();
+    uint32_t netdev_idx = ipv4->AddInterface (rxDev);
+    ipv4->AddAddress (netdev_idx, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.2"), Ipv4Mask (0xffff0000U)));
+    ipv4->SetUp (netdev_idx);
+    Ptr<Ipv4StaticRouting> ipv4StaticRouting = Ipv4RoutingHelper::GetRouting <Ipv4StaticRouting> (ipv4->GetRoutingProtocol ());
+    ipv4StaticRouting->SetDefaultRoute (Ipv4Address ("10.0.0.1"), netdev_idx);
+  }
+
+  // Router, with a 1500 bytes MTU towards the receiver and a 9000 bytes
+  // MTU towards the sender
+  Ptr<Node> fwNode = CreateObject<Node> ();
+  internet.Install (fwNode);
+  Ptr<SimpleNetDevice> fwDev1 = CreateObject<SimpleNetDevice> ();
+  fwDev1->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+  fwDev1->SetMtu (1500);
+  fwDev1->SetAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  fwNode->AddDevice (fwDev1);
+  Ptr<SimpleNetDevice> fwDev2 = CreateObject<SimpleNetDevice> ();
+  fwDev2->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+  fwDev2->SetMtu (9000);
+  fwNode->AddDevice (fwDev2);
+  {
+    Ptr<Ipv4> ipv4 = fwNode->GetObject<Ipv4> ();
+    uint32_t netdev_idx = ipv4->AddInterface (fwDev1);
+    ipv4->AddAddress (netdev_idx, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask (0xffff0000U)));
+    ipv4->SetUp (netdev_idx);
+    netdev_idx = ipv4->AddInterface (fwDev2);
+    ipv4->AddAddress (netdev_idx, Ipv4InterfaceAddress (Ipv4Address ("10.1.0.1"), Ipv4Mask (0xffff0000U)));
+    ipv4->SetUp (netdev_idx);
+  }
+
+  // Sender Node
+  Ptr<Node> txNode = CreateObject<Node> ();
+  internet.Install (txNode);
+  Ptr<SimpleNetDevice> txDev = CreateObject<SimpleNetDevice> ();
+  txDev->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+  txDev->SetMtu (9000);
+  txDev->SetAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
+  txNode->AddDevice (txDev);
+  {
+    Ptr<Ipv4> ipv4 = txNode->GetObject<Ipv4> ();
+    uint32_t netdev_idx = ipv4->AddInterface (txDev);
+    ipv4->AddAddress (netdev_idx, Ipv4InterfaceAddress (Ipv4Address ("10.1.0.2"), Ipv4Mask (0xffff0000U)));
+    ipv4->SetUp (netdev_idx);
+    Ptr<Ipv4StaticRouting> ipv4StaticRouting = Ipv4RoutingHelper::GetRouting <Ipv4StaticRouting> (ipv4->GetRoutingProtocol ());
+    ipv4StaticRouting->SetDefaultRoute (Ipv4Address ("10.1.0.1"), netdev_idx);
+  }
+
+  Ptr<SimpleChannel> channel1 = CreateObject<SimpleChannel> ();
+  channel1->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  rxDev->SetChannel (channel1);
+  fwDev1->SetChannel (channel1);
+
+  Ptr<SimpleChannel> channel2 = CreateObject<SimpleChannel> ();
+  channel2->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  fwDev2->SetChannel (channel2);
+  txDev->SetChannel (channel2);
+
+  txNode->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpTsoTest::SenderTx, this));
+  fwNode->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpTsoTest::RouterTx, this));
+
+  Ptr<Socket> rxSocket = rxNode->GetObject<TcpSocketFactory> ()->CreateSocket ();
+  rxSocket->SetAttribute ("SegmentSize", UintegerValue (SEGMENT_SIZE));
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->Listen ();
+  rxSocket->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&TcpTsoTest::HandleAccept, this));
+
+  Ptr<Socket> txSocket = txNode->GetObject<TcpSocketFactory> ()->CreateSocket ();
+  txSocket->SetAttribute ("SegmentSize", UintegerValue (SEGMENT_SIZE));
+  txSocket->SetAttribute ("InitialCwnd", UintegerValue (10));
+  txSocket->SetAttribute ("TsoSegments", UintegerValue (tsoSegments));
+  txSocket->Bind ();
+  txSocket->Connect (InetSocketAddress (Ipv4Address ("10.0.0.2"), 1234));
+  Simulator::Schedule (Seconds (0.1), &TcpTsoTest::SendData, this, txSocket);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+TcpTsoTest::DoRun (void)
+{
+  RunTransfer (1);
+  NS_TEST_ASSERT_MSG_EQ (m_rxBytes, TRANSFER_SIZE, "Transfer incomplete without offload");
+  std::vector<uint32_t> seqs = m_forwardedSeqs;
+  std::vector<uint32_t> sizes = m_forwardedSizes;
+  uint32_t senderPackets = m_senderPackets;
+  Time completion = m_completion;
+  NS_TEST_ASSERT_MSG_EQ (senderPackets, seqs.size (), "Packets split without offload");
+
+  RunTransfer (8);
+  NS_TEST_ASSERT_MSG_EQ (m_rxBytes, TRANSFER_SIZE, "Transfer incomplete with offload");
+  NS_TEST_ASSERT_MSG_EQ (m_forwardedFins, 1u, "FIN must only be on the last segment");
+  NS_TEST_ASSERT_MSG_LT (m_senderPackets * 3, m_forwardedSeqs.size (),
+                         "Offload should cut the number of packets sent");
+
+  // The router forwards the same segments in both modes
+  NS_TEST_ASSERT_MSG_EQ (m_forwardedSeqs.size (), seqs.size (), "Different number of segments");
+  for (uint32_t i = 0; i < seqs.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_forwardedSeqs[i], seqs[i], "Different sequence of segments");
+      NS_TEST_ASSERT_MSG_EQ (m_forwardedSizes[i], sizes[i], "Different segment sizes");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (m_forwardedSizes[i], SEGMENT_SIZE, "Segment larger than the MSS");
+    }
+
+  double ratio = m_completion.GetSeconds () / completion.GetSeconds ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (ratio, 1.0, 0.05, "Completion times differ");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP segmentation offload TestSuite
+ */
+class TcpTsoTestSuite : public TestSuite
+{
+public:
+  TcpTsoTestSuite () : TestSuite ("tcp-tso-test", UNIT)
+  {
+    AddTestCase (new TcpTsoTest (), TestCase::QUICK);
+  }
+};
+
+static TcpTsoTestSuite g_tcpTsoTestSuite; //!< Static variable for test initialization
@@ -20,6 +20,10 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/tcp-option-sack.h"
+#include "ns3/random-variable-stream.h"
+
+#include <deque>
 
 using namespace ns3;
 
@@ -49,6 +53,8 @@ private:
   void TestNextSeg ();
   /** \brief Test the scoreboard with emulated SACK */
   void TestUpdateScoreboardWithCraftedSACK ();
+  /** \brief Test the bytes in flight with lost, retransmitted and SACKed segments */
+  void TestBytesInFlight ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -82,6 +88,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestNextSeg, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestUpdateScoreboardWithCraftedSACK, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestBytesInFlight, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -393,6 +401,109 @@ TcpTxBufferTestCase::TestUpdateScoreboardWithCraftedSACK ()
 void
 TcpTxBufferTestCase::TestTransmittedBlock ()
 {
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  txBuf.SetHeadSequence (head);
+  txBuf.Add (Create<Packet> (1000));
+
+  // Send ten segments, 100 bytes long each
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      txBuf.CopyFromSequence (100, head + (100 * i));
+    }
+
+  // exactly the same as previous
+  Ptr<Packet> ret = txBuf.CopyFromSequence (100, head + 200);
+  NS_TEST_ASSERT_MSG_EQ (ret->GetSize (), 100,
+                         "Retransmitted block differs from the segment sent");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.SizeFromSequence (head + 200), 800,
+                         "Retransmission changed the buffer");
+
+  // starts inside a packet, ends in another packet
+  ret = txBuf.CopyFromSequence (200, head + 450);
+  NS_TEST_ASSERT_MSG_EQ (ret->GetSize (), 200,
+                         "Merged block has a different size than requested");
+
+  // starts inside a packet, ends earlier in the same packet
+  ret = txBuf.CopyFromSequence (20, head + 510);
+  NS_TEST_ASSERT_MSG_EQ (ret->GetSize (), 20,
+                         "Split block has a different size than requested");
+
+  // starts over the boundary, but ends after (with new data)
+  ret = txBuf.CopyFromSequence (100, head + 950);
+  NS_TEST_ASSERT_MSG_EQ (ret->GetSize (), 50,
+                         "Block is not limited by the data in the buffer");
+
+  // The head is not retransmitted yet
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsHeadRetransmitted (), false,
+                         "Head marked as retransmitted");
+  txBuf.CopyFromSequence (100, head);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsHeadRetransmitted (), true,
+                         "Head not marked as retransmitted");
+
+  txBuf.DiscardUpTo (head + 1000);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 0,
+                         "Data inside the buffer");
+}
+
+void
+TcpTxBufferTestCase::TestBytesInFlight ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  uint32_t dupThresh = 3;
+  uint32_t segmentSize = 100;
+  SequenceNumber32 ret;
+  txBuf.SetHeadSequence (head);
+  txBuf.Add (Create<Packet> (1000));
+
+  // Send ten segments
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 1000,
+                         "All the segments sent should be in flight");
+
+  // SACK segments 5, 6 and 7: segments from 0 to 4 are lost
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  sack->AddSackBlock (TcpOptionSack::SackBlock (head + 500, head + 800));
+  txBuf.Update (sack->GetSackList ());
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + 400, dupThresh, segmentSize), true,
+                         "Segment before three SACKed segments not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + 500, dupThresh, segmentSize), false,
+                         "SACKed segment deemed lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 200,
+                         "Only the segments after the SACKed ones should be in flight");
+
+  // Retransmit the first lost segment: it is in flight again
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, dupThresh, segmentSize, true), true,
+                         "No lost segment to retransmit");
+  NS_TEST_ASSERT_MSG_EQ (ret, head, "The first lost segment is not the head");
+  txBuf.CopyFromSequence (segmentSize, ret);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 300,
+                         "Retransmitted segment not in flight");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, dupThresh, segmentSize, true), true,
+                         "No lost segment to retransmit");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + segmentSize,
+                         "NextSeg did not skip the retransmitted segment");
+
+  // After an RTO, nothing is in flight until it is retransmitted
+  txBuf.SetSentListLost ();
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 0,
+                         "Bytes in flight after marking the sent list lost");
+  txBuf.ResetScoreboard ();
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, dupThresh, segmentSize, false), true,
+                         "No lost segment to retransmit after the RTO");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + segmentSize,
+                         "NextSeg did not return the first segment marked lost");
+  txBuf.CopyFromSequence (segmentSize, ret);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 100,
+                         "Retransmitted segment not in flight after the RTO");
+
+  txBuf.DiscardUpTo (head + 1000);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), 0,
+                         "Bytes in flight with an empty buffer");
 }
 
 void
@@ -400,6 +511,363 @@ TcpTxBufferTestCase::DoTeardown ()
 {
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Randomized differential test of the TcpTxBuffer scoreboard
+ *
+ * Random sends, SACK blocks, cumulative ACKs, retransmissions and RTOs are
+ * applied both to a TcpTxBuffer and to a reference scoreboard, which keeps
+ * three flags per segment and evaluates the RFC 6675 routines by walking
+ * every segment, as the buffer did before its sent list was indexed. After
+ * every step, the results of IsLost, NextSeg and BytesInFlight, and the
+ * SACKed and lost byte counts, must be the same.
+ */
+class TcpTxBufferScoreboardTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param dupThresh the DupAck threshold
+   * \param stream the random stream to draw the steps from
+   */
+  TcpTxBufferScoreboardTestCase (uint32_t dupThresh, int64_t stream);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Flags of a sent segment in the reference scoreboard
+   */
+  struct RefSegment
+  {
+    bool m_sacked;   //!< The segment has been SACKed
+    bool m_retrans;  //!< The segment has been retransmitted
+    bool m_lost;     //!< The segment has been marked as lost
+  };
+
+  /**
+   * \brief Reference RFC 6675 IsLost, for a sent segment
+   * \param i index of the segment
+   * \returns true if the segment is lost
+   */
+  bool RefIsLost (uint32_t i) const;
+
+  /**
+   * \brief Reference RFC 6675 NextSeg
+   * \param i index of the segment to transmit, as output
+   * \param isRecovery true if in recovery
+   * \returns true if a segment should be transmitted
+   */
+  bool RefNextSeg (uint32_t *i, bool isRecovery) const;
+
+  /**
+   * \brief Reference RFC 6675 pipe
+   * \returns the bytes in flight
+   */
+  uint32_t RefBytesInFlight (void) const;
+
+  /**
+   * \brief Transmit a segment, new or already sent, in both scoreboards
+   * \param i index of the segment
+   */
+  void Transmit (uint32_t i);
+
+  /**
+   * \brief Compare the buffer with the reference
+   * \param step the current step, to report failures
+   */
+  void Check (uint32_t step);
+
+  static const uint32_t m_segmentSize = 500; //!< Segment size
+  static const uint32_t m_maxWindow = 120;   //!< Maximum segments in flight
+  uint32_t m_dupThresh;                      //!< DupAck threshold
+  int64_t m_stream;                          //!< Random stream
+  Ptr<TcpTxBuffer> m_txBuf;                  //!< Buffer under test
+  std::deque<RefSegment> m_ref;              //!< Reference sent list
+  uint32_t m_unsent;                         //!< Segments not sent yet
+};
+
+TcpTxBufferScoreboardTestCase::TcpTxBufferScoreboardTestCase (uint32_t dupThresh, int64_t stream)
+  : TestCase ("TcpTxBuffer scoreboard against a reference, dupThresh=" +
+              std::to_string (dupThresh)),
+    m_dupThresh (dupThresh),
+    m_stream (stream),
+    m_unsent (0)
+{
+}
+
+bool
+TcpTxBufferScoreboardTestCase::RefIsLost (uint32_t i) const
+{
+  if (m_ref[i].m_lost)
+    {
+      return true;
+    }
+  if (m_ref[i].m_sacked)
+    {
+      return false;
+    }
+
+  uint32_t count = 0;
+  for (uint32_t j = i + 1; j < m_ref.size (); ++j)
+    {
+      if (m_ref[j].m_sacked)
+        {
+          ++count;
+          if (count >= m_dupThresh || count * m_segmentSize > (m_dupThresh - 1) * m_segmentSize)
+            {
+              return true;
+            }
+        }
+    }
+  return false;
+}
+
+bool
+TcpTxBufferScoreboardTestCase::RefNextSeg (uint32_t *i, bool isRecovery) const
+{
+  bool rule3 = false;
+  uint32_t rule3Index = 0;
+
+  for (uint32_t j = 0; j < m_ref.size (); ++j)
+    {
+      if (!m_ref[j].m_retrans && !m_ref[j].m_sacked)
+        {
+          if (RefIsLost (j))
+            {
+              *i = j;
+              return true;
+            }
+          else if (isRecovery && !rule3)
+            {
+              rule3 = true;
+              rule3Index = j;
+            }
+        }
+    }
+
+  if (m_unsent > 0)
+    {
+      *i = m_ref.size ();
+      return true;
+    }
+
+  *i = rule3Index;
+  return rule3;
+}
+
+uint32_t
+TcpTxBufferScoreboardTestCase::RefBytesInFlight (void) const
+{
+  uint32_t size = 0;
+
+  for (uint32_t j = 0; j < m_ref.size (); ++j)
+    {
+      if (m_ref[j].m_sacked)
+        {
+          continue;
+        }
+      if (!RefIsLost (j) || (m_ref[j].m_retrans && !m_ref[j].m_lost))
+        {
+          size += m_segmentSize;
+        }
+    }
+  return size;
+}
+
+void
+TcpTxBufferScoreboardTestCase::Transmit (uint32_t i)
+{
+  NS_ASSERT (i <= m_ref.size ());
+  m_txBuf->CopyFromSequence (m_segmentSize, m_txBuf->HeadSequence () + i * m_segmentSize);
+
+  if (i == m_ref.size ())
+    {
+      RefSegment segment = { false, false, false };
+      m_ref.push_back (segment);
+      --m_unsent;
+    }
+  else
+    {
+      m_ref[i].m_retrans = true;
+      m_ref[i].m_lost = false;
+    }
+}
+
+void
+TcpTxBufferScoreboardTestCase::Check (uint32_t step)
+{
+  SequenceNumber32 head = m_txBuf->HeadSequence ();
+  uint32_t sacked = 0;
+  uint32_t lost = 0;
+  int32_t highestSacked = -1;
+
+  for (uint32_t j = 0; j < m_ref.size (); ++j)
+    {
+      if (m_ref[j].m_sacked)
+        {
+          sacked += m_segmentSize;
+          highestSacked = j;
+        }
+      else if (m_ref[j].m_lost)
+        {
+          lost += m_segmentSize;
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (m_txBuf->GetSackedBytes (), sacked,
+                         "SACKed bytes differ at step " << step);
+  NS_TEST_ASSERT_MSG_EQ (m_txBuf->GetLostBytes (), lost,
+                         "Lost bytes differ at step " << step);
+  NS_TEST_ASSERT_MSG_EQ (m_txBuf->BytesInFlight (m_dupThresh, m_segmentSize),
+                         RefBytesInFlight (), "Bytes in flight differ at step " << step);
+  NS_TEST_ASSERT_MSG_EQ (m_txBuf->IsHeadRetransmitted (),
+                         !m_ref.empty () && m_ref[0].m_retrans,
+                         "Head retransmission differs at step " << step);
+
+  // IsLost () is false after the highest SACKed segment
+  for (uint32_t j = 0; j < m_ref.size (); ++j)
+    {
+      bool refLost = static_cast<int32_t> (j) <= highestSacked && RefIsLost (j);
+      NS_TEST_ASSERT_MSG_EQ (m_txBuf->IsLost (head + j * m_segmentSize, m_dupThresh, m_segmentSize),
+                             refLost, "IsLost differs for segment " << j << " at step " << step);
+    }
+
+  for (uint32_t r = 0; r < 2; ++r)
+    {
+      SequenceNumber32 seq;
+      uint32_t i;
+      bool found = m_txBuf->NextSeg (&seq, m_dupThresh, m_segmentSize, r == 1);
+      bool refFound = RefNextSeg (&i, r == 1);
+      NS_TEST_ASSERT_MSG_EQ (found, refFound, "NextSeg differs at step " << step);
+      if (found)
+        {
+          NS_TEST_ASSERT_MSG_EQ (seq, head + i * m_segmentSize,
+                                 "NextSeg differs at step " << step);
+        }
+    }
+}
+
+void
+TcpTxBufferScoreboardTestCase::DoRun (void)
+{
+  const uint32_t steps = 2000;
+  const uint32_t segments = 20000;
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (m_stream);
+  m_txBuf = CreateObject<TcpTxBuffer> ();
+  m_ref.clear ();
+
+  m_txBuf->SetMaxBufferSize (segments * m_segmentSize);
+  m_txBuf->SetHeadSequence (SequenceNumber32 (1));
+  m_txBuf->Add (Create<Packet> (segments * m_segmentSize));
+  m_unsent = segments;
+
+  for (uint32_t step = 0; step < steps && !IsStatusFailure (); ++step)
+    {
+      uint32_t sent = m_ref.size ();
+      uint32_t action = rng->GetInteger (0, 19);
+
+      if (action < 6)
+        {
+          // Send up to four new segments
+          for (uint32_t n = rng->GetInteger (1, 4); n > 0; --n)
+            {
+              if (m_unsent > 0 && m_ref.size () < m_maxWindow)
+                {
+                  Transmit (m_ref.size ());
+                }
+            }
+        }
+      else if (action < 12 && sent > 1)
+        {
+          // Up to three SACK blocks, not always aligned on the segments
+          TcpOptionSack::SackList list;
+          for (uint32_t n = rng->GetInteger (1, 3); n > 0; --n)
+            {
+              uint32_t first = rng->GetInteger (1, sent - 1);
+              uint32_t last = std::min (sent, first + rng->GetInteger (1, 8));
+              SequenceNumber32 start = m_txBuf->HeadSequence () + first * m_segmentSize;
+              SequenceNumber32 end = m_txBuf->HeadSequence () + last * m_segmentSize;
+              if (rng->GetInteger (0, 3) == 0)
+                {
+                  start -= rng->GetInteger (1, m_segmentSize - 1);
+                }
+              if (rng->GetInteger (0, 3) == 0)
+                {
+                  end += rng->GetInteger (1, m_segmentSize - 1);
+                }
+              list.push_back (TcpOptionSack::SackBlock (start, end));
+              for (uint32_t j = first; j < last; ++j)
+                {
+                  m_ref[j].m_sacked = true;
+                }
+            }
+          m_txBuf->Update (list);
+        }
+      else if (action < 14 && sent > 0)
+        {
+          // Cumulative ACK; the new head cannot stay SACKed
+          uint32_t acked = rng->GetInteger (1, std::min (sent, 10u));
+          m_txBuf->DiscardUpTo (m_txBuf->HeadSequence () + acked * m_segmentSize);
+          m_ref.erase (m_ref.begin (), m_ref.begin () + acked);
+          if (!m_ref.empty ())
+            {
+              m_ref[0].m_sacked = false;
+            }
+        }
+      else if (action < 19)
+        {
+          // Transmit what NextSeg returns
+          uint32_t i;
+          if (RefNextSeg (&i, rng->GetInteger (0, 1) == 1)
+              && (i < m_ref.size () || m_ref.size () < m_maxWindow))
+            {
+              Transmit (i);
+            }
+        }
+      else
+        {
+          uint32_t event = rng->GetInteger (0, 2);
+          if (event == 0)
+            {
+              // RTO: only the head stays in the sent list, marked as lost
+              m_txBuf->ResetSentList ();
+              if (!m_ref.empty ())
+                {
+                  m_unsent += m_ref.size () - 1;
+                  m_ref.resize (1);
+                  m_ref[0].m_sacked = false;
+                  m_ref[0].m_retrans = false;
+                  m_ref[0].m_lost = true;
+                }
+            }
+          else if (event == 1)
+            {
+              m_txBuf->SetSentListLost ();
+              for (uint32_t j = 0; j < m_ref.size (); ++j)
+                {
+                  m_ref[j].m_lost = true;
+                }
+            }
+          else
+            {
+              m_txBuf->ResetScoreboard ();
+              for (uint32_t j = 0; j < m_ref.size (); ++j)
+                {
+                  m_ref[j].m_sacked = false;
+                }
+            }
+        }
+
+      Check (step);
+    }
+
+  m_txBuf = 0;
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -413,6 +881,8 @@ public:
     : TestSuite ("tcp-tx-buffer", UNIT)
   {
     AddTestCase (new TcpTxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpTxBufferScoreboardTestCase (3, 1), TestCase::QUICK);
+    AddTestCase (new TcpTxBufferScoreboardTestCase (1, 2), TestCase::QUICK);
   }
 };
 
@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/enum.h"
 
 #include "trace-helper.h"
 
@@ -83,8 +84,16 @@ PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bo
   NS_ABORT_MSG_UNLESS (prefix.size (), "Empty prefix string");
 
   std::ostringstream oss;
-  oss << prefix << "-";
+  oss << prefix << "-" << GetDeviceName (device, useObjectNames) << ".pcap";
+  return oss.str ();
+}
 
+std::string
+PcapHelper::GetDeviceName (Ptr<NetDevice> device, bool useObjectNames)
+{
+  NS_LOG_FUNCTION (device << useObjectNames);
+
+  std::ostringstream oss;
   std::string nodename;
   std::string devicename;
 
@@ -116,8 +125,6 @@ PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bo
       oss << device->GetIfIndex ();
     }
 
-  oss << ".pcap";
-
   return oss.str ();
 }
 
@@ -177,6 +184,63 @@ PcapHelper::SinkWithHeader (Ptr<PcapFileWrapper> file, const Header &header, Ptr
   file->Write (Simulator::Now (), header, p);
 }
 
+Ptr<PcapNgFileWrapper>
+PcapHelper::CreateNgFile (std::string filename, PcapNgFile::Compression compression)
+{
+  NS_LOG_FUNCTION (filename << compression);
+
+  Ptr<PcapNgFileWrapper> file = CreateObject<PcapNgFileWrapper> ();
+  file->SetAttribute ("Compression", EnumValue (compression));
+  file->Open (filename);
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename);
+
+  //
+  // As for pcap files, the file object is kept alive by the callbacks of the
+  // trace sources it is hooked to, and closed when they are all destroyed.
+  //
+  return file;
+}
+
+uint32_t
+PcapHelper::AddNgInterface (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> device,
+                            DataLinkType dataLinkType, std::string traceName, bool useObjectNames)
+{
+  NS_LOG_FUNCTION (file << device << dataLinkType << traceName << useObjectNames);
+
+  std::string name = GetDeviceName (device, useObjectNames);
+
+  Ptr<NgInterface> interface = Create<NgInterface> ();
+  interface->file = file;
+  interface->interface = file->AddInterface (dataLinkType, name, device->GetInstanceTypeId ().GetName ());
+
+  bool result =
+    device->TraceConnectWithoutContext (traceName, MakeBoundCallback (&NgSink, interface));
+  NS_ABORT_MSG_UNLESS (result, "PcapHelper::AddNgInterface():  Unable to hook \"" << traceName << "\"");
+  return interface->interface;
+}
+
+Ptr<PcapNgFileWrapper>
+PcapHelper::EnablePcapNg (std::string filename, NetDeviceContainer devices,
+                          DataLinkType dataLinkType, std::string traceName,
+                          PcapNgFile::Compression compression)
+{
+  NS_LOG_FUNCTION (filename << dataLinkType << traceName << compression);
+
+  Ptr<PcapNgFileWrapper> file = CreateNgFile (filename, compression);
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      AddNgInterface (file, *i, dataLinkType, traceName);
+    }
+  return file;
+}
+
+void
+PcapHelper::NgSink (Ptr<NgInterface> interface, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (interface->file << interface->interface << p);
+  interface->file->Write (interface->interface, Simulator::Now (), p);
+}
+
 AsciiTraceHelper::AsciiTraceHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -24,6 +24,7 @@
 #include "ns3/node-container.h"
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
 
 namespace ns3 {
@@ -81,6 +82,18 @@ public:
    */
   std::string GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames = true);
 
+  /**
+   * @brief Name a device after its node and itself, as "<node>-<device>".
+   *
+   * This is the part of the file names built by GetFilenameFromDevice
+   * identifying the device, and the name of its pcapng interface.
+   *
+   * @param device NetDevice
+   * @param useObjectNames use node and device names instead of indexes
+   * @returns the device name
+   */
+  std::string GetDeviceName (Ptr<NetDevice> device, bool useObjectNames = true);
+
   /**
    * @brief Let the pcap helper figure out a reasonable filename to use for the
    * pcap file associated with a node.
@@ -118,6 +131,55 @@ public:
    */
   template <typename T> void HookDefaultSink (Ptr<T> object, std::string traceName, Ptr<PcapFileWrapper> file);
 
+  /**
+   * @brief Create a pcapng file, which can hold the packets of many devices.
+   *
+   * @param filename file name
+   * @param compression compression of the file
+   * @returns a smart pointer to the pcapng file
+   */
+  Ptr<PcapNgFileWrapper> CreateNgFile (std::string filename,
+                                       PcapNgFile::Compression compression = PcapNgFile::NONE);
+
+  /**
+   * @brief Describe a device as a new interface of a pcapng file and write
+   * the packets it traces to this file.
+   *
+   * The interface is named after the node and the device, as returned by
+   * GetDeviceName, and described by the type of the device.
+   *
+   * @param file the pcapng file
+   * @param device the device
+   * @param dataLinkType data link type of the packets traced by the device
+   * @param traceName name of the trace source of the device, which must
+   * provide the packets as Ptr<const Packet>
+   * @param useObjectNames use node and device names instead of indexes
+   * @returns the index of the interface in the file
+   */
+  uint32_t AddNgInterface (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> device,
+                           DataLinkType dataLinkType,
+                           std::string traceName = "PromiscSniffer",
+                           bool useObjectNames = true);
+
+  /**
+   * @brief Trace a set of devices into a single pcapng file.
+   *
+   * All the devices must trace packets of the same data link type through
+   * the same trace source; devices of different types can be added to the
+   * returned file with AddNgInterface.
+   *
+   * @param filename file name
+   * @param devices the devices to trace
+   * @param dataLinkType data link type of the packets traced by the devices
+   * @param traceName name of the trace source of the devices
+   * @param compression compression of the file
+   * @returns a smart pointer to the pcapng file
+   */
+  Ptr<PcapNgFileWrapper> EnablePcapNg (std::string filename, NetDeviceContainer devices,
+                                       DataLinkType dataLinkType,
+                                       std::string traceName = "PromiscSniffer",
+                                       PcapNgFile::Compression compression = PcapNgFile::NONE);
+
 private:
   /**
    * The basic default trace sink.
@@ -141,6 +203,23 @@ private:
    * @see DefaultSink
    */
   static void SinkWithHeader (Ptr<PcapFileWrapper> file, const Header& header, Ptr<const Packet> p);
+
+  /**
+   * @brief A pcapng file interface, bound to the trace sink of a device
+   */
+  struct NgInterface : public SimpleRefCount<NgInterface>
+  {
+    Ptr<PcapNgFileWrapper> file; //!< the pcapng file
+    uint32_t interface;          //!< index of the interface in the file
+  };
+
+  /**
+   * The trace sink writing the packets of a device to a pcapng file.
+   *
+   * @param interface the pcapng file interface of the device
+   * @param p the packet to write
+   */
+  static void NgSink (Ptr<NgInterface> interface, Ptr<const Packet> p);
 };
 
 template <typename T> void
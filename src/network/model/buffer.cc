@@ -20,6 +20,8 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/ip-checksum.h"
+#include <algorithm>
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -1143,14 +1145,40 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
-  /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  NS_ASSERT_MSG (m_current + size <= m_dataEnd, GetReadErrorMessage ());
+  /* see RFC 1071 to understand this code. The bytes before and after
+   * the zero area are summed as two contiguous spans; the zero area
+   * only shifts the parity of the bytes which follow it.
+   */
+  uint64_t sum = initialChecksum;
+  uint32_t end = m_current + size;
+  uint32_t offset = 0;
+
+  if (m_current < m_zeroStart)
+    {
+      uint32_t n = std::min (end, m_zeroStart) - m_current;
+      sum += IpChecksumAccumulate (&m_data[m_current], n);
+      offset += n;
+      m_current += n;
+    }
+  if (m_current < end && m_current < m_zeroEnd)
+    {
+      uint32_t n = std::min (end, m_zeroEnd) - m_current;
+      offset += n;
+      m_current += n;
+    }
+  if (m_current < end)
+    {
+      uint32_t n = end - m_current;
+      uint16_t partial = IpChecksumAccumulate (&m_data[m_current - (m_zeroEnd - m_zeroStart)], n);
+      if (offset & 1)
+        {
+          // the span starts in the middle of a 16-bit word
+          partial = (partial >> 8) | (partial << 8);
+        }
+      sum += partial;
+      m_current += n;
+    }
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
@@ -143,6 +143,7 @@ ByteTagList::ByteTagList ()
     m_maxEnd (INT32_MIN),
     m_adjustment (0),
     m_used (0),
+    m_lastTag (0),
     m_data (0)
 {
   NS_LOG_FUNCTION (this);
@@ -152,6 +153,7 @@ ByteTagList::ByteTagList (const ByteTagList &o)
     m_maxEnd (o.m_maxEnd),
     m_adjustment (o.m_adjustment),
     m_used (o.m_used),
+    m_lastTag (o.m_lastTag),
     m_data (o.m_data)
 {
   NS_LOG_FUNCTION (this << &o);
@@ -174,6 +176,7 @@ ByteTagList::operator = (const ByteTagList &o)
   m_adjustment = o.m_adjustment;
   m_data = o.m_data;
   m_used = o.m_used;
+  m_lastTag = o.m_lastTag;
   if (m_data != 0)
     {
       m_data->count++;
@@ -186,6 +189,7 @@ ByteTagList::~ByteTagList ()
   Deallocate (m_data);
   m_data = 0;
   m_used = 0;
+  m_lastTag = 0;
 }
 
 TagBuffer
@@ -221,6 +225,7 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
     {
       m_maxEnd = end - m_adjustment;
     }
+  m_lastTag = m_used;
   m_used = spaceNeeded;
   m_data->dirty = m_used;
   return tag;
@@ -234,11 +239,60 @@ ByteTagList::Add (const ByteTagList &o)
   while (i.HasNext ())
     {
       ByteTagList::Iterator::Item item = i.Next ();
+      if (MergeWithLast (item))
+        {
+          continue;
+        }
       TagBuffer buf = Add (item.tid, item.size, item.start, item.end);
       buf.CopyFrom (item.buf);
     }
 }
 
+bool
+ByteTagList::MergeWithLast (const ByteTagList::Iterator::Item &item)
+{
+  NS_LOG_FUNCTION (this << item.tid << item.start << item.end);
+  if (m_data == 0)
+    {
+      return false;
+    }
+  uint8_t *last = &m_data->data[m_lastTag];
+  TagBuffer header = TagBuffer (last, &m_data->data[m_used]);
+  uint32_t tid = header.ReadU32 ();
+  uint32_t size = header.ReadU32 ();
+  header.ReadU32 ();
+  int32_t end = header.ReadU32 () + m_adjustment;
+  if (tid != item.tid.GetUid () || size != item.size || end != item.start)
+    {
+      return false;
+    }
+  TagBuffer data = item.buf;
+  for (uint32_t k = 0; k < size; ++k)
+    {
+      if (data.ReadU8 () != last[4 + 4 + 4 + 4 + k])
+        {
+          return false;
+        }
+    }
+  if (m_data->count != 1)
+    {
+      // the buffer is shared: unshare it before updating the tag in place.
+      struct ByteTagListData *newData = Allocate (m_used);
+      std::memcpy (&newData->data, &m_data->data, m_used);
+      Deallocate (m_data);
+      m_data = newData;
+      m_data->dirty = m_used;
+    }
+  TagBuffer endField = TagBuffer (&m_data->data[m_lastTag + 4 + 4 + 4],
+                                  &m_data->data[m_used]);
+  endField.WriteU32 (item.end - m_adjustment);
+  if (item.end - m_adjustment > m_maxEnd)
+    {
+      m_maxEnd = item.end - m_adjustment;
+    }
+  return true;
+}
+
 void 
 ByteTagList::RemoveAll (void)
 {
@@ -249,6 +303,7 @@ ByteTagList::RemoveAll (void)
   m_adjustment = 0;
   m_data = 0;
   m_used = 0;
+  m_lastTag = 0;
 }
 
 ByteTagList::Iterator 
@@ -264,8 +319,11 @@ ByteTagList::Iterator
 ByteTagList::Begin (int32_t offsetStart, int32_t offsetEnd) const
 {
   NS_LOG_FUNCTION (this << offsetStart << offsetEnd);
-  if (m_data == 0)
+  if (m_data == 0
+      || offsetStart >= m_maxEnd + m_adjustment
+      || offsetEnd <= m_minStart + m_adjustment)
     {
+      // no tag can overlap the requested range: skip the linear scan.
       return Iterator (0, 0, offsetStart, offsetEnd, 0);
     }
   else
@@ -298,10 +356,6 @@ ByteTagList::AddAtEnd (int32_t appendOffset)
         }
       TagBuffer buf = list.Add (item.tid, item.size, item.start, item.end);
       buf.CopyFrom (item.buf);
-      if (item.end > m_maxEnd)
-        {
-          m_maxEnd = item.end;
-        }
     }
   *this = list;
 }
@@ -314,7 +368,6 @@ ByteTagList::AddAtStart (int32_t prependOffset)
     {
       return;
     }
-  m_minStart = INT32_MAX;
   ByteTagList list;
   ByteTagList::Iterator i = BeginAll ();
   while (i.HasNext ())
@@ -331,10 +384,6 @@ ByteTagList::AddAtStart (int32_t prependOffset)
         }
       TagBuffer buf = list.Add (item.tid, item.size, item.start, item.end);
       buf.CopyFrom (item.buf);
-      if (item.start < m_minStart)
-        {
-          m_minStart = item.start;
-        }
     }
   *this = list;
 }
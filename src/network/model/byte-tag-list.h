@@ -184,7 +184,11 @@ private:
   /**
    * \param o the other list of tags to aggregate.
    *
-   * Aggregate the two lists of tags.
+   * Aggregate the two lists of tags. A tag of o which starts exactly
+   * where the last tag of this list ends, and which carries the same
+   * TypeId and the same serialized data, is merged into that last tag
+   * rather than appended, so that reassembling a stream of identically
+   * tagged packets does not grow the list by one tag per packet.
    */
   void Add (const ByteTagList &o);
 
@@ -239,6 +243,18 @@ private:
    */
   ByteTagList::Iterator BeginAll (void) const;
 
+  /**
+   * \brief Try to extend the last tag of this list to cover a new item
+   *
+   * The last tag is extended only if it has the same TypeId, size and
+   * serialized data as the item, and if it ends exactly where the item
+   * starts.
+   *
+   * \param item the tag to merge
+   * \returns true if the item has been merged, false otherwise
+   */
+  bool MergeWithLast (const ByteTagList::Iterator::Item &item);
+
   /**
    * \brief Allocate the memory for the ByteTagListData
    * \param size the memory to allocate
@@ -256,6 +272,7 @@ private:
   int32_t m_maxEnd; //!< maximal end offset
   int32_t m_adjustment; //!< adjustment to byte tag offsets
   uint32_t m_used; //!< the number of used bytes in the buffer
+  uint32_t m_lastTag; //!< offset of the last tag in the buffer
   struct ByteTagListData *m_data; //!< the ByteTagListData structure
 };
 
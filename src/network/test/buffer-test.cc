@@ -19,9 +19,12 @@
  */
 
 #include "ns3/buffer.h"
+#include "ns3/ip-checksum.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include <algorithm>
+#include <vector>
 
 using namespace ns3;
 
@@ -378,6 +381,141 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Checksum unit tests: the span-based checksum of a Buffer::Iterator
+ * must match the word-by-word sum of RFC 1071 wherever the checksummed
+ * bytes start and end relative to the zero area of the buffer, and
+ * the incremental update of RFC 1624 must match a full computation.
+ */
+class BufferChecksumTest : public TestCase {
+private:
+  /**
+   * Computes the reference checksum, a 16-bit word at a time.
+   * \param data The bytes to checksum
+   * \param size The number of bytes
+   * \param initialChecksum The initial value
+   * \returns the checksum
+   */
+  uint16_t ReferenceChecksum (const uint8_t *data, uint32_t size, uint32_t initialChecksum);
+  /**
+   * \returns the next pseudo-random byte
+   */
+  uint8_t NextByte (void);
+  uint32_t m_state; //!< pseudo-random generator state
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer checksum"),
+    m_state (0x12345678)
+{
+}
+
+uint16_t
+BufferChecksumTest::ReferenceChecksum (const uint8_t *data, uint32_t size, uint32_t initialChecksum)
+{
+  uint32_t sum = initialChecksum;
+  for (uint32_t j = 0; j + 1 < size; j += 2)
+    {
+      sum += data[j] | (data[j + 1] << 8);
+    }
+  if (size & 1)
+    {
+      sum += data[size - 1];
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+uint8_t
+BufferChecksumTest::NextByte (void)
+{
+  m_state ^= m_state << 13;
+  m_state ^= m_state >> 17;
+  m_state ^= m_state << 5;
+  return m_state >> 24;
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  // head bytes, zero area, tail bytes, with both parities of each
+  uint32_t sizes[] = { 0, 1, 2, 7, 20, 33, 64, 1501 };
+  uint32_t nSizes = sizeof (sizes) / sizeof (sizes[0]);
+  for (uint32_t h = 0; h < nSizes; h++)
+    {
+      for (uint32_t z = 0; z < nSizes; z++)
+        {
+          for (uint32_t t = 0; t < nSizes; t++)
+            {
+              Buffer buffer (sizes[z]);
+              buffer.AddAtStart (sizes[h]);
+              buffer.AddAtEnd (sizes[t]);
+              Buffer::Iterator i = buffer.Begin ();
+              for (uint32_t j = 0; j < sizes[h]; j++)
+                {
+                  i.WriteU8 (NextByte ());
+                }
+              i.Next (sizes[z]);
+              for (uint32_t j = 0; j < sizes[t]; j++)
+                {
+                  i.WriteU8 (NextByte ());
+                }
+              uint32_t size = buffer.GetSize ();
+              std::vector<uint8_t> data (size + 1);
+              buffer.CopyData (&data[0], size);
+
+              uint32_t starts[] = { 0, 1, 3, sizes[h], sizes[h] + 1, size / 2 };
+              for (uint32_t k = 0; k < sizeof (starts) / sizeof (starts[0]); k++)
+                {
+                  uint32_t start = std::min (starts[k], size);
+                  uint32_t lengths[] = { size - start, (size - start) / 2, (size - start) / 3 };
+                  for (uint32_t l = 0; l < sizeof (lengths) / sizeof (lengths[0]); l++)
+                    {
+                      uint32_t length = std::min<uint32_t> (lengths[l], 0xffff);
+                      i = buffer.Begin ();
+                      i.Next (start);
+                      uint16_t got = i.CalculateIpChecksum (length, 0x1234);
+                      uint16_t expected = ReferenceChecksum (&data[start], length, 0x1234);
+                      NS_TEST_ASSERT_MSG_EQ (got, expected, "Bad checksum of " << length << " bytes at offset " << start
+                                             << " (head " << sizes[h] << ", zero " << sizes[z] << ", tail " << sizes[t] << ")");
+                      NS_TEST_ASSERT_MSG_EQ (i.GetRemainingSize (), size - start - length, "Iterator not moved past the checksummed bytes");
+                    }
+                }
+            }
+        }
+    }
+
+  // incremental update, for every word of a 20-byte header
+  uint8_t header[20];
+  for (uint32_t j = 0; j < 20; j++)
+    {
+      header[j] = NextByte ();
+    }
+  for (uint32_t word = 0; word < 10; word++)
+    {
+      for (uint32_t n = 0; n < 64; n++)
+        {
+          uint16_t checksum = ReferenceChecksum (header, 20, 0);
+          uint16_t oldWord = header[2 * word] | (header[2 * word + 1] << 8);
+          header[2 * word] = NextByte ();
+          header[2 * word + 1] = (n & 1) ? header[2 * word + 1] : NextByte ();
+          uint16_t newWord = header[2 * word] | (header[2 * word + 1] << 8);
+          uint16_t updated = IpChecksumUpdate (checksum, oldWord, newWord);
+          NS_TEST_ASSERT_MSG_EQ (updated, ReferenceChecksum (header, 20, 0), "Bad incremental checksum update");
+          NS_TEST_ASSERT_MSG_EQ (ReferenceChecksum (header, 20, updated), 0, "Updated checksum does not verify");
+        }
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +532,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
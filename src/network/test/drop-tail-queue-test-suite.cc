@@ -19,6 +19,7 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/uinteger.h"
+#include <list>
 
 using namespace ns3;
 
@@ -83,6 +84,71 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the FIFO order is preserved while the ring buffer storing the
+ * items of a DropTailQueue wraps around and grows.
+ */
+class DropTailQueueRingTestCase : public TestCase
+{
+public:
+  DropTailQueueRingTestCase ();
+  virtual void DoRun (void);
+};
+
+DropTailQueueRingTestCase::DropTailQueueRingTestCase ()
+  : TestCase ("Check the FIFO order across wrap-around and growth of the drop tail queue storage")
+{
+}
+void
+DropTailQueueRingTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (1000));
+
+  std::list<Ptr<Packet> > expected;
+  // interleave enqueue and dequeue operations so that the head of the
+  // ring moves while the occupancy grows beyond the initial capacity
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      for (uint32_t j = 0; j < 3; j++)
+        {
+          Ptr<Packet> p = Create<Packet> (i + 1);
+          NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (p), true, "The queue should accept the packet");
+          expected.push_back (p);
+        }
+      Ptr<Packet> packet = queue->Dequeue ();
+      NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), expected.front ()->GetUid (), "Wrong dequeue order");
+      expected.pop_front ();
+      NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), expected.size (), "Wrong number of packets");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->Peek ()->GetUid (), expected.front ()->GetUid (), "Wrong head of line packet");
+
+  Ptr<Packet> packet = queue->Remove ();
+  NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), expected.front ()->GetUid (), "Wrong removed packet");
+  expected.pop_front ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 1, "The removed packet should be counted as dropped");
+
+  uint32_t bytes = 0;
+  for (std::list<Ptr<Packet> >::const_iterator i = expected.begin (); i != expected.end (); i++)
+    {
+      bytes += (*i)->GetSize ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), bytes, "Wrong number of bytes");
+
+  while (!expected.empty ())
+    {
+      packet = queue->Dequeue ();
+      NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), expected.front ()->GetUid (), "Wrong dequeue order");
+      expected.pop_front ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0, "The queue should be empty");
+  NS_TEST_EXPECT_MSG_EQ ((queue->Peek () == 0), true, "There are really no packets in there");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -96,6 +162,7 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueRingTestCase (), TestCase::QUICK);
   }
 };
 
@@ -731,6 +731,36 @@ PacketTest::DoRun (void)
     CHECK (tmp, 1, E (25, 0, 50));
   }
 
+  /* Test merging of adjacent byte tags carrying identical data. */
+  {
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp->AddByteTag (ATestTag<20> (1));
+    Ptr<Packet> a = Create<Packet> (50);
+    a->AddByteTag (ATestTag<20> (1));
+    Ptr<Packet> b = Create<Packet> (50);
+    b->AddByteTag (ATestTag<20> (1));
+    Ptr<const Packet> copy = tmp->Copy ();
+    tmp->AddAtEnd (a);
+    CHECK (tmp, 1, E (20, 0, 150));
+    CHECK (copy, 1, E (20, 0, 100));
+    tmp->AddAtEnd (b);
+    CHECK (tmp, 1, E (20, 0, 200));
+    CHECK (a, 1, E (20, 0, 50));
+
+    Ptr<Packet> frag = tmp->CreateFragment (50, 100);
+    CHECK (frag, 1, E (20, 0, 100));
+
+    Ptr<Packet> c = Create<Packet> (50);
+    c->AddByteTag (ATestTag<20> (2));
+    tmp->AddAtEnd (c);
+    CHECK (tmp, 2, E (20, 0, 200), E (20, 200, 250));
+
+    Ptr<Packet> d = Create<Packet> (50);
+    d->AddByteTag (ATestTag<21> (2));
+    tmp->AddAtEnd (d);
+    CHECK (tmp, 3, E (20, 0, 200), E (20, 200, 250), E (21, 250, 300));
+  }
+
   /* Test ALargeTestTag */
   {
     Ptr<Packet> tmp = Create<Packet> (0);
@@ -20,6 +20,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <sstream>
+#include <fstream>
 #include <cstring>
 
 #include "ns3/log.h"
@@ -1144,6 +1145,94 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that a pcap file written from a background
+ * thread is identical to the same file written synchronously.
+ */
+class AsyncWriteTestCase : public TestCase
+{
+public:
+  AsyncWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Write the test records to a pcap file
+   * \param filename the name of the file
+   * \param async whether the records are written by a background thread
+   */
+  void WriteFile (std::string filename, bool async);
+
+  /**
+   * \param filename the name of the file
+   * \return the content of the file
+   */
+  std::string ReadFile (std::string filename);
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase ()
+  : TestCase ("Check that PcapFile writes the same file from a background thread")
+{
+}
+
+void
+AsyncWriteTestCase::WriteFile (std::string filename, bool async)
+{
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1, 1000);
+  if (async)
+    {
+      // a small buffer, so that the writer thread is often behind
+      f.EnableAsyncWrite (8192);
+      NS_TEST_EXPECT_MSG_EQ (f.IsAsyncWrite (), true, "Asynchronous writes not enabled");
+    }
+
+  uint8_t data[1500];
+  for (uint32_t i = 0; i < sizeof (data); ++i)
+    {
+      data[i] = i & 0xff;
+    }
+  for (uint32_t i = 0; i < 5000; ++i)
+    {
+      f.Write (i / 1000, i % 1000, data, (i * 7) % sizeof (data));
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Write must not fail");
+    }
+  f.Close ();
+}
+
+std::string
+AsyncWriteTestCase::ReadFile (std::string filename)
+{
+  std::ifstream in (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream content;
+  content << in.rdbuf ();
+  return content.str ();
+}
+
+void
+AsyncWriteTestCase::DoRun (void)
+{
+  std::string syncFilename = CreateTempDirFilename ("sync.pcap");
+  std::string asyncFilename = CreateTempDirFilename ("async.pcap");
+  WriteFile (syncFilename, false);
+  WriteFile (asyncFilename, true);
+
+  std::string syncContent = ReadFile (syncFilename);
+  std::string asyncContent = ReadFile (asyncFilename);
+  NS_TEST_ASSERT_MSG_GT (syncContent.size (), 24, "Records missing from the synchronous file");
+  NS_TEST_EXPECT_MSG_EQ (asyncContent.size (), syncContent.size (), "Files have different sizes");
+  NS_TEST_EXPECT_MSG_EQ ((asyncContent == syncContent), true, "Files have different contents");
+
+  remove (syncFilename.c_str ());
+  remove (asyncFilename.c_str ());
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1165,6 +1254,7 @@ PcapFileTestSuite::PcapFileTestSuite ()
   //AddTestCase (new AppendModeCreateTestCase, TestCase::QUICK);
   AddTestCase (new FileHeaderTestCase, TestCase::QUICK);
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncWriteTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
 }
@@ -0,0 +1,292 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "ns3/test.h"
+#include "ns3/pcapng-file.h"
+#include "ns3/network-config.h"
+#include "ns3/trace-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/node.h"
+#include "ns3/names.h"
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case checking the blocks of a pcapng file holding the packets
+ * of two interfaces, and that the compressed file holds the same blocks.
+ */
+class PcapNgFileTestCase : public TestCase
+{
+public:
+  PcapNgFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Write the test file
+   * \param filename the name of the file
+   * \param compression the compression of the file
+   */
+  void WriteFile (std::string filename, PcapNgFile::Compression compression);
+
+  /**
+   * \param data the file content
+   * \param offset the offset of the value
+   * \return the 32 bit value at the given offset
+   */
+  uint32_t Get32 (std::string const &data, uint32_t offset);
+
+  /**
+   * \param data the file content
+   * \param offset the offset of the value
+   * \return the 16 bit value at the given offset
+   */
+  uint16_t Get16 (std::string const &data, uint32_t offset);
+};
+
+PcapNgFileTestCase::PcapNgFileTestCase ()
+  : TestCase ("Check the blocks written to a pcapng file")
+{
+}
+
+uint32_t
+PcapNgFileTestCase::Get32 (std::string const &data, uint32_t offset)
+{
+  uint32_t value;
+  std::memcpy (&value, data.data () + offset, sizeof (value));
+  return value;
+}
+
+uint16_t
+PcapNgFileTestCase::Get16 (std::string const &data, uint32_t offset)
+{
+  uint16_t value;
+  std::memcpy (&value, data.data () + offset, sizeof (value));
+  return value;
+}
+
+void
+PcapNgFileTestCase::WriteFile (std::string filename, PcapNgFile::Compression compression)
+{
+  PcapNgFile f;
+  f.Open (filename, compression);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ") returns error");
+
+  NS_TEST_EXPECT_MSG_EQ (f.AddInterface (9, 100, "0-1", "ns3::PointToPointNetDevice"), 0, "Wrong interface index");
+  NS_TEST_EXPECT_MSG_EQ (f.AddInterface (1, 1000, "node", ""), 1, "Wrong interface index");
+  NS_TEST_EXPECT_MSG_EQ (f.GetNInterfaces (), 2, "Wrong number of interfaces");
+
+  uint8_t data[200];
+  for (uint32_t i = 0; i < sizeof (data); ++i)
+    {
+      data[i] = i;
+    }
+  // truncated to the snap length of interface 0
+  f.Write (0, 5000000123ULL, data, 150);
+  // padded to 32 bits
+  f.Write (1, 7, data, 5);
+  f.Close ();
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+}
+
+void
+PcapNgFileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("test.pcapng");
+  WriteFile (filename, PcapNgFile::NONE);
+
+  std::ifstream in (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream content;
+  content << in.rdbuf ();
+  std::string data = content.str ();
+  remove (filename.c_str ());
+
+  // Section Header Block, with the shb_userappl and end of options
+  uint32_t offset = 0;
+  NS_TEST_ASSERT_MSG_GT (data.size (), 28, "File too short");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, 0), 0x0a0d0d0a, "Wrong SHB type");
+  uint32_t length = Get32 (data, 4);
+  NS_TEST_EXPECT_MSG_EQ (length, 24 + 8 + 4 + 4, "Wrong SHB length");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, 8), 0x1a2b3c4d, "Wrong byte order magic");
+  NS_TEST_EXPECT_MSG_EQ (Get16 (data, 12), 1, "Wrong major version");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, length - 4), length, "Wrong SHB trailing length");
+  offset += length;
+
+  // Interface Description Block of interface 0: if_name, if_description,
+  // if_tsresol and end of options
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset), 1, "Wrong IDB type");
+  length = Get32 (data, offset + 4);
+  NS_TEST_EXPECT_MSG_EQ (length, 16 + 8 + 32 + 8 + 4 + 4, "Wrong IDB length");
+  NS_TEST_EXPECT_MSG_EQ (Get16 (data, offset + 8), 9, "Wrong link type");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 12), 100, "Wrong snap length");
+  NS_TEST_EXPECT_MSG_EQ (Get16 (data, offset + 16), 2, "Wrong if_name code");
+  NS_TEST_EXPECT_MSG_EQ (Get16 (data, offset + 18), 3, "Wrong if_name length");
+  NS_TEST_EXPECT_MSG_EQ (data.substr (offset + 20, 3), "0-1", "Wrong if_name");
+  NS_TEST_EXPECT_MSG_EQ (Get16 (data, offset + 24), 3, "Wrong if_description code");
+  NS_TEST_EXPECT_MSG_EQ (Get16 (data, offset + 56), 9, "Wrong if_tsresol code");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (data[offset + 60]), 9, "Timestamps must be in nanoseconds");
+  offset += length;
+
+  // Interface Description Block of interface 1, without description
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset), 1, "Wrong IDB type");
+  length = Get32 (data, offset + 4);
+  NS_TEST_EXPECT_MSG_EQ (length, 16 + 8 + 8 + 4 + 4, "Wrong IDB length");
+  NS_TEST_EXPECT_MSG_EQ (Get16 (data, offset + 8), 1, "Wrong link type");
+  offset += length;
+
+  // Enhanced Packet Block truncated to the snap length
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset), 6, "Wrong EPB type");
+  length = Get32 (data, offset + 4);
+  NS_TEST_EXPECT_MSG_EQ (length, 32 + 100, "Wrong EPB length");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 8), 0, "Wrong interface");
+  uint64_t ts = (static_cast<uint64_t> (Get32 (data, offset + 12)) << 32) + Get32 (data, offset + 16);
+  NS_TEST_EXPECT_MSG_EQ (ts, 5000000123ULL, "Wrong timestamp");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 20), 100, "Wrong captured length");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 24), 150, "Wrong original length");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (static_cast<uint8_t> (data[offset + 28 + 99])), 99, "Wrong packet data");
+  offset += length;
+
+  // Enhanced Packet Block with padded data
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset), 6, "Wrong EPB type");
+  length = Get32 (data, offset + 4);
+  NS_TEST_EXPECT_MSG_EQ (length, 32 + 8, "Wrong EPB length");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + 8), 1, "Wrong interface");
+  NS_TEST_EXPECT_MSG_EQ (Get32 (data, offset + length - 4), length, "Wrong EPB trailing length");
+  offset += length;
+  NS_TEST_EXPECT_MSG_EQ (offset, data.size (), "Unexpected data at the end of the file");
+
+#ifdef HAVE_ZLIB_H
+  NS_TEST_EXPECT_MSG_EQ (PcapNgFile::IsCompressionSupported (PcapNgFile::GZIP), true, "gzip must be supported");
+  std::string gzFilename = CreateTempDirFilename ("test.pcapng.gz");
+  WriteFile (gzFilename, PcapNgFile::GZIP);
+  gzFile gz = gzopen (gzFilename.c_str (), "rb");
+  NS_TEST_ASSERT_MSG_NE (gz, 0, "Unable to open the compressed file");
+  std::string uncompressed (data.size () + 1, 0);
+  int read = gzread (gz, &uncompressed[0], uncompressed.size ());
+  gzclose (gz);
+  remove (gzFilename.c_str ());
+  NS_TEST_EXPECT_MSG_EQ (read, static_cast<int> (data.size ()), "Wrong uncompressed size");
+  uncompressed.resize (data.size ());
+  NS_TEST_EXPECT_MSG_EQ ((uncompressed == data), true, "Compressed file holds different blocks");
+#endif /* HAVE_ZLIB_H */
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case checking the names given by the pcap helper to the
+ * interfaces of the devices it adds to a pcapng file.
+ */
+class PcapNgInterfaceNameTestCase : public TestCase
+{
+public:
+  PcapNgInterfaceNameTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapNgInterfaceNameTestCase::PcapNgInterfaceNameTestCase ()
+  : TestCase ("Check the names of the pcapng interfaces added by the pcap helper")
+{
+}
+
+void
+PcapNgInterfaceNameTestCase::DoRun (void)
+{
+  Ptr<Node> named = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> namedDevice = CreateObject<SimpleNetDevice> ();
+  named->AddDevice (namedDevice);
+  Names::Add ("server", named);
+  Names::Add ("server/eth0", namedDevice);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  node->AddDevice (CreateObject<SimpleNetDevice> ());
+  node->AddDevice (device);
+
+  std::string filename = CreateTempDirFilename ("names.pcapng");
+  PcapHelper helper;
+  Ptr<PcapNgFileWrapper> file = helper.CreateNgFile (filename);
+  helper.AddNgInterface (file, namedDevice, PcapHelper::DLT_EN10MB, "PhyRxDrop");
+  helper.AddNgInterface (file, namedDevice, PcapHelper::DLT_EN10MB, "PhyRxDrop", false);
+  helper.AddNgInterface (file, device, PcapHelper::DLT_EN10MB, "PhyRxDrop");
+  file->Close ();
+  Names::Clear ();
+
+  std::ifstream in (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream content;
+  content << in.rdbuf ();
+  std::string data = content.str ();
+  remove (filename.c_str ());
+
+  std::string expected[] = { "server-eth0",
+                             std::to_string (named->GetId ()) + "-0",
+                             std::to_string (node->GetId ()) + "-1" };
+
+  // skip the Section Header Block: the if_name option opens each Interface
+  // Description Block
+  uint32_t length;
+  NS_TEST_ASSERT_MSG_GT (data.size (), 8, "File too short");
+  std::memcpy (&length, data.data () + 4, sizeof (length));
+  uint32_t offset = length;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      NS_TEST_ASSERT_MSG_GT (data.size (), offset + 20, "File too short");
+      uint32_t type;
+      uint16_t nameLength;
+      std::memcpy (&type, data.data () + offset, sizeof (type));
+      std::memcpy (&length, data.data () + offset + 4, sizeof (length));
+      std::memcpy (&nameLength, data.data () + offset + 18, sizeof (nameLength));
+      NS_TEST_EXPECT_MSG_EQ (type, 1, "Wrong IDB type");
+      NS_TEST_EXPECT_MSG_EQ (data.substr (offset + 20, nameLength), expected[i], "Wrong if_name of interface " << i);
+      offset += length;
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PCAPNG file TestSuite
+ */
+class PcapNgFileTestSuite : public TestSuite
+{
+public:
+  PcapNgFileTestSuite ();
+};
+
+PcapNgFileTestSuite::PcapNgFileTestSuite ()
+  : TestSuite ("pcapng-file", UNIT)
+{
+  AddTestCase (new PcapNgFileTestCase, TestCase::QUICK);
+  AddTestCase (new PcapNgInterfaceNameTestCase, TestCase::QUICK);
+}
+
+static PcapNgFileTestSuite pcapNgFileTestSuite; //!< Static variable for test initialization
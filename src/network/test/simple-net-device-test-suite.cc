@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/data-rate.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/net-device-container.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief SimpleNetDevice DataRate Test
+ *
+ * Packets of 1000 bytes are sent over an 8 Mb/s link, so each one holds
+ * the link for 1 ms. Two packets are sent at 0 ms and a third one at
+ * 1.5 ms, while the second one is still being transmitted although the
+ * device queue is already empty. The third packet must wait until the
+ * link is free, at 2 ms.
+ */
+class SimpleNetDeviceDataRateTest : public TestCase
+{
+  Ptr<SimpleNetDevice> m_txDevice;  //!< Sending device
+  std::vector<Time> m_rxTimes;      //!< Times at which the packets are received
+
+  /**
+   * Send a packet
+   */
+  void SendPacket (void);
+
+  /**
+   * Receive a packet
+   * \param device The receiving device
+   * \param packet The packet
+   * \param protocol The protocol number
+   * \param from The sender address
+   * \returns true
+   */
+  bool ReceivePacket (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+public:
+  virtual void DoRun (void);
+  SimpleNetDeviceDataRateTest ();
+};
+
+SimpleNetDeviceDataRateTest::SimpleNetDeviceDataRateTest ()
+  : TestCase ("SimpleNetDevice holds the link for the transmission time of every packet")
+{
+}
+
+void
+SimpleNetDeviceDataRateTest::SendPacket (void)
+{
+  m_txDevice->Send (Create<Packet> (1000), Mac48Address::GetBroadcast (), 0x800);
+}
+
+bool
+SimpleNetDeviceDataRateTest::ReceivePacket (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+void
+SimpleNetDeviceDataRateTest::DoRun (void)
+{
+  Ptr<Node> txNode = CreateObject<Node> ();
+  Ptr<Node> rxNode = CreateObject<Node> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+
+  SimpleNetDeviceHelper helper;
+  helper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("8Mbps")));
+  m_txDevice = DynamicCast<SimpleNetDevice> (helper.Install (txNode, channel).Get (0));
+  Ptr<NetDevice> rxDevice = helper.Install (rxNode, channel).Get (0);
+  rxDevice->SetReceiveCallback (MakeCallback (&SimpleNetDeviceDataRateTest::ReceivePacket, this));
+
+  Simulator::Schedule (Seconds (0), &SimpleNetDeviceDataRateTest::SendPacket, this);
+  Simulator::Schedule (Seconds (0), &SimpleNetDeviceDataRateTest::SendPacket, this);
+  Simulator::Schedule (MicroSeconds (1500), &SimpleNetDeviceDataRateTest::SendPacket, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 3, "All the packets should be received");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[0], MilliSeconds (0), "The first packet should be sent at once");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[1], MilliSeconds (1), "The second packet should wait for the first one");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[2], MilliSeconds (2), "The third packet should wait for the second one");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief SimpleNetDevice TestSuite
+ */
+class SimpleNetDeviceTestSuite : public TestSuite
+{
+public:
+  SimpleNetDeviceTestSuite ();
+};
+
+SimpleNetDeviceTestSuite::SimpleNetDeviceTestSuite ()
+  : TestSuite ("simple-net-device", UNIT)
+{
+  AddTestCase (new SimpleNetDeviceDataRateTest, TestCase::QUICK);
+}
+
+static SimpleNetDeviceTestSuite g_simpleNetDeviceTestSuite; //!< Static variable for test initialization
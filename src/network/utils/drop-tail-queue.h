@@ -20,6 +20,7 @@
 #define DROPTAIL_H
 
 #include "ns3/queue.h"
+#include "ns3/ring-buffer.h"
 
 namespace ns3 {
 
@@ -27,6 +28,10 @@ namespace ns3 {
  * \ingroup queue
  *
  * \brief A FIFO packet queue that drops tail-end packets on overflow
+ *
+ * Items are stored in a RingBuffer rather than in the list provided by the
+ * Queue base class, so that enqueue and dequeue operations do not allocate
+ * memory once the queue has reached its steady state occupancy.
  */
 template <typename Item>
 class DropTailQueue : public Queue<Item>
@@ -52,12 +57,13 @@ public:
   virtual Ptr<const Item> Peek (void) const;
 
 private:
-  using Queue<Item>::Head;
-  using Queue<Item>::Tail;
-  using Queue<Item>::DoEnqueue;
-  using Queue<Item>::DoDequeue;
-  using Queue<Item>::DoRemove;
-  using Queue<Item>::DoPeek;
+  using Queue<Item>::WouldOverflow;
+  using Queue<Item>::NotifyEnqueue;
+  using Queue<Item>::NotifyDequeue;
+  using Queue<Item>::NotifyRemove;
+  using Queue<Item>::DropBeforeEnqueue;
+
+  RingBuffer<Ptr<Item> > m_items; //!< the items in the queue
 };
 
 
@@ -96,7 +102,16 @@ DropTailQueue<Item>::Enqueue (Ptr<Item> item)
 {
   QUEUE_LOG (LOG_LOGIC, "DropTailQueue:Enqueue(" << this << ", " << item << ")");
 
-  return DoEnqueue (Tail (), item);
+  if (WouldOverflow (item))
+    {
+      DropBeforeEnqueue (item);
+      return false;
+    }
+
+  m_items.PushBack (item);
+  NotifyEnqueue (item);
+
+  return true;
 }
 
 template <typename Item>
@@ -105,7 +120,14 @@ DropTailQueue<Item>::Dequeue (void)
 {
   QUEUE_LOG (LOG_LOGIC, "DropTailQueue:Dequeue(" << this << ")");
 
-  Ptr<Item> item = DoDequeue (Head ());
+  if (m_items.IsEmpty ())
+    {
+      QUEUE_LOG (LOG_LOGIC, "Queue empty");
+      return 0;
+    }
+
+  Ptr<Item> item = m_items.PopFront ();
+  NotifyDequeue (item);
 
   QUEUE_LOG (LOG_LOGIC, "Popped " << item);
 
@@ -118,7 +140,14 @@ DropTailQueue<Item>::Remove (void)
 {
   QUEUE_LOG (LOG_LOGIC, "DropTailQueue:Remove(" << this << ")");
 
-  Ptr<Item> item = DoRemove (Head ());
+  if (m_items.IsEmpty ())
+    {
+      QUEUE_LOG (LOG_LOGIC, "Queue empty");
+      return 0;
+    }
+
+  Ptr<Item> item = m_items.PopFront ();
+  NotifyRemove (item);
 
   QUEUE_LOG (LOG_LOGIC, "Removed " << item);
 
@@ -131,7 +160,13 @@ DropTailQueue<Item>::Peek (void) const
 {
   QUEUE_LOG (LOG_LOGIC, "DropTailQueue:Peek(" << this << ")");
 
-  return DoPeek (Head ());
+  if (m_items.IsEmpty ())
+    {
+      QUEUE_LOG (LOG_LOGIC, "Queue empty");
+      return 0;
+    }
+
+  return m_items.Front ();
 }
 
 } // namespace ns3
@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ip-checksum.h"
+#include <cstring>
+
+#if defined (__AVX2__) || defined (__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * The one's complement sum does not depend on the byte order of the
+ * words which are added together (RFC 1071, section 2.B), so all the
+ * kernels below load host-order words, accumulate them in 64 bits and
+ * convert the folded result to the little-endian order of
+ * Buffer::Iterator::ReadU16 at the very end.  32-bit words are summed
+ * rather than 16-bit words: folding the carries later gives the same
+ * result (RFC 1071, section 2.C).
+ */
+
+namespace {
+
+/**
+ * \param p the first byte of the word
+ * \returns the host-order 32-bit word starting at p
+ */
+inline uint64_t
+Load32 (const uint8_t *p)
+{
+  uint32_t word;
+  std::memcpy (&word, p, 4);
+  return word;
+}
+
+/**
+ * \brief Add a span to a 64-bit one's complement accumulator, a 32-bit
+ * word at a time.
+ * \param data the first byte of the span
+ * \param size the number of bytes in the span
+ * \param sum the accumulator
+ * \returns the updated accumulator
+ */
+uint64_t
+SumScalar (const uint8_t *data, uint32_t size, uint64_t sum)
+{
+  while (size >= 16)
+    {
+      sum += Load32 (data) + Load32 (data + 4) + Load32 (data + 8) + Load32 (data + 12);
+      data += 16;
+      size -= 16;
+    }
+  while (size >= 4)
+    {
+      sum += Load32 (data);
+      data += 4;
+      size -= 4;
+    }
+  if (size >= 2)
+    {
+      uint16_t word;
+      std::memcpy (&word, data, 2);
+      sum += word;
+      data += 2;
+      size -= 2;
+    }
+  if (size > 0)
+    {
+      // an odd trailing byte is padded with a zero byte
+      uint16_t word = 0;
+      std::memcpy (&word, data, 1);
+      sum += word;
+    }
+  return sum;
+}
+
+#if defined (__AVX2__)
+/**
+ * \brief Add a span to a 64-bit one's complement accumulator, 32 bytes
+ * at a time.
+ * \param data the first byte of the span
+ * \param size the number of bytes in the span
+ * \param sum the accumulator
+ * \returns the updated accumulator
+ */
+uint64_t
+SumVector (const uint8_t *data, uint32_t size, uint64_t sum)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  __m256i acc = zero;
+  while (size >= 32)
+    {
+      __m256i v = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data));
+      // widen the 32-bit words to 64 bits so that no carry is lost
+      acc = _mm256_add_epi64 (acc, _mm256_unpacklo_epi32 (v, zero));
+      acc = _mm256_add_epi64 (acc, _mm256_unpackhi_epi32 (v, zero));
+      data += 32;
+      size -= 32;
+    }
+  uint64_t lanes[4];
+  _mm256_storeu_si256 (reinterpret_cast<__m256i *> (lanes), acc);
+  sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  return SumScalar (data, size, sum);
+}
+#elif defined (__SSE2__)
+/**
+ * \brief Add a span to a 64-bit one's complement accumulator, 16 bytes
+ * at a time.
+ * \param data the first byte of the span
+ * \param size the number of bytes in the span
+ * \param sum the accumulator
+ * \returns the updated accumulator
+ */
+uint64_t
+SumVector (const uint8_t *data, uint32_t size, uint64_t sum)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128i acc = zero;
+  while (size >= 16)
+    {
+      __m128i v = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data));
+      // widen the 32-bit words to 64 bits so that no carry is lost
+      acc = _mm_add_epi64 (acc, _mm_unpacklo_epi32 (v, zero));
+      acc = _mm_add_epi64 (acc, _mm_unpackhi_epi32 (v, zero));
+      data += 16;
+      size -= 16;
+    }
+  uint64_t lanes[2];
+  _mm_storeu_si128 (reinterpret_cast<__m128i *> (lanes), acc);
+  sum += lanes[0] + lanes[1];
+  return SumScalar (data, size, sum);
+}
+#else
+/**
+ * \brief Add a span to a 64-bit one's complement accumulator.
+ * \param data the first byte of the span
+ * \param size the number of bytes in the span
+ * \param sum the accumulator
+ * \returns the updated accumulator
+ */
+inline uint64_t
+SumVector (const uint8_t *data, uint32_t size, uint64_t sum)
+{
+  return SumScalar (data, size, sum);
+}
+#endif
+
+/**
+ * \param sum a 64-bit one's complement accumulator
+ * \returns the accumulator folded to 16 bits
+ */
+inline uint16_t
+Fold (uint64_t sum)
+{
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return static_cast<uint16_t> (sum);
+}
+
+} // anonymous namespace
+
+namespace ns3 {
+
+uint16_t
+IpChecksumAccumulate (const uint8_t *data, uint32_t size)
+{
+  uint16_t folded = Fold (SumVector (data, size, 0));
+  uint8_t bytes[2];
+  std::memcpy (bytes, &folded, 2);
+  return bytes[0] | (bytes[1] << 8);
+}
+
+uint16_t
+IpChecksumUpdate (uint16_t checksum, uint16_t oldWord, uint16_t newWord)
+{
+  // HC' = ~(~HC + ~m + m')
+  uint32_t sum = static_cast<uint16_t> (~checksum);
+  sum += static_cast<uint16_t> (~oldWord);
+  sum += newWord;
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return ~sum;
+}
+
+} // namespace ns3
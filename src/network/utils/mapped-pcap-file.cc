@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "mapped-pcap-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MappedPcapFile");
+
+const uint32_t MAGIC = 0xa1b2c3d4;            /**< Magic number identifying standard pcap file format */
+const uint32_t SWAPPED_MAGIC = 0xd4c3b2a1;    /**< Looks this way if byte swapping is required */
+
+const uint32_t NS_MAGIC = 0xa1b23c4d;         /**< Magic number identifying nanosec resolution pcap file format */
+const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swapping is required */
+
+const std::size_t FILE_HEADER_SIZE = 24;      /**< Size of the pcap file header */
+const std::size_t RECORD_HEADER_SIZE = 16;    /**< Size of a pcap record header */
+
+MappedPcapFile::Iterator::Iterator ()
+  : m_file (0),
+    m_offset (0),
+    m_prefetched (0)
+{
+  m_record.inclLen = 0;
+  m_record.origLen = 0;
+  m_record.data = 0;
+}
+
+MappedPcapFile::Iterator::Iterator (const MappedPcapFile *file, std::size_t offset)
+  : m_file (file),
+    m_offset (offset),
+    m_prefetched (0)
+{
+  Load ();
+}
+
+const MappedPcapFile::Record &
+MappedPcapFile::Iterator::operator * (void) const
+{
+  return m_record;
+}
+
+const MappedPcapFile::Record *
+MappedPcapFile::Iterator::operator -> (void) const
+{
+  return &m_record;
+}
+
+MappedPcapFile::Iterator &
+MappedPcapFile::Iterator::operator ++ (void)
+{
+  NS_ASSERT (m_offset < m_file->m_size);
+  m_offset += RECORD_HEADER_SIZE + m_record.inclLen;
+  Load ();
+  return *this;
+}
+
+bool
+MappedPcapFile::Iterator::operator == (const Iterator &o) const
+{
+  return m_file == o.m_file && m_offset == o.m_offset;
+}
+
+bool
+MappedPcapFile::Iterator::operator != (const Iterator &o) const
+{
+  return !(*this == o);
+}
+
+void
+MappedPcapFile::Iterator::Load (void)
+{
+  std::size_t size = m_file->m_size;
+  if (m_offset + RECORD_HEADER_SIZE > size)
+    {
+      if (m_offset != size)
+        {
+          NS_LOG_WARN ("Truncated record header at offset " << m_offset);
+        }
+      m_offset = size;
+      return;
+    }
+  uint32_t tsSec = m_file->Read32 (m_offset);
+  uint32_t tsFrac = m_file->Read32 (m_offset + 4);
+  m_record.inclLen = m_file->Read32 (m_offset + 8);
+  m_record.origLen = m_file->Read32 (m_offset + 12);
+  if (m_record.inclLen > size - m_offset - RECORD_HEADER_SIZE)
+    {
+      NS_LOG_WARN ("Truncated record at offset " << m_offset);
+      m_offset = size;
+      return;
+    }
+  m_record.data = m_file->m_base + m_offset + RECORD_HEADER_SIZE;
+  if (m_file->m_nanosecMode)
+    {
+      m_record.timestamp = NanoSeconds (tsSec * 1000000000ULL + tsFrac);
+    }
+  else
+    {
+      m_record.timestamp = MicroSeconds (tsSec * 1000000ULL + tsFrac);
+    }
+
+  std::size_t next = m_offset + RECORD_HEADER_SIZE + m_record.inclLen;
+  if (next + PREFETCH_WINDOW / 2 > m_prefetched && m_prefetched < size)
+    {
+      m_prefetched = m_file->Prefetch (std::max (next, m_prefetched));
+    }
+#ifdef __GNUC__
+  if (next < size)
+    {
+      __builtin_prefetch (m_file->m_base + next);
+    }
+#endif
+}
+
+MappedPcapFile::MappedPcapFile ()
+  : m_base (0),
+    m_size (0),
+    m_swapMode (false),
+    m_nanosecMode (false),
+    m_snapLen (0),
+    m_dataLinkType (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MappedPcapFile::~MappedPcapFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+MappedPcapFile::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_LOG_ERROR ("Unable to open " << filename);
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || static_cast<std::size_t> (st.st_size) < FILE_HEADER_SIZE)
+    {
+      NS_LOG_ERROR (filename << " is not a pcap file");
+      close (fd);
+      return false;
+    }
+  void *base = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping remains valid once the descriptor is closed
+  close (fd);
+  if (base == MAP_FAILED)
+    {
+      NS_LOG_ERROR ("Unable to map " << filename);
+      return false;
+    }
+  madvise (base, st.st_size, MADV_SEQUENTIAL);
+  m_base = static_cast<const uint8_t *> (base);
+  m_size = st.st_size;
+
+  uint32_t magic;
+  std::memcpy (&magic, m_base, sizeof (magic));
+  m_swapMode = (magic == SWAPPED_MAGIC || magic == NS_SWAPPED_MAGIC);
+  m_nanosecMode = (magic == NS_MAGIC || magic == NS_SWAPPED_MAGIC);
+  if (magic != MAGIC && magic != NS_MAGIC && !m_swapMode)
+    {
+      NS_LOG_ERROR (filename << " is not a pcap file");
+      Close ();
+      return false;
+    }
+  m_snapLen = Read32 (16);
+  m_dataLinkType = Read32 (20);
+  return true;
+}
+
+void
+MappedPcapFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_base != 0)
+    {
+      munmap (const_cast<uint8_t *> (m_base), m_size);
+      m_base = 0;
+      m_size = 0;
+    }
+}
+
+bool
+MappedPcapFile::IsOpen (void) const
+{
+  return m_base != 0;
+}
+
+uint32_t
+MappedPcapFile::GetDataLinkType (void) const
+{
+  return m_dataLinkType;
+}
+
+uint32_t
+MappedPcapFile::GetSnapLen (void) const
+{
+  return m_snapLen;
+}
+
+bool
+MappedPcapFile::IsNanoSecMode (void) const
+{
+  return m_nanosecMode;
+}
+
+bool
+MappedPcapFile::GetSwapMode (void) const
+{
+  return m_swapMode;
+}
+
+MappedPcapFile::Iterator
+MappedPcapFile::Begin (void) const
+{
+  NS_ASSERT (IsOpen ());
+  return Iterator (this, FILE_HEADER_SIZE);
+}
+
+MappedPcapFile::Iterator
+MappedPcapFile::End (void) const
+{
+  NS_ASSERT (IsOpen ());
+  return Iterator (this, m_size);
+}
+
+uint32_t
+MappedPcapFile::Read32 (std::size_t offset) const
+{
+  uint32_t value;
+  std::memcpy (&value, m_base + offset, sizeof (value));
+  if (m_swapMode)
+    {
+      value = ((value >> 24) & 0x000000ff) | ((value >> 8) & 0x0000ff00)
+        | ((value << 8) & 0x00ff0000) | ((value << 24) & 0xff000000);
+    }
+  return value;
+}
+
+std::size_t
+MappedPcapFile::Prefetch (std::size_t offset) const
+{
+  std::size_t pageSize = sysconf (_SC_PAGESIZE);
+  std::size_t start = offset & ~(pageSize - 1);
+  std::size_t end = std::min (offset + PREFETCH_WINDOW, m_size);
+  madvise (const_cast<uint8_t *> (m_base) + start, end - start, MADV_WILLNEED);
+  return end;
+}
+
+} // namespace ns3
@@ -46,6 +46,16 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("AsyncWrite",
+                   "Whether the packet records are written to the file by a background thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_asyncWrite),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AsyncBufferSize",
+                   "Maximum number of bytes buffered in memory when AsyncWrite is enabled.",
+                   UintegerValue (PcapFile::ASYNC_BUFFER_DEFAULT),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_asyncBufferSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -113,6 +123,10 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
     {
       m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
     } 
+  if (m_asyncWrite)
+    {
+      m_file.EnableAsyncWrite (m_asyncBufferSize);
+    }
 }
 
 void
@@ -224,6 +224,8 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_asyncWrite; //!< Write the packet records from a background thread
+  uint32_t m_asyncBufferSize; //!< Memory bound of the background writer
 };
 
 } // namespace ns3
@@ -29,6 +29,13 @@
 #include "pcap-file.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <list>
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#endif
 //
 // This file is used as part of the ns-3 test framework, so please refrain from 
 // adding any ns-3 specific constructs such as Packet to this file.
@@ -47,8 +54,269 @@ const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 
+#ifdef HAVE_PTHREAD_H
+
+/**
+ * \brief Stream buffer handing the bytes written to a PcapFile over to a
+ *        background thread
+ *
+ * Bytes are accumulated in fixed size chunks. Full chunks are queued and
+ * written, in order, to the buffer of the underlying file by a writer
+ * thread. Chunks are recycled, so that the memory used never exceeds the
+ * requested bound; the writing thread blocks when all the chunks are
+ * waiting to be written.
+ */
+class PcapAsyncWriteBuffer : public std::streambuf
+{
+public:
+  /**
+   * Start the writer thread
+   * \param sink the buffer of the underlying file
+   * \param bufferSize maximum number of bytes held in memory
+   */
+  PcapAsyncWriteBuffer (std::streambuf *sink, uint32_t bufferSize);
+  virtual ~PcapAsyncWriteBuffer ();
+
+  /**
+   * Write out all the buffered bytes and stop the writer thread
+   */
+  void Close (void);
+
+protected:
+  /**
+   * Queue the current chunk once it is full and start a new one
+   * \param c the character which did not fit in the current chunk
+   * \return EOF if the writer thread failed, another value otherwise
+   */
+  virtual int_type overflow (int_type c);
+
+private:
+  /**
+   * Queue the current chunk (if not empty) for writing and make the put
+   * area point to a free chunk, waiting for one if needed
+   * \return false if the writer thread failed
+   */
+  bool Submit (void);
+
+  /**
+   * Body of the writer thread
+   */
+  void Run (void);
+
+  /// Maximum wall-clock time to wait for a condition, in nanoseconds
+  static const uint64_t WAIT_NS = 1000000;
+
+  std::streambuf *m_sink;       //!< buffer of the underlying file
+  uint32_t m_chunkSize;         //!< size of each chunk
+  uint32_t m_maxChunks;         //!< maximum number of chunks
+  uint32_t m_nChunks;           //!< number of chunks allocated so far
+  char *m_current;              //!< the chunk being filled
+  std::list<std::pair<char *, uint32_t> > m_pending; //!< chunks to write, with their used size
+  std::list<char *> m_free;     //!< chunks ready to be filled
+  bool m_stop;                  //!< whether the writer thread must exit once done
+  bool m_failed;                //!< whether writing to the file failed
+  SystemMutex m_mutex;          //!< protects the lists and the flags
+  SystemCondition m_dataReady;  //!< signalled when a chunk is queued
+  SystemCondition m_spaceReady; //!< signalled when a chunk is released
+  Ptr<SystemThread> m_thread;   //!< the writer thread
+};
+
+PcapAsyncWriteBuffer::PcapAsyncWriteBuffer (std::streambuf *sink, uint32_t bufferSize)
+  : m_sink (sink),
+    m_chunkSize (256 * 1024),
+    m_nChunks (1),
+    m_stop (false),
+    m_failed (false)
+{
+  NS_LOG_FUNCTION (this << sink << bufferSize);
+  bufferSize = std::max<uint32_t> (bufferSize, 2 * 4096);
+  m_chunkSize = std::min (m_chunkSize, bufferSize / 2);
+  m_maxChunks = bufferSize / m_chunkSize;
+  m_current = new char [m_chunkSize];
+  setp (m_current, m_current + m_chunkSize);
+  m_thread = Create<SystemThread> (MakeCallback (&PcapAsyncWriteBuffer::Run, this));
+  m_thread->Start ();
+}
+
+PcapAsyncWriteBuffer::~PcapAsyncWriteBuffer ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+PcapAsyncWriteBuffer::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_thread == 0)
+    {
+      return;
+    }
+  {
+    CriticalSection cs (m_mutex);
+    if (m_current != 0 && pptr () > pbase ())
+      {
+        m_pending.push_back (std::make_pair (m_current, static_cast<uint32_t> (pptr () - pbase ())));
+        m_current = 0;
+      }
+    m_stop = true;
+  }
+  m_dataReady.SetCondition (true);
+  m_dataReady.Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+  m_sink->pubsync ();
+
+  delete [] m_current;
+  m_current = 0;
+  setp (0, 0);
+  while (!m_free.empty ())
+    {
+      delete [] m_free.front ();
+      m_free.pop_front ();
+    }
+  while (!m_pending.empty ())
+    {
+      // only left over if the writer thread failed
+      delete [] m_pending.front ().first;
+      m_pending.pop_front ();
+    }
+}
+
+PcapAsyncWriteBuffer::int_type
+PcapAsyncWriteBuffer::overflow (int_type c)
+{
+  if (!Submit ())
+    {
+      return traits_type::eof ();
+    }
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      *pptr () = traits_type::to_char_type (c);
+      pbump (1);
+    }
+  return traits_type::not_eof (c);
+}
+
+bool
+PcapAsyncWriteBuffer::Submit (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_current == 0)
+    {
+      return false;
+    }
+  uint32_t used = pptr () - pbase ();
+  char *next = 0;
+  {
+    CriticalSection cs (m_mutex);
+    if (m_failed)
+      {
+        return false;
+      }
+    if (used == 0)
+      {
+        next = m_current;
+      }
+    else
+      {
+        m_pending.push_back (std::make_pair (m_current, used));
+        if (!m_free.empty ())
+          {
+            next = m_free.front ();
+            m_free.pop_front ();
+          }
+        else if (m_nChunks < m_maxChunks)
+          {
+            next = new char [m_chunkSize];
+            m_nChunks++;
+          }
+      }
+  }
+  m_current = 0;
+  setp (0, 0);
+  if (used > 0)
+    {
+      m_dataReady.SetCondition (true);
+      m_dataReady.Signal ();
+    }
+  while (next == 0)
+    {
+      // all the chunks are queued: wait for the writer thread to release one
+      m_spaceReady.SetCondition (false);
+      {
+        CriticalSection cs (m_mutex);
+        if (m_failed)
+          {
+            return false;
+          }
+        if (!m_free.empty ())
+          {
+            next = m_free.front ();
+            m_free.pop_front ();
+          }
+      }
+      if (next == 0)
+        {
+          m_spaceReady.TimedWait (WAIT_NS);
+        }
+    }
+  m_current = next;
+  setp (m_current, m_current + m_chunkSize);
+  return true;
+}
+
+void
+PcapAsyncWriteBuffer::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
+    {
+      m_dataReady.SetCondition (false);
+      std::pair<char *, uint32_t> chunk (0, 0);
+      bool stop = false;
+      {
+        CriticalSection cs (m_mutex);
+        if (m_failed)
+          {
+            break;
+          }
+        if (!m_pending.empty ())
+          {
+            chunk = m_pending.front ();
+            m_pending.pop_front ();
+          }
+        stop = m_stop;
+      }
+      if (chunk.first == 0)
+        {
+          if (stop)
+            {
+              break;
+            }
+          m_dataReady.TimedWait (WAIT_NS);
+          continue;
+        }
+      bool ok = m_sink->sputn (chunk.first, chunk.second) == chunk.second;
+      {
+        CriticalSection cs (m_mutex);
+        m_free.push_back (chunk.first);
+        if (!ok)
+          {
+            m_failed = true;
+          }
+      }
+      m_spaceReady.SetCondition (true);
+      m_spaceReady.Signal ();
+    }
+}
+
+#endif /* HAVE_PTHREAD_H */
+
 PcapFile::PcapFile ()
   : m_file (),
+    m_out (&m_file),
+    m_asyncBuffer (0),
     m_swapMode (false),
     m_nanosecMode (false)
 {
@@ -68,7 +336,7 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_file.fail ();
+  return m_file.fail () || m_out->fail ();
 }
 bool 
 PcapFile::Eof (void) const
@@ -81,6 +349,7 @@ PcapFile::Clear (void)
 {
   NS_LOG_FUNCTION (this);
   m_file.clear ();
+  m_out->clear ();
 }
 
 
@@ -88,9 +357,44 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_asyncBuffer != 0)
+    {
+      m_asyncBuffer->Close ();
+      delete m_out;
+      delete m_asyncBuffer;
+      m_out = &m_file;
+      m_asyncBuffer = 0;
+    }
+#endif /* HAVE_PTHREAD_H */
   m_file.close ();
 }
 
+void
+PcapFile::EnableAsyncWrite (uint32_t bufferSize)
+{
+  NS_LOG_FUNCTION (this << bufferSize);
+  NS_ASSERT (m_file.good ());
+  if (m_asyncBuffer != 0)
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  m_file.flush ();
+  m_asyncBuffer = new PcapAsyncWriteBuffer (m_file.rdbuf (), bufferSize);
+  m_out = new std::ostream (m_asyncBuffer);
+#else
+  NS_LOG_WARN ("Threads are not supported: " << m_filename << " is written synchronously");
+#endif /* HAVE_PTHREAD_H */
+}
+
+bool
+PcapFile::IsAsyncWrite (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_asyncBuffer != 0;
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -345,6 +649,7 @@ void
 PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection, bool swapMode, bool nanosecMode)
 {
   NS_LOG_FUNCTION (this << dataLinkType << snapLen << timeZoneCorrection << swapMode);
+  NS_ASSERT_MSG (m_asyncBuffer == 0, "PcapFile::Init (): the file header must be written before enabling asynchronous writes");
 
   //
   // Initialize the magic number and nanosecond mode flag
@@ -403,7 +708,7 @@ uint32_t
 PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
+  NS_ASSERT (m_out->good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
@@ -422,11 +727,11 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
+  m_out->write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
+  m_out->write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
+  m_out->write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
+  m_out->write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
+  NS_BUILD_DEBUG(m_out->flush());
   return inclLen;
 }
 
@@ -435,8 +740,8 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  m_out->write ((const char *)data, inclLen);
+  NS_BUILD_DEBUG(m_out->flush());
 }
 
 void 
@@ -444,8 +749,8 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  p->CopyData (m_out, inclLen);
+  NS_BUILD_DEBUG(m_out->flush());
 }
 
 void 
@@ -460,9 +765,9 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
+  headerBuffer.CopyData (m_out, toCopy);
   inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  p->CopyData (m_out, inclLen);
 }
 
 void
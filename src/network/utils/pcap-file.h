@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class PcapAsyncWriteBuffer;
 
 
 /**
@@ -44,6 +45,7 @@ class PcapFile
 public:
   static const int32_t  ZONE_DEFAULT    = 0;           /**< Time zone offset for current location */
   static const uint32_t SNAPLEN_DEFAULT = 65535;       /**< Default value for maximum octets to save per packet */
+  static const uint32_t ASYNC_BUFFER_DEFAULT = 16 * 1024 * 1024; /**< Default memory bound of the asynchronous writer, in bytes */
 
 public:
   PcapFile ();
@@ -122,6 +124,28 @@ public:
              bool swapMode = false,
              bool nanosecMode = false);
 
+  /**
+   * \brief Write the packet records from a background thread
+   *
+   * Once enabled, the packet records are formatted by the calling thread
+   * into in-memory chunks, which a background thread writes to the file in
+   * order. At most bufferSize bytes are held in memory: if the background
+   * thread falls behind, Write blocks until a chunk has been written out.
+   * The resulting file is identical to the one written synchronously.
+   *
+   * This method must be called after Init. The pending records are written
+   * out by Close. If the build does not support threads, the file keeps
+   * being written synchronously.
+   *
+   * \param bufferSize maximum number of bytes buffered in memory
+   */
+  void EnableAsyncWrite (uint32_t bufferSize = ASYNC_BUFFER_DEFAULT);
+
+  /**
+   * \return true if the packet records are written by a background thread
+   */
+  bool IsAsyncWrite (void) const;
+
   /**
    * \brief Write next packet to file
    * 
@@ -368,6 +392,8 @@ private:
 
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
+  std::ostream  *m_out;         //!< stream the packet records are written to
+  PcapAsyncWriteBuffer *m_asyncBuffer; //!< background writer, if asynchronous writes are enabled
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
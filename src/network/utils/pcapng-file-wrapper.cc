@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <limits>
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "pcapng-file-wrapper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFileWrapper");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapNgFileWrapper);
+
+TypeId
+PcapNgFileWrapper::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapNgFileWrapper")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<PcapNgFileWrapper> ()
+    .AddAttribute ("CaptureSize",
+                   "Default maximum length of captured packets (cf. pcap snaplen)",
+                   UintegerValue (PcapNgFile::SNAPLEN_DEFAULT),
+                   MakeUintegerAccessor (&PcapNgFileWrapper::m_snapLen),
+                   MakeUintegerChecker<uint32_t> (0, PcapNgFile::SNAPLEN_DEFAULT))
+    .AddAttribute ("Compression",
+                   "Compression of the file, applied while it is written.",
+                   EnumValue (PcapNgFile::NONE),
+                   MakeEnumAccessor (&PcapNgFileWrapper::m_compression),
+                   MakeEnumChecker (PcapNgFile::NONE, "None",
+                                    PcapNgFile::GZIP, "Gzip"))
+  ;
+  return tid;
+}
+
+PcapNgFileWrapper::PcapNgFileWrapper ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapNgFileWrapper::~PcapNgFileWrapper ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapNgFileWrapper::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.Fail ();
+}
+
+void
+PcapNgFileWrapper::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.Open (filename, m_compression);
+}
+
+void
+PcapNgFileWrapper::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Close ();
+}
+
+uint32_t
+PcapNgFileWrapper::AddInterface (uint32_t dataLinkType, std::string const &name,
+                                 std::string const &description, uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << name << description << snapLen);
+  if (snapLen == std::numeric_limits<uint32_t>::max ())
+    {
+      snapLen = m_snapLen;
+    }
+  return m_file.AddInterface (dataLinkType, snapLen, name, description);
+}
+
+uint32_t
+PcapNgFileWrapper::GetNInterfaces (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.GetNInterfaces ();
+}
+
+void
+PcapNgFileWrapper::Write (uint32_t interface, Time t, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << t << p);
+  m_file.Write (interface, t.GetNanoSeconds (), p);
+}
+
+void
+PcapNgFileWrapper::Write (uint32_t interface, Time t, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << t << &header << p);
+  m_file.Write (interface, t.GetNanoSeconds (), header, p);
+}
+
+void
+PcapNgFileWrapper::Write (uint32_t interface, Time t, uint8_t const *buffer, uint32_t length)
+{
+  NS_LOG_FUNCTION (this << interface << t << &buffer << length);
+  m_file.Write (interface, t.GetNanoSeconds (), buffer, length);
+}
+
+} // namespace ns3
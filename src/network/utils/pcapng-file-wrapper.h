@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_WRAPPER_H
+#define PCAPNG_FILE_WRAPPER_H
+
+#include <string>
+#include <limits>
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "pcapng-file.h"
+
+namespace ns3 {
+
+/**
+ * A class that wraps a PcapNgFile as an ns3::Object and provides a
+ * higher-layer ns-3 interface to the low-level public methods of
+ * PcapNgFile, in the same way as PcapFileWrapper does for pcap files.
+ */
+class PcapNgFileWrapper : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapNgFileWrapper ();
+  ~PcapNgFileWrapper ();
+
+  /**
+   * \return true if writing the underlying file failed, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new pcapng file, compressed as set by the "Compression"
+   * attribute.
+   *
+   * \param filename String containing the name of the file.
+   */
+  void Open (std::string const &filename);
+
+  /**
+   * Close the underlying pcapng file.
+   */
+  void Close (void);
+
+  /**
+   * Describe a new interface in the pcapng file.
+   *
+   * \param dataLinkType A data link type as defined in the pcap library.
+   * \param name The name of the interface, if not empty.
+   * \param description The description of the interface, if not empty.
+   * \param snapLen An optional maximum size for packets captured on this
+   * interface.  If not provided, the "CaptureSize" attribute is used.
+   * \return the index of the interface, to be passed to Write
+   */
+  uint32_t AddInterface (uint32_t dataLinkType,
+                         std::string const &name = "",
+                         std::string const &description = "",
+                         uint32_t snapLen = std::numeric_limits<uint32_t>::max ());
+
+  /**
+   * \return the number of interfaces described in the file
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \brief Write the next packet to file
+   *
+   * \param interface Index of the interface the packet was captured on.
+   * \param t Packet timestamp as ns3::Time.
+   * \param p Packet to write to the pcapng file.
+   */
+  void Write (uint32_t interface, Time t, Ptr<const Packet> p);
+
+  /**
+   * \brief Write the provided header along with the packet to the pcapng file.
+   *
+   * \param interface Index of the interface the packet was captured on.
+   * \param t Packet timestamp as ns3::Time.
+   * \param header The Header to prepend to the packet.
+   * \param p Packet to write to the pcapng file.
+   */
+  void Write (uint32_t interface, Time t, const Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Write the provided data buffer to the pcapng file.
+   *
+   * \param interface Index of the interface the packet was captured on.
+   * \param t Packet timestamp as ns3::Time.
+   * \param buffer The buffer to write.
+   * \param length The size of the buffer.
+   */
+  void Write (uint32_t interface, Time t, uint8_t const *buffer, uint32_t length);
+
+private:
+  PcapNgFile m_file; //!< Pcapng file
+  uint32_t m_snapLen; //!< default max length of saved packets
+  PcapNgFile::Compression m_compression; //!< compression of the file
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_WRAPPER_H */
@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "ns3/log.h"
+#include "ns3/network-config.h"
+#include "pcapng-file.h"
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFile");
+
+const uint32_t SECTION_HEADER_BLOCK = 0x0a0d0d0a;     /**< Section Header Block type */
+const uint32_t INTERFACE_DESCRIPTION_BLOCK = 0x1;     /**< Interface Description Block type */
+const uint32_t ENHANCED_PACKET_BLOCK = 0x6;           /**< Enhanced Packet Block type */
+const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d;         /**< Identifies the byte order of the section */
+const uint16_t VERSION_MAJOR = 1;                     /**< Major version of supported pcapng file format */
+const uint16_t VERSION_MINOR = 0;                     /**< Minor version of supported pcapng file format */
+
+const uint16_t OPT_ENDOFOPT = 0;                      /**< End of options */
+const uint16_t SHB_USERAPPL = 4;                      /**< Application which wrote the section */
+const uint16_t IF_NAME = 2;                           /**< Name of the interface */
+const uint16_t IF_DESCRIPTION = 3;                    /**< Description of the interface */
+const uint16_t IF_TSRESOL = 9;                        /**< Resolution of the interface timestamps */
+
+PcapNgFile::PcapNgFile ()
+  : m_gzFile (0),
+    m_fail (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapNgFile::~PcapNgFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapNgFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_fail || m_file.fail ();
+}
+
+bool
+PcapNgFile::IsCompressionSupported (Compression compression)
+{
+  NS_LOG_FUNCTION (compression);
+  switch (compression)
+    {
+    case NONE:
+      return true;
+    case GZIP:
+#ifdef HAVE_ZLIB_H
+      return true;
+#else
+      return false;
+#endif /* HAVE_ZLIB_H */
+    }
+  return false;
+}
+
+void
+PcapNgFile::Open (std::string const &filename, Compression compression)
+{
+  NS_LOG_FUNCTION (this << filename << compression);
+  NS_ASSERT (!m_file.is_open () && m_gzFile == 0);
+
+  m_filename = filename;
+  m_fail = false;
+  m_snapLen.clear ();
+  switch (compression)
+    {
+    case NONE:
+      m_file.open (filename.c_str (), std::ios::out | std::ios::binary);
+      break;
+    case GZIP:
+#ifdef HAVE_ZLIB_H
+      m_gzFile = gzopen (filename.c_str (), "wb");
+      m_fail = (m_gzFile == 0);
+#else
+      NS_LOG_ERROR ("gzip compression is not supported: zlib was not found");
+      m_fail = true;
+#endif /* HAVE_ZLIB_H */
+      break;
+    }
+  if (Fail ())
+    {
+      return;
+    }
+
+  BeginBlock (SECTION_HEADER_BLOCK);
+  Append32 (BYTE_ORDER_MAGIC);
+  Append16 (VERSION_MAJOR);
+  Append16 (VERSION_MINOR);
+  // section length is not specified
+  Append32 (0xffffffff);
+  Append32 (0xffffffff);
+  const char application[] = "ns-3";
+  AppendOption (SHB_USERAPPL, application, sizeof (application) - 1);
+  AppendOption (OPT_ENDOFOPT, 0, 0);
+  EndBlock ();
+}
+
+void
+PcapNgFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_ZLIB_H
+  if (m_gzFile != 0)
+    {
+      if (gzclose (static_cast<gzFile> (m_gzFile)) != Z_OK)
+        {
+          m_fail = true;
+        }
+      m_gzFile = 0;
+    }
+#endif /* HAVE_ZLIB_H */
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+}
+
+uint32_t
+PcapNgFile::AddInterface (uint32_t dataLinkType, uint32_t snapLen,
+                          std::string const &name, std::string const &description)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name << description);
+  NS_ASSERT_MSG (dataLinkType <= 0xffff, "Data link type " << dataLinkType << " does not fit in pcapng");
+
+  BeginBlock (INTERFACE_DESCRIPTION_BLOCK);
+  Append16 (dataLinkType);
+  Append16 (0);
+  Append32 (snapLen);
+  if (!name.empty ())
+    {
+      AppendOption (IF_NAME, name.data (), name.size ());
+    }
+  if (!description.empty ())
+    {
+      AppendOption (IF_DESCRIPTION, description.data (), description.size ());
+    }
+  // timestamps are in nanoseconds (10^-9 s)
+  uint8_t tsResol = 9;
+  AppendOption (IF_TSRESOL, &tsResol, 1);
+  AppendOption (OPT_ENDOFOPT, 0, 0);
+  EndBlock ();
+
+  m_snapLen.push_back (snapLen);
+  return m_snapLen.size () - 1;
+}
+
+uint32_t
+PcapNgFile::GetNInterfaces (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_snapLen.size ();
+}
+
+void
+PcapNgFile::BeginBlock (uint32_t type)
+{
+  m_block.clear ();
+  Append32 (type);
+  // block total length, set by EndBlock
+  Append32 (0);
+}
+
+void
+PcapNgFile::Append16 (uint16_t value)
+{
+  uint8_t *p = reinterpret_cast<uint8_t *> (&value);
+  m_block.insert (m_block.end (), p, p + sizeof (value));
+}
+
+void
+PcapNgFile::Append32 (uint32_t value)
+{
+  uint8_t *p = reinterpret_cast<uint8_t *> (&value);
+  m_block.insert (m_block.end (), p, p + sizeof (value));
+}
+
+uint8_t *
+PcapNgFile::AppendData (uint32_t length)
+{
+  uint32_t start = m_block.size ();
+  uint32_t padded = (length + 3) & ~3U;
+  m_block.resize (start + padded, 0);
+  return &m_block[0] + start;
+}
+
+void
+PcapNgFile::AppendOption (uint16_t code, const void *value, uint16_t length)
+{
+  Append16 (code);
+  Append16 (length);
+  if (length > 0)
+    {
+      std::memcpy (AppendData (length), value, length);
+    }
+}
+
+uint8_t *
+PcapNgFile::BeginPacketBlock (uint32_t interface, uint64_t tsNs, uint32_t totalLen, uint32_t &inclLen)
+{
+  NS_ASSERT_MSG (interface < m_snapLen.size (), "Unknown interface " << interface);
+  inclLen = totalLen > m_snapLen[interface] ? m_snapLen[interface] : totalLen;
+
+  BeginBlock (ENHANCED_PACKET_BLOCK);
+  Append32 (interface);
+  Append32 (tsNs >> 32);
+  Append32 (tsNs & 0xffffffff);
+  Append32 (inclLen);
+  Append32 (totalLen);
+  return AppendData (inclLen);
+}
+
+void
+PcapNgFile::EndBlock (void)
+{
+  uint32_t length = m_block.size () + 4;
+  std::memcpy (&m_block[4], &length, sizeof (length));
+  Append32 (length);
+
+  if (Fail ())
+    {
+      return;
+    }
+#ifdef HAVE_ZLIB_H
+  if (m_gzFile != 0)
+    {
+      if (gzwrite (static_cast<gzFile> (m_gzFile), &m_block[0], m_block.size ()) != static_cast<int> (m_block.size ()))
+        {
+          m_fail = true;
+        }
+      return;
+    }
+#endif /* HAVE_ZLIB_H */
+  m_file.write (reinterpret_cast<const char *> (&m_block[0]), m_block.size ());
+}
+
+void
+PcapNgFile::Write (uint32_t interface, uint64_t tsNs, uint8_t const * const data, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interface << tsNs << &data << totalLen);
+  uint32_t inclLen;
+  uint8_t *buffer = BeginPacketBlock (interface, tsNs, totalLen, inclLen);
+  std::memcpy (buffer, data, inclLen);
+  EndBlock ();
+}
+
+void
+PcapNgFile::Write (uint32_t interface, uint64_t tsNs, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << tsNs << p);
+  uint32_t inclLen;
+  uint8_t *buffer = BeginPacketBlock (interface, tsNs, p->GetSize (), inclLen);
+  p->CopyData (buffer, inclLen);
+  EndBlock ();
+}
+
+void
+PcapNgFile::Write (uint32_t interface, uint64_t tsNs, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << tsNs << &header << p);
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t inclLen;
+  uint8_t *buffer = BeginPacketBlock (interface, tsNs, headerSize + p->GetSize (), inclLen);
+
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, inclLen);
+  headerBuffer.Begin ().Read (buffer, toCopy);
+  p->CopyData (buffer + toCopy, inclLen - toCopy);
+  EndBlock ();
+}
+
+} // namespace ns3
@@ -272,4 +272,14 @@ QueueBase::DoNsLog (const enum LogLevel level, std::string str) const
     NS_LOG (level, str);
 }
 
+bool
+QueueBase::IsNsLogEnabled (const enum LogLevel level) const
+{
+#ifdef NS3_LOG_ENABLE
+  return g_log.IsEnabled (level);
+#else
+  return false;
+#endif
+}
+
 } // namespace ns3
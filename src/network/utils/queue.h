@@ -238,6 +238,16 @@ protected:
    */
   void DoNsLog (const enum LogLevel level, std::string str) const;
 
+  /**
+   * \brief Check whether the ns-3 logging system would print a message
+   *
+   * Used by QUEUE_LOG to avoid formatting messages that are not printed.
+   *
+   * \param level the log level
+   * \return true if messages of the given level are enabled
+   */
+  bool IsNsLogEnabled (const enum LogLevel level) const;
+
 private:
   TracedValue<uint32_t> m_nBytes;               //!< Number of bytes in the queue
   uint32_t m_nTotalReceivedBytes;               //!< Total received bytes
@@ -395,6 +405,39 @@ protected:
    */
   Ptr<const Item> DoPeek (ConstIterator pos) const;
 
+  /**
+   * \brief Check whether an item fits in the queue
+   * \param item the item to enqueue
+   * \return true if storing the item would exceed the maximum queue size
+   *
+   * This method, along with NotifyEnqueue, NotifyDequeue and NotifyRemove,
+   * allows subclasses to store items in a container of their own instead
+   * of the list browsed by Head and Tail, while keeping the statistics and
+   * trace sources of this class up to date.
+   */
+  bool WouldOverflow (Ptr<Item> item) const;
+
+  /**
+   * \brief Update the statistics and fire the traces for an item that has
+   *        just been stored in the queue
+   * \param item the enqueued item
+   */
+  void NotifyEnqueue (Ptr<Item> item);
+
+  /**
+   * \brief Update the statistics and fire the traces for an item that has
+   *        just been pulled from the queue to be dequeued
+   * \param item the dequeued item
+   */
+  void NotifyDequeue (Ptr<Item> item);
+
+  /**
+   * \brief Update the statistics and fire the traces for an item that has
+   *        just been pulled from the queue to be dropped
+   * \param item the removed item
+   */
+  void NotifyRemove (Ptr<Item> item);
+
   /**
    * \brief Drop a packet before enqueue
    * \param item item that was dropped
@@ -431,11 +474,14 @@ private:
 };
 
 
-#define QUEUE_LOG(level,params)              \
-  {                                          \
-    std::stringstream ss;                    \
-    ss << params;                            \
-    QueueBase::DoNsLog (level, ss.str ());   \
+#define QUEUE_LOG(level,params)                 \
+  {                                             \
+    if (QueueBase::IsNsLogEnabled (level))      \
+      {                                         \
+        std::stringstream ss;                   \
+        ss << params;                           \
+        QueueBase::DoNsLog (level, ss.str ());  \
+      }                                         \
   }
 
 
@@ -486,31 +532,14 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
 {
   QUEUE_LOG (LOG_LOGIC, "Queue:DoEnqueue(" << this << ", " << item << ")");
 
-  if (m_mode == QUEUE_MODE_PACKETS && (m_nPackets.Get () >= m_maxPackets))
-    {
-      QUEUE_LOG (LOG_LOGIC, "Queue full (at max packets) -- dropping pkt");
-      DropBeforeEnqueue (item);
-      return false;
-    }
-
-  if (m_mode == QUEUE_MODE_BYTES && (m_nBytes.Get () + item->GetSize () > m_maxBytes))
+  if (WouldOverflow (item))
     {
-      QUEUE_LOG (LOG_LOGIC, "Queue full (packet would exceed max bytes) -- dropping pkt");
       DropBeforeEnqueue (item);
       return false;
     }
 
   m_packets.insert (pos, item);
-
-  uint32_t size = item->GetSize ();
-  m_nBytes += size;
-  m_nTotalReceivedBytes += size;
-
-  m_nPackets++;
-  m_nTotalReceivedPackets++;
-
-  QUEUE_LOG (LOG_LOGIC, "m_traceEnqueue (p)");
-  m_traceEnqueue (item);
+  NotifyEnqueue (item);
 
   return true;
 }
@@ -532,14 +561,7 @@ Queue<Item>::DoDequeue (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
-
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
-
-      QUEUE_LOG (LOG_LOGIC, "m_traceDequeue (p)");
-      m_traceDequeue (item);
+      NotifyDequeue (item);
     }
   return item;
 }
@@ -561,15 +583,70 @@ Queue<Item>::DoRemove (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
+      NotifyRemove (item);
+    }
+  return item;
+}
 
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
+template <typename Item>
+bool
+Queue<Item>::WouldOverflow (Ptr<Item> item) const
+{
+  if (m_mode == QUEUE_MODE_PACKETS && (m_nPackets.Get () >= m_maxPackets))
+    {
+      QUEUE_LOG (LOG_LOGIC, "Queue full (at max packets) -- dropping pkt");
+      return true;
+    }
 
-      DropAfterDequeue (item);
+  if (m_mode == QUEUE_MODE_BYTES && (m_nBytes.Get () + item->GetSize () > m_maxBytes))
+    {
+      QUEUE_LOG (LOG_LOGIC, "Queue full (packet would exceed max bytes) -- dropping pkt");
+      return true;
     }
-  return item;
+
+  return false;
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyEnqueue (Ptr<Item> item)
+{
+  uint32_t size = item->GetSize ();
+  m_nBytes += size;
+  m_nTotalReceivedBytes += size;
+
+  m_nPackets++;
+  m_nTotalReceivedPackets++;
+
+  QUEUE_LOG (LOG_LOGIC, "m_traceEnqueue (p)");
+  m_traceEnqueue (item);
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyDequeue (Ptr<Item> item)
+{
+  NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
+  NS_ASSERT (m_nPackets.Get () > 0);
+
+  m_nBytes -= item->GetSize ();
+  m_nPackets--;
+
+  QUEUE_LOG (LOG_LOGIC, "m_traceDequeue (p)");
+  m_traceDequeue (item);
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyRemove (Ptr<Item> item)
+{
+  NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
+  NS_ASSERT (m_nPackets.Get () > 0);
+
+  m_nBytes -= item->GetSize ();
+  m_nPackets--;
+
+  DropAfterDequeue (item);
 }
 
 template <typename Item>
@@ -0,0 +1,320 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A growable FIFO container backed by a contiguous circular array
+ *
+ * Items are appended at the back and removed from the front in O(1),
+ * without any per-item memory allocation once the buffer has grown to
+ * the steady state occupancy. The capacity is always a power of two and
+ * doubles whenever the buffer is full; it is never reduced.
+ *
+ * The buffer can be browsed from the front to the back with a ConstIterator:
+ *
+ * \code
+ *   for (RingBuffer<T>::ConstIterator i = buffer.Begin (); i != buffer.End (); ++i)
+ *     {
+ *       (*i)->method ();
+ *     }
+ * \endcode
+ *
+ * Iterators are invalidated by any operation that modifies the buffer.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /**
+   * \brief Const iterator over the items of a RingBuffer, from front to back
+   */
+  class ConstIterator
+  {
+public:
+    /// Default constructor
+    ConstIterator ()
+      : m_buffer (0),
+        m_index (0)
+    {}
+    /**
+     * \return a reference to the current item
+     */
+    const T & operator * (void) const
+    {
+      return (*m_buffer)[m_index];
+    }
+    /**
+     * \return a pointer to the current item
+     */
+    const T * operator -> (void) const
+    {
+      return &(*m_buffer)[m_index];
+    }
+    /**
+     * Move to the next item (prefix)
+     * \return a reference to this iterator
+     */
+    ConstIterator & operator ++ (void)
+    {
+      m_index++;
+      return *this;
+    }
+    /**
+     * Move to the next item (postfix)
+     * \return the iterator before the increment
+     */
+    ConstIterator operator ++ (int)
+    {
+      ConstIterator old = *this;
+      m_index++;
+      return old;
+    }
+    /**
+     * \param o the other iterator
+     * \return true if both iterators refer to the same position
+     */
+    bool operator == (const ConstIterator &o) const
+    {
+      return m_buffer == o.m_buffer && m_index == o.m_index;
+    }
+    /**
+     * \param o the other iterator
+     * \return true if the iterators refer to different positions
+     */
+    bool operator != (const ConstIterator &o) const
+    {
+      return !(*this == o);
+    }
+private:
+    /// Friend class
+    friend class RingBuffer<T>;
+    /**
+     * \param buffer the buffer to iterate over
+     * \param index the position of the item, counted from the front
+     */
+    ConstIterator (const RingBuffer<T> *buffer, uint32_t index)
+      : m_buffer (buffer),
+        m_index (index)
+    {}
+    const RingBuffer<T> *m_buffer; //!< the buffer
+    uint32_t m_index;              //!< position of the item, counted from the front
+  };
+
+  /**
+   * \brief Create an empty buffer
+   * \param capacity the initial capacity, rounded up to a power of two
+   */
+  RingBuffer (uint32_t capacity = 16);
+
+  /**
+   * \return true if the buffer holds no item
+   */
+  bool IsEmpty (void) const;
+
+  /**
+   * \return the number of items in the buffer
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * \return the number of items the buffer can hold before growing
+   */
+  uint32_t GetCapacity (void) const;
+
+  /**
+   * \brief Append an item at the back of the buffer
+   * \param item the item to append
+   */
+  void PushBack (const T &item);
+
+  /**
+   * \brief Remove the item at the front of the buffer and return it
+   * \return the removed item
+   */
+  T PopFront (void);
+
+  /**
+   * \return a reference to the item at the front of the buffer
+   */
+  const T & Front (void) const;
+
+  /**
+   * \param index the position of the item, counted from the front
+   * \return a reference to the item
+   */
+  const T & operator [] (uint32_t index) const;
+
+  /**
+   * \brief Remove all the items
+   */
+  void Clear (void);
+
+  /**
+   * \return an iterator which refers to the item at the front
+   */
+  ConstIterator Begin (void) const;
+
+  /**
+   * \return an iterator which indicates past-the-last item
+   */
+  ConstIterator End (void) const;
+
+private:
+  /**
+   * \brief Double the capacity, moving the items to the start of the
+   *        new storage
+   */
+  void Grow (void);
+
+  std::vector<T> m_slots; //!< the circular storage
+  uint32_t m_mask;        //!< capacity minus one
+  uint32_t m_head;        //!< index of the front item in m_slots
+  uint32_t m_size;        //!< number of items in the buffer
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename T>
+RingBuffer<T>::RingBuffer (uint32_t capacity)
+  : m_head (0),
+    m_size (0)
+{
+  uint32_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_slots.resize (size);
+  m_mask = size - 1;
+}
+
+template <typename T>
+bool
+RingBuffer<T>::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::GetSize (void) const
+{
+  return m_size;
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::GetCapacity (void) const
+{
+  return m_mask + 1;
+}
+
+template <typename T>
+void
+RingBuffer<T>::PushBack (const T &item)
+{
+  if (m_size == GetCapacity ())
+    {
+      Grow ();
+    }
+  m_slots[(m_head + m_size) & m_mask] = item;
+  m_size++;
+}
+
+template <typename T>
+T
+RingBuffer<T>::PopFront (void)
+{
+  NS_ASSERT (m_size > 0);
+  T item = m_slots[m_head];
+  // release the slot so that the buffer does not keep references alive
+  m_slots[m_head] = T ();
+  m_head = (m_head + 1) & m_mask;
+  m_size--;
+  return item;
+}
+
+template <typename T>
+const T &
+RingBuffer<T>::Front (void) const
+{
+  NS_ASSERT (m_size > 0);
+  return m_slots[m_head];
+}
+
+template <typename T>
+const T &
+RingBuffer<T>::operator [] (uint32_t index) const
+{
+  NS_ASSERT (index < m_size);
+  return m_slots[(m_head + index) & m_mask];
+}
+
+template <typename T>
+void
+RingBuffer<T>::Clear (void)
+{
+  while (m_size > 0)
+    {
+      PopFront ();
+    }
+  m_head = 0;
+}
+
+template <typename T>
+typename RingBuffer<T>::ConstIterator
+RingBuffer<T>::Begin (void) const
+{
+  return ConstIterator (this, 0);
+}
+
+template <typename T>
+typename RingBuffer<T>::ConstIterator
+RingBuffer<T>::End (void) const
+{
+  return ConstIterator (this, m_size);
+}
+
+template <typename T>
+void
+RingBuffer<T>::Grow (void)
+{
+  std::vector<T> slots (2 * GetCapacity ());
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      slots[i] = m_slots[(m_head + i) & m_mask];
+    }
+  m_slots.swap (slots);
+  m_mask = m_slots.size () - 1;
+  m_head = 0;
+}
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
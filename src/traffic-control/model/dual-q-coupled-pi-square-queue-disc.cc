@@ -265,6 +265,48 @@ DualQCoupledPiSquareQueueDisc::GetDropProb (void)
   return m_dropProb;
 }
 
+Time
+DualQCoupledPiSquareQueueDisc::GetSojournTime (uint32_t queueNumber)
+{
+  NS_LOG_FUNCTION (this << queueNumber);
+  Ptr<const QueueDiscItem> item = GetInternalQueue (queueNumber)->Peek ();
+  if (item == 0)
+    {
+      return Time (Seconds (0));
+    }
+  DualQCoupledPiSquareTimestampTag tag;
+  item->GetPacket ()->PeekPacketTag (tag);
+  return Simulator::Now () - tag.GetTxTime ();
+}
+
+double
+DualQCoupledPiSquareQueueDisc::GetClassicProb (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_classicDropProb / m_k;
+}
+
+double
+DualQCoupledPiSquareQueueDisc::GetL4SProb (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Same conditions as the step marking in DoDequeue
+  bool minL4SQueueSizeFlag = false;
+  if (GetMode () == QUEUE_DISC_MODE_BYTES && GetInternalQueue (1)->GetNBytes () > 2 * m_meanPktSize)
+    {
+      minL4SQueueSizeFlag = true;
+    }
+  else if (GetMode () == QUEUE_DISC_MODE_PACKETS && GetInternalQueue (1)->GetNPackets () > 2)
+    {
+      minL4SQueueSizeFlag = true;
+    }
+  if (minL4SQueueSizeFlag && GetSojournTime (1) > m_l4sThreshold)
+    {
+      return 1;
+    }
+  return (m_l4sDropProb < 1) ? m_l4sDropProb : 1;
+}
+
 int64_t
 DualQCoupledPiSquareQueueDisc::AssignStreams (int64_t stream)
 {
@@ -318,6 +360,8 @@ DualQCoupledPiSquareQueueDisc::InitializeParams (void)
   m_betaU = m_beta * m_tUpdate.GetSeconds ();
   m_minL4SLength = 2 * m_meanPktSize;
   m_dropProb = 0.0;
+  m_classicDropProb = 0.0;
+  m_l4sDropProb = 0.0;
   m_qDelayOld = Time (Seconds (0));
   m_stats.forcedDrop = 0;
   m_stats.unforcedClassicDrop = 0;
@@ -389,7 +433,7 @@ DualQCoupledPiSquareQueueDisc::DoDequeue ()
       if ((item1 = GetInternalQueue (0)->Peek ()) != 0)
         {
           item1->GetPacket ()->PeekPacketTag (tag1);
-          classicQueueTime = tag1.GetTxTime ();
+          classicQueueTime = Simulator::Now () - tag1.GetTxTime ();
         }
       else
         {
@@ -399,13 +443,14 @@ DualQCoupledPiSquareQueueDisc::DoDequeue ()
       if ((item2 = GetInternalQueue (1)->Peek ()) != 0)
         {
           item2->GetPacket ()->PeekPacketTag (tag2);
-          l4sQueueTime = tag2.GetTxTime ();
+          l4sQueueTime = Simulator::Now () - tag2.GetTxTime ();
         }
       else
         {
           l4sQueueTime = Time (Seconds (0));
         }
 
+      // Time-shifted FIFO: compare the sojourn times of the head packets
       if (l4sQueueTime.GetSeconds () + m_tShift.GetSeconds () >= classicQueueTime.GetSeconds () && GetInternalQueue (1)->Peek () != 0 )
         {
           Ptr<QueueDiscItem> item = GetInternalQueue (1)->Dequeue ();
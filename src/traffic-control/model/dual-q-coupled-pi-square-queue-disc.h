@@ -123,6 +123,29 @@ public:
    */
   double GetDropProb (void);
 
+  /**
+   * \brief Get the sojourn time of the packet at the head of a queue
+   *
+   * \param queueNumber 0 for the Classic queue, 1 for the L4S queue
+   * \returns the time spent in the queue by its oldest packet, zero if empty
+   */
+  Time GetSojournTime (uint32_t queueNumber);
+
+  /**
+   * \brief Get the probability of dropping or marking the next Classic packet
+   *
+   * \returns the squared base probability, divided by the coupling factor
+   */
+  double GetClassicProb (void);
+
+  /**
+   * \brief Get the probability of marking the next L4S packet
+   *
+   * \returns 1 if the L4S queue is above the marking threshold, else the
+   * coupled probability
+   */
+  double GetL4SProb (void);
+
   /**
    * \brief Get Dual Queue PI Square statistics after running.
    *
@@ -27,6 +27,7 @@
 #include "ns3/double.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/nstime.h"
 
 using namespace ns3;
 
@@ -357,6 +358,70 @@ DualQCoupledPiSquareQueueDiscTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class DualQCoupledPiSquareSchedulerTestCase : public TestCase
+{
+public:
+  DualQCoupledPiSquareSchedulerTestCase ();
+  virtual void DoRun (void);
+private:
+  void Enqueue (Ptr<DualQCoupledPiSquareQueueDisc> queue, bool l4s);
+  void CheckDequeue (Ptr<DualQCoupledPiSquareQueueDisc> queue, bool l4s, std::string reason);
+};
+
+DualQCoupledPiSquareSchedulerTestCase::DualQCoupledPiSquareSchedulerTestCase ()
+  : TestCase ("Check that the DualQ scheduler serves the queue whose head packet has waited longer, after the time shift")
+{
+}
+
+void
+DualQCoupledPiSquareSchedulerTestCase::Enqueue (Ptr<DualQCoupledPiSquareQueueDisc> queue, bool l4s)
+{
+  Address dest;
+  if (l4s)
+    {
+      queue->Enqueue (Create<DualQueueL4SQueueDiscTestItem> (Create<Packet> (1000), dest, 0));
+    }
+  else
+    {
+      queue->Enqueue (Create<DualQueueClassicQueueDiscTestItem> (Create<Packet> (1000), dest, 0));
+    }
+}
+
+void
+DualQCoupledPiSquareSchedulerTestCase::CheckDequeue (Ptr<DualQCoupledPiSquareQueueDisc> queue, bool l4s, std::string reason)
+{
+  Ptr<QueueDiscItem> item = queue->Dequeue ();
+  NS_TEST_ASSERT_MSG_NE (item, 0, "There should be a packet to dequeue");
+  NS_TEST_ASSERT_MSG_EQ (item->IsL4S (), l4s, reason);
+}
+
+void
+DualQCoupledPiSquareSchedulerTestCase::DoRun (void)
+{
+  // The time shift is twice the Classic queue delay reference, i.e., 30 ms
+  Ptr<DualQCoupledPiSquareQueueDisc> queue = CreateObject<DualQCoupledPiSquareQueueDisc> ();
+  queue->SetAttribute ("ClassicQueueDelayReference", TimeValue (MilliSeconds (15)));
+  queue->Initialize ();
+
+  Simulator::Schedule (Seconds (0), &DualQCoupledPiSquareSchedulerTestCase::Enqueue, this, queue, false);
+
+  // The Classic packet has waited 10 ms, less than the time shift
+  Simulator::Schedule (MilliSeconds (10), &DualQCoupledPiSquareSchedulerTestCase::Enqueue, this, queue, true);
+  Simulator::Schedule (MilliSeconds (10), &DualQCoupledPiSquareSchedulerTestCase::CheckDequeue, this, queue, true,
+                       "The L4S packet should be served first while the Classic one has waited less than the time shift");
+
+  // The Classic packet has waited 100 ms, more than the time shift
+  Simulator::Schedule (MilliSeconds (100), &DualQCoupledPiSquareSchedulerTestCase::Enqueue, this, queue, true);
+  Simulator::Schedule (MilliSeconds (100), &DualQCoupledPiSquareSchedulerTestCase::CheckDequeue, this, queue, false,
+                       "The Classic packet should be served first once it has waited more than the time shift");
+  Simulator::Schedule (MilliSeconds (100), &DualQCoupledPiSquareSchedulerTestCase::CheckDequeue, this, queue, true,
+                       "The L4S packet should be served last");
+
+  Simulator::Stop (MilliSeconds (200));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
 static class DualQCoupledPiSquareQueueDiscTestSuite : public TestSuite
 {
 public:
@@ -364,5 +429,6 @@ public:
     : TestSuite ("dual-q-coupled-pi-square-queue-disc", UNIT)
   {
     AddTestCase (new DualQCoupledPiSquareQueueDiscTestCase (), TestCase::QUICK);
+    AddTestCase (new DualQCoupledPiSquareSchedulerTestCase (), TestCase::QUICK);
   }
 } g_DualQCoupledPiSquareQueueTestSuite;
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the Internet checksum of the
+// Buffer::Iterator, which sums contiguous spans of the buffer, against
+// a loop reading one 16-bit word at a time, for various packet sizes.
+// It also compares the incremental update of a header checksum after
+// a TTL decrement (RFC 1624) with a full computation over the header.
+// Sample usage:  ./waf --run 'bench-checksum --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/buffer.h"
+#include "ns3/ip-checksum.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+static uint32_t g_sink = 0; //!< accumulates the results so that they are not optimized away
+
+/**
+ * \param size the number of bytes
+ * \returns a buffer holding size written (non-zero) bytes
+ */
+static Buffer
+makeBuffer (uint32_t size)
+{
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  Buffer::Iterator i = buffer.Begin ();
+  for (uint32_t j = 0; j < size; j++)
+    {
+      i.WriteU8 (j * 7 + 1);
+    }
+  return buffer;
+}
+
+static void
+benchSpans (Buffer const &buffer, uint32_t n)
+{
+  uint32_t size = buffer.GetSize ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Buffer::Iterator it = buffer.Begin ();
+      g_sink += it.CalculateIpChecksum (size);
+    }
+}
+
+static void
+benchWords (Buffer const &buffer, uint32_t n)
+{
+  uint32_t size = buffer.GetSize ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Buffer::Iterator it = buffer.Begin ();
+      uint32_t sum = 0;
+      for (uint32_t j = 0; j < size / 2; j++)
+        {
+          sum += it.ReadU16 ();
+        }
+      if (size & 1)
+        {
+          sum += it.ReadU8 ();
+        }
+      while (sum >> 16)
+        {
+          sum = (sum & 0xffff) + (sum >> 16);
+        }
+      g_sink += static_cast<uint16_t> (~sum);
+    }
+}
+
+static void
+benchTtlFull (Buffer const &buffer, uint32_t n)
+{
+  std::vector<uint8_t> header (20);
+  buffer.CopyData (&header[0], 20);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      header[8]--;
+      header[10] = 0;
+      header[11] = 0;
+      g_sink += static_cast<uint16_t> (~IpChecksumAccumulate (&header[0], 20));
+    }
+}
+
+static void
+benchTtlIncremental (Buffer const &buffer, uint32_t n)
+{
+  std::vector<uint8_t> header (20);
+  buffer.CopyData (&header[0], 20);
+  uint16_t checksum = ~IpChecksumAccumulate (&header[0], 20);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint8_t ttl = header[8]--;
+      checksum = IpChecksumUpdate (checksum, ttl, header[8]);
+      g_sink += checksum;
+    }
+}
+
+static void
+runBench (void (*bench) (Buffer const &, uint32_t), Buffer const &buffer,
+          uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) (buffer, n);
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  minDelay = std::max<uint64_t> (minDelay, 1);
+  double ps = n;
+  ps *= 1000;
+  ps /= minDelay;
+  std::cout << ps << " packets/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << buffer.GetSize () << " bytes\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+  std::string sizes = "20,64,576,1500,9000";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the Internet checksum");
+  cmd.AddValue ("n", "number of packets", n);
+  cmd.AddValue ("sizes", "comma-separated list of packet sizes (bytes)", sizes);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of packets must be specified " <<
+        "by command-line argument --n=(number of packets)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-checksum with n=" << n << std::endl;
+
+  std::istringstream list (sizes);
+  std::string token;
+  while (std::getline (list, token, ','))
+    {
+      uint32_t size = atoi (token.c_str ());
+      Buffer buffer = makeBuffer (size);
+      runBench (&benchSpans, buffer, n, minIterations, "contiguous spans");
+      runBench (&benchWords, buffer, n, minIterations, "16-bit words");
+    }
+
+  Buffer header = makeBuffer (20);
+  runBench (&benchTtlFull, header, n, minIterations, "TTL decrement, full checksum");
+  runBench (&benchTtlIncremental, header, n, minIterations, "TTL decrement, incremental update");
+
+  return 0;
+}
@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the lookups of the end point demux
+// of a server with many concurrent connections, as done by TCP for every
+// received segment, against a linear scan of the list of end points.
+// Sample usage:  ./waf --run 'bench-demux --n=1000000 --flows=10000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/abort.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+static uint32_t g_flows = 10000;          //!< number of concurrent connections
+static const uint16_t g_serverPort = 80;  //!< port of the server
+
+/**
+ * Address of the client of a connection
+ * \param flow the connection index
+ * \return the IPv4 address of the client
+ */
+static Ipv4Address
+ClientAddress (uint32_t flow)
+{
+  return Ipv4Address (Ipv4Address ("10.1.0.0").Get () + flow / 1000);
+}
+
+/**
+ * Port of the client of a connection
+ * \param flow the connection index
+ * \return the port of the client
+ */
+static uint16_t
+ClientPort (uint32_t flow)
+{
+  return 49152 + flow % 1000;
+}
+
+/**
+ * IPv6 address of the client of a connection
+ * \param flow the connection index
+ * \return the IPv6 address of the client
+ */
+static Ipv6Address
+ClientAddress6 (uint32_t flow)
+{
+  uint8_t buf[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+  buf[14] = (flow / 1000) >> 8;
+  buf[15] = (flow / 1000) & 0xff;
+  return Ipv6Address (buf);
+}
+
+/**
+ * Look up the segments of n packets spread over all the connections of
+ * a server having a listening end point and g_flows accepted connections
+ * \param n the number of lookups
+ * \param linear whether to scan the list of end points instead of using Lookup
+ */
+static void
+benchIpv4 (uint32_t n, bool linear)
+{
+  Ipv4Address server ("10.0.0.1");
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->AddAddress (Ipv4InterfaceAddress (server, Ipv4Mask ("255.255.255.0")));
+
+  Ipv4EndPointDemux demux;
+  demux.Allocate (g_serverPort);
+  for (uint32_t flow = 0; flow < g_flows; flow++)
+    {
+      demux.Allocate (server, g_serverPort, ClientAddress (flow), ClientPort (flow));
+    }
+  Ipv4EndPointDemux::EndPoints all = demux.GetAllEndPoints ();
+
+  uint32_t found = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t flow = (i * 7919) % g_flows;
+      Ipv4Address client = ClientAddress (flow);
+      uint16_t port = ClientPort (flow);
+      if (linear)
+        {
+          for (Ipv4EndPointDemux::EndPointsI it = all.begin (); it != all.end (); ++it)
+            {
+              if ((*it)->GetLocalPort () == g_serverPort && (*it)->GetLocalAddress () == server
+                  && (*it)->GetPeerPort () == port && (*it)->GetPeerAddress () == client)
+                {
+                  found++;
+                  break;
+                }
+            }
+        }
+      else
+        {
+          found += demux.Lookup (server, g_serverPort, client, port, interface).size ();
+        }
+    }
+  NS_ABORT_MSG_UNLESS (found == n, "Missing connections");
+}
+
+/**
+ * Same as benchIpv4, for IPv6
+ * \param n the number of lookups
+ * \param linear whether to scan the list of end points instead of using Lookup
+ */
+static void
+benchIpv6 (uint32_t n, bool linear)
+{
+  Ipv6Address server ("2001:db8:1::1");
+
+  Ipv6EndPointDemux demux;
+  demux.Allocate (g_serverPort);
+  for (uint32_t flow = 0; flow < g_flows; flow++)
+    {
+      demux.Allocate (server, g_serverPort, ClientAddress6 (flow), ClientPort (flow));
+    }
+  Ipv6EndPointDemux::EndPoints all = demux.GetEndPoints ();
+
+  uint32_t found = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t flow = (i * 7919) % g_flows;
+      Ipv6Address client = ClientAddress6 (flow);
+      uint16_t port = ClientPort (flow);
+      if (linear)
+        {
+          for (Ipv6EndPointDemux::EndPointsI it = all.begin (); it != all.end (); ++it)
+            {
+              if ((*it)->GetLocalPort () == g_serverPort && (*it)->GetLocalAddress () == server
+                  && (*it)->GetPeerPort () == port && (*it)->GetPeerAddress () == client)
+                {
+                  found++;
+                  break;
+                }
+            }
+        }
+      else
+        {
+          found += demux.Lookup (server, g_serverPort, client, port, 0).size ();
+        }
+    }
+  NS_ABORT_MSG_UNLESS (found == n, "Missing connections");
+}
+
+static void
+benchIpv4Hash (uint32_t n)
+{
+  benchIpv4 (n, false);
+}
+
+static void
+benchIpv4Linear (uint32_t n)
+{
+  benchIpv4 (n, true);
+}
+
+static void
+benchIpv6Hash (uint32_t n)
+{
+  benchIpv6 (n, false);
+}
+
+static void
+benchIpv6Linear (uint32_t n)
+{
+  benchIpv6 (n, true);
+}
+
+static uint64_t
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  (*bench) (n);
+  uint64_t deltaMs = time.End ();
+  return deltaMs;
+}
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t delay = runBenchOneIteration (bench, n);
+      minDelay = std::min (minDelay, delay);
+    }
+  double ps = n;
+  ps *= 1000;
+  ps /= std::max (minDelay, (uint64_t) 1);
+  std::cout << ps << " lookups/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+  bool linear = true;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark end point demux lookups");
+  cmd.AddValue ("n", "number of lookups", n);
+  cmd.AddValue ("flows", "number of concurrent connections", g_flows);
+  cmd.AddValue ("linear", "also run the linear scan of the end points", linear);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || g_flows == 0)
+    {
+      std::cerr << "Error-- number of lookups must be specified " <<
+        "by command-line argument --n=(number of lookups)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-demux with n=" << n << " flows=" << g_flows << std::endl;
+
+  runBench (&benchIpv4Hash, n, minIterations, "Ipv4EndPointDemux::Lookup");
+  runBench (&benchIpv6Hash, n, minIterations, "Ipv6EndPointDemux::Lookup");
+  if (linear)
+    {
+      runBench (&benchIpv4Linear, n, minIterations, "IPv4 linear scan");
+      runBench (&benchIpv6Linear, n, minIterations, "IPv6 linear scan");
+    }
+
+  return 0;
+}
@@ -328,6 +328,25 @@ benchByteTags (uint32_t n)
     }
 }
 
+static void
+benchByteTagsReassembly (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // Reassemble a stream of identically tagged segments, as a TCP
+      // receive buffer does for a bulk transfer.
+      Ptr<Packet> stream = Create<Packet> ();
+      for (uint32_t j = 0; j < 100; j++)
+        {
+          Ptr<Packet> segment = Create<Packet> (536);
+          BenchTag<16> tag;
+          segment->AddByteTag (tag);
+          stream->AddAtEnd (segment);
+        }
+      Ptr<Packet> head = stream->CreateFragment (0, 536);
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -385,6 +404,7 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchByteTagsReassembly, n, minIterations, "Reassembly of byte tagged segments");
 
   return 0;
 }
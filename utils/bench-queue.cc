@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the enqueue/dequeue operations of
+// the DropTailQueue, whose items are stored in a ring buffer, against a
+// FIFO queue storing its items in the list of the Queue base class.
+// Sample usage:  ./waf --run 'bench-queue --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/drop-tail-queue.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// FIFO queue relying on the list based storage of the Queue base class
+class ListFifoQueue : public Queue<Packet>
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("anon::ListFifoQueue")
+      .SetParent<Queue<Packet> > ()
+      .SetGroupName ("Utils")
+      .HideFromDocumentation ()
+      .AddConstructor<ListFifoQueue> ()
+    ;
+    return tid;
+  }
+  virtual bool Enqueue (Ptr<Packet> item)
+  {
+    return DoEnqueue (Tail (), item);
+  }
+  virtual Ptr<Packet> Dequeue (void)
+  {
+    return DoDequeue (Head ());
+  }
+  virtual Ptr<Packet> Remove (void)
+  {
+    return DoRemove (Head ());
+  }
+  virtual Ptr<const Packet> Peek (void) const
+  {
+    return DoPeek (Head ());
+  }
+};
+
+static uint32_t g_backlog = 100; //!< number of packets kept in the queue
+
+/**
+ * Keep g_backlog packets in the queue and perform n enqueue/dequeue pairs
+ * \param queue the queue to benchmark
+ * \param n the number of enqueue/dequeue pairs
+ */
+static void
+benchQueue (Ptr<Queue<Packet> > queue, uint32_t n)
+{
+  queue->SetAttribute ("MaxPackets", UintegerValue (g_backlog + 1));
+  Ptr<Packet> p = Create<Packet> (1000);
+  for (uint32_t i = 0; i < g_backlog; i++)
+    {
+      queue->Enqueue (p);
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      queue->Enqueue (p);
+      queue->Dequeue ();
+    }
+  queue->Flush ();
+}
+
+static void
+benchDropTail (uint32_t n)
+{
+  benchQueue (CreateObject<DropTailQueue<Packet> > (), n);
+}
+
+static void
+benchList (uint32_t n)
+{
+  benchQueue (CreateObject<ListFifoQueue> (), n);
+}
+
+static uint64_t
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  (*bench) (n);
+  uint64_t deltaMs = time.End ();
+  return deltaMs;
+}
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t delay = runBenchOneIteration (bench, n);
+      minDelay = std::min (minDelay, delay);
+    }
+  double ps = n;
+  ps *= 1000;
+  ps /= minDelay;
+  std::cout << ps << " enqueue/dequeue pairs/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark Queue storage");
+  cmd.AddValue ("n", "number of enqueue/dequeue pairs", n);
+  cmd.AddValue ("backlog", "number of packets kept in the queue", g_backlog);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of operations must be specified " <<
+        "by command-line argument --n=(number of enqueue/dequeue pairs)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-queue with n=" << n << " backlog=" << g_backlog << std::endl;
+
+  runBench (&benchDropTail, n, minIterations, "DropTailQueue (ring buffer)");
+  runBench (&benchList, n, minIterations, "FIFO on Queue base class list");
+
+  return 0;
+}
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the TCP buffers against the
+// window size. For the TcpTxBuffer scoreboard, a window of segments is
+// sent and the first one is lost; each following ACK SACKs one more
+// segment, as during a fast recovery, and for each ACK the scoreboard is
+// updated, and the bytes in flight and the next segment to transmit are
+// computed. For the TcpRxBuffer reassembly, every other segment of a window
+// is lost and the others are buffered out of order; then the
+// retransmissions fill the holes, one at a time, and the whole window is
+// extracted.
+// Sample usage:  ./waf --run 'bench-tcp-buffers --windows=1000,10000,100000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-option-sack.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * \param segments the window, in segments
+ * \returns the number of ACKs processed
+ */
+static uint32_t
+benchTxScoreboard (uint32_t segments)
+{
+  const uint32_t dupThresh = 3;
+  const uint32_t segmentSize = 1000;
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  SequenceNumber32 head (1);
+  SequenceNumber32 next;
+
+  txBuf->SetMaxBufferSize (segments * segmentSize);
+  txBuf->SetHeadSequence (head);
+  txBuf->Add (Create<Packet> (segments * segmentSize));
+
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf->CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  for (uint32_t i = 1; i < segments; ++i)
+    {
+      sack->ClearSackList ();
+      sack->AddSackBlock (TcpOptionSack::SackBlock (head + segmentSize,
+                                                    head + (segmentSize * (i + 1))));
+      txBuf->Update (sack->GetSackList ());
+      txBuf->BytesInFlight (dupThresh, segmentSize);
+      if (txBuf->NextSeg (&next, dupThresh, segmentSize, true) && next == head)
+        {
+          txBuf->CopyFromSequence (segmentSize, next);
+        }
+    }
+
+  if (!txBuf->IsHeadRetransmitted ())
+    {
+      std::cerr << "Error-- the lost segment was not retransmitted" << std::endl;
+      exit (1);
+    }
+  return segments - 1;
+}
+
+/**
+ * \param segments the window, in segments
+ * \returns the number of segments received
+ */
+static uint32_t
+benchRxReassembly (uint32_t segments)
+{
+  const uint32_t segmentSize = 100;
+  Ptr<TcpRxBuffer> rxBuf = CreateObject<TcpRxBuffer> ();
+  TcpHeader h;
+  uint32_t extracted = 0;
+
+  rxBuf->SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf->SetMaxBufferSize (segments * segmentSize);
+
+  for (uint32_t i = 1; i < segments; i += 2)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (1 + i * segmentSize));
+      rxBuf->Add (Create<Packet> (segmentSize), h);
+    }
+  for (uint32_t i = 0; i < segments; i += 2)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (1 + i * segmentSize));
+      rxBuf->Add (Create<Packet> (segmentSize), h);
+    }
+  while (rxBuf->Available ())
+    {
+      extracted += rxBuf->Extract (16 * segmentSize)->GetSize ();
+    }
+
+  if (extracted != segments * segmentSize)
+    {
+      std::cerr << "Error-- the whole window was not extracted" << std::endl;
+      exit (1);
+    }
+  return segments;
+}
+
+static void
+runBench (uint32_t (*bench) (uint32_t), uint32_t segments,
+          uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      n = (*bench) (segments);
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  double us = minDelay;
+  us *= 1000;
+  us /= n;
+  std::cout << us << " us/" << name
+            << " (" << minDelay << " ms elapsed)\t"
+            << segments << " segments"
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t minIterations = 1;
+  std::string windows = "1000,10000,100000";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the TCP buffers against the window size");
+  cmd.AddValue ("windows", "comma-separated list of window sizes (segments)", windows);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  std::istringstream list (windows);
+  std::string token;
+  while (std::getline (list, token, ','))
+    {
+      uint32_t segments = atoi (token.c_str ());
+      if (segments < 2)
+        {
+          std::cerr << "Error-- windows must hold at least two segments" << std::endl;
+          exit (1);
+        }
+      runBench (&benchTxScoreboard, segments, minIterations, "ACK, TcpTxBuffer SACK recovery");
+      runBench (&benchRxReassembly, segments, minIterations, "segment, TcpRxBuffer reassembly");
+    }
+
+  return 0;
+}
@@ -0,0 +1,288 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark how the TCP stack scales with the
+// number of concurrent connections. For every flow count, it runs that many
+// BulkSend flows across a dumbbell, from the left leaves to the right ones,
+// and reports the wall clock time of the setup and of the run, the number of
+// simulator events and their rate, the growth of the resident memory per
+// flow, and the activity of every layer: IP packets sent, packets enqueued
+// in and dropped by the queue discs, packets transmitted by the devices and
+// segments retransmitted by TCP.
+//
+// The resident memory freed by a run is reused by the next ones, so the
+// memory per flow is only accurate for the first flow count (or with a
+// single one, e.g. --flows=10000).
+//
+// Sample usage:  ./waf --run 'bench-tcp-flows --flows=10,100,1000,10000'
+//                ./waf --run 'bench-tcp-flows --transport=TcpDctcp
+//                  --queueDisc=ns3::DualQCoupledPiSquareQueueDisc
+//                  --ns3::TcpSocketBase::UseEcn=true'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <stdlib.h> // for exit ()
+#include <unistd.h> // for sysconf ()
+
+using namespace ns3;
+
+static const uint16_t g_sinkPort = 5000;  //!< port of the sinks
+
+/// Activity of the layers during a run
+struct Counters
+{
+  uint64_t ipTx;           //!< IP packets sent
+  uint64_t qdiscEnqueue;   //!< packets enqueued in the queue discs
+  uint64_t qdiscDrop;      //!< packets dropped by the queue discs
+  uint64_t phyTx;          //!< packets transmitted by the devices
+};
+
+static Counters g_counters; //!< activity of the current run
+
+static void
+IpTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  g_counters.ipTx++;
+}
+
+static void
+QueueDiscEnqueue (Ptr<const QueueDiscItem> item)
+{
+  g_counters.qdiscEnqueue++;
+}
+
+static void
+QueueDiscDrop (Ptr<const QueueDiscItem> item)
+{
+  g_counters.qdiscDrop++;
+}
+
+static void
+PhyTx (Ptr<const Packet> p)
+{
+  g_counters.phyTx++;
+}
+
+/**
+ * Resident memory of the process, read from /proc (Linux only)
+ * \return the resident memory in bytes, 0 if unknown
+ */
+static uint64_t
+GetResidentMemory (void)
+{
+  std::ifstream statm ("/proc/self/statm");
+  uint64_t size = 0;
+  uint64_t resident = 0;
+  if (!(statm >> size >> resident))
+    {
+      return 0;
+    }
+  return resident * sysconf (_SC_PAGESIZE);
+}
+
+/// Parameters of the runs
+struct BenchConfig
+{
+  uint32_t leaves;              //!< number of leaves on each side
+  std::string queueDisc;        //!< queue disc of the bottleneck
+  std::string bottleneckRate;   //!< rate of the bottleneck
+  std::string bottleneckDelay;  //!< delay of the bottleneck
+  std::string accessRate;       //!< rate of the access links
+  double duration;              //!< simulated time of a run, in seconds
+};
+
+/**
+ * Run flows concurrent connections across a dumbbell and print a line of
+ * results
+ * \param config the parameters of the run
+ * \param flows the number of connections
+ */
+static void
+runBench (const BenchConfig &config, uint32_t flows)
+{
+  g_counters = Counters ();
+  uint64_t memory = GetResidentMemory ();
+  SystemWallClockMs setupTime;
+  setupTime.Start ();
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue (config.accessRate));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue (config.bottleneckRate));
+  bottleneck.SetChannelAttribute ("Delay", StringValue (config.bottleneckDelay));
+  PointToPointDumbbellHelper dumbbell (config.leaves, access, config.leaves, access, bottleneck);
+
+  InternetStackHelper stack;
+  dumbbell.InstallStack (stack);
+
+  // The bottleneck device is the first one of the routers
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc (config.queueDisc);
+  NetDeviceContainer routerDevices;
+  routerDevices.Add (dumbbell.GetLeft ()->GetDevice (0));
+  routerDevices.Add (dumbbell.GetRight ()->GetDevice (0));
+  tch.Install (routerDevices);
+
+  dumbbell.AssignIpv4Addresses (Ipv4AddressHelper ("10.1.0.0", "255.255.255.0"),
+                                Ipv4AddressHelper ("10.2.0.0", "255.255.255.0"),
+                                Ipv4AddressHelper ("10.3.0.0", "255.255.255.0"));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory",
+                               InetSocketAddress (Ipv4Address::GetAny (), g_sinkPort));
+  ApplicationContainer sinks;
+  for (uint32_t i = 0; i < config.leaves; i++)
+    {
+      sinks.Add (sinkHelper.Install (dumbbell.GetRight (i)));
+    }
+  sinks.Start (Seconds (0));
+
+  // Spread the connection establishments over the first 100 ms
+  Time spread = MilliSeconds (100);
+  ApplicationContainer senders;
+  for (uint32_t flow = 0; flow < flows; flow++)
+    {
+      uint32_t leaf = flow % config.leaves;
+      BulkSendHelper sender ("ns3::TcpSocketFactory",
+                             InetSocketAddress (dumbbell.GetRightIpv4Address (leaf), g_sinkPort));
+      ApplicationContainer app = sender.Install (dumbbell.GetLeft (leaf));
+      app.Start (spread * flow / flows);
+      senders.Add (app);
+    }
+
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::Ipv4L3Protocol/Tx", MakeCallback (&IpTx));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::TrafficControlLayer/RootQueueDiscList/*/Enqueue",
+                                 MakeCallback (&QueueDiscEnqueue));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::TrafficControlLayer/RootQueueDiscList/*/Drop",
+                                 MakeCallback (&QueueDiscDrop));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/PhyTxEnd",
+                                 MakeCallback (&PhyTx));
+  uint64_t setupMs = setupTime.End ();
+
+  SystemWallClockMs runTime;
+  runTime.Start ();
+  Simulator::Stop (Seconds (config.duration));
+  Simulator::Run ();
+  uint64_t runMs = runTime.End ();
+  uint64_t events = Simulator::GetEventCount ();
+  uint64_t memoryAfter = GetResidentMemory ();
+  memory = memoryAfter > memory ? memoryAfter - memory : 0;
+
+  uint64_t retransmissions = 0;
+  for (uint32_t i = 0; i < config.leaves; i++)
+    {
+      Ptr<TcpL4Protocol> tcp = dumbbell.GetLeft (i)->GetObject<TcpL4Protocol> ();
+      for (uint32_t j = 0; j < tcp->GetNSockets (); j++)
+        {
+          retransmissions += tcp->GetSocket (j)->GetTcpInfo ().m_retransSegments;
+        }
+    }
+  uint64_t rxBytes = 0;
+  for (uint32_t i = 0; i < sinks.GetN (); i++)
+    {
+      rxBytes += DynamicCast<PacketSink> (sinks.Get (i))->GetTotalRx ();
+    }
+
+  std::cout << flows << "\t"
+            << setupMs << "\t"
+            << runMs << "\t"
+            << events << "\t"
+            << events * 1000 / std::max (runMs, (uint64_t) 1) << "\t"
+            << memory / 1024 / flows << "\t"
+            << g_counters.ipTx << "\t"
+            << g_counters.qdiscEnqueue << "\t"
+            << g_counters.qdiscDrop << "\t"
+            << g_counters.phyTx << "\t"
+            << retransmissions << "\t"
+            << rxBytes * 8 / config.duration / 1e6
+            << std::endl;
+
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  std::string flowCounts = "10,100,1000,10000";
+  std::string transport = "TcpNewReno";
+  BenchConfig config;
+  config.leaves = 10;
+  config.queueDisc = "ns3::PfifoFastQueueDisc";
+  config.bottleneckRate = "1Gbps";
+  config.bottleneckDelay = "10ms";
+  config.accessRate = "10Gbps";
+  config.duration = 2;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the TCP stack with many concurrent flows");
+  cmd.AddValue ("flows", "comma separated list of flow counts", flowCounts);
+  cmd.AddValue ("transport", "congestion control of the flows (TcpNewReno, TcpDctcp, TcpPrague...)", transport);
+  cmd.AddValue ("queueDisc", "queue disc of the bottleneck", config.queueDisc);
+  cmd.AddValue ("leaves", "number of leaves on each side of the dumbbell", config.leaves);
+  cmd.AddValue ("bottleneckRate", "rate of the bottleneck", config.bottleneckRate);
+  cmd.AddValue ("bottleneckDelay", "one way delay of the bottleneck", config.bottleneckDelay);
+  cmd.AddValue ("accessRate", "rate of the access links", config.accessRate);
+  cmd.AddValue ("duration", "simulated time of every run, in seconds", config.duration);
+  cmd.Parse (argc, argv);
+
+  std::vector<uint32_t> counts;
+  std::istringstream list (flowCounts);
+  std::string count;
+  while (std::getline (list, count, ','))
+    {
+      counts.push_back (atoi (count.c_str ()));
+    }
+  if (counts.empty () || config.leaves == 0 || config.duration <= 0)
+    {
+      std::cerr << "Error-- flow counts must be specified " <<
+        "by command-line argument --flows=(n1,n2...)" << std::endl;
+      exit (1);
+    }
+
+  TypeId tid;
+  if (!TypeId::LookupByNameFailSafe ("ns3::" + transport, &tid))
+    {
+      std::cerr << "Error-- unknown transport ns3::" << transport << std::endl;
+      exit (1);
+    }
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (tid));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+
+  std::cout << "Running bench-tcp-flows with transport=" << transport
+            << " queueDisc=" << config.queueDisc
+            << " bottleneck=" << config.bottleneckRate << "/" << config.bottleneckDelay
+            << " duration=" << config.duration << "s" << std::endl;
+  std::cout << "flows\tsetup(ms)\trun(ms)\tevents\tevents/s\tmemory/flow(KB)"
+            << "\tip-tx\tqdisc-enqueue\tqdisc-drop\tphy-tx\ttcp-retx\tgoodput(Mbps)" << std::endl;
+  for (std::vector<uint32_t>::const_iterator it = counts.begin (); it != counts.end (); ++it)
+    {
+      if (*it > 0)
+        {
+          runBench (config, *it);
+        }
+    }
+
+  return 0;
+}